@@ -5,21 +5,47 @@
 // Network: 8 inputs -> 16 hidden (ReLU) -> 4 outputs (argmax)
 // Total parameters: 212
 //
-// Memory layout (matches nn_engine.v):
-//   [  0..127] Layer 1 weights  (16 neurons x 8 inputs, row-major)
-//   [128..143] Layer 1 biases   (16 values)
-//   [144..207] Layer 2 weights  (4 neurons x 16 inputs, row-major)
-//   [208..211] Layer 2 biases   (4 values)
+// Memory layout (matches the nn_engine.v layer descriptors below):
+//   [  0..127] Layer 1 weights
+//   [128..143] Layer 1 biases
+//   [144..207] Layer 2 weights
+//   [208..211] Layer 2 biases
 //
-// Load into hardware via Wishbone register SE_NN_WEIGHTS:
-//   for (int i = 0; i < 212; i++)
-//       reg_write(SE_NN_WEIGHTS, NN_WEIGHT(i, all_weights[i]));
+// Load into the shadow bank via Wishbone, 4 weights per write, then the
+// layer descriptors, and swap it in with the layer count / precision:
+//   reg_write(SE_NN_WT_ADDR, 0);
+//   for (int i = 0; i < NN_PARAM_BYTES; i += 4)
+//       reg_write(SE_NN_WT_DATA, NN_WEIGHT_WORD(all_weights, i));
+//   for (int l = 0; l < NN_LAYERS; l++) {
+//       reg_write(SE_NN_LAYER_SHAPE(l), nn_layer_shape[l]);
+//       reg_write(SE_NN_LAYER_BASE(l), nn_layer_base[l]);
+//   }
+//   reg_write(SE_NN_CFG, NN_CFG_VALUE | NN_CFG_SWAP);
 
 #ifndef NN_WEIGHTS_H
 #define NN_WEIGHTS_H
 
 #include <stdint.h>
 
+// Model shape: layers and weight memory bytes (whole 32-bit words)
+#define NN_LAYERS      2
+#define NN_PARAM_BYTES 212
+
+// SE_NN_CFG: [3:0] INT4 layers, [10:8] layer count
+#define NN_CFG_VALUE   0x00000200
+
+// SE_NN_LAYER_SHAPE(l): inputs, outputs, ReLU, requantise shift
+static const uint32_t nn_layer_shape[NN_LAYERS] = {
+    0x00011008,  // layer 1: 8 -> 16, ReLU, shift 0
+    0x00000410,  // layer 2: 16 -> 4, shift 0
+};
+
+// SE_NN_LAYER_BASE(l): weight and bias base addresses
+static const uint32_t nn_layer_base[NN_LAYERS] = {
+    0x00800000,  // layer 1: weights 0, biases 128
+    0x00D00090,  // layer 2: weights 144, biases 208
+};
+
 // Layer 1 weights: 16 neurons x 8 inputs (row-major)
 // Address range: [0..127]
 // Weight for neuron n, input i = layer1_weights[n * 8 + i]
@@ -64,11 +90,11 @@ static const int8_t layer2_biases[4] = {
     -127,   75,  -18,   70
 };
 
-// All 212 parameters in flat array for sequential weight loading
+// Weight memory image, 212 bytes, streamed 4 per write
 // Layout: L1 weights[128] | L1 biases[16] | L2 weights[64] | L2 biases[4]
-// Load via: for (int i = 0; i < 212; i++)
-//               reg_write(SE_NN_WEIGHTS, NN_WEIGHT(i, all_weights[i]));
-static const int8_t all_weights[212] = {
+// Load via: for (int i = 0; i < NN_PARAM_BYTES; i += 4)
+//               reg_write(SE_NN_WT_DATA, NN_WEIGHT_WORD(all_weights, i));
+static const int8_t all_weights[NN_PARAM_BYTES] = {
     // Layer 1 weights [0..127]
       18,  -34,  -14,   41,  -54,  -64,   29,  -12,  -21,   24,  -21,  -21,   11,  -86,  -77,  -25,
      -45,   14,  -41,  -63,   66,  -10,    3,  -64,  -39,  -54,  -64,   15,  -42,  -70,  -41,   44,
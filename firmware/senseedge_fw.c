@@ -6,7 +6,8 @@
 //   2. Load pre-trained INT8 neural network weights
 //   3. Set ADC sample rate and alarm thresholds
 //   4. Enable the hardware pipeline
-//   5. Poll for classification results and transmit via UART
+//   5. Sleep until the result FIFO IRQ, drain it and transmit via UART
+//      (or let the hardware UART send the results itself, UART_AUTO_REPORT)
 
 #include <firmware_apis.h>
 #include "senseedge_regs.h"
@@ -14,42 +15,46 @@
 
 // ---------- Configuration ----------
 
-#define ADC_CLK_DIVIDER     250     // 25MHz / 250 = 100kHz SPI clock -> ~6.25 kSPS
+#define ADC_CLK_DIVIDER     250     // SPI bit clock; free running this sets the sample rate too
+#define ADC_SAMPLE_RATE     0       // Sample sets per second from the sample timer (0 = free running)
 #define ALARM_THRESHOLD     150     // Confidence threshold for fault alarm
 #define ALARM_FAULT_COUNT   3       // Consecutive faults before alarm triggers
-
-// UART bit-bang configuration (on GPIO 5)
-#define UART_BAUD_DELAY     217     // ~115200 baud at 25 MHz (25M / 115200 = 217)
-#define UART_GPIO           5
-
-// ---------- UART Bit-Bang ----------
-
-static void uart_delay(void)
-{
-    volatile int i;
-    for (i = 0; i < UART_BAUD_DELAY; i++);
-}
-
+#define FRAME_HOP_SIZE      HOP_NO_OVERLAP  // New samples per FFT frame
+#define FRAME_OVERRUN       FRAME_OVR_DROP_OLDEST   // Windows faster than the FFT: drop or stall
+#define ADC_CHANNELS        1       // ADCs sampled round robin (1-4, at most the chip's N_CH)
+#define AVG_SHIFT           0       // Spectral averaging weight 1/2^n per frame (0 = off)
+#define AVG_EVERY           1       // Classify every n-th (averaged) frame, 1-16
+#define GATE_THRESHOLD      0       // Reuse the last result below this feature change (0 = off)
+#define GATE_MAX_SKIP       16      // ...but run the NN at least every n + 1 frames (0 = never forced)
+#define FFT_LENGTH          FFT_SIZE_64     // Longer FFT = finer bins, lower frame rate
+#define NN_LOAD_AT_BOOT     1       // 0: keep the boot ROM model the NN resets to
+#define NN_MODEL_CFG        0       // SE_MODEL_CFG: per-channel or all resident models (0 = the loaded one)
+#define RESULT_BATCH        4       // Results queued per wake-up (RES_FIFO_DEPTH max)
+#define FW_USE_IRQ          1       // 1: sleep (wfi) until the user IRQ, 0: poll SE_IRQ_FLAGS
+#define RESULT_QUEUE        32      // Results buffered in RAM (power of 2)
+
+// UART configuration (hardware UART TX on GPIO 5)
+#define SYS_CLK_HZ          25000000
+#define UART_BAUD           115200
+#define UART_AUTO_REPORT    0       // 1: the hardware sends results as RESULT frames,
+                                    //    the core only wakes for alarms
+#define LINK_FRAMED         1       // 1: binary frames (ml/senseedge_link.py), 0: ASCII lines
+
+// Results carry a tag byte (SE_RES_FIFO_CH: channel, NN bank) when several
+// channels or models produce them
+#define RES_TAGGED          (ADC_CHANNELS > 1 || (NN_MODEL_CFG & (MODEL_CFG_PER_CH | MODEL_CFG_ALL(0))))
+#define LINK_SEND_FEATURES  1       // With each batch: features of the latest frame
+#define LINK_SPECTRUM_BINS  0       // With each batch: FFT magnitudes from bin 0 (0 = off, even, max 126)
+#define LINK_PERF_EVERY     0       // Every n batches: perf counters (0 = off)
+#define SNAP_TIMEOUT        1000000 // SE_SNAP_CTRL reads before a frame report is skipped
+
+// ---------- UART ----------
+
+// Queue a byte in the hardware UART FIFO; only waits while it is full
 static void uart_send_byte(uint8_t byte)
 {
-    int bit;
-
-    // Start bit (low)
-    GPIOs_writeLow(UART_GPIO, 0);
-    uart_delay();
-
-    // Data bits (LSB first)
-    for (bit = 0; bit < 8; bit++) {
-        if (byte & (1 << bit))
-            GPIOs_writeHigh(UART_GPIO, 1);
-        else
-            GPIOs_writeLow(UART_GPIO, 0);
-        uart_delay();
-    }
-
-    // Stop bit (high)
-    GPIOs_writeHigh(UART_GPIO, 1);
-    uart_delay();
+    while (UART_LEVEL(USER_readWord(SE_UART_DATA)) >= UART_FIFO_DEPTH);
+    USER_writeWord(byte, SE_UART_DATA);
 }
 
 static void uart_send_string(const char *str)
@@ -89,6 +94,43 @@ static void uart_send_dec(uint32_t val)
         uart_send_byte(buf[i]);
 }
 
+// ---------- Link Framing ----------
+
+static uint8_t link_crc;
+
+// One frame byte, folded into the CRC
+static void link_byte(uint8_t b)
+{
+    int i;
+
+    uart_send_byte(b);
+    link_crc ^= b;
+    for (i = 0; i < 8; i++)
+        link_crc = (link_crc & 0x80) ? (link_crc << 1) ^ LINK_CRC_POLY : link_crc << 1;
+}
+
+static void link_word(uint32_t w, int bytes)
+{
+    while (bytes-- > 0) {
+        link_byte(w & 0xFF);
+        w >>= 8;
+    }
+}
+
+// Sync, type and length; the caller sends len payload bytes, then link_end()
+static void link_begin(uint8_t type, uint8_t len)
+{
+    uart_send_byte(LINK_SYNC);
+    link_crc = 0;
+    link_byte(type);
+    link_byte(len);
+}
+
+static void link_end(void)
+{
+    uart_send_byte(link_crc);
+}
+
 // ---------- Classification Result Names ----------
 
 static const char *class_names[4] = {
@@ -98,17 +140,289 @@ static const char *class_names[4] = {
     "MISALIGNMENT"
 };
 
+// ---------- Reporting ----------
+
+// Status message: a TEXT frame, or a line
+static void report_text(const char *msg)
+{
+#if LINK_FRAMED
+    const char *p;
+    uint8_t len = 0;
+
+    for (p = msg; *p && len < 255; p++)
+        len++;
+    link_begin(LINK_TEXT, len);
+    while (len--)
+        link_byte((uint8_t)*msg++);
+    link_end();
+#else
+    uart_send_string(msg);
+    uart_send_string("\r\n");
+#endif
+}
+
+// One result: a 4-byte RESULT frame (8 bytes on the wire, one more with
+// the tag), or
+// CLASS:<name> CONF:<value> ALARM:<0/1> FRAME:<n>[ CH:<c>][ MODEL:<m>][ REUSED]
+// (about 50)
+static void report_result(uint32_t result, uint32_t tag)
+{
+#if LINK_FRAMED
+    link_begin(LINK_RESULT, 4 + RES_TAGGED);
+    link_word(result, 4);
+    if (RES_TAGGED)
+        link_byte(tag);
+    link_end();
+#else
+    uart_send_string("CLASS:");
+    uart_send_string(class_names[RES_CLASS_ID(result)]);
+
+    uart_send_string(" CONF:");
+    uart_send_dec(RES_CONFIDENCE(result));
+
+    uart_send_string(" ALARM:");
+    uart_send_byte(RES_ALARM(result) ? '1' : '0');
+
+    uart_send_string(" FRAME:");
+    uart_send_dec(RES_FRAME(result));
+    if (ADC_CHANNELS > 1) {
+        uart_send_string(" CH:");
+        uart_send_dec(RES_CH(tag));
+    }
+    if (RES_TAGGED && NN_MODEL_CFG) {
+        uart_send_string(" MODEL:");
+        uart_send_dec(RES_MODEL(tag));
+    }
+    if (RES_REUSED(result))
+        uart_send_string(" REUSED");
+    uart_send_string("\r\n");
+#endif
+}
+
+static void report_alarm(uint32_t class_id)
+{
+#if LINK_FRAMED
+    link_begin(LINK_ALARM, 1);
+    link_byte(class_id);
+    link_end();
+#else
+    uart_send_string("*** ALARM: Fault detected! ***\r\n");
+    uart_send_string("Class: ");
+    uart_send_string(class_names[class_id]);
+    uart_send_string("\r\n");
+#endif
+}
+
+// Features and spectrum of the frame the pipeline finished last (framed
+// link only): 3 + LINK_SPECTRUM_BINS / 2 packed reads from a readback
+// snapshot, so they all belong to one frame (and channel). The snapshot is
+// released before the UART starts, the pipeline stalls while it is held.
+// Skipped if no frame is published within SNAP_TIMEOUT reads (pipeline
+// disabled or stalled).
+static void report_frame_data(void)
+{
+#if LINK_FRAMED && (LINK_SEND_FEATURES || LINK_SPECTRUM_BINS)
+    static uint32_t snap_words[3 + LINK_SPECTRUM_BINS / 2];
+    uint32_t snap;
+    uint32_t wait_count = 0;
+    uint32_t i;
+
+    USER_writeWord(SNAP_TAKE, SE_SNAP_CTRL);
+    while (!((snap = USER_readWord(SE_SNAP_CTRL)) & SNAP_HELD)) {
+        if (++wait_count > SNAP_TIMEOUT) {
+            USER_writeWord(0, SE_SNAP_CTRL);
+            return;
+        }
+    }
+    snap_words[0] = USER_readWord(SE_SNAP_FEAT0);
+    snap_words[1] = USER_readWord(SE_SNAP_FEAT1);
+    snap_words[2] = USER_readWord(SE_SNAP_FEAT2);
+    for (i = 0; i < LINK_SPECTRUM_BINS / 2; i++)
+        snap_words[3 + i] = USER_readWord(SE_SPECTRUM(i));
+    USER_writeWord(0, SE_SNAP_CTRL);
+
+    if (LINK_SEND_FEATURES) {
+        link_begin(LINK_FEATURES, 2 + FEAT_COUNT + (ADC_CHANNELS > 1));
+        link_word(SNAP_FRAME(snap), 2);
+        for (i = 0; i < FEAT_COUNT / 4; i++)
+            link_word(snap_words[i], 4);
+        if (ADC_CHANNELS > 1)
+            link_byte(SNAP_CH(snap));
+        link_end();
+    }
+    if (LINK_SPECTRUM_BINS) {
+        link_begin(LINK_SPECTRUM, 2 + 2 * LINK_SPECTRUM_BINS + (ADC_CHANNELS > 1));
+        link_word(SNAP_FRAME(snap), 2);
+        for (i = 0; i < LINK_SPECTRUM_BINS / 2; i++)
+            link_word(snap_words[3 + i], 4);
+        if (ADC_CHANNELS > 1)
+            link_byte(SNAP_CH(snap));
+        link_end();
+    }
+#endif
+}
+
+#if LINK_PERF_EVERY
+// Frame, drop and overrun counts and the longest cycle count of every
+// stage since the previous report (reading them clears them): a PERF
+// frame, or PERF FRAMES:<n> DROPS:<n> OVERRUNS:<n> SPI:<n> ... LAT:<n>
+static void report_perf(void)
+{
+    uint32_t frames, drops, overruns;
+    uint32_t stage_max[PERF_LAT + 1];
+    int s;
+
+    frames   = USER_readWord(SE_PERF_FRAMES);
+    drops    = USER_readWord(SE_PERF_DROPS);
+    overruns = USER_readWord(SE_PERF_OVERRUNS);
+    for (s = PERF_SPI; s <= PERF_LAT; s++)
+        stage_max[s] = USER_readWord(SE_PERF_MAX(s));
+
+#if LINK_FRAMED
+    link_begin(LINK_PERF, 8 + 4 * (PERF_LAT + 1));
+    link_word(frames, 4);
+    link_word(drops, 2);
+    link_word(overruns, 2);
+    for (s = PERF_SPI; s <= PERF_LAT; s++)
+        link_word(stage_max[s], 4);
+    link_end();
+#else
+    static const char *stage_names[PERF_LAT + 1] = {
+        " SPI:", " FFT:", " FE:", " NN:", " LAT:"
+    };
+
+    uart_send_string("PERF FRAMES:");
+    uart_send_dec(frames);
+    uart_send_string(" DROPS:");
+    uart_send_dec(drops);
+    uart_send_string(" OVERRUNS:");
+    uart_send_dec(overruns);
+    for (s = PERF_SPI; s <= PERF_LAT; s++) {
+        uart_send_string(stage_names[s]);
+        uart_send_dec(stage_max[s]);
+    }
+    uart_send_string("\r\n");
+#endif
+}
+#endif
+
+// ---------- Model Loading ----------
+
+// Load nn_weights.h into the shadow model bank and swap it in. The weight
+// image is streamed 4 bytes per write; classification keeps running on
+// the active bank until the swap, so this also updates a model in the
+// field without stopping the pipeline.
+static void nn_load_model(void)
+{
+    uint32_t i;
+
+    // An inference started before the last swap may still read this bank
+    while (USER_readWord(SE_STATUS) & STATUS_NN_BUSY);
+
+    USER_writeWord(0, SE_NN_WT_ADDR);
+    for (i = 0; i < NN_PARAM_BYTES; i += 4)
+        USER_writeWord(NN_WEIGHT_WORD(all_weights, i), SE_NN_WT_DATA);
+
+    // Layer descriptors, then layer count and precision with the swap
+    for (i = 0; i < NN_LAYERS; i++) {
+        USER_writeWord(nn_layer_shape[i], SE_NN_LAYER_SHAPE(i));
+        USER_writeWord(nn_layer_base[i], SE_NN_LAYER_BASE(i));
+    }
+    USER_writeWord(NN_CFG_VALUE | NN_CFG_SWAP, SE_NN_CFG);
+}
+
+// ---------- Result Service ----------
+
+// Results moved out of the hardware FIFO, waiting for the UART
+static uint32_t res_queue[RESULT_QUEUE];
+static uint8_t  res_queue_tag[RESULT_QUEUE];    // Their SE_RES_FIFO_CH tags
+static uint32_t res_head;           // Next free entry
+static uint32_t res_tail;           // Next entry to send
+static uint32_t res_flags;          // SE_IRQ_FLAGS seen since the last report
+static uint32_t res_lost;           // Results dropped by a full software queue
+
+// Work pending: the user IRQ fired (FW_USE_IRQ), or the flags say so
+static int se_pending(void)
+{
+#if FW_USE_IRQ
+    return IRQ_getFlag();
+#else
+    return USER_readWord(SE_IRQ_FLAGS) & (IRQ_RES_FIFO | IRQ_ALARM);
+#endif
+}
+
+// Result IRQ service: acknowledge the flags (which drops irq[0]) and move
+// every queued result to RAM, a Wishbone read each (two with tagged
+// results), so the hardware FIFO has room again long before the UART has
+// sent the batch.
+static void se_service(void)
+{
+    uint32_t flags;
+    uint32_t result;
+
+#if FW_USE_IRQ
+    IRQ_clearFlag();                // An IRQ from here on wakes us again
+#endif
+    flags = USER_readWord(SE_IRQ_FLAGS);
+    USER_writeWord(flags, SE_IRQ_FLAGS);
+    res_flags |= flags;
+
+    while ((result = USER_readWord(SE_RES_FIFO)) & RES_VALID) {
+        if (res_head - res_tail < RESULT_QUEUE) {
+            res_queue_tag[res_head % RESULT_QUEUE] =
+                RES_TAGGED ? USER_readWord(SE_RES_FIFO_CH) & 0x33 : 0;
+            res_queue[res_head++ % RESULT_QUEUE] = result;
+        } else {
+            res_lost++;
+        }
+    }
+}
+
+#if FW_USE_IRQ
+// Sleep in wfi unless the user IRQ has already been taken. The user IRQ is
+// edge-triggered and irq[0] stays high until the flags are acknowledged,
+// so an IRQ taken between the check and the wfi would never come again.
+// mstatus.MIE is cleared around both: wfi still wakes on the pending IRQ,
+// which is taken as soon as MIE is set again.
+static void se_sleep(void)
+{
+    __asm__ volatile ("csrci mstatus, 8");
+    if (!IRQ_getFlag())
+        __asm__ volatile ("wfi");
+    __asm__ volatile ("csrsi mstatus, 8");
+}
+#endif
+
+// Idle until there is work. With FW_USE_IRQ the core sleeps in wfi until
+// the user IRQ (se_sleep).
+static void se_wait(void)
+{
+#if FW_USE_IRQ
+    while (!se_pending())
+        se_sleep();
+#else
+    uint32_t cycle_count = 0;
+
+    while (!se_pending()) {
+        if (++cycle_count > 1000000) {
+            // Timeout — pipeline may be stuck
+            report_text("WARN: Pipeline timeout");
+            return;
+        }
+    }
+#endif
+}
+
 // ---------- Main Firmware ----------
 
 void main(void)
 {
-    uint32_t i;
     uint32_t status;
     uint32_t result;
     uint32_t class_id;
-    uint32_t confidence;
-    uint32_t irq_flags;
-    uint32_t cycle_count;
+    uint32_t batches;
+    uint32_t ch;
+    uint32_t tag;
 
     // --- Phase 1: GPIO Configuration ---
     ManagmentGpio_outputEnable();
@@ -130,95 +444,151 @@ void main(void)
     GPIOs_configure(5, GPIO_MODE_USER_STD_OUTPUT);
     // GPIO 6: UART RX (input from ESP32)
     GPIOs_configure(6, GPIO_MODE_USER_STD_INPUT_NOPULL);
+    // GPIO 30-32: SPI CS_N of ADC channels 1-3
+    for (ch = 1; ch < ADC_CHANNELS; ch++)
+        GPIOs_configure(CH_CS_GPIO(ch), GPIO_MODE_USER_STD_OUTPUT);
 
     GPIOs_loadConfigs();
 
     // Enable Wishbone user interface
     User_enableIF();
 
+#if FW_USE_IRQ
+    // SenseEdge irq[0] wakes the core (enabled in SE_CTRL below)
+    IRQ_enableUser0(1);
+#endif
+
     // Signal: GPIO config complete
     ManagmentGpio_write(1);
 
     // --- Phase 2: Load Neural Network Weights ---
-    // Write all 212 parameters to the NN weight registers
-    // The hardware expects: address in [15:8], data in [7:0]
-    for (i = 0; i < NN_TOTAL_PARAMS; i++) {
-        USER_writeWord(NN_WEIGHT(i, (uint8_t)all_weights[i]), SE_NN_WEIGHTS);
-    }
+#if NN_LOAD_AT_BOOT
+    nn_load_model();
+#endif
 
     // Signal: weights loaded
     ManagmentGpio_write(2);
 
     // --- Phase 3: Configure System ---
-    // Set ADC clock divider for desired sample rate
+    // Set the SPI bit clock, and the sample rate if the timer is used:
+    // a fast bit clock then keeps the chip select short at any rate
     USER_writeWord(ADC_CLK_DIVIDER, SE_CLK_DIV);
+#if ADC_SAMPLE_RATE
+    USER_writeWord(SAMPLE_PERIOD(SYS_CLK_HZ, ADC_SAMPLE_RATE), SE_SAMPLE_PERIOD);
+#endif
+
+    // Set frame hop size (smaller hop = overlapped frames, faster results)
+    // and what happens when frames come faster than the pipeline runs;
+    // with several ADC channels every one is classified in turn
+    USER_writeWord(FRAME_CFG(FRAME_HOP_SIZE, FRAME_OVERRUN) | FRAME_CHANNELS(ADC_CHANNELS),
+                   SE_FRAME_CFG);
+
+    // Average spectra across frames and classify once per AVG_EVERY windows:
+    // a steadier result, fewer NN runs and reports
+    USER_writeWord(AVG_CFG(AVG_SHIFT, AVG_EVERY), SE_AVG_CFG);
+
+    // Skip the NN on frames whose features barely moved; they report the
+    // previous class again, flagged RES_REUSED
+    USER_writeWord(GATE_CFG(GATE_THRESHOLD, GATE_MAX_SKIP), SE_GATE_CFG);
+
+    // Resident models: which bank classifies which channel, or every bank
+    // on every frame (faults then count per bank)
+    USER_writeWord(NN_MODEL_CFG, SE_MODEL_CFG);
+
+    // UART bit rate, CPU-fed until the startup message is out
+    USER_writeWord(UART_CFG(UART_DIV(SYS_CLK_HZ, UART_BAUD)), SE_UART_CFG);
 
     // Set alarm configuration: threshold and consecutive fault count
     USER_writeWord(ALARM_CFG(ALARM_THRESHOLD, ALARM_FAULT_COUNT), SE_ALARM_CFG);
 
-    // Clear any pending IRQ flags
-    USER_writeWord(0x3, SE_IRQ_FLAGS);
+    // Result FIFO: flag a batch, start empty; clear any pending IRQ flags
+    USER_writeWord(RES_CFG_LEVEL(RESULT_BATCH) | RES_CFG_FLUSH, SE_RES_CFG);
+    USER_writeWord(IRQ_CLASS_DONE | IRQ_ALARM | IRQ_RES_FIFO, SE_IRQ_FLAGS);
 
     // --- Phase 4: Enable Pipeline ---
-    USER_writeWord(0x1, SE_CTRL);
+#if FW_USE_IRQ
+    USER_writeWord(CTRL_ENABLE | CTRL_FFT_SIZE(FFT_LENGTH) |
+                   CTRL_IRQ_EN(IRQ_RES_FIFO | IRQ_ALARM), SE_CTRL);
+#else
+    USER_writeWord(CTRL_ENABLE | CTRL_FFT_SIZE(FFT_LENGTH), SE_CTRL);
+#endif
 
     // Signal: system running
     ManagmentGpio_write(3);
 
     // Send startup message via UART
-    uart_send_string("SenseEdge v1.0 Online\r\n");
-    uart_send_string("Monitoring vibration...\r\n");
+    report_text("SenseEdge v1.0 Online");
+    report_text("Monitoring vibration...");
+
+#if UART_AUTO_REPORT
+    // --- Phase 5: Hardware Reporting ---
+    // Every result leaves as a RESULT frame straight from the result FIFO
+    // (alarms as its alarm bit); the core must not read SE_RES_FIFO now,
+    // and sleeps until an alarm
+    USER_writeWord(UART_CFG(UART_DIV(SYS_CLK_HZ, UART_BAUD)) | UART_CFG_AUTO, SE_UART_CFG);
+    USER_writeWord(RES_CFG_LEVEL(0), SE_RES_CFG);
+#if FW_USE_IRQ
+    USER_writeWord(CTRL_ENABLE | CTRL_FFT_SIZE(FFT_LENGTH) | CTRL_IRQ_EN(IRQ_ALARM), SE_CTRL);
+#endif
+    batches = 0;
+    while (1) {
+        while (!(USER_readWord(SE_IRQ_FLAGS) & IRQ_ALARM)) {
+#if FW_USE_IRQ
+            se_sleep();
+            IRQ_clearFlag();
+#endif
+        }
+        USER_writeWord(IRQ_ALARM, SE_IRQ_FLAGS);
+
+        // Signal: alarm raised on management GPIO
+        ManagmentGpio_write(3 + (++batches & 1));
+    }
+#endif
 
     // --- Phase 5: Main Classification Loop ---
+    // The core idles between batches; the hardware keeps queueing results
+    class_id = CLASS_HEALTHY;
+    batches = 0;
     while (1) {
-        // Poll for classification done IRQ
-        cycle_count = 0;
-        do {
-            irq_flags = USER_readWord(SE_IRQ_FLAGS);
-            cycle_count++;
-            if (cycle_count > 1000000) {
-                // Timeout — pipeline may be stuck
-                uart_send_string("WARN: Pipeline timeout\r\n");
-                break;
-            }
-        } while (!(irq_flags & IRQ_CLASS_DONE));
-
-        // Clear IRQ flags
-        USER_writeWord(irq_flags, SE_IRQ_FLAGS);
-
-        // Read classification result
-        result = USER_readWord(SE_CLASS_RESULT);
-        class_id = GET_CLASS_ID(result);
-        confidence = GET_CONFIDENCE(result);
-
-        // Read status (check alarm)
-        status = USER_readWord(SE_STATUS);
+        se_wait();
+        se_service();
 
-        // Transmit result via UART
-        // Format: CLASS:<name> CONF:<value> ALARM:<0/1>\r\n
-        uart_send_string("CLASS:");
-        if (class_id < 4)
-            uart_send_string(class_names[class_id]);
-        else
-            uart_send_string("UNKNOWN");
+        while (res_tail != res_head) {
+            tag    = res_queue_tag[res_tail % RESULT_QUEUE];
+            result = res_queue[res_tail++ % RESULT_QUEUE];
+            class_id = RES_CLASS_ID(result);
 
-        uart_send_string(" CONF:");
-        uart_send_dec(confidence);
+            // Transmit result via UART
+            report_result(result, tag);
 
-        uart_send_string(" ALARM:");
-        uart_send_byte((status & STATUS_ALARM) ? '1' : '0');
-        uart_send_string("\r\n");
+            // Keep the hardware FIFO drained while the UART is busy
+            if (se_pending())
+                se_service();
+        }
 
-        // Check for alarm condition
-        if (irq_flags & IRQ_ALARM) {
-            uart_send_string("*** ALARM: Fault detected! ***\r\n");
-            uart_send_string("Class: ");
-            uart_send_string(class_names[class_id]);
-            uart_send_string("\r\n");
+        // Results lost to a full FIFO show up as a FRAME gap
+        status = USER_readWord(SE_STATUS);
+        if ((status & STATUS_RES_OVF) || res_lost) {
+            report_text("WARN: Results dropped");
+            USER_writeWord(RES_CFG_LEVEL(RESULT_BATCH) | RES_CFG_CLR_OVF, SE_RES_CFG);
+            res_lost = 0;
         }
 
+        // Check for alarm condition
+        if (res_flags & IRQ_ALARM)
+            report_alarm(class_id);
+
+        report_frame_data();
+
+        res_flags = 0;
+
         // Signal: result available on management GPIO
         // Toggle between 3 and 4 to indicate new results
-        ManagmentGpio_write(3 + (cycle_count & 1));
+        ManagmentGpio_write(3 + (++batches & 1));
+
+#if LINK_PERF_EVERY
+        if (batches % LINK_PERF_EVERY == 0)
+            report_perf();
+#endif
     }
 }
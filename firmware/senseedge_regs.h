@@ -9,15 +9,53 @@
 #define SE_BASE             0x30000000
 
 // Control and status registers
-#define SE_CTRL             (SE_BASE + 0x00)  // R/W: [0]=enable
+#define SE_CTRL             (SE_BASE + 0x00)  // R/W: [0]=enable [1]=inject [2]=trigger (W) [5:4]=fft_size [11:8]=irq_enable
 #define SE_STATUS           (SE_BASE + 0x04)  // R:   [0]=enable [1]=fft_busy [2]=nn_busy [3]=fe_busy [4]=alarm
+                                              //      [12:8]=result FIFO level [13]=result FIFO overflow
+                                              //      [14]=sample overrun (IRQ_FLAGS[3])
 #define SE_CLASS_RESULT     (SE_BASE + 0x08)  // R:   [1:0]=class_id [9:2]=confidence
 #define SE_ALARM_CFG        (SE_BASE + 0x0C)  // R/W: [7:0]=threshold [11:8]=consecutive_faults
 #define SE_FFT_DATA         (SE_BASE + 0x10)  // R:   16-bit FFT magnitude (auto-increment)
-#define SE_FEATURE_DATA     (SE_BASE + 0x14)  // R:   8-bit feature value (auto-increment)
-#define SE_IRQ_FLAGS        (SE_BASE + 0x18)  // R/W: [0]=class_done [1]=alarm_irq
-#define SE_CLK_DIV          (SE_BASE + 0x1C)  // R/W: [15:0]=ADC clock divider
-#define SE_NN_WEIGHTS       (SE_BASE + 0x20)  // W:   NN weight write (addr in [15:8], data in [7:0])
+#define SE_FEATURE_DATA     (SE_BASE + 0x14)  // R:   8-bit feature value, FEAT_* 0-11 (auto-increment)
+#define SE_IRQ_FLAGS        (SE_BASE + 0x18)  // R/W: [0]=class_done [1]=alarm_irq [2]=result FIFO level [3]=overrun
+#define SE_CLK_DIV          (SE_BASE + 0x1C)  // R/W: [15:0]=SPI bit clock divider: SCLK = clk / (2 * (n + 1))
+#define SE_NN_WEIGHTS       (SE_BASE + 0x20)  // W:   weights 0-211, byte k of word 0x20 + a = weight a + k
+#define SE_FRAME_CFG        (SE_BASE + 0x78)  // R/W: [8:0]=hop size (new samples per frame, 1-N), [13:12]=overrun policy
+                                              //      [17:16]=ADC channels - 1
+#define SE_NN_CFG           (SE_BASE + 0x7C)  // R/W: [3:0]=INT4 layers (bit l = layer l) [10:8]=layer count
+                                              //      [16]=swap (W1) [18:17]=active bank (R)
+#define SE_NN_LAYER_SHAPE(l) (SE_BASE + 0x80 + 8 * (l))  // R/W: [5:0]=inputs [13:8]=outputs [16]=ReLU [23:20]=shift
+#define SE_NN_LAYER_BASE(l)  (SE_BASE + 0x84 + 8 * (l))  // R/W: [9:0]=weight base [25:16]=bias base
+#define SE_NN_WT_ADDR       (SE_BASE + 0xA0)  // R/W: [9:0]=weight streaming address (word aligned)
+#define SE_NN_WT_DATA       (SE_BASE + 0xA4)  // W:   4 weights at SE_NN_WT_ADDR, which steps by 4
+#define SE_RES_FIFO         (SE_BASE + 0xA8)  // R:   pop the oldest result (0 if empty)
+#define SE_RES_FIFO_HI      (SE_BASE + 0xAC)  // R:   [15:0]=top score [31:16]=runner-up score of the last pop
+#define SE_RES_CFG          (SE_BASE + 0xB0)  // R/W: [4:0]=IRQ level (0 = off), W [8]=flush [9]=clear overflow
+#define SE_UART_DATA        (SE_BASE + 0xB4)  // W:   [7:0]=byte to send  R: [4:0]=bytes queued [8]=busy
+#define SE_UART_CFG         (SE_BASE + 0xB8)  // R/W: [15:0]=bit period - 1 (clocks) [16]=auto-report results
+                                              //      [17]=auto frames carry RES_FIFO_HI
+#define SE_SNAP_CTRL        (SE_BASE + 0xBC)  // R/W: [0]=take (1) / release (0)  R: [1]=held [5:4]=fft_size
+                                              //      [7:6]=channel [31:16]=frame
+#define SE_SNAP_FEAT0       (SE_BASE + 0xC0)  // R:   features 0-3 of the snapshot, feature 0 in [7:0]
+#define SE_SNAP_FEAT1       (SE_BASE + 0xC4)  // R:   features 4-7
+#define SE_SNAP_FEAT2       (SE_BASE + 0xC8)  // R:   features 8-11 (time domain)
+#define SE_AVG_CFG          (SE_BASE + 0xCC)  // R/W: [2:0]=spectral averaging shift (0 = off) [11:8]=classify every n+1 frames
+#define SE_GATE_CFG         (SE_BASE + 0xD0)  // R/W: [11:0]=change gate threshold (0 = off) [23:16]=max skips in a row
+#define SE_RES_FIFO_CH      (SE_BASE + 0xD4)  // R:   [1:0]=ADC channel [5:4]=NN bank of the last pop
+#define SE_SAMPLE_PERIOD    (SE_BASE + 0xD8)  // R/W: [23:0]=clocks per ADC sample set (0 = free running)
+#define SE_SAMPLE_IN        (SE_BASE + 0xDC)  // W:   [11:0]=next sample (ADC code, CTRL_INJECT) R: [0]=taken at once
+#define SE_MODEL_CFG        (SE_BASE + 0xE0)  // R/W: [0]=per-channel banks [1]=all banks [5:4]=last bank
+                                              //      [15:8]=channel map [17:16]=edit bank [18]=edit enable
+#define SE_PROFILE(m)       (SE_BASE + 0xE4 + 4 * (m))  // R/W: [7:0]=threshold [11:8]=consecutive_faults [16]=enable
+#define SE_SPECTRUM(k)      (SE_BASE + 0x100 + 4 * (k))  // R: bins 2k [15:0] and 2k+1 [31:16] of the snapshot
+#define SE_PERF_FRAMES      (SE_BASE + 0x200) // R:   frames classified since reset (free running, skips included)
+#define SE_PERF_DROPS       (SE_BASE + 0x204) // R:   [15:0]=windows dropped (read clears)
+#define SE_PERF_OVERRUNS    (SE_BASE + 0x208) // R:   [15:0]=windows handed over while the FFT ran (read clears)
+#define SE_PERF_STALLS      (SE_BASE + 0x20C) // R:   [15:0]=FRAME_OVR_STALL stalls and lost sample periods (read clears)
+#define SE_PERF_LAST(s)     (SE_BASE + 0x210 + 8 * (s))  // R: cycles of stage s (PERF_*) in the last frame
+#define SE_PERF_MAX(s)      (SE_BASE + 0x214 + 8 * (s))  // R: longest since the last read (read clears)
+#define SE_PERF_SKIPS       (SE_BASE + 0x238) // R:   [15:0]=results reused by the change gate (read clears)
+#define SE_PERF_REJECTS     (SE_BASE + 0x23C) // R:   [15:0]=SAMPLE_IN samples dropped, sampling held (read clears)
 
 // Status register bit positions
 #define STATUS_ENABLE       (1 << 0)
@@ -25,10 +63,42 @@
 #define STATUS_NN_BUSY      (1 << 2)
 #define STATUS_FE_BUSY      (1 << 3)
 #define STATUS_ALARM        (1 << 4)
+#define STATUS_RES_LEVEL(s) (((s) >> 8) & 0x1F)  // Results queued
+#define STATUS_RES_OVF      (1 << 13)            // Results dropped since the last flush
+#define STATUS_OVERRUN      (1 << 14)            // IRQ_OVERRUN flag: window lost or sampling stalled
+
+// Control register fields
+#define CTRL_ENABLE         (1 << 0)
+#define CTRL_FFT_SIZE(sz)   (((sz) & 0x3) << 4)
+#define CTRL_IRQ_EN(m)      (((m) & 0xF) << 8)  // IRQ_* flags driving irq[0]
+#define CTRL_INJECT         (1 << 1)    // Samples from SE_SAMPLE_IN, SPI idle
+#define CTRL_TRIG           (1 << 2)    // Write 1: classify the newest window now
+
+// FFT length select (CTRL[5:4]), clamped to the synthesized maximum
+#define FFT_SIZE_64         0       // 32 bins
+#define FFT_SIZE_128        1       // 64 bins
+#define FFT_SIZE_256        2       // 128 bins
+
+// Feature indices (SE_FEATURE_DATA address, byte of SE_SNAP_FEAT0-2)
+#define FEAT_BAND_LOW       0
+#define FEAT_BAND_MIDLOW    1
+#define FEAT_BAND_MIDHI     2
+#define FEAT_BAND_HIGH      3
+#define FEAT_PEAK_FREQ      4
+#define FEAT_PEAK_MAG       5
+#define FEAT_CENTROID       6
+#define FEAT_TOTAL_ENERGY   7
+#define FEAT_RMS            8       // Standard deviation of the window >> 3
+#define FEAT_PEAK           9       // max |x| >> 3
+#define FEAT_CREST          10      // 16 * peak / RMS, saturated
+#define FEAT_KURTOSIS       11      // 16 * E[x^4] / E[x^2]^2, saturated (Gaussian ~48)
+#define FEAT_COUNT          12
 
 // IRQ flag bit positions
 #define IRQ_CLASS_DONE      (1 << 0)
 #define IRQ_ALARM           (1 << 1)
+#define IRQ_RES_FIFO        (1 << 2)    // A result brought the FIFO to the RES_CFG level
+#define IRQ_OVERRUN         (1 << 3)    // A sample window was lost, or sampling stalled
 
 // Classification classes
 #define CLASS_HEALTHY        0
@@ -40,13 +110,155 @@
 #define GET_CLASS_ID(reg)    ((reg) & 0x3)
 #define GET_CONFIDENCE(reg)  (((reg) >> 2) & 0xFF)
 
+// Result FIFO entries (SE_RES_FIFO word, then SE_RES_FIFO_HI). Frame numbers
+// count the sample windows handed over since reset; a gap is a dropped window
+#define RES_FIFO_DEPTH       8
+#define RES_VALID            (1 << 11)
+#define RES_CLASS_ID(w)      ((w) & 0x3)
+#define RES_CONFIDENCE(w)    (((w) >> 2) & 0xFF)
+#define RES_ALARM(w)         (((w) >> 10) & 0x1)
+#define RES_SECOND_ID(w)     (((w) >> 12) & 0x3)
+#define RES_REUSED(w)        (((w) >> 14) & 0x1)  // Change gate skip: NN did not run
+#define RES_FRAME(w)         ((w) >> 16)
+#define RES_TOP_SCORE(hi)    ((int16_t)((hi) & 0xFFFF))
+#define RES_SECOND_SCORE(hi) ((int16_t)((hi) >> 16))
+#define RES_CH(c)            ((c) & 0x3)          // SE_RES_FIFO_CH
+#define RES_MODEL(c)         (((c) >> 4) & 0x3)   // SE_RES_FIFO_CH: NN bank the result came from
+#define RES_CFG_LEVEL(n)     ((n) & 0x1F)
+#define RES_CFG_FLUSH        (1 << 8)
+#define RES_CFG_CLR_OVF      (1 << 9)
+
+// UART TX (GPIO 5): 16-byte FIFO; writes to a full FIFO, or in AUTO mode,
+// are dropped. AUTO sends each result FIFO entry as a LINK_RESULT frame
+#define UART_FIFO_DEPTH      16
+#define UART_LEVEL(d)        ((d) & 0x1F)
+#define UART_BUSY            (1 << 8)
+#define UART_CFG(div)        ((div) & 0xFFFF)
+#define UART_CFG_AUTO        (1 << 16)
+#define UART_CFG_SCORES      (1 << 17)
+#define UART_DIV(clk, baud)  (((clk) + (baud) / 2) / (baud) - 1)  // Nearest bit period
+
+// Readback snapshot: hold the latest spectrum and features of one frame
+// while the pipeline carries on; it stalls after one more frame, so
+// release it as soon as the readback is done
+#define SNAP_TAKE            (1 << 0)
+#define SNAP_HELD            (1 << 1)
+#define SNAP_FFT_SIZE(s)     (((s) >> 4) & 0x3)
+#define SNAP_CH(s)           (((s) >> 6) & 0x3)
+#define SNAP_FRAME(s)        ((s) >> 16)
+
+// Performance counter stages (SE_PERF_LAST / SE_PERF_MAX), in clocks.
+// Stage counts saturate at 2^24 - 1, the latency wraps modulo 2^24
+#define PERF_SPI             0      // Window hand-over interval (SPI fill of one hop)
+#define PERF_FFT             1      // FFT start to done
+#define PERF_FE              2      // Feature extraction (started with the FFT) to done
+#define PERF_NN              3      // NN start to done
+#define PERF_LAT             4      // Window hand-over to classification (end to end)
+
+// Link frames: LINK_SYNC, type, payload length (0-255), payload, CRC-8
+// (polynomial 0x07, init 0) over type, length and payload. Multi-byte
+// fields are little endian. With more than one ADC channel, RESULT,
+// FEATURES and SPECTRUM payloads end in a channel byte (odd lengths); with
+// MODEL_CFG_PER_CH / MODEL_CFG_ALL a RESULT payload always does, the NN
+// bank in its [5:4] as in SE_RES_FIFO_CH
+#define LINK_SYNC            0xA5
+#define LINK_RESULT          0x01   // SE_RES_FIFO word, optionally then SE_RES_FIFO_HI
+#define LINK_FEATURES        0x02   // 16-bit frame number, then its 12 feature bytes
+#define LINK_SPECTRUM        0x03   // 16-bit frame number, then 16-bit magnitudes from bin 0
+#define LINK_ALARM           0x04   // Fault class that raised the alarm
+#define LINK_TEXT            0x05   // ASCII message, no line ending
+#define LINK_PERF            0x06   // SE_PERF_FRAMES (4), DROPS (2), OVERRUNS (2), then
+                                    // SE_PERF_MAX of PERF_SPI..PERF_LAT (4 each)
+#define LINK_CRC_POLY        0x07
+
 // Pack alarm config: threshold in [7:0], fault count in [11:8]
 #define ALARM_CFG(threshold, faults)  (((faults) << 8) | ((threshold) & 0xFF))
 
-// Pack NN weight write: address in [15:8], data in [7:0]
-#define NN_WEIGHT(addr, data)  (((addr) << 8) | ((data) & 0xFF))
+// Frame hop sizes at N = 64: 64 = no overlap, 32 = 50% overlap, 16 = 75% overlap
+// (0 = one full frame of the selected length)
+#define HOP_NO_OVERLAP      64
+#define HOP_HALF_OVERLAP    32
+#define HOP_75PCT_OVERLAP   16
+
+// Overrun policy (SE_FRAME_CFG[13:12]): what the sample front end does when
+// windows come faster than the FFT takes them
+#define FRAME_OVR_DROP_OLDEST   0   // The newest window replaces a waiting one
+#define FRAME_OVR_DROP_NEWEST   1   // Keep the waiting window, discard new ones
+#define FRAME_OVR_STALL         2   // Stop sampling until the waiting window is taken
+#define FRAME_CFG(hop, ovr)     (((uint32_t)((ovr) & 0x3) << 12) | ((hop) & 0x1FF))
+
+// ADC channels (SE_FRAME_CFG[17:16]): n ADCs (1-4, up to the N_CH the chip
+// was built with) share SPI clock and MISO, chip selects on GPIO 2 and
+// 30-32. They are sampled round robin, each at 1/n of the conversion rate,
+// and every channel's window is classified on its own; its results report
+// the channel in SE_RES_FIFO_CH
+#define FRAME_CHANNELS(n)       ((((uint32_t)(n) - 1) & 0x3) << 16)
+#define CH_CS_GPIO(c)           ((c) == 0 ? 2 : 29 + (c))  // Chip select pin of channel c
+
+// Sample timer (SE_SAMPLE_PERIOD): one sample set (every channel once)
+// every SAMPLE_PERIOD(clk, hz) clocks, independent of the SPI bit clock in
+// SE_CLK_DIV. The set has to fit: n * 34 * (CLK_DIV + 1) clocks or less,
+// a period lost to a late set counts in SE_PERF_STALLS
+#define SAMPLE_PERIOD(clk, hz)  ((((clk) + (hz) / 2) / (hz)) & 0xFFFFFF)  // Nearest period, hz > 0
+
+// Spectral averaging (SE_AVG_CFG): every frame updates avg += (mag - avg) / 2^shift,
+// features and NN run on every `every`-th averaged spectrum (1-16); shift 0 = off
+#define AVG_CFG(shift, every)   (((((uint32_t)(every) - 1) & 0xF) << 8) | ((shift) & 0x7))
+
+// Change-gated inference (SE_GATE_CFG): a feature vector within L1 distance
+// thr of the one last classified reuses that result (RES_REUSED) and the NN
+// stays idle; a run is forced after max skips in a row (0 = no limit)
+#define GATE_CFG(thr, max)      ((((uint32_t)(max) & 0xFF) << 16) | ((thr) & 0xFFF))
+
+// Pack weights i..i+3 of a byte image into one SE_NN_WT_DATA / SE_NN_WEIGHTS
+// word, weight i in [7:0]
+#define NN_WEIGHT_WORD(img, i) \
+    ((uint32_t)(uint8_t)(img)[i] | ((uint32_t)(uint8_t)(img)[(i) + 1] << 8) | \
+     ((uint32_t)(uint8_t)(img)[(i) + 2] << 16) | ((uint32_t)(uint8_t)(img)[(i) + 3] << 24))
+
+// NN configuration (NN_CFG): layer count and INT4 layers. An INT4 layer
+// packs two weights per byte, even input in the low nibble
+#define NN_CFG(int4_mask, layers)  ((((layers) & 0x7) << 8) | ((int4_mask) & 0xF))
+#define NN_CFG_INT4(l)      (1 << (l))
+
+// The model (weights, descriptors, NN_CFG fields) is double banked: the
+// registers edit the shadow bank while the engine runs the active one.
+// NN_CFG_SWAP makes the shadow bank active from the next inference; the
+// same write can carry the new layer count / INT4 layers. Wait for
+// STATUS_NN_BUSY to clear after a swap before editing the new shadow bank.
+#define NN_CFG_SWAP         (1 << 16)
+#define NN_CFG_BANK(c)      (((c) >> 17) & 0x3)     // Active bank of an NN_CFG read
+
+// Resident models (SE_MODEL_CFG): every bank keeps its model, 2 banks or 4
+// (NN_MODELS build), all booting with the default descriptors. PER_CH runs
+// channel c on bank MODEL_CFG_MAP(c, b); ALL classifies every feature
+// vector on banks 0..last in turn, one result each (change gate off,
+// alarm faults counted per bank). EDIT points NN_CFG, the descriptors and
+// the weight ports at one bank instead of the shadow one; edit only a bank
+// no inference is using. Every setting applies from the next inference.
+#define MODEL_CFG_PER_CH         (1 << 0)
+#define MODEL_CFG_ALL(last)      ((1 << 1) | (((last) & 0x3) << 4))
+#define MODEL_CFG_MAP(c, b)      (((uint32_t)(b) & 0x3) << (8 + 2 * (c)))
+#define MODEL_CFG_EDIT(b)        ((1 << 18) | (((uint32_t)(b) & 0x3) << 16))
+
+// Alarm profile of a bank (SE_PROFILE): once enabled, its threshold and
+// fault count replace SE_ALARM_CFG for the results of that bank
+#define PROFILE(threshold, faults)   ((1 << 16) | ALARM_CFG(threshold, faults))
+
+// NN layer descriptors: neuron n's weights are the row at
+// wbase + n * row_bytes (inputs, or (inputs + 1) / 2 for INT4), its bias
+// at bbase + n; outputs are sat16((sum + bias) >> shift), then ReLU
+#define NN_LAYER_SHAPE(n_in, n_out, relu, shift) \
+    ((((shift) & 0xF) << 20) | (((relu) & 0x1) << 16) | (((n_out) & 0x3F) << 8) | ((n_in) & 0x3F))
+#define NN_LAYER_BASE(wbase, bbase)  ((((bbase) & 0x3FF) << 16) | ((wbase) & 0x3FF))
+
+// NN engine limits
+#define NN_MAX_LAYERS         4
+#define NN_MAX_NEURONS        32   // Inputs / outputs per layer
+#define NN_WT_MEM_BYTES       512  // Weights and biases, per bank
+#define NN_MODELS             2    // Resident models (weight banks) built
 
-// NN weight memory layout
+// Default model (descriptor table after reset): 8 -> 16 (ReLU) -> 4
 #define NN_L1_WEIGHTS_START   0    // Layer 1 weights: [0..127] (16 neurons x 8 inputs)
 #define NN_L1_BIASES_START    128  // Layer 1 biases:  [128..143]
 #define NN_L2_WEIGHTS_START   144  // Layer 2 weights: [144..207] (4 neurons x 16 inputs)
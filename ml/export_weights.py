@@ -6,7 +6,12 @@
 Export INT8 neural network weights to a C header file for the SenseEdge ASIC.
 
 Reads the .npz file produced by train_senseedge.py and generates
-firmware/nn_weights.h with arrays matching the nn_engine.v memory layout:
+firmware/nn_weights.h: the weight memory image, the nn_engine.v layer
+descriptor table that points into it, and NN_CFG_VALUE. Each layer is
+stored as its weight rows (row-major, w[neuron][input]) followed by its
+biases, every layer starting on an 8-byte boundary, and the image is
+padded to whole 32-bit words for the 4-bytes-per-write load. The default
+8->16->4 model gives the original layout:
 
   [0..127]   Layer 1 weights  (16 neurons x 8 inputs, row-major)
   [128..143] Layer 1 biases   (16 values)
@@ -14,6 +19,15 @@ firmware/nn_weights.h with arrays matching the nn_engine.v memory layout:
   [208..211] Layer 2 biases   (4 values)
   ---------
   212 total INT8 parameters
+
+Layers trained with --int4 are packed two weights per byte (even input in
+the low nibble), (inputs + 1) / 2 bytes per row, and NN_CFG_VALUE selects
+INT4 for them.
+
+The same model is also written as verilog/rtl/nn_default_model.vh, the
+synthesis-time boot image: nn_engine.v copies its words into weight bank 0
+after reset and wb_interface.v resets the descriptors, layer count and
+INT4 layers to it, so the chip classifies without a firmware load.
 """
 
 import argparse
@@ -22,32 +36,113 @@ import sys
 import numpy as np
 
 
+# nn_engine.v limits (senseedge_top defaults)
+MAX_LAYERS   = 4
+MAX_NEURONS  = 32       # ACT_N
+WT_MEM_BYTES = 512      # 2^WT_AW, one bank
+ROW_ALIGN    = 8        # Layer bases on a word of the widest MAC array
+LOAD_WORD    = 4        # Weight bytes per Wishbone write (SE_NN_WT_DATA)
+
+
 def load_weights(npz_path):
-    """Load the .npz weight file and return individual arrays.
+    """Load the .npz weight file and return its layers, input layer first.
 
-    Returns:
-        layer1_weights : (16, 8)  int8
-        layer1_biases  : (16,)    int8
-        layer2_weights : (4, 16)  int8
-        layer2_biases  : (4,)     int8
+    Returns a list of dicts:
+        w     : (outputs, inputs) int8 weights
+        b     : (outputs,)        int8 biases
+        shift : requantise shift (output = sat16((sum + bias) >> shift))
+        int4  : weights are INT4 values
     """
     data = np.load(npz_path)
 
-    l1w = data["layer1_weights"]
-    l1b = data["layer1_biases"]
-    l2w = data["layer2_weights"]
-    l2b = data["layer2_biases"]
-
-    # Validate shapes
-    assert l1w.shape == (16, 8),  f"layer1_weights: expected (16,8), got {l1w.shape}"
-    assert l1b.shape == (16,),    f"layer1_biases: expected (16,), got {l1b.shape}"
-    assert l2w.shape == (4, 16),  f"layer2_weights: expected (4,16), got {l2w.shape}"
-    assert l2b.shape == (4,),     f"layer2_biases: expected (4,), got {l2b.shape}"
-
-    total = l1w.size + l1b.size + l2w.size + l2b.size
-    assert total == 212, f"Expected 212 parameters, got {total}"
-
-    return l1w, l1b, l2w, l2b
+    n_layers = int(data["layers"]) if "layers" in data else 2
+    shifts = data["shifts"] if "shifts" in data else np.zeros(n_layers, dtype=int)
+    int4 = data["int4_layers"] if "int4_layers" in data else np.zeros(n_layers, dtype=bool)
+
+    layers = []
+    for i in range(n_layers):
+        w = data[f"layer{i + 1}_weights"]
+        b = data[f"layer{i + 1}_biases"]
+        assert w.ndim == 2 and b.shape == (w.shape[0],), \
+            f"layer {i + 1}: weights {w.shape} / biases {b.shape} mismatch"
+        if i > 0:
+            assert w.shape[1] == layers[-1]["w"].shape[0], \
+                f"layer {i + 1}: {w.shape[1]} inputs, previous layer has " \
+                f"{layers[-1]['w'].shape[0]} outputs"
+        layers.append({"w": w, "b": b, "shift": int(shifts[i]), "int4": bool(int4[i])})
+
+    check_limits(layers)
+    return layers
+
+
+def check_limits(layers):
+    """Check the model against what nn_engine.v can run."""
+    assert 1 <= len(layers) <= MAX_LAYERS, \
+        f"{len(layers)} layers, nn_engine runs 1..{MAX_LAYERS}"
+    for i, ly in enumerate(layers):
+        n_out, n_in = ly["w"].shape
+        assert n_in <= MAX_NEURONS and n_out <= MAX_NEURONS, \
+            f"layer {i + 1}: {n_in} -> {n_out}, nn_engine holds {MAX_NEURONS} activations"
+        assert 0 <= ly["shift"] <= 15, f"layer {i + 1}: shift {ly['shift']} not in 0..15"
+    assert layers[-1]["w"].shape[0] >= 4, "the last layer needs the 4 class outputs"
+
+
+def pack_int4(w):
+    """Pack an INT4 weight matrix two per byte, even input in the low nibble.
+
+    An odd input count leaves the last high nibble 0. Returns
+    (rows, (cols + 1) / 2) int8, the byte image nn_engine.v reads.
+    """
+    assert w.min() >= -8 and w.max() <= 7, \
+        f"INT4 weights out of range [{w.min()}, {w.max()}]"
+    w = w.astype(np.int64)
+    if w.shape[1] % 2:
+        w = np.concatenate([w, np.zeros((w.shape[0], 1), dtype=np.int64)], axis=1)
+    packed = (w[:, 0::2] & 0xF) | ((w[:, 1::2] & 0xF) << 4)
+    return packed.astype(np.uint8).astype(np.int8)
+
+
+def layout_model(layers):
+    """Lay the layers out in weight memory.
+
+    Returns (image, sections, descs):
+        image    : list of int, the weight memory bytes from address 0
+        sections : list of (start, end, comment) covering the image
+        descs    : per layer (inputs, outputs, relu, shift, wbase, bbase)
+    """
+    image, sections, descs = [], [], []
+    for i, ly in enumerate(layers):
+        pad = -len(image) % ROW_ALIGN
+        if pad:
+            sections.append((len(image), len(image) + pad, "Padding"))
+            image += [0] * pad
+        w = pack_int4(ly["w"]) if ly["int4"] else ly["w"]
+        wbase = len(image)
+        image += [int(v) for v in w.flatten()]
+        sections.append((wbase, len(image), f"Layer {i + 1} weights"
+                         + (" (INT4 packed)" if ly["int4"] else "")))
+        bbase = len(image)
+        image += [int(v) for v in ly["b"].flatten()]
+        sections.append((bbase, len(image), f"Layer {i + 1} biases"))
+        n_out, n_in = ly["w"].shape
+        descs.append((n_in, n_out, i < len(layers) - 1, ly["shift"], wbase, bbase))
+    pad = -len(image) % LOAD_WORD
+    if pad:
+        sections.append((len(image), len(image) + pad, "Padding"))
+        image += [0] * pad
+    assert len(image) <= WT_MEM_BYTES, \
+        f"{len(image)} bytes, nn_engine weight memory holds {WT_MEM_BYTES}"
+    return image, sections, descs
+
+
+def layer_shape(n_in, n_out, relu, shift, wbase, bbase):
+    """SE_NN_LAYER_SHAPE(l) register value."""
+    return (shift << 20) | (int(relu) << 16) | (n_out << 8) | n_in
+
+
+def layer_base(n_in, n_out, relu, shift, wbase, bbase):
+    """SE_NN_LAYER_BASE(l) register value."""
+    return (bbase << 16) | wbase
 
 
 def format_int8_array(arr, name, indent="    "):
@@ -63,31 +158,45 @@ def format_int8_array(arr, name, indent="    "):
     return ",\n".join(lines)
 
 
-def generate_header(l1w, l1b, l2w, l2b):
+def generate_header(layers):
     """Generate the C header file contents as a string."""
     # Build the flat all_weights array matching hardware memory layout
-    all_weights = np.concatenate([
-        l1w.flatten(), l1b.flatten(),
-        l2w.flatten(), l2b.flatten()
-    ]).astype(np.int8)
+    image, sections, descs = layout_model(layers)
+    n_layers = len(layers)
+    int4_mask = sum(1 << i for i, ly in enumerate(layers) if ly["int4"])
+    nn_cfg = (n_layers << 8) | int4_mask
+    n_params = sum(ly["w"].size + ly["b"].size for ly in layers)
+
+    shape = [layers[0]["w"].shape[1]] + [ly["w"].shape[0] for ly in layers]
+    network = f"{shape[0]} inputs"
+    for n in shape[1:-1]:
+        network += f" -> {n} hidden (ReLU)"
+    network += f" -> {shape[-1]} outputs (argmax)"
 
     header = []
     header.append("// SPDX-License-Identifier: Apache-2.0")
-    header.append("// SenseEdge Neural Network Weights (INT8)")
+    header.append("// SenseEdge Neural Network Weights ("
+                  + ("INT8/INT4" if int4_mask else "INT8") + ")")
     header.append("// Auto-generated by ml/export_weights.py -- do not edit by hand")
     header.append("//")
-    header.append("// Network: 8 inputs -> 16 hidden (ReLU) -> 4 outputs (argmax)")
-    header.append("// Total parameters: 212")
+    header.append(f"// Network: {network}")
+    header.append(f"// Total parameters: {n_params}")
     header.append("//")
-    header.append("// Memory layout (matches nn_engine.v):")
-    header.append("//   [  0..127] Layer 1 weights  (16 neurons x 8 inputs, row-major)")
-    header.append("//   [128..143] Layer 1 biases   (16 values)")
-    header.append("//   [144..207] Layer 2 weights  (4 neurons x 16 inputs, row-major)")
-    header.append("//   [208..211] Layer 2 biases   (4 values)")
+    header.append("// Memory layout (matches the nn_engine.v layer descriptors below):")
+    for start, end, comment in sections:
+        if comment != "Padding":
+            header.append(f"//   [{start:3d}..{end - 1:3d}] {comment}")
     header.append("//")
-    header.append("// Load into hardware via Wishbone register SE_NN_WEIGHTS:")
-    header.append("//   for (int i = 0; i < 212; i++)")
-    header.append("//       reg_write(SE_NN_WEIGHTS, NN_WEIGHT(i, all_weights[i]));")
+    header.append("// Load into the shadow bank via Wishbone, 4 weights per write, then the")
+    header.append("// layer descriptors, and swap it in with the layer count / precision:")
+    header.append("//   reg_write(SE_NN_WT_ADDR, 0);")
+    header.append("//   for (int i = 0; i < NN_PARAM_BYTES; i += 4)")
+    header.append("//       reg_write(SE_NN_WT_DATA, NN_WEIGHT_WORD(all_weights, i));")
+    header.append("//   for (int l = 0; l < NN_LAYERS; l++) {")
+    header.append("//       reg_write(SE_NN_LAYER_SHAPE(l), nn_layer_shape[l]);")
+    header.append("//       reg_write(SE_NN_LAYER_BASE(l), nn_layer_base[l]);")
+    header.append("//   }")
+    header.append("//   reg_write(SE_NN_CFG, NN_CFG_VALUE | NN_CFG_SWAP);")
     header.append("")
     header.append("#ifndef NN_WEIGHTS_H")
     header.append("#define NN_WEIGHTS_H")
@@ -95,78 +204,75 @@ def generate_header(l1w, l1b, l2w, l2b):
     header.append("#include <stdint.h>")
     header.append("")
 
-    # --- Layer 1 weights: 16 neurons x 8 inputs ---
-    header.append("// Layer 1 weights: 16 neurons x 8 inputs (row-major)")
-    header.append("// Address range: [0..127]")
-    header.append("// Weight for neuron n, input i = layer1_weights[n * 8 + i]")
-    header.append("static const int8_t layer1_weights[128] = {")
-    for n in range(16):
-        row = l1w[n]
-        vals = ", ".join(f"{int(v):4d}" for v in row)
-        header.append(f"    {vals},  // neuron {n:2d}")
-    header.append("};")
+    # --- Layer descriptor table ---
+    header.append("// Model shape: layers and weight memory bytes (whole 32-bit words)")
+    header.append(f"#define NN_LAYERS      {n_layers}")
+    header.append(f"#define NN_PARAM_BYTES {len(image)}")
     header.append("")
-
-    # --- Layer 1 biases ---
-    header.append("// Layer 1 biases: 16 values")
-    header.append("// Address range: [128..143]")
-    header.append("static const int8_t layer1_biases[16] = {")
-    vals = ", ".join(f"{int(v):4d}" for v in l1b)
-    header.append(f"    {vals}")
-    header.append("};")
+    header.append("// SE_NN_CFG: [3:0] INT4 layers, [10:8] layer count")
+    header.append(f"#define NN_CFG_VALUE   0x{nn_cfg:08X}")
     header.append("")
-
-    # --- Layer 2 weights: 4 neurons x 16 inputs ---
-    header.append("// Layer 2 weights: 4 neurons x 16 inputs (row-major)")
-    header.append("// Address range: [144..207]")
-    header.append("// Weight for neuron n, input i = layer2_weights[n * 16 + i]")
-    header.append("static const int8_t layer2_weights[64] = {")
-    for n in range(4):
-        row = l2w[n]
-        vals = ", ".join(f"{int(v):4d}" for v in row)
-        header.append(f"    {vals},  // neuron {n}")
+    header.append("// SE_NN_LAYER_SHAPE(l): inputs, outputs, ReLU, requantise shift")
+    header.append("static const uint32_t nn_layer_shape[NN_LAYERS] = {")
+    for i, d in enumerate(descs):
+        relu = ", ReLU" if d[2] else ""
+        header.append(f"    0x{layer_shape(*d):08X},  // layer {i + 1}: "
+                      f"{d[0]} -> {d[1]}{relu}, shift {d[3]}")
     header.append("};")
     header.append("")
-
-    # --- Layer 2 biases ---
-    header.append("// Layer 2 biases: 4 values")
-    header.append("// Address range: [208..211]")
-    header.append("static const int8_t layer2_biases[4] = {")
-    vals = ", ".join(f"{int(v):4d}" for v in l2b)
-    header.append(f"    {vals}")
+    header.append("// SE_NN_LAYER_BASE(l): weight and bias base addresses")
+    header.append("static const uint32_t nn_layer_base[NN_LAYERS] = {")
+    for i, d in enumerate(descs):
+        header.append(f"    0x{layer_base(*d):08X},  // layer {i + 1}: "
+                      f"weights {d[4]}, biases {d[5]}")
     header.append("};")
     header.append("")
 
+    # --- Per-layer weights and biases ---
+    for i, (ly, d) in enumerate(zip(layers, descs)):
+        n_out, n_in = ly["w"].shape
+        k = i + 1
+        rb = (n_in + 1) // 2 if ly["int4"] else n_in
+        header.append(f"// Layer {k} weights: {n_out} neurons x {n_in} inputs (row-major)"
+                      + (", INT4 values" if ly["int4"] else ""))
+        header.append(f"// Address range: [{d[4]}..{d[4] + n_out * rb - 1}]"
+                      + (", packed two per byte" if ly["int4"] else ""))
+        header.append(f"// Weight for neuron n, input i = layer{k}_weights[n * {n_in} + i]")
+        header.append(f"static const int8_t layer{k}_weights[{ly['w'].size}] = {{")
+        for n in range(n_out):
+            vals = ", ".join(f"{int(v):4d}" for v in ly["w"][n])
+            label = f"{n:2d}" if n_out > 10 else f"{n}"
+            header.append(f"    {vals},  // neuron {label}")
+        header.append("};")
+        header.append("")
+        header.append(f"// Layer {k} biases: {n_out} values")
+        header.append(f"// Address range: [{d[5]}..{d[5] + n_out - 1}]")
+        header.append(f"static const int8_t layer{k}_biases[{n_out}] = {{")
+        for j in range(0, n_out, 16):
+            vals = ", ".join(f"{int(v):4d}" for v in ly["b"][j:j + 16])
+            header.append(f"    {vals}" + ("," if j + 16 < n_out else ""))
+        header.append("};")
+        header.append("")
+
     # --- Flat all_weights array for sequential loading ---
-    header.append("// All 212 parameters in flat array for sequential weight loading")
-    header.append("// Layout: L1 weights[128] | L1 biases[16] | L2 weights[64] | L2 biases[4]")
-    header.append("// Load via: for (int i = 0; i < 212; i++)")
-    header.append("//               reg_write(SE_NN_WEIGHTS, NN_WEIGHT(i, all_weights[i]));")
-    header.append("static const int8_t all_weights[212] = {")
+    header.append(f"// Weight memory image, {len(image)} bytes, streamed 4 per write")
+    header.append("// Layout: " + " | ".join(
+        f"{c.replace('Layer ', 'L').replace(' (INT4 packed)', '')}[{e - s}]"
+        for s, e, c in sections))
+    header.append("// Load via: for (int i = 0; i < NN_PARAM_BYTES; i += 4)")
+    header.append("//               reg_write(SE_NN_WT_DATA, NN_WEIGHT_WORD(all_weights, i));")
+    header.append("static const int8_t all_weights[NN_PARAM_BYTES] = {")
 
     # Format with section comments
-    flat = all_weights.astype(np.int64)
-    sections = [
-        (0,   128, "Layer 1 weights [0..127]"),
-        (128, 144, "Layer 1 biases [128..143]"),
-        (144, 208, "Layer 2 weights [144..207]"),
-        (208, 212, "Layer 2 biases [208..211]"),
-    ]
+    body = []
     for start, end, comment in sections:
-        header.append(f"    // {comment}")
-        chunk = flat[start:end]
+        body.append(f"    // {comment} [{start}..{end - 1}]")
         vals_per_line = 16
-        for i in range(0, len(chunk), vals_per_line):
-            row = chunk[i:i + vals_per_line]
-            line = ", ".join(f"{v:4d}" for v in row)
-            if start + i + vals_per_line < 212:
-                header.append(f"    {line},")
-            else:
-                # Check if this is the very last line
-                if end == 212 and i + vals_per_line >= len(chunk):
-                    header.append(f"    {line}")
-                else:
-                    header.append(f"    {line},")
+        for i in range(start, end, vals_per_line):
+            row = image[i:min(i + vals_per_line, end)]
+            body.append("    " + ", ".join(f"{v:4d}" for v in row) + ",")
+    body[-1] = body[-1][:-1]    # No comma after the last value
+    header += body
     header.append("};")
     header.append("")
     header.append("#endif // NN_WEIGHTS_H")
@@ -175,6 +281,56 @@ def generate_header(l1w, l1b, l2w, l2b):
     return "\n".join(header)
 
 
+def generate_rom(layers):
+    """Generate the Verilog boot model include (nn_default_model.vh)."""
+    image, sections, descs = layout_model(layers)
+    int4_mask = sum(1 << i for i, ly in enumerate(layers) if ly["int4"])
+    words = [sum((image[a + k] & 0xFF) << (8 * k) for k in range(LOAD_WORD))
+             for a in range(0, len(image), LOAD_WORD)]
+
+    shape = [layers[0]["w"].shape[1]] + [ly["w"].shape[0] for ly in layers]
+    network = " -> ".join(str(n) for n in shape)
+
+    rom = []
+    rom.append("// SPDX-License-Identifier: Apache-2.0")
+    rom.append("// SenseEdge - Boot Default NN Model")
+    rom.append("// Auto-generated by ml/export_weights.py -- do not edit by hand")
+    rom.append("//")
+    rom.append(f"// Network: {network}, {len(image)} weight memory bytes")
+    rom.append("// Included in a module body: nn_engine.v copies the image into weight")
+    rom.append("// bank 0 after reset, wb_interface.v resets both banks' descriptors,")
+    rom.append("// layer count and INT4 layers to this model.")
+    rom.append("")
+    rom.append("    // Weight image: byte 4a + k is byte k of nn_rom_word(a)")
+    rom.append(f"    localparam NN_ROM_WORDS = {len(words)};")
+    rom.append("")
+    rom.append("    // SE_NN_CFG layer count / INT4 layers, descriptor table (SHAPE, BASE)")
+    rom.append(f"    localparam [2:0]   NN_ROM_LAYERS = 3'd{len(layers)};")
+    rom.append(f"    localparam [3:0]   NN_ROM_INT4   = 4'b{int4_mask:04b};")
+    rom.append("    localparam [255:0] NN_ROM_DESC   = {")
+    for l in reversed(range(MAX_LAYERS)):
+        if l < len(descs):
+            base, shp = layer_base(*descs[l]), layer_shape(*descs[l])
+        else:
+            base, shp = 0, 0
+        end = "};" if l == 0 else ", "
+        rom.append(f"        32'h{base:08X}, 32'h{shp:08X}{end}  // layer {l + 1}: BASE, SHAPE")
+    rom.append("")
+    rom.append("    function [31:0] nn_rom_word;")
+    rom.append("        input [6:0] a;")
+    rom.append("        begin")
+    rom.append("            case (a)")
+    for a, w in enumerate(words):
+        rom.append(f"                7'd{a:<3d}: nn_rom_word = 32'h{w:08X};")
+    rom.append("                default: nn_rom_word = 32'h00000000;")
+    rom.append("            endcase")
+    rom.append("        end")
+    rom.append("    endfunction")
+    rom.append("")
+
+    return "\n".join(rom)
+
+
 def main():
     parser = argparse.ArgumentParser(
         description="Export SenseEdge INT8 weights to C header")
@@ -182,6 +338,9 @@ def main():
                         help="Input .npz path (default: ml/senseedge_weights.npz)")
     parser.add_argument("--output", type=str, default=None,
                         help="Output .h path (default: firmware/nn_weights.h)")
+    parser.add_argument("--rom", type=str, default=None,
+                        help="Boot model .vh path "
+                             "(default: verilog/rtl/nn_default_model.vh)")
     args = parser.parse_args()
 
     ml_dir = os.path.dirname(os.path.abspath(__file__))
@@ -191,6 +350,8 @@ def main():
         args.input = os.path.join(ml_dir, "senseedge_weights.npz")
     if args.output is None:
         args.output = os.path.join(project_root, "firmware", "nn_weights.h")
+    if args.rom is None:
+        args.rom = os.path.join(project_root, "verilog", "rtl", "nn_default_model.vh")
 
     if not os.path.isfile(args.input):
         print(f"ERROR: Weight file not found: {args.input}")
@@ -198,10 +359,10 @@ def main():
         return 1
 
     print(f"Loading weights from: {args.input}")
-    l1w, l1b, l2w, l2b = load_weights(args.input)
+    layers = load_weights(args.input)
 
     print(f"Generating C header ...")
-    header_text = generate_header(l1w, l1b, l2w, l2b)
+    header_text = generate_header(layers)
 
     # Ensure output directory exists
     os.makedirs(os.path.dirname(args.output), exist_ok=True)
@@ -209,17 +370,29 @@ def main():
     with open(args.output, "w") as f:
         f.write(header_text)
 
+    with open(args.rom, "w") as f:
+        f.write(generate_rom(layers))
+
+    image, sections, descs = layout_model(layers)
     print(f"Wrote: {args.output}")
-    print(f"  layer1_weights[128]  (16 x 8,  row-major)")
-    print(f"  layer1_biases[16]")
-    print(f"  layer2_weights[64]   (4 x 16, row-major)")
-    print(f"  layer2_biases[4]")
-    print(f"  all_weights[212]     (flat, for sequential loading)")
+    for i, (ly, d) in enumerate(zip(layers, descs)):
+        n_out, n_in = ly["w"].shape
+        prec = "INT4" if ly["int4"] else "INT8"
+        print(f"  layer{i + 1}: {n_in:2d} -> {n_out:2d}  {prec}, shift {d[3]}, "
+              f"weights @ {d[4]}, biases @ {d[5]}")
+    print(f"  all_weights[{len(image)}]  (weight memory image)")
+    print(f"Wrote: {args.rom}  (boot model, {len(image) // LOAD_WORD} words)")
     print("\nTo load weights into hardware:")
     print("  #include \"nn_weights.h\"")
     print("  #include \"senseedge_regs.h\"")
-    print("  for (int i = 0; i < 212; i++)")
-    print("      reg_write(SE_NN_WEIGHTS, NN_WEIGHT(i, all_weights[i]));")
+    print("  reg_write(SE_NN_WT_ADDR, 0);")
+    print("  for (int i = 0; i < NN_PARAM_BYTES; i += 4)")
+    print("      reg_write(SE_NN_WT_DATA, NN_WEIGHT_WORD(all_weights, i));")
+    print("  for (int l = 0; l < NN_LAYERS; l++) {")
+    print("      reg_write(SE_NN_LAYER_SHAPE(l), nn_layer_shape[l]);")
+    print("      reg_write(SE_NN_LAYER_BASE(l), nn_layer_base[l]);")
+    print("  }")
+    print("  reg_write(SE_NN_CFG, NN_CFG_VALUE | NN_CFG_SWAP);")
 
     return 0
 
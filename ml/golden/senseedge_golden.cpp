@@ -0,0 +1,734 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge Golden Model
+// Each block follows its RTL module expression by expression, with the
+// register widths applied where the RTL truncates or wraps: the ROM
+// tables are copied from fft_engine.v, so a change there must be made
+// here too. Datapath options the RTL documents as bit-identical (FFT_ARCH,
+// NN_LANES, USE_SRAM) are not options of the model.
+
+#include "senseedge_golden.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// --- Fixed-width helpers ---
+inline int64_t sext(int64_t v, int bits)
+{
+    const int64_t m = int64_t(1) << (bits - 1);
+    v &= (int64_t(1) << bits) - 1;
+    return (v ^ m) - m;
+}
+
+inline uint64_t trunc(uint64_t v, int bits)
+{
+    return v & ((uint64_t(1) << bits) - 1);
+}
+
+// =========================================================================
+// fft_engine
+// =========================================================================
+
+// W(k,256) = cos(2*pi*k/256) - j*sin(2*pi*k/256), Q1.14 (tw_rom)
+const int16_t TW_RE[128] = {
+     16384,  16379,  16364,  16340,  16305,  16261,  16207,  16143,
+     16069,  15986,  15893,  15791,  15679,  15557,  15426,  15286,
+     15137,  14978,  14811,  14635,  14449,  14256,  14053,  13842,
+     13623,  13395,  13160,  12916,  12665,  12406,  12140,  11866,
+     11585,  11297,  11003,  10702,  10394,  10080,   9760,   9434,
+      9102,   8765,   8423,   8076,   7723,   7366,   7005,   6639,
+      6270,   5897,   5520,   5139,   4756,   4370,   3981,   3590,
+      3196,   2801,   2404,   2006,   1608,   1205,    804,    402,
+         0,   -402,   -804,  -1205,  -1608,  -2006,  -2404,  -2801,
+     -3196,  -3590,  -3981,  -4370,  -4756,  -5139,  -5520,  -5897,
+     -6270,  -6639,  -7005,  -7366,  -7723,  -8076,  -8423,  -8765,
+     -9102,  -9434,  -9760, -10080, -10394, -10702, -11003, -11297,
+    -11585, -11866, -12140, -12406, -12665, -12916, -13160, -13395,
+    -13623, -13842, -14053, -14256, -14449, -14635, -14811, -14978,
+    -15137, -15286, -15426, -15557, -15679, -15791, -15893, -15986,
+    -16069, -16143, -16207, -16261, -16305, -16340, -16364, -16379
+};
+
+const int16_t TW_IM[128] = {
+         0,   -402,   -804,  -1205,  -1608,  -2006,  -2404,  -2801,
+     -3196,  -3590,  -3981,  -4370,  -4756,  -5139,  -5520,  -5897,
+     -6270,  -6639,  -7005,  -7366,  -7723,  -8076,  -8423,  -8765,
+     -9102,  -9434,  -9760, -10080, -10394, -10702, -11003, -11297,
+    -11585, -11866, -12140, -12406, -12665, -12916, -13160, -13395,
+    -13623, -13842, -14053, -14256, -14449, -14635, -14811, -14978,
+    -15137, -15286, -15426, -15557, -15679, -15791, -15893, -15986,
+    -16069, -16143, -16207, -16261, -16305, -16340, -16364, -16379,
+    -16384, -16379, -16364, -16340, -16305, -16261, -16207, -16143,
+    -16069, -15986, -15893, -15791, -15679, -15557, -15426, -15286,
+    -15137, -14978, -14811, -14635, -14449, -14256, -14053, -13842,
+    -13623, -13395, -13160, -12916, -12665, -12406, -12140, -11866,
+    -11585, -11297, -11003, -10702, -10394, -10080,  -9760,  -9434,
+     -9102,  -8765,  -8423,  -8076,  -7723,  -7366,  -7005,  -6639,
+     -6270,  -5897,  -5520,  -5139,  -4756,  -4370,  -3981,  -3590,
+     -3196,  -2801,  -2404,  -2006,  -1608,  -1205,   -804,   -402
+};
+
+// Periodic windows for k = 0..128, Q1.14 (win_rom)
+const int16_t HANN[129] = {
+         0,      2,     10,     22,     39,     62,     89,    121,
+       157,    199,    246,    297,    353,    413,    479,    549,
+       624,    703,    787,    875,    967,   1064,   1165,   1271,
+      1381,   1494,   1612,   1734,   1859,   1989,   2122,   2259,
+      2399,   2543,   2691,   2841,   2995,   3152,   3312,   3475,
+      3641,   3809,   3980,   4154,   4330,   4509,   4689,   4872,
+      5057,   5244,   5432,   5622,   5814,   6007,   6202,   6397,
+      6594,   6791,   6990,   7189,   7389,   7589,   7790,   7991,
+      8192,   8393,   8594,   8795,   8995,   9195,   9394,   9593,
+      9790,   9987,  10182,  10377,  10570,  10762,  10952,  11140,
+     11327,  11512,  11695,  11875,  12054,  12230,  12404,  12575,
+     12743,  12909,  13072,  13232,  13389,  13543,  13693,  13841,
+     13985,  14125,  14262,  14395,  14525,  14650,  14772,  14890,
+     15003,  15113,  15219,  15320,  15417,  15509,  15597,  15681,
+     15760,  15835,  15905,  15971,  16031,  16087,  16138,  16185,
+     16227,  16263,  16295,  16322,  16345,  16362,  16374,  16382,
+     16384
+};
+
+const int16_t HAMM[129] = {
+      1311,   1313,   1320,   1331,   1347,   1367,   1392,   1422,
+      1456,   1494,   1537,   1584,   1635,   1691,   1751,   1816,
+      1884,   1957,   2034,   2115,   2201,   2290,   2383,   2480,
+      2581,   2686,   2794,   2906,   3021,   3141,   3263,   3389,
+      3518,   3651,   3786,   3925,   4066,   4211,   4358,   4508,
+      4660,   4815,   4973,   5133,   5295,   5459,   5625,   5793,
+      5963,   6135,   6308,   6483,   6660,   6837,   7016,   7196,
+      7377,   7559,   7742,   7925,   8109,   8293,   8478,   8662,
+      8847,   9032,   9217,   9402,   9586,   9770,   9953,  10136,
+     10318,  10499,  10679,  10857,  11035,  11211,  11386,  11560,
+     11732,  11902,  12070,  12236,  12400,  12562,  12722,  12879,
+     13034,  13187,  13337,  13484,  13629,  13770,  13909,  14044,
+     14177,  14306,  14432,  14554,  14673,  14789,  14901,  15009,
+     15114,  15215,  15312,  15405,  15494,  15579,  15660,  15737,
+     15810,  15879,  15943,  16004,  16059,  16111,  16158,  16201,
+     16239,  16273,  16302,  16327,  16348,  16364,  16375,  16382,
+     16384
+};
+
+// Reverse the low nbits bits of idx (bit_rev)
+inline unsigned bit_rev(unsigned idx, int nbits)
+{
+    unsigned r = 0;
+    for (int b = 0; b < nbits; b++)
+        r |= ((idx >> b) & 1u) << (nbits - 1 - b);
+    return r;
+}
+
+// p' = a + w*b, q' = a - w*b with 24-bit data and a 24-bit product
+void butterfly(int32_t &ar, int32_t &ai, int32_t &br, int32_t &bi, unsigned tw)
+{
+    const int64_t wr = TW_RE[tw], wi = TW_IM[tw];
+    const int64_t prod_re = int64_t(br) * wr - int64_t(bi) * wi;
+    const int64_t prod_im = int64_t(br) * wi + int64_t(bi) * wr;
+    const int64_t tr = sext(prod_re >> 14, 24);
+    const int64_t ti = sext(prod_im >> 14, 24);
+    const int32_t pr = int32_t(sext(ar + tr, 24)), pi = int32_t(sext(ai + ti, 24));
+    br = int32_t(sext(ar - tr, 24));
+    bi = int32_t(sext(ai - ti, 24));
+    ar = pr;
+    ai = pi;
+}
+
+// max(|Re|, |Im|) + min(|Re|, |Im|) / 2, saturated to 16 bits
+inline uint16_t magnitude(int32_t xr, int32_t xi)
+{
+    const uint32_t ar = uint32_t(xr < 0 ? -int64_t(xr) : xr);
+    const uint32_t ai = uint32_t(xi < 0 ? -int64_t(xi) : xi);
+    const uint32_t mx = std::max(ar, ai), mn = std::min(ar, ai);
+    if (mx >> 16)
+        return 0xFFFF;
+    return uint16_t(mx + (mn >> 1));
+}
+
+void fft(const int16_t *x, int fft_size, int window, bool real_fft, uint16_t *mag)
+{
+    const int log2n = 6 + fft_size;
+    const int log2m = log2n - (real_fft ? 1 : 0);
+    const unsigned n = 1u << log2n, m = 1u << log2m;
+    int32_t re[256], im[256];
+
+    // Load pass: point i takes the sample at bit_reverse(i), windowed
+    for (unsigned i = 0; i < n; i++) {
+        const unsigned off = real_fft ? (bit_rev(i >> 1, log2n - 1) << 1) | (i & 1u)
+                                      : bit_rev(i, log2n);
+        int32_t s = x[off];
+        if (window != 0) {
+            unsigned k = (off << (8 - log2n)) & 0xFF;
+            k = (k > 128) ? 256 - k : k;
+            const int32_t coef = (window == 2) ? HAMM[k] : HANN[k];
+            s = int32_t(sext((int64_t(s) * coef) >> 14, 16));
+        }
+        if (!real_fft) {
+            re[i] = s;
+            im[i] = 0;
+        } else if (i & 1u) {
+            im[i >> 1] = s;
+        } else {
+            re[i >> 1] = s;
+        }
+    }
+
+    // Radix-2 DIT stages: butterfly j pairs p (0 inserted at bit s) with
+    // p + 2^s, twiddle (j mod 2^s) << (7 - s)
+    for (int s = 0; s < log2m; s++) {
+        const unsigned mask = (1u << s) - 1;
+        for (unsigned j = 0; j < m / 2; j++) {
+            const unsigned p = ((j & ~mask) << 1) | (j & mask);
+            const unsigned q = p | (1u << s);
+            butterfly(re[p], im[p], re[q], im[q], (j & mask) << (7 - s));
+        }
+    }
+
+    // Magnitude pass (with the REAL_FFT split): N/2 bins
+    const unsigned bins = n / 2;
+    for (unsigned k = 0; k < bins; k++) {
+        int32_t xr = re[k], xi = im[k];
+        if (real_fft) {
+            const unsigned mir = (bins - k) & (bins - 1);
+            int32_t er = int32_t((int64_t(re[k]) + re[mir]) >> 1);
+            int32_t ei = int32_t((int64_t(im[k]) - im[mir]) >> 1);
+            int32_t orr = int32_t((int64_t(im[k]) + im[mir]) >> 1);
+            int32_t oi = int32_t((int64_t(re[mir]) - re[k]) >> 1);
+            butterfly(er, ei, orr, oi, (k << (8 - log2n)) & 0x7F);
+            xr = er;
+            xi = ei;
+        }
+        mag[k] = magnitude(xr, xi);
+    }
+}
+
+// =========================================================================
+// feature_extract
+// =========================================================================
+
+// 8-bit saturating quotient of the normalising unit (div_start)
+inline uint8_t div8(uint64_t num, uint64_t den)
+{
+    if (den == 0 || num >= (den << 8))
+        return num == 0 ? 0 : 0xFF;
+    return uint8_t(num / den);
+}
+
+inline uint32_t isqrt(uint32_t v)
+{
+    uint32_t res = 0, bit = 1u << 20;
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+inline uint8_t sat_top(uint64_t v)
+{
+    return (v >> 16) & 0xFF ? 0xFF : uint8_t(v >> 8);
+}
+
+void features(const uint16_t *mag, const int16_t *x, int fft_size, uint8_t *feat)
+{
+    const int log2n = 6 + fft_size;
+    const unsigned bins = 1u << (log2n - 1);
+
+    // Spectral sums over 64-point bins (bin >> fft_size)
+    uint64_t low = 0, midlow = 0, midhi = 0, high = 0, total = 0, weighted = 0;
+    uint16_t peak_mag = 0;
+    unsigned peak_bin = 0;
+    for (unsigned k = 0; k < bins; k++) {
+        const unsigned b64 = k >> fft_size;
+        const uint16_t v = mag[k];
+        if (b64 >= 1 && b64 <= 4)   low    = trunc(low + v, 24);
+        if (b64 >= 5 && b64 <= 10)  midlow = trunc(midlow + v, 24);
+        if (b64 >= 11 && b64 <= 20) midhi  = trunc(midhi + v, 24);
+        if (b64 >= 21 && b64 <= 31) high   = trunc(high + v, 24);
+        if (v > peak_mag) {
+            peak_mag = v;
+            peak_bin = k;
+        }
+        weighted = trunc(weighted + uint64_t(v) * b64, 32);
+        total    = trunc(total + v, 24);
+    }
+
+    const uint64_t n_total = total >> fft_size;
+    feat[0] = sat_top(low >> fft_size);
+    feat[1] = sat_top(midlow >> fft_size);
+    feat[2] = sat_top(midhi >> fft_size);
+    feat[3] = sat_top(high >> fft_size);
+    feat[4] = uint8_t(peak_bin << (3 - fft_size));
+    feat[5] = uint8_t((peak_mag >> fft_size) >> 8);
+    feat[6] = n_total == 0 ? 0 : uint8_t((weighted >> fft_size) >> 16);
+    feat[7] = sat_top(n_total);
+
+    if (x == nullptr) {
+        feat[8] = feat[9] = feat[10] = feat[11] = 0;
+        return;
+    }
+
+    // Time-domain sums of the raw window, |x| saturated to 2047
+    int64_t t_sum = 0;
+    uint64_t t_sq = 0, t_q2 = 0;
+    uint32_t t_peak = 0;
+    for (unsigned i = 0; i < (1u << log2n); i++) {
+        const int32_t s = x[i];
+        const uint32_t a = std::min<uint32_t>(uint32_t(s < 0 ? -s : s), 2047);
+        const uint32_t sq = a * a;
+        const uint64_t q = sq >> 6;
+        t_sum = sext(t_sum + s, 24);
+        t_sq  = trunc(t_sq + sq, 30);
+        t_q2  = trunc(t_q2 + q * q, 40);
+        t_peak = std::max(t_peak, a);
+    }
+
+    const int64_t  mean  = t_sum >> log2n;
+    const uint64_t ms    = trunc(t_sq >> log2n, 22);
+    const uint64_t mean2 = uint64_t(mean * mean);
+    const uint32_t var   = mean2 >= ms ? 0 : uint32_t(ms - trunc(mean2, 22));
+    const uint64_t m2    = trunc(t_sq >> (log2n + 6), 16);
+    const uint64_t m2sq  = trunc(m2 * m2, 32);
+    const uint64_t m4    = trunc(t_q2 >> log2n, 32);
+    const uint32_t rms   = isqrt(var) & 0x7FF;
+
+    feat[8]  = uint8_t(rms >> 3);
+    feat[9]  = uint8_t(t_peak >> 3);
+    feat[10] = div8(uint64_t(t_peak) << 4, rms);
+    feat[11] = div8(m4 << 4, m2sq);
+}
+
+// =========================================================================
+// nn_engine
+// =========================================================================
+
+// Activation buffers start at 0 and the runner-up at class 0 / score 0
+// for every inference: the RTL keeps both from the previous one, which
+// only a table whose layer reads past the last layer's outputs, or a
+// last layer of one output, can see.
+int nn(const se_model *m, const uint8_t *feat, se_result *r)
+{
+    const unsigned nl   = (m->nn_cfg >> 8) & 7;
+    const unsigned int4 = m->nn_cfg & 0xF;
+    if (nl > SE_MAX_LAYERS)
+        return -1;
+    const unsigned layers = nl ? nl : 1;
+
+    int32_t act[2][SE_MAX_NEURONS] = {};
+    int32_t max_val = 0, max2_val = 0;
+    int32_t max_idx = 0, max2_idx = 0;
+
+    for (unsigned l = 0; l < layers; l++) {
+        const uint32_t d     = m->shape[l];
+        const unsigned nin   = d & 0x3F;
+        const unsigned nout  = (d >> 8) & 0x3F;
+        const bool     relu  = (d >> 16) & 1;
+        const unsigned shift = (d >> 20) & 0xF;
+        const unsigned wbase = m->base[l] & 0x3FF;
+        const unsigned bbase = (m->base[l] >> 16) & 0x3FF;
+        const bool     i4    = (int4 >> l) & 1;
+        const bool     last  = (l + 1 == layers);
+        if (nin == 0 || nout == 0 || nin > SE_MAX_NEURONS || nout > SE_MAX_NEURONS)
+            return -1;
+
+        // Features 12-31 read 0
+        if (l == 0)
+            for (unsigned i = 0; i < nin; i++)
+                act[0][i] = (i < SE_N_FEAT) ? feat[i] : 0;
+
+        const int32_t *in = act[l & 1];
+        int32_t *out = act[(l + 1) & 1];
+        const unsigned row = i4 ? (nin + 1) >> 1 : nin;
+
+        for (unsigned n = 0; n < nout; n++) {
+            const unsigned w0 = wbase + n * row;
+            int64_t acc = 0;
+            for (unsigned b = 0; b < row; b++) {
+                const uint8_t wb = m->wt[(w0 + b) % SE_WT_BYTES];
+                if (i4) {
+                    const unsigned ia = 2 * b, ib = ia + 1;
+                    acc += int64_t(ia < nin ? in[ia] : 0) * sext(wb & 0xF, 4);
+                    acc += int64_t(ib < nin ? in[ib] : 0) * sext(wb >> 4, 4);
+                } else {
+                    acc += int64_t(in[b]) * int8_t(wb);
+                }
+                acc = sext(acc, 24);
+            }
+
+            // Requantise: bias, shift, saturate to 16 bits, activation
+            const int64_t pre = sext(acc + int8_t(m->wt[(bbase + n) % SE_WT_BYTES]), 24);
+            int32_t v = int32_t(std::min<int64_t>(std::max<int64_t>(pre >> shift, -32768), 32767));
+            if (relu && v < 0)
+                v = 0;
+            out[n] = v;
+
+            // Argmax and runner-up over the first four outputs
+            if (last && n < 4) {
+                if (n == 0 || v > max_val) {
+                    max2_val = max_val;
+                    max2_idx = max_idx;
+                    max_val  = v;
+                    max_idx  = int32_t(n);
+                } else if (n == 1 || v > max2_val) {
+                    max2_val = v;
+                    max2_idx = int32_t(n);
+                }
+            }
+        }
+    }
+
+    r->class_id     = max_idx;
+    r->top_score    = max_val;
+    r->second_id    = max2_idx;
+    r->second_score = max2_val;
+    r->confidence   = max_val < 0 ? 0 : std::min(max_val, 255);
+    return 0;
+}
+
+// =========================================================================
+// alarm_logic
+// =========================================================================
+
+// NN_MODELS: banks past the last one built fold onto the built ones
+inline int n_banks(const se_config *c)
+{
+    return c->n_models == 4 ? 4 : 2;
+}
+
+// Counters for max(N_CH, NN_MODELS) channels; the thresholds are the
+// PROFILE of the result's bank once enabled (wb_interface prof_m)
+void alarm(se_alarm_state *s, const se_config *c, int ch, se_result *r)
+{
+    ch = std::min(ch, std::max(c->n_ch, n_banks(c)) - 1);
+    const uint32_t prof = c->profile[r->model & (n_banks(c) - 1)];
+    const bool    use_p = (prof >> 16) & 1;
+    const int32_t thr   = use_p ? int32_t(prof & 0xFF) : (c->alarm_thr & 0xFF);
+    const int32_t need  = use_p ? int32_t((prof >> 8) & 0xF) : (c->fault_count & 0xF);
+    const int32_t cnt = s->consec[ch];
+    r->alarm_irq = 0;
+    if (r->class_id != 0 && r->confidence >= thr) {
+        if (cnt < 15)
+            s->consec[ch] = cnt + 1;
+        s->fault_class = r->class_id;
+        if (cnt >= need && !s->active) {
+            s->active = 1;
+            s->ch = ch;
+            r->alarm_irq = 1;
+        }
+    } else {
+        s->consec[ch] = 0;
+        if (r->class_id == 0 && r->confidence >= thr && ch == s->ch)
+            s->active = 0;
+    }
+    r->alarm_active = s->active;
+    r->fault_class  = s->fault_class;
+}
+
+} // namespace
+
+// =========================================================================
+// Pipeline: spec_avg and nn_gate state around the blocks
+// =========================================================================
+
+struct se_pipe {
+    se_config      cfg;
+    se_model       models[SE_MAX_MODELS];
+    int            bank;            // Active bank (NN_CFG[18:17])
+
+    // spec_avg, per channel: 8-fraction-bit averages
+    uint32_t       avg[4][128];
+    int            frame_cnt[4];
+    bool           primed[4];
+    int            size_q[4];
+
+    // nn_gate
+    uint8_t        ref_vec[SE_N_FEAT];
+    bool           ref_ok;
+    int            ref_bank;
+    int            ref_ch;
+    int            skip_cnt;
+
+    se_result      held;            // Result of the last NN run
+    se_alarm_state alarm;
+};
+
+extern "C" {
+
+void se_fft(const int16_t *x, int fft_size, int window, int real_fft, uint16_t *mag)
+{
+    fft(x, fft_size, window, real_fft != 0, mag);
+}
+
+void se_features(const uint16_t *mag, const int16_t *x, int fft_size, uint8_t *feat)
+{
+    features(mag, x, fft_size, feat);
+}
+
+int se_nn(const se_model *m, const uint8_t *feat, se_result *r)
+{
+    return nn(m, feat, r);
+}
+
+void se_alarm_step(se_alarm_state *s, const se_config *c, int ch, se_result *r)
+{
+    alarm(s, c, ch, r);
+}
+
+int se_model_load_vh(const char *path, se_model *m)
+{
+    std::ifstream f(path);
+    if (!f)
+        return -1;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    const std::string s = ss.str();
+
+    *m = se_model();
+    std::smatch mt;
+    if (!std::regex_search(s, mt, std::regex("NN_ROM_LAYERS\\s*=\\s*3'd(\\d+)")))
+        return -1;
+    m->nn_cfg = uint32_t(std::stoul(mt[1])) << 8;
+    if (std::regex_search(s, mt, std::regex("NN_ROM_INT4\\s*=\\s*4'b([01]+)")))
+        m->nn_cfg |= uint32_t(std::stoul(mt[1], nullptr, 2));
+
+    // Descriptor words, layer 4 BASE first down to layer 1 SHAPE
+    const size_t d0 = s.find("NN_ROM_DESC");
+    const size_t d1 = s.find("};", d0);
+    if (d0 == std::string::npos || d1 == std::string::npos)
+        return -1;
+    const std::string desc = s.substr(d0, d1 - d0);
+    const std::regex hex("32'h([0-9A-Fa-f]+)");
+    std::vector<uint32_t> words;
+    for (auto it = std::sregex_iterator(desc.begin(), desc.end(), hex);
+         it != std::sregex_iterator(); ++it)
+        words.push_back(uint32_t(std::stoul((*it)[1], nullptr, 16)));
+    if (words.size() != 2 * SE_MAX_LAYERS)
+        return -1;
+    for (int l = 0; l < SE_MAX_LAYERS; l++) {
+        m->base[l]  = words[2 * (SE_MAX_LAYERS - 1 - l)];
+        m->shape[l] = words[2 * (SE_MAX_LAYERS - 1 - l) + 1];
+    }
+
+    // Image: byte 4a + k is byte k of nn_rom_word(a)
+    const std::regex word("7'd(\\d+)\\s*:\\s*nn_rom_word\\s*=\\s*32'h([0-9A-Fa-f]+)");
+    int n = 0;
+    for (auto it = std::sregex_iterator(s.begin(), s.end(), word);
+         it != std::sregex_iterator(); ++it, n++) {
+        const unsigned a = unsigned(std::stoul((*it)[1]));
+        const uint32_t v = uint32_t(std::stoul((*it)[2], nullptr, 16));
+        for (unsigned k = 0; k < 4 && 4 * a + k < SE_WT_BYTES; k++)
+            m->wt[4 * a + k] = uint8_t(v >> (8 * k));
+    }
+    return n ? 0 : -1;
+}
+
+se_pipe *se_pipe_new(const se_config *c, const se_model *m)
+{
+    se_pipe *p = new se_pipe();
+    p->cfg = *c;
+    for (int b = 0; b < SE_MAX_MODELS; b++)
+        p->models[b] = m[c->n_models > 0 ? std::min(b, n_banks(c) - 1) : 0];
+    return p;
+}
+
+void se_pipe_free(se_pipe *p)
+{
+    delete p;
+}
+
+void se_pipe_reset(se_pipe *p)
+{
+    for (int c = 0; c < 4; c++) {
+        p->primed[c]    = false;
+        p->frame_cnt[c] = 0;
+    }
+    p->ref_ok = false;
+}
+
+// The shadow bank is the other one of the active pair
+void se_pipe_set_model(se_pipe *p, const se_model *m)
+{
+    p->bank = (p->bank ^ 1) & (n_banks(&p->cfg) - 1);
+    p->models[p->bank] = *m;
+}
+
+void se_pipe_load_bank(se_pipe *p, int bank, const se_model *m)
+{
+    p->models[bank & (n_banks(&p->cfg) - 1)] = *m;
+}
+
+int se_frame_results(const se_config *c)
+{
+    if (!((c->model_cfg >> 1) & 1))
+        return 1;
+    return int((c->model_cfg >> 4) & 3 & unsigned(n_banks(c) - 1)) + 1;
+}
+
+int se_pipe_frame(se_pipe *p, const int16_t *x, int ch, uint16_t *spec,
+                  uint8_t *feat, se_result *r)
+{
+    const se_config &c = p->cfg;
+    const int size = std::min(std::max(c.fft_size, 0), 2);
+    const unsigned bins = 32u << size;
+    ch = std::min(std::max(ch, 0), std::max(c.n_ch, 1) - 1);
+
+    uint16_t mag[128];
+    fft(x, size, c.window, c.real_fft != 0, mag);
+
+    // spec_avg: fill on the first frame of a length, then blend
+    const bool pub  = p->frame_cnt[ch] >= (c.avg_every & 0xF);
+    const int  sh   = c.avg_shift & 7;
+    const bool fill = !p->primed[ch] || size != p->size_q[ch] || sh == 0;
+    p->size_q[ch] = size;
+    for (unsigned k = 0; k < bins; k++) {
+        const uint32_t in = uint32_t(mag[k]) << 8;
+        uint32_t &acc = p->avg[ch][k];
+        if (fill)
+            acc = in;
+        else
+            acc = uint32_t(trunc(acc + ((int64_t(in) - acc) >> sh), 24));
+        mag[k] = uint16_t(acc >> 8);
+    }
+    p->primed[ch] = (sh != 0);
+    p->frame_cnt[ch] = pub ? 0 : std::min(p->frame_cnt[ch] + 1, 15);
+
+    if (spec)
+        std::copy(mag, mag + bins, spec);
+    const int n_res = se_frame_results(&c);
+    std::fill(r, r + n_res, se_result());
+    if (!pub)
+        return 0;
+
+    uint8_t f[SE_N_FEAT];
+    features(mag, x, size, f);
+    if (feat)
+        std::copy(f, f + SE_N_FEAT, feat);
+
+    // MODEL_CFG.ALL: banks 0 to last on the vector in turn, each result
+    // counted as its bank's; the change gate is held in reset
+    const unsigned mask = unsigned(n_banks(&c) - 1);
+    if ((c.model_cfg >> 1) & 1) {
+        for (int b = 0; b < n_res; b++) {
+            if (nn(&p->models[b], f, &p->held) < 0)
+                return -1;
+            r[b] = p->held;
+            r[b].published = 1;
+            r[b].model     = b;
+            alarm(&p->alarm, &c, b, &r[b]);
+        }
+        std::copy(f, f + SE_N_FEAT, p->ref_vec);
+        p->ref_ok   = false;
+        p->skip_cnt = 0;
+        return n_res;
+    }
+
+    // Bank of the vector: the channel's map entry with PER_CH
+    const int bank = int(((c.model_cfg & 1) ? (c.model_cfg >> (8 + 2 * ch)) & 3
+                                            : unsigned(p->bank)) & mask);
+
+    // nn_gate: reuse the held result while the vector stays close
+    unsigned dist = 0;
+    for (int i = 0; i < SE_N_FEAT; i++)
+        dist += unsigned(std::abs(int(f[i]) - int(p->ref_vec[i])));
+    const int thr = c.gate_thr & 0xFFF, max_skip = c.gate_max & 0xFF;
+    const bool skip = thr != 0 && p->ref_ok && p->ref_bank == bank && p->ref_ch == ch &&
+                      int(dist) < thr && (max_skip == 0 || p->skip_cnt < max_skip);
+    if (skip) {
+        p->skip_cnt = std::min(p->skip_cnt + 1, 0xFF);
+    } else {
+        if (nn(&p->models[bank], f, &p->held) < 0)
+            return -1;
+        std::copy(f, f + SE_N_FEAT, p->ref_vec);
+        p->ref_ok   = true;
+        p->ref_bank = bank;
+        p->ref_ch   = ch;
+        p->skip_cnt = 0;
+    }
+
+    *r = p->held;
+    r->published = 1;
+    r->skipped   = skip;
+    r->model     = bank;
+    alarm(&p->alarm, &c, ch, r);
+    return 1;
+}
+
+int se_run_batch(const se_config *c, const se_model *m, const int16_t *x,
+                 int64_t n_frames, int64_t stream_len, const int32_t *ch,
+                 uint16_t *spec, uint8_t *feat, se_result *r, int n_threads)
+{
+    const int size = std::min(std::max(c->fft_size, 0), 2);
+    const int64_t n = int64_t(64) << size, bins = n / 2;
+    if (stream_len < 1)
+        stream_len = n_frames;
+    const int64_t n_streams = stream_len ? (n_frames + stream_len - 1) / stream_len : 0;
+    const int64_t n_res = se_frame_results(c);
+
+    std::atomic<int64_t> next(0);
+    std::atomic<int> status(0);
+    auto worker = [&]() {
+        for (int64_t s; (s = next++) < n_streams; ) {
+            std::unique_ptr<se_pipe> p(se_pipe_new(c, m));
+            const int64_t end = std::min(n_frames, (s + 1) * stream_len);
+            for (int64_t i = s * stream_len; i < end; i++)
+                if (se_pipe_frame(p.get(), x + i * n, ch ? ch[i] : 0,
+                                  spec ? spec + i * bins : nullptr,
+                                  feat ? feat + i * SE_N_FEAT : nullptr,
+                                  r + i * n_res) < 0)
+                    status = -1;
+        }
+    };
+
+    if (n_threads <= 0)
+        n_threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    n_threads = int(std::min<int64_t>(n_threads, std::max<int64_t>(n_streams, 1)));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n_threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+    return status;
+}
+
+int se_nn_batch(const se_model *m, const uint8_t *feat, int64_t n,
+                se_result *r, int n_threads)
+{
+    const int64_t chunk = 4096;
+    std::atomic<int64_t> next(0);
+    std::atomic<int> status(0);
+    auto worker = [&]() {
+        for (int64_t b; (b = next.fetch_add(chunk)) < n; )
+            for (int64_t i = b; i < std::min(n, b + chunk); i++) {
+                r[i] = se_result();
+                if (nn(m, feat + i * SE_N_FEAT, r + i) < 0)
+                    status = -1;
+            }
+    };
+
+    if (n_threads <= 0)
+        n_threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    n_threads = int(std::min<int64_t>(n_threads, (n + chunk - 1) / chunk));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n_threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+    return status;
+}
+
+} // extern "C"
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge Golden Model
+// Bit-exact C++ model of the senseedge_top datapath, one frame at a time:
+// fft_engine (WINDOW, REAL_FFT), spec_avg, feature_extract, nn_gate,
+// nn_engine with its resident banks (MODEL_CFG) and alarm_logic. Every result matches the RTL to the bit; what
+// is not modelled is timing (cycles, drops, overruns) and the sample ring,
+// so a frame is the N samples the FFT load pass reads, in frame order.
+// Plain C interface, for ml/senseedge_golden.py (ctypes) and C++ benches.
+
+#ifndef SENSEEDGE_GOLDEN_H
+#define SENSEEDGE_GOLDEN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SE_N_FEAT       12      // feature_extract features per frame
+#define SE_MAX_LAYERS   4       // nn_engine descriptor table
+#define SE_MAX_NEURONS  32      // nn_engine ACT_N
+#define SE_WT_BYTES     512     // nn_engine weight bank (2^WT_AW)
+#define SE_MAX_MODELS   4       // Resident NN banks (NN_MODELS)
+
+// Build options and registers of one pipeline (senseedge_top parameters,
+// CTRL / FRAME_CFG / AVG_CFG / GATE_CFG / ALARM_CFG / MODEL_CFG / PROFILE
+// fields)
+typedef struct {
+    int32_t fft_size;       // 0 = 64, 1 = 128, 2 = 256 points
+    int32_t window;         // WINDOW: 0 rectangular, 1 Hann, 2 Hamming
+    int32_t real_fft;       // REAL_FFT
+    int32_t n_ch;           // N_CH: ADC channels built (1-4)
+    int32_t avg_shift;      // Spectral average weight 1/2^s, 0 = off
+    int32_t avg_every;      // Classify every avg_every + 1 frames
+    int32_t gate_thr;       // Change gate L1 threshold, 0 = off
+    int32_t gate_max;       // Change gate skips in a row, 0 = no limit
+    int32_t alarm_thr;      // Minimum confidence of a fault
+    int32_t fault_count;    // Consecutive faults before the alarm
+    int32_t n_models;       // NN_MODELS: banks built, 2 or 4 (0 = 2)
+    uint32_t model_cfg;     // MODEL_CFG: [0] PER_CH, [1] ALL, [5:4] last bank, [15:8] channel map
+    uint32_t profile[SE_MAX_MODELS];    // PROFILE(m): [7:0] threshold, [11:8] count, [16] EN
+} se_config;
+
+// One NN weight bank as firmware loads it: the register values and the
+// weight memory image (firmware/nn_weights.h, nn_default_model.vh)
+typedef struct {
+    uint32_t nn_cfg;                    // SE_NN_CFG: [3:0] INT4 layers, [10:8] layer count
+    uint32_t shape[SE_MAX_LAYERS];      // SE_NN_LAYER_SHAPE(l)
+    uint32_t base[SE_MAX_LAYERS];       // SE_NN_LAYER_BASE(l)
+    uint8_t  wt[SE_WT_BYTES];           // Weight memory, byte a at wt[a]
+} se_model;
+
+// Result of one frame, as the result FIFO and alarm pins show it
+typedef struct {
+    int32_t published;      // Frame went on to feature extraction (spec_avg)
+    int32_t skipped;        // Change gate reused the last NN result
+    int32_t model;          // NN bank of the result (RES_FIFO_CH[5:4])
+    int32_t class_id;
+    int32_t confidence;
+    int32_t second_id;
+    int32_t top_score;      // Signed 16-bit scores
+    int32_t second_score;
+    int32_t alarm_active;
+    int32_t alarm_irq;      // Alarm raised on this frame
+    int32_t fault_class;    // last_fault_class
+} se_result;
+
+// alarm_logic counters (zero for reset)
+typedef struct {
+    int32_t consec[4];
+    int32_t active;
+    int32_t ch;
+    int32_t fault_class;
+} se_alarm_state;
+
+typedef struct se_pipe se_pipe;
+
+// --- Blocks ---
+// x: the 2^(6 + fft_size) samples of a frame, sign-extended 12-bit codes.
+// se_fft writes 2^(5 + fft_size) magnitudes. se_features takes a spectrum
+// of that length and the raw samples (time features 0 with x NULL).
+void se_fft(const int16_t *x, int fft_size, int window, int real_fft, uint16_t *mag);
+void se_features(const uint16_t *mag, const int16_t *x, int fft_size, uint8_t *feat);
+
+// One inference on feat[SE_N_FEAT]; fills the class / score fields of r.
+// Returns -1 for a descriptor table the RTL cannot run (0 or more than 4
+// layers, 0 inputs or outputs, more than SE_MAX_NEURONS).
+int  se_nn(const se_model *m, const uint8_t *feat, se_result *r);
+
+// One classification into the alarm counters, with the alarm profile of
+// bank r->model (ALARM_CFG unless enabled); sets r's alarm fields
+void se_alarm_step(se_alarm_state *s, const se_config *c, int ch, se_result *r);
+
+// Parse a Verilog boot model (verilog/rtl/nn_default_model.vh); -1 if
+// the file cannot be read or lacks the image
+int  se_model_load_vh(const char *path, se_model *m);
+
+// --- Pipeline ---
+// Keeps the state carried between frames (averages, gate reference, held
+// result, alarm counters, banks), from reset / enable with bank 0 active.
+// m holds the model of every bank, m[0] to m[n_models - 1]; with
+// n_models 0 it is one model that both banks hold. Frames go in the
+// order the FFT takes them; spec / feat may be NULL. A frame gives
+// se_frame_results(c) results in r, one per bank with MODEL_CFG.ALL
+// (banks 0 to last), else one. Returns their number, 0 when spec_avg
+// held the frame back, -1 for a bad model.
+se_pipe *se_pipe_new(const se_config *c, const se_model *m);
+void     se_pipe_free(se_pipe *p);
+void     se_pipe_reset(se_pipe *p);                          // CTRL enable low
+void     se_pipe_set_model(se_pipe *p, const se_model *m);   // Load the shadow bank, swap
+void     se_pipe_load_bank(se_pipe *p, int bank, const se_model *m); // MODEL_CFG.EDIT load
+int      se_pipe_frame(se_pipe *p, const int16_t *x, int ch,
+                       uint16_t *spec, uint8_t *feat, se_result *r);
+int      se_frame_results(const se_config *c);
+
+// --- Batch evaluation ---
+// n_frames frames of 2^(6 + fft_size) samples back to back in x. They
+// form streams of stream_len frames, each run from reset on its own
+// pipeline; the streams are spread over n_threads threads (0: one per
+// core). stream_len 1 makes every frame independent. m as for
+// se_pipe_new; r holds se_frame_results(c) results per frame. ch (per
+// frame), spec, feat may be NULL; returns -1 for a bad model.
+int  se_run_batch(const se_config *c, const se_model *m, const int16_t *x,
+                  int64_t n_frames, int64_t stream_len, const int32_t *ch,
+                  uint16_t *spec, uint8_t *feat, se_result *r, int n_threads);
+
+// NN only, on n feature vectors of SE_N_FEAT bytes
+int  se_nn_batch(const se_model *m, const uint8_t *feat, int64_t n,
+                 se_result *r, int n_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSEEDGE_GOLDEN_H
@@ -0,0 +1,272 @@
+# SPDX-License-Identifier: Apache-2.0
+# SenseEdge Golden Model Binding
+# Python interface to the bit-exact C++ model of the pipeline (ml/golden)
+
+"""
+Run recorded frames through a bit-exact model of the SenseEdge pipeline.
+
+ml/golden/senseedge_golden.cpp models fft_engine (WINDOW, REAL_FFT),
+spec_avg, feature_extract, nn_gate, nn_engine with its banks (MODEL_CFG)
+and alarm_logic the way the RTL computes them, and is loaded here with ctypes. Build it first:
+
+  make -C ml/golden
+
+(or point SENSEEDGE_GOLDEN_LIB at the library). Frames are int16 arrays
+of 2^(6 + fft_size) sign-extended 12-bit ADC codes in sample order, one
+frame per row; the model is a weight bank as firmware loads it, taken
+from a trained .npz (the export_weights.py layout) or a boot model .vh.
+
+  model = Model.from_npz("senseedge_weights.npz")
+  out = run(frames, Config(window=1), model, threads=0)
+  out["result"]["class_id"], out["features"]
+
+With several banks, pass one Model per bank and MODEL_CFG in the
+config; MODEL_CFG.ALL gives every frame one result per bank:
+
+  out = run(frames, Config(n_models=4, model_cfg=0x32), [m0, m1, m2, m3])
+  out["result"][:, 2]                     # bank 2 on every frame
+
+run() spreads independent streams over threads; nn() classifies feature
+vectors only, e.g. to score a quantised model on the exact features.
+The command line scores an .npy of frames:
+
+  python senseedge_golden.py frames.npy [--model weights.npz] [--window hann]
+"""
+
+import argparse
+import ctypes
+import os
+import sys
+import time
+
+import numpy as np
+
+
+N_FEAT = 12             # senseedge_golden.h SE_N_FEAT
+MAX_LAYERS = 4          # SE_MAX_LAYERS
+WT_BYTES = 512          # SE_WT_BYTES
+MAX_MODELS = 4          # SE_MAX_MODELS
+
+WINDOWS = {"rect": 0, "hann": 1, "hamming": 2}
+
+# se_result, one int32 per field
+RESULT_DTYPE = np.dtype([(name, np.int32) for name in (
+    "published", "skipped", "model", "class_id", "confidence", "second_id",
+    "top_score", "second_score", "alarm_active", "alarm_irq", "fault_class")])
+
+
+class Config(ctypes.Structure):
+    """se_config: build options and registers, at the wb_interface.v
+    reset values unless given."""
+    _fields_ = [(name, ctypes.c_int32) for name in (
+        "fft_size", "window", "real_fft", "n_ch", "avg_shift", "avg_every",
+        "gate_thr", "gate_max", "alarm_thr", "fault_count", "n_models")] + [
+        ("model_cfg", ctypes.c_uint32),
+        ("profile", ctypes.c_uint32 * MAX_MODELS)]
+
+    def __init__(self, **kw):
+        values = dict(fft_size=0, window=0, real_fft=0, n_ch=1, avg_shift=0,
+                      avg_every=0, gate_thr=0, gate_max=0, alarm_thr=128,
+                      fault_count=3, n_models=0, model_cfg=0)
+        values.update(kw)
+        profile = values.pop("profile", ())
+        super().__init__(**values)
+        for m, v in enumerate(profile):
+            self.profile[m] = v
+
+
+class Model(ctypes.Structure):
+    """se_model: SE_NN_CFG, the layer descriptors and the weight image
+    of one bank."""
+    _fields_ = [("nn_cfg", ctypes.c_uint32),
+                ("shape", ctypes.c_uint32 * MAX_LAYERS),
+                ("base", ctypes.c_uint32 * MAX_LAYERS),
+                ("wt", ctypes.c_uint8 * WT_BYTES)]
+
+    @classmethod
+    def from_registers(cls, image, shapes, bases, nn_cfg):
+        """From the values firmware writes: weight bytes from address 0,
+        SE_NN_LAYER_SHAPE / _BASE per layer and SE_NN_CFG."""
+        m = cls()
+        m.nn_cfg = nn_cfg
+        for l, (s, b) in enumerate(zip(shapes, bases)):
+            m.shape[l] = s
+            m.base[l] = b
+        for a, v in enumerate(image):
+            m.wt[a] = int(v) & 0xFF
+        return m
+
+    @classmethod
+    def from_npz(cls, path):
+        """From a train_senseedge.py weight file, laid out like
+        firmware/nn_weights.h."""
+        from export_weights import load_weights, layout_model, layer_shape, layer_base
+        layers = load_weights(path)
+        image, _, descs = layout_model(layers)
+        int4 = sum(1 << l for l, ly in enumerate(layers) if ly["int4"])
+        return cls.from_registers(image, [layer_shape(*d) for d in descs],
+                                  [layer_base(*d) for d in descs],
+                                  (len(layers) << 8) | int4)
+
+    @classmethod
+    def from_vh(cls, path):
+        """From a boot model, verilog/rtl/nn_default_model.vh."""
+        m = cls()
+        if _lib().se_model_load_vh(path.encode(), ctypes.byref(m)) < 0:
+            raise ValueError(f"{path}: no boot model image")
+        return m
+
+
+_LIB = None
+
+
+def _lib():
+    global _LIB
+    if _LIB is None:
+        path = os.environ.get("SENSEEDGE_GOLDEN_LIB") or os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), "golden",
+            "libsenseedge_golden.so")
+        if not os.path.isfile(path):
+            raise OSError(f"{path} not found; build it with: make -C ml/golden")
+        lib = ctypes.CDLL(path)
+        vp, i32, i64 = ctypes.c_void_p, ctypes.c_int, ctypes.c_int64
+        lib.se_fft.argtypes = [vp, i32, i32, i32, vp]
+        lib.se_features.argtypes = [vp, vp, i32, vp]
+        lib.se_nn_batch.argtypes = [vp, vp, i64, vp, i32]
+        lib.se_run_batch.argtypes = [vp, vp, vp, i64, i64, vp, vp, vp, vp, i32]
+        lib.se_model_load_vh.argtypes = [ctypes.c_char_p, vp]
+        lib.se_frame_results.argtypes = [vp]
+        _LIB = lib
+    return _LIB
+
+
+def _ptr(a):
+    return a.ctypes.data_as(ctypes.c_void_p)
+
+
+def _frame_len(fft_size):
+    return 64 << fft_size
+
+
+def fft(frame, fft_size=0, window=0, real_fft=0):
+    """fft_engine: the N/2 magnitudes of one frame."""
+    x = np.ascontiguousarray(frame, dtype=np.int16)
+    assert x.shape == (_frame_len(fft_size),), f"frame of {x.shape}"
+    mag = np.empty(_frame_len(fft_size) // 2, dtype=np.uint16)
+    _lib().se_fft(_ptr(x), fft_size, window, real_fft, _ptr(mag))
+    return mag
+
+
+def features(mag, frame=None, fft_size=0):
+    """feature_extract: 12 features of a spectrum and its raw frame
+    (time features 0 without one)."""
+    m = np.ascontiguousarray(mag, dtype=np.uint16)
+    assert m.shape == (_frame_len(fft_size) // 2,), f"spectrum of {m.shape}"
+    x = None if frame is None else np.ascontiguousarray(frame, dtype=np.int16)
+    feat = np.empty(N_FEAT, dtype=np.uint8)
+    _lib().se_features(_ptr(m), None if x is None else _ptr(x), fft_size, _ptr(feat))
+    return feat
+
+
+def nn(model, feats, threads=0):
+    """nn_engine on (n, 12) feature vectors; returns RESULT_DTYPE records
+    (class, confidence and scores)."""
+    f = np.ascontiguousarray(np.atleast_2d(feats), dtype=np.uint8)
+    assert f.shape[1] == N_FEAT, f"feature vectors of {f.shape[1]}"
+    res = np.zeros(len(f), dtype=RESULT_DTYPE)
+    if _lib().se_nn_batch(ctypes.byref(model), _ptr(f), len(f),
+                          _ptr(res), threads) < 0:
+        raise ValueError("descriptor table nn_engine cannot run")
+    return res
+
+
+def run(frames, config, model, stream_len=0, channels=None, threads=0,
+        spectra=False):
+    """The whole pipeline on (n, N) frames in FFT order.
+
+    model is one Model, or one per bank (config.n_models of them).
+    Frames form streams of stream_len (0: one stream) that each start
+    from reset and run on their own thread; stream_len 1 makes every
+    frame independent (no averaging, gating or alarm history). channels
+    tags each frame with its ADC channel. Returns a dict with "result"
+    (RESULT_DTYPE per frame, (n, banks) with MODEL_CFG.ALL, published 0
+    for frames spec_avg held back),
+    "features" (n, 12) and, with spectra, "spectra" (n, N/2).
+    """
+    n = _frame_len(config.fft_size)
+    x = np.ascontiguousarray(frames, dtype=np.int16).reshape(-1, n)
+    count = len(x)
+    ch = None
+    if channels is not None:
+        ch = np.ascontiguousarray(channels, dtype=np.int32)
+        assert ch.shape == (count,), "one channel per frame"
+    if isinstance(model, Model):
+        model = [model]
+    assert len(model) == max(config.n_models, 1), "one model per bank"
+    banks = (Model * len(model))(*model)
+    per_frame = _lib().se_frame_results(ctypes.byref(config))
+    res = np.zeros((count, per_frame), dtype=RESULT_DTYPE)
+    feat = np.zeros((count, N_FEAT), dtype=np.uint8)
+    spec = np.zeros((count, n // 2), dtype=np.uint16) if spectra else None
+    if _lib().se_run_batch(ctypes.byref(config), banks, _ptr(x),
+                           count, stream_len,
+                           None if ch is None else _ptr(ch),
+                           None if spec is None else _ptr(spec),
+                           _ptr(feat), _ptr(res), threads) < 0:
+        raise ValueError("descriptor table nn_engine cannot run")
+    out = {"result": res if per_frame > 1 else res[:, 0], "features": feat}
+    if spectra:
+        out["spectra"] = spec
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Classify recorded frames with the SenseEdge golden model")
+    parser.add_argument("frames", help=".npy of (n, N) int16 ADC codes")
+    parser.add_argument("--model", type=str, default=None,
+                        help="Weight file (.npz) or boot model (.vh) "
+                             "(default: verilog/rtl/nn_default_model.vh)")
+    parser.add_argument("--window", choices=sorted(WINDOWS), default="rect")
+    parser.add_argument("--real-fft", action="store_true")
+    parser.add_argument("--avg-shift", type=int, default=0)
+    parser.add_argument("--avg-every", type=int, default=0)
+    parser.add_argument("--gate-thr", type=int, default=0)
+    parser.add_argument("--stream-len", type=int, default=0,
+                        help="Frames per independent stream (default: one stream)")
+    parser.add_argument("--threads", type=int, default=0,
+                        help="Worker threads (default: one per core)")
+    parser.add_argument("--output", type=str, default=None,
+                        help="Write features and results to this .npz")
+    args = parser.parse_args()
+
+    frames = np.load(args.frames)
+    fft_size = {64: 0, 128: 1, 256: 2}.get(frames.shape[-1])
+    if fft_size is None:
+        print(f"ERROR: frames of {frames.shape[-1]} samples, expected 64/128/256")
+        return 1
+    path = args.model or os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                      "..", "verilog", "rtl", "nn_default_model.vh")
+    model = Model.from_npz(path) if path.endswith(".npz") else Model.from_vh(path)
+    cfg = Config(fft_size=fft_size, window=WINDOWS[args.window],
+                 real_fft=int(args.real_fft), avg_shift=args.avg_shift,
+                 avg_every=args.avg_every, gate_thr=args.gate_thr)
+
+    t0 = time.time()
+    out = run(frames, cfg, model, args.stream_len, threads=args.threads)
+    dt = time.time() - t0
+    res = out["result"]
+    pub = res[res["published"] == 1]
+    print(f"{len(res)} frames in {dt:.2f} s ({len(res) / max(dt, 1e-9):.0f} frames/s), "
+          f"{len(pub)} classified, {int(pub['skipped'].sum())} by the change gate")
+    for c in range(4):
+        print(f"  class {c}: {int((pub['class_id'] == c).sum())}")
+    print(f"  alarms raised: {int(res['alarm_irq'].sum())}")
+    if args.output:
+        np.savez(args.output, features=out["features"], **{k: res[k] for k in res.dtype.names})
+        print(f"Saved {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,226 @@
+# SPDX-License-Identifier: Apache-2.0
+# SenseEdge Link Decoder
+# Decodes the binary frames the firmware and the hardware UART send on GPIO 5
+
+"""
+Decode the SenseEdge UART link (firmware LINK_FRAMED, UART_CFG.AUTO).
+
+Every frame is
+
+  0xA5 | type | length | payload (length bytes) | CRC-8
+
+with the CRC (polynomial 0x07, init 0, MSB first) over type, length and
+payload, and multi-byte fields little endian. Frame types, as in
+firmware/senseedge_regs.h (LINK_*):
+
+  0x01 RESULT    SE_RES_FIFO word (4 bytes), optionally SE_RES_FIFO_HI (4)
+  0x02 FEATURES  16-bit frame number, then its 12 feature bytes
+  0x03 SPECTRUM  16-bit frame number, then 16-bit FFT magnitudes from bin 0
+  0x04 ALARM     fault class that raised the alarm
+  0x05 TEXT      ASCII status message
+  0x06 PERF      frames classified (4), windows dropped (2), overruns (2),
+                 then the longest SPI, FFT, FE, NN and end-to-end cycle
+                 counts since the previous PERF frame (4 each)
+
+With more than one ADC channel (SE_FRAME_CFG[17:16]) RESULT, FEATURES and
+SPECTRUM payloads end in one more byte, the channel: their length is then
+odd. RESULT payloads also carry it with per-channel or back-to-back NN
+models (SE_MODEL_CFG), the byte then holding the NN bank in [5:4].
+
+The decoder resynchronises on the next 0xA5 after an unknown type or a
+CRC error, so it can be started at any point of a running stream. Reads
+a serial port (needs pyserial) or a capture file and prints one line per
+frame.
+"""
+
+import argparse
+import struct
+import sys
+
+
+SYNC = 0xA5
+CRC_POLY = 0x07
+
+RESULT, FEATURES, SPECTRUM, ALARM, TEXT, PERF = 0x01, 0x02, 0x03, 0x04, 0x05, 0x06
+FRAME_TYPES = (RESULT, FEATURES, SPECTRUM, ALARM, TEXT, PERF)
+
+CLASS_NAMES = ["HEALTHY", "BEARING_WEAR", "IMBALANCE", "MISALIGNMENT"]
+PERF_STAGES = ["SPI", "FFT", "FE", "NN", "LAT"]
+
+
+def crc8(data, crc=0):
+    """CRC-8 of the link frames (type, length and payload)."""
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ CRC_POLY) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode(ftype, payload):
+    """Build one frame, as the firmware sends it."""
+    payload = bytes(payload)
+    assert len(payload) <= 255, f"{len(payload)}-byte payload, a frame holds 255"
+    body = bytes([ftype, len(payload)]) + payload
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+class FrameDecoder:
+    """Incremental frame parser: feed() bytes, get (type, payload) tuples.
+
+    crc_errors counts frames dropped on a bad CRC; skipped counts bytes
+    discarded while looking for a frame start.
+    """
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+        self.skipped = 0
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                self.skipped += len(self.buf)
+                self.buf.clear()
+                break
+            self.skipped += start
+            del self.buf[:start]
+            if len(self.buf) >= 2 and self.buf[1] not in FRAME_TYPES:
+                # A payload byte that looks like sync: no frame starts here
+                self.skipped += 1
+                del self.buf[:1]
+                continue
+            if len(self.buf) < 3 or len(self.buf) < 4 + self.buf[2]:
+                break                       # Rest of the frame still to come
+            n = self.buf[2]
+            body = bytes(self.buf[1:3 + n])
+            if crc8(body) != self.buf[3 + n]:
+                # Not a frame start after all: search again one byte on
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            frames.append((body[0], body[2:]))
+            del self.buf[:4 + n]
+        return frames
+
+
+def channel(payload):
+    """ADC channel of a RESULT, FEATURES or SPECTRUM payload, None if single channel."""
+    return payload[-1] & 0x3 if len(payload) % 2 else None
+
+
+def model(payload):
+    """NN bank of a tagged RESULT payload (RES_MODEL), None if untagged."""
+    return (payload[-1] >> 4) & 0x3 if len(payload) % 2 else None
+
+
+def decode_result(payload):
+    """Fields of a RESULT payload (RES_* macros of senseedge_regs.h)."""
+    w = struct.unpack_from("<I", payload)[0]
+    res = {
+        "class": w & 0x3,
+        "confidence": (w >> 2) & 0xFF,
+        "alarm": (w >> 10) & 0x1,
+        "second": (w >> 12) & 0x3,
+        "reused": (w >> 14) & 0x1,
+        "frame": w >> 16,
+        "channel": channel(payload),
+        "model": model(payload),
+    }
+    if len(payload) >= 8:
+        res["top_score"], res["second_score"] = struct.unpack_from("<hh", payload, 4)
+    return res
+
+
+def decode_perf(payload):
+    """Fields of a PERF payload (SE_PERF_* registers, stage maxima in clocks)."""
+    frames, drops, overruns = struct.unpack_from("<IHH", payload)
+    perf = {"frames": frames, "drops": drops, "overruns": overruns}
+    n = min(len(PERF_STAGES), (len(payload) - 8) // 4)
+    perf.update(zip(PERF_STAGES, struct.unpack_from(f"<{n}I", payload, 8)))
+    return perf
+
+
+def format_frame(ftype, payload):
+    """One line of text per frame, the ASCII format of LINK_FRAMED 0."""
+    if ftype == RESULT and len(payload) >= 4:
+        r = decode_result(payload)
+        line = (f"CLASS:{CLASS_NAMES[r['class']]} CONF:{r['confidence']} "
+                f"ALARM:{r['alarm']} FRAME:{r['frame']}")
+        if r["channel"] is not None:
+            line += f" CH:{r['channel']} MODEL:{r['model']}"
+        if r["reused"]:
+            line += " REUSED"
+        if "top_score" in r:
+            line += (f" SCORES:{r['top_score']}/{r['second_score']}"
+                     f" ({CLASS_NAMES[r['second']]})")
+        return line
+    if ftype in (FEATURES, SPECTRUM) and len(payload) >= 2:
+        frame = struct.unpack_from("<H", payload)[0]
+        ch = channel(payload)
+        tag = f"FRAME:{frame}" + (f" CH:{ch}" if ch is not None else "")
+        data = payload[2:len(payload) & ~1]
+        if ftype == FEATURES:
+            return f"FEATURES {tag}: " + " ".join(str(b) for b in data)
+        mags = struct.unpack(f"<{len(data) // 2}H", data)
+        return f"SPECTRUM[{len(mags)}] {tag}: " + " ".join(str(m) for m in mags)
+    if ftype == ALARM and payload:
+        return f"*** ALARM: Fault detected! *** Class: {CLASS_NAMES[payload[0] & 0x3]}"
+    if ftype == PERF and len(payload) >= 8:
+        p = decode_perf(payload)
+        return (f"PERF FRAMES:{p['frames']} DROPS:{p['drops']} OVERRUNS:{p['overruns']} " +
+                " ".join(f"{k}:{p[k]}" for k in PERF_STAGES if k in p))
+    if ftype == TEXT:
+        return payload.decode("ascii", errors="replace")
+    return f"TYPE 0x{ftype:02X}: {payload.hex()}"
+
+
+def open_source(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            print("ERROR: --port needs pyserial (pip install pyserial)")
+            sys.exit(1)
+        return serial.Serial(args.port, args.baud, timeout=0.1)
+    if args.file == "-":
+        return sys.stdin.buffer
+    return open(args.file, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode the SenseEdge binary UART link")
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port", type=str,
+                     help="Serial port, e.g. /dev/ttyUSB0")
+    src.add_argument("--file", type=str,
+                     help="Raw capture file ('-' for stdin)")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    dec = FrameDecoder()
+    stream = open_source(args)
+    try:
+        while True:
+            data = stream.read(256)
+            if not data:
+                if args.port:
+                    continue
+                break
+            for ftype, payload in dec.feed(data):
+                print(format_frame(ftype, payload), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+    if dec.crc_errors or dec.skipped:
+        print(f"({dec.crc_errors} CRC errors, {dec.skipped} bytes skipped)",
+              file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
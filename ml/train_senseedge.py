@@ -7,7 +7,13 @@
 Train a small fully-connected neural network for the SenseEdge ASIC.
 
 Architecture: 8 inputs -> 16 hidden (ReLU) -> 4 outputs (argmax)
-All weights quantized to INT8 [-128, 127] for hardware inference.
+(--hidden sets up to 3 hidden layers of up to 32 neurons; nn_engine.v
+walks whatever the layer descriptor table describes)
+All weights quantized to INT8 [-128, 127] for hardware inference;
+--int4 quantizes selected layers' weights to INT4 [-8, 7] instead
+(nn_engine.v packs them two per byte, twice the MACs per clock).
+Each layer gets the requantise shift that keeps its 16-bit outputs from
+saturating on the training set.
 Total parameters: (8*16) + 16 + (16*4) + 4 = 212
 
 Features match the hardware feature_extract.v module:
@@ -19,6 +25,12 @@ Features match the hardware feature_extract.v module:
   [5] Peak magnitude      (value at peak bin)
   [6] Spectral centroid   (weighted avg frequency)
   [7] Total energy        (sum all bins)
+With --time-features the network takes 12 inputs, adding the time-domain
+features of the raw window:
+  [8]  RMS                (standard deviation of the samples)
+  [9]  Peak               (max |x|)
+  [10] Crest factor       (16 * peak / RMS)
+  [11] Kurtosis           (16 * E[x^4] / E[x^2]^2)
 
 All features are normalized to [0, 255] (uint8) to match hardware.
 """
@@ -33,20 +45,25 @@ import numpy as np
 # Synthetic data generation
 # ---------------------------------------------------------------------------
 
-def generate_synthetic_data(n_samples_per_class=500, seed=42):
+def generate_synthetic_data(n_samples_per_class=500, seed=42,
+                            time_features=False):
     """Generate synthetic vibration feature data for 4 fault classes.
 
     Each sample is 8 features in [0, 255] (uint8 range) that mimic the
-    spectral characteristics produced by feature_extract.v.
+    spectral characteristics produced by feature_extract.v, followed by
+    the 4 time-domain features with time_features (12 in all).
 
     Classes:
       0 - Healthy:      energy concentrated in low band, low total energy
       1 - Bearing Wear: energy in mid-low band, high peak magnitude
       2 - Imbalance:    energy in mid-high band
       3 - Misalignment: energy in high band
+    In the time domain bearing wear is impulsive (high crest factor and
+    kurtosis), imbalance a near-sinusoid (crest ~22, kurtosis ~24) and
+    healthy / misaligned machines roughly Gaussian (kurtosis ~48).
 
     Returns:
-        X : ndarray (N, 8) float64 in [0, 255]
+        X : ndarray (N, 8 or 12) float64 in [0, 255]
         y : ndarray (N,) int, class labels 0-3
     """
     rng = np.random.RandomState(seed)
@@ -112,6 +129,20 @@ def generate_synthetic_data(n_samples_per_class=500, seed=42):
     X = np.vstack(X_all)
     y = np.concatenate(y_all)
 
+    if time_features:
+        # RMS, peak, crest, kurtosis ranges per class (feature_extract.v scale)
+        ranges = [
+            [(20, 60),   (70, 150),  (35, 60),   (35, 65)],     # Healthy
+            [(40, 90),   (180, 255), (70, 140),  (110, 255)],   # Bearing wear
+            [(90, 170),  (130, 240), (20, 26),   (20, 30)],     # Imbalance
+            [(60, 120),  (150, 250), (30, 50),   (40, 75)],     # Misalignment
+        ]
+        T = np.zeros((len(y), 4))
+        for c, cr in enumerate(ranges):
+            m = y == c
+            T[m] = np.column_stack([rng.uniform(lo, hi, m.sum()) for lo, hi in cr])
+        X = np.hstack([X, T])
+
     # Shuffle
     idx = rng.permutation(len(y))
     return X[idx], y[idx]
@@ -121,8 +152,9 @@ def generate_synthetic_data(n_samples_per_class=500, seed=42):
 # Real CWRU data loading (optional, requires scipy)
 # ---------------------------------------------------------------------------
 
-def load_cwru_data(data_dir):
-    """Load real CWRU bearing dataset .mat files and extract 8 features.
+def load_cwru_data(data_dir, window="rect", time_features=False):
+    """Load real CWRU bearing dataset .mat files and extract 8 features
+    (12 with time_features).
 
     Expected directory layout (standard CWRU filenames):
       data_dir/Normal.mat          -> class 0
@@ -131,10 +163,11 @@ def load_cwru_data(data_dir):
       data_dir/OR007.mat           -> class 3 (outer race / misalignment)
 
     Each .mat file should contain a drive-end accelerometer signal key
-    ending in '_DE_time'.
+    ending in '_DE_time'. `window` must match the WINDOW the ASIC was
+    built with (see _window_coeffs).
 
     Returns:
-        X : ndarray (N, 8) float64 in [0, 255]
+        X : ndarray (N, 8 or 12) float64 in [0, 255]
         y : ndarray (N,) int
     """
     try:
@@ -177,7 +210,7 @@ def load_cwru_data(data_dir):
 
         for i in range(n_windows):
             seg = signal[i * hop: i * hop + window_size]
-            features = _extract_features_from_signal(seg)
+            features = _extract_features_from_signal(seg, window, time_features)
             X_all.append(features)
             y_all.append(label)
 
@@ -189,7 +222,7 @@ def load_cwru_data(data_dir):
     y = np.array(y_all, dtype=int)
 
     # Normalize each feature to [0, 255]
-    for j in range(8):
+    for j in range(X.shape[1]):
         col = X[:, j]
         cmin, cmax = col.min(), col.max()
         if cmax > cmin:
@@ -201,14 +234,95 @@ def load_cwru_data(data_dir):
     return X[idx], y[idx]
 
 
-def _extract_features_from_signal(segment):
+# Window options of fft_engine.v (WINDOW parameter)
+WINDOWS = {"rect": 0, "hann": 1, "hamming": 2}
+
+
+def _window_coeffs(window, n_fft=64):
+    """Q1.14 window coefficients applied by the fft_engine.v load pass.
+
+    Rebuilds the hardware ROM: periodic Hann / Hamming sampled at k/256
+    for k = 0..128 and mirrored, then taken every 256/n_fft entries.
+    """
+    if window == "rect":
+        return np.full(n_fft, 16384, dtype=np.int64)
+    a = 0.5 if window == "hann" else 0.54
+    k = np.arange(129)
+    half = np.floor(16384.0 * (a - (1.0 - a) * np.cos(2.0 * np.pi * k / 256.0))
+                    + 0.5).astype(np.int64)
+    rom = np.concatenate([half, half[127:0:-1]])    # k = 0..255
+    return rom[np.arange(n_fft) * (256 // n_fft)]
+
+
+def _apply_window(segment, window, n_fft=64):
+    """Window a segment as the hardware does: x * w >> 14.
+
+    Integer segments (ADC codes) are windowed bit-exactly; float segments
+    use the same coefficients without the final truncation.
+    """
+    seg = np.asarray(segment[:n_fft])
+    if window == "rect":
+        return seg
+    w = _window_coeffs(window, n_fft)
+    if np.issubdtype(seg.dtype, np.integer):
+        return (seg.astype(np.int64) * w) >> 14
+    return seg * (w / 16384.0)
+
+
+def _time_features(segment, n_fft=64):
+    """The 4 time-domain features of feature_extract.v: RMS, peak, crest
+    factor and kurtosis of the raw (unwindowed) window.
+
+    Integer segments (ADC codes) follow the hardware bit-exactly; float
+    segments use the same definitions without the truncations.
+    """
+    x = np.asarray(segment[:n_fft])
+    if not np.issubdtype(x.dtype, np.integer):
+        a = np.abs(x)
+        m2 = np.mean(x * x)
+        rms = np.sqrt(max(m2 - np.mean(x) ** 2, 0.0))
+        peak = a.max()
+        crest = 16.0 * peak / rms if rms > 0 else (255.0 if peak > 0 else 0.0)
+        kurt = 16.0 * np.mean(x ** 4) / m2 ** 2 if m2 > 0 else 0.0
+        return np.array([rms / 8.0, peak / 8.0, min(crest, 255.0), min(kurt, 255.0)])
+
+    # Hardware: |x| saturated to 11 bits, sums over 2^L samples shifted by L
+    L = int(np.log2(n_fft))
+    x = x.astype(np.int64)
+    a = np.minimum(np.abs(x), 2047)
+    sq = a * a
+    mean = int(x.sum()) >> L
+    var = max((int(sq.sum()) >> L) - mean * mean, 0)
+    rms = int(np.sqrt(var))
+    while rms * rms > var:
+        rms -= 1
+    while (rms + 1) * (rms + 1) <= var:
+        rms += 1
+    peak = int(a.max())
+    m2 = int(sq.sum()) >> (L + 6)
+    m4 = int(((sq >> 6) ** 2).sum()) >> L
+
+    def div8(num, den):
+        # Saturating 8-bit quotient, x / 0 = 255, 0 / 0 = 0
+        if den == 0:
+            return 0 if num == 0 else 255
+        return min(num // den, 255)
+
+    return np.array([rms >> 3, peak >> 3, div8(16 * peak, rms),
+                     div8(16 * m4, m2 * m2)], dtype=np.float64)
+
+
+def _extract_features_from_signal(segment, window="rect", time_features=False):
     """Compute 8 features from a time-domain segment, mirroring
     the hardware feature_extract.v module.
 
-    Uses a 64-point FFT and takes the first 32 magnitude bins.
+    Uses a 64-point FFT and takes the first 32 magnitude bins. The
+    segment is windowed first with the fft_engine.v WINDOW option the
+    model is trained for ("rect", "hann" or "hamming"). time_features
+    appends the 4 time-domain features (_time_features).
     """
     n_fft = 64
-    fft_vals = np.fft.rfft(segment[:n_fft])
+    fft_vals = np.fft.rfft(_apply_window(segment, window, n_fft))
     mag = np.abs(fft_vals)[:32]  # bins 0..31
 
     band_low    = np.sum(mag[1:5])
@@ -225,13 +339,16 @@ def _extract_features_from_signal(segment):
     else:
         centroid = 0.0
 
-    return np.array([
+    features = np.array([
         band_low, band_midlow, band_midhi, band_high,
         peak_bin * 8.0,       # scale like hardware: peak_bin << 3
         peak_mag_val,
         centroid * 8.0,       # scale to approximate hardware range
         total,
     ])
+    if time_features:
+        features = np.concatenate([features, _time_features(segment, n_fft)])
+    return features
 
 
 # ---------------------------------------------------------------------------
@@ -259,50 +376,48 @@ def cross_entropy_loss(probs, labels):
     return log_probs.mean()
 
 
-def forward(X, W1, b1, W2, b2):
+def forward(X, layers):
     """Forward pass.
 
     Args:
-        X:  (batch, 8)   inputs in [0, 255]
-        W1: (16, 8)      layer 1 weights
-        b1: (16,)        layer 1 biases
-        W2: (4, 16)      layer 2 weights
-        b2: (4,)         layer 2 biases
+        X:      (batch, inputs) inputs in [0, 255]
+        layers: list of (W, b), W (outputs, inputs), b (outputs,); ReLU
+                after every layer but the last
 
     Returns:
-        z1, h1, z2, probs
+        zs (pre-activations per layer), hs (input of each layer), probs
     """
-    z1 = X @ W1.T + b1           # (batch, 16)
-    h1 = relu(z1)                 # (batch, 16)
-    z2 = h1 @ W2.T + b2          # (batch, 4)
-    probs = softmax(z2)           # (batch, 4)
-    return z1, h1, z2, probs
-
-
-def backward(X, z1, h1, probs, labels, W2):
+    zs, hs = [], []
+    h = X
+    for i, (W, b) in enumerate(layers):
+        hs.append(h)
+        z = h @ W.T + b
+        zs.append(z)
+        h = relu(z) if i < len(layers) - 1 else z
+    probs = softmax(zs[-1])
+    return zs, hs, probs
+
+
+def backward(zs, hs, probs, labels, layers):
     """Backward pass with cross-entropy + softmax gradient.
 
     Returns:
-        dW1, db1, dW2, db2
+        list of (dW, db), one per layer
     """
-    n = X.shape[0]
+    n = labels.shape[0]
 
     # Output layer gradient: softmax + cross-entropy
-    dz2 = probs.copy()
-    dz2[np.arange(n), labels] -= 1.0
-    dz2 /= n
-
-    dW2 = dz2.T @ h1             # (4, 16)
-    db2 = dz2.sum(axis=0)        # (4,)
-
-    # Hidden layer gradient
-    dh1 = dz2 @ W2               # (batch, 16)
-    dz1 = dh1 * relu_grad(z1)    # (batch, 16)
+    dz = probs.copy()
+    dz[np.arange(n), labels] -= 1.0
+    dz /= n
 
-    dW1 = dz1.T @ X              # (16, 8)
-    db1 = dz1.sum(axis=0)        # (16,)
-
-    return dW1, db1, dW2, db2
+    grads = [None] * len(layers)
+    for i in reversed(range(len(layers))):
+        grads[i] = (dz.T @ hs[i], dz.sum(axis=0))
+        if i > 0:
+            # Hidden layer gradient
+            dz = (dz @ layers[i][0]) * relu_grad(zs[i - 1])
+    return grads
 
 
 # ---------------------------------------------------------------------------
@@ -324,28 +439,53 @@ def quantize_int8(weights):
     return q, scale
 
 
+def quantize_int4(weights):
+    """Quantize float weights to INT4 [-8, 7] (same scheme as INT8).
+
+    Returns quantized weights (int8 ndarray holding 4-bit values) and the
+    scale factor.
+    """
+    w_max = np.max(np.abs(weights))
+    if w_max == 0:
+        return np.zeros_like(weights, dtype=np.int8), 1.0
+    scale = 7.0 / w_max
+    q = np.round(weights * scale).astype(np.int64)
+    q = np.clip(q, -8, 7).astype(np.int8)
+    return q, scale
+
+
+def parse_int4(spec, n_layers):
+    """Layers with INT4 weights: "none", "l1", "l2", "both" or a list of
+    layer numbers such as "1,3". Returns one flag per layer (NN_CFG[3:0])."""
+    aliases = {"none": "", "l1": "1", "l2": "2", "both": "1,2"}
+    spec = aliases.get(spec, spec)
+    picked = {int(t) for t in spec.split(",") if t.strip()}
+    assert picked <= set(range(1, n_layers + 1)), \
+        f"--int4 {spec}: layers are 1..{n_layers}"
+    return [i + 1 in picked for i in range(n_layers)]
+
+
 # ---------------------------------------------------------------------------
 # Training loop
 # ---------------------------------------------------------------------------
 
-def train(X_train, y_train, X_val, y_val,
+def train(X_train, y_train, X_val, y_val, sizes=(8, 16, 4),
           epochs=200, batch_size=64, lr=0.01, lr_decay=0.995, seed=123):
-    """Train the 8->16->4 network using mini-batch SGD.
+    """Train the network (sizes: inputs, hidden..., outputs) using
+    mini-batch SGD.
 
     Returns:
-        W1, b1, W2, b2 (float64 weights)
+        list of (W, b) float64 weights
     """
     rng = np.random.RandomState(seed)
 
     # Xavier initialization
-    W1 = rng.randn(16, 8) * np.sqrt(2.0 / 8)
-    b1 = np.zeros(16)
-    W2 = rng.randn(4, 16) * np.sqrt(2.0 / 16)
-    b2 = np.zeros(4)
+    layers = [(rng.randn(n_out, n_in) * np.sqrt(2.0 / n_in), np.zeros(n_out))
+              for n_in, n_out in zip(sizes[:-1], sizes[1:])]
 
     n_train = X_train.shape[0]
     best_val_acc = 0.0
-    best_params = (W1.copy(), b1.copy(), W2.copy(), b2.copy())
+    best_params = [(W.copy(), b.copy()) for W, b in layers]
 
     print(f"Training: {n_train} samples, {epochs} epochs, "
           f"batch_size={batch_size}, lr={lr}")
@@ -365,29 +505,26 @@ def train(X_train, y_train, X_val, y_val,
             Xb = X_shuf[start:end]
             yb = y_shuf[start:end]
 
-            z1, h1, z2, probs = forward(Xb, W1, b1, W2, b2)
+            zs, hs, probs = forward(Xb, layers)
             loss = cross_entropy_loss(probs, yb)
             epoch_loss += loss
             n_batches += 1
 
-            dW1, db1, dW2, db2 = backward(Xb, z1, h1, probs, yb, W2)
-
-            W1 -= lr * dW1
-            b1 -= lr * db1
-            W2 -= lr * dW2
-            b2 -= lr * db2
+            grads = backward(zs, hs, probs, yb, layers)
+            layers = [(W - lr * dW, b - lr * db)
+                      for (W, b), (dW, db) in zip(layers, grads)]
 
         lr *= lr_decay
         epoch_loss /= n_batches
 
         # Validation accuracy
-        _, _, _, val_probs = forward(X_val, W1, b1, W2, b2)
+        _, _, val_probs = forward(X_val, layers)
         val_preds = np.argmax(val_probs, axis=1)
         val_acc = np.mean(val_preds == y_val)
 
         if val_acc > best_val_acc:
             best_val_acc = val_acc
-            best_params = (W1.copy(), b1.copy(), W2.copy(), b2.copy())
+            best_params = [(W.copy(), b.copy()) for W, b in layers]
 
         if (epoch + 1) % 20 == 0 or epoch == 0:
             print(f"  Epoch {epoch+1:4d}/{epochs}  "
@@ -404,56 +541,82 @@ def train(X_train, y_train, X_val, y_val,
 # Evaluate quantized model
 # ---------------------------------------------------------------------------
 
-def evaluate_quantized(X, y, W1_q, b1_q, W2_q, b2_q):
-    """Run inference with INT8 weights (cast to float for numpy matmul)
-    and report accuracy.  This simulates what the hardware will compute."""
-    _, _, _, probs = forward(
-        X,
-        W1_q.astype(np.float64), b1_q.astype(np.float64),
-        W2_q.astype(np.float64), b2_q.astype(np.float64),
-    )
-    preds = np.argmax(probs, axis=1)
+def hw_forward(X, q_layers, shifts):
+    """Integer inference exactly as nn_engine.v computes it: 24-bit
+    wrapping sums plus bias, arithmetic shift, saturation to 16 bits, ReLU
+    on hidden layers. Returns the last layer's outputs and the largest
+    pre-shift magnitude per layer."""
+    h = np.asarray(X, dtype=np.int64)
+    peaks = []
+    for i, (W, b) in enumerate(q_layers):
+        s = h @ W.astype(np.int64).T + b.astype(np.int64)
+        s = ((s + (1 << 23)) & ((1 << 24) - 1)) - (1 << 23)
+        peaks.append(int(np.abs(s).max()))
+        h = np.clip(s >> shifts[i], -32768, 32767)
+        if i < len(q_layers) - 1:
+            h = np.maximum(h, 0)
+    return h, peaks
+
+
+def requant_shifts(X, q_layers):
+    """Smallest shift per layer that keeps its outputs on X within 16 bits,
+    chosen layer by layer as the next layer sees the shifted values."""
+    shifts = [0] * len(q_layers)
+    for i in range(len(q_layers)):
+        _, peaks = hw_forward(X, q_layers[:i + 1], shifts)
+        while (peaks[i] >> shifts[i]) > 32767 and shifts[i] < 15:
+            shifts[i] += 1
+    return shifts
+
+
+def evaluate_quantized(X, y, q_layers, shifts):
+    """Run inference with the integer model and report accuracy, with the
+    predictions. The class is the argmax of the first four outputs, like
+    the hardware."""
+    out, _ = hw_forward(X, q_layers, shifts)
+    preds = np.argmax(out[:, :4], axis=1)
     acc = np.mean(preds == y)
-    return acc
+    return acc, preds
 
 
 # ---------------------------------------------------------------------------
 # Save weights
 # ---------------------------------------------------------------------------
 
-def save_weights(path, W1_q, b1_q, W2_q, b2_q, scales):
+def save_weights(path, q_layers, shifts, scales, int4):
     """Save INT8 quantized weights to .npz file.
 
-    Memory layout matches nn_engine.v:
+    layer<k>_weights (outputs x inputs, row-major) and layer<k>_biases for
+    k = 1..layers, the requantise shift of every layer, and int4 flags for
+    the layers whose weights are INT4 values. export_weights.py lays them
+    out in nn_engine.v weight memory; the 8->16->4 default lands at
       [0..127]   Layer 1 weights (16 neurons x 8 inputs, row-major)
       [128..143]  Layer 1 biases
       [144..207]  Layer 2 weights (4 neurons x 16 inputs, row-major)
       [208..211]  Layer 2 biases
     """
-    # Build flat array matching hardware memory layout
-    all_weights = np.concatenate([
-        W1_q.flatten(),   # [0..127]   16x8 row-major
-        b1_q.flatten(),   # [128..143]
-        W2_q.flatten(),   # [144..207] 4x16 row-major
-        b2_q.flatten(),   # [208..211]
-    ]).astype(np.int8)
-
-    assert len(all_weights) == 212, \
-        f"Expected 212 parameters, got {len(all_weights)}"
+    arrays = {}
+    for k, (W_q, b_q) in enumerate(q_layers, start=1):
+        arrays[f"layer{k}_weights"] = W_q
+        arrays[f"layer{k}_biases"] = b_q
+    all_weights = np.concatenate(
+        [a for W_q, b_q in q_layers for a in (W_q.flatten(), b_q.flatten())]
+    ).astype(np.int8)
 
     np.savez(path,
-             layer1_weights=W1_q,
-             layer1_biases=b1_q,
-             layer2_weights=W2_q,
-             layer2_biases=b2_q,
+             layers=len(q_layers),
              all_weights=all_weights,
-             scales=np.array(scales))
+             shifts=np.array(shifts),
+             scales=np.array(scales),
+             int4_layers=np.array(int4),
+             **arrays)
 
     print(f"Saved INT8 weights to {path}")
-    print(f"  Layer 1 weights: {W1_q.shape}  range [{W1_q.min()}, {W1_q.max()}]")
-    print(f"  Layer 1 biases:  {b1_q.shape}  range [{b1_q.min()}, {b1_q.max()}]")
-    print(f"  Layer 2 weights: {W2_q.shape}  range [{W2_q.min()}, {W2_q.max()}]")
-    print(f"  Layer 2 biases:  {b2_q.shape}  range [{b2_q.min()}, {b2_q.max()}]")
+    for k, ((W_q, b_q), sh, flag) in enumerate(zip(q_layers, shifts, int4), start=1):
+        prec = "INT4" if flag else "INT8"
+        print(f"  Layer {k} weights: {W_q.shape}  range [{W_q.min()}, {W_q.max()}]"
+              f"  {prec}, shift {sh}")
+        print(f"  Layer {k} biases:  {b_q.shape}  range [{b_q.min()}, {b_q.max()}]")
     print(f"  Total: {len(all_weights)} parameters")
 
 
@@ -464,6 +627,9 @@ def save_weights(path, W1_q, b1_q, W2_q, b2_q, scales):
 def main():
     parser = argparse.ArgumentParser(
         description="Train SenseEdge vibration classifier (8->16->4 INT8)")
+    parser.add_argument("--time-features", action="store_true",
+                        help="Train on 12 features: the 8 spectral ones plus "
+                             "RMS, peak, crest factor and kurtosis")
     parser.add_argument("--cwru-dir", type=str, default=None,
                         help="Path to CWRU .mat files (omit for synthetic data)")
     parser.add_argument("--epochs", type=int, default=200)
@@ -474,27 +640,53 @@ def main():
     parser.add_argument("--output", type=str, default=None,
                         help="Output .npz path (default: ml/senseedge_weights.npz)")
     parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--window", choices=sorted(WINDOWS), default="rect",
+                        help="FFT input window, must match the fft_engine.v "
+                             "WINDOW build option (default: rect)")
+    parser.add_argument("--hidden", type=str, default="16",
+                        help="Hidden layer widths, comma separated, up to 3 "
+                             "layers of 1-32 (default: 16)")
+    parser.add_argument("--int4", type=str, default="none",
+                        help="Layers with INT4 weights: none, l1, l2, both or "
+                             "layer numbers such as 1,3 (default: none)")
+    parser.add_argument("--golden", action="store_true",
+                        help="Check the saved weights on the validation set "
+                             "with the golden model (make -C ml/golden)")
     args = parser.parse_args()
 
+    hidden = [int(t) for t in args.hidden.split(",") if t.strip()]
+    assert len(hidden) <= 3 and all(1 <= n <= 32 for n in hidden), \
+        "--hidden: up to 3 layers of 1-32 neurons"
+    sizes = [12 if args.time_features else 8] + hidden + [4]
+    int4 = parse_int4(args.int4, len(sizes) - 1)
+    n_params = sum((a + 1) * b for a, b in zip(sizes[:-1], sizes[1:]))
+
     if args.output is None:
         args.output = os.path.join(os.path.dirname(__file__),
                                    "senseedge_weights.npz")
 
     print("=" * 65)
     print("SenseEdge ML Training Pipeline")
-    print("Network: 8 inputs -> 16 hidden (ReLU) -> 4 outputs (argmax)")
+    print("Network: " + " -> ".join(
+        [f"{sizes[0]} inputs"] + [f"{n} hidden (ReLU)" for n in hidden]
+        + [f"{sizes[-1]} outputs (argmax)"]))
     print("Quantization: INT8 [-128, 127]")
-    print("Total parameters: 212")
+    if any(int4):
+        print("INT4 [-8, 7] weights: layer "
+              + ", ".join(str(i + 1) for i, f in enumerate(int4) if f))
+    print(f"Total parameters: {n_params}")
     print("=" * 65)
 
     # --- Load data ---
     if args.cwru_dir is not None:
         print(f"\nLoading CWRU data from {args.cwru_dir} ...")
-        X, y = load_cwru_data(args.cwru_dir)
+        print(f"  FFT window: {args.window} (WINDOW={WINDOWS[args.window]})")
+        X, y = load_cwru_data(args.cwru_dir, args.window, args.time_features)
     else:
         print("\nGenerating synthetic training data ...")
         X, y = generate_synthetic_data(n_samples_per_class=args.samples,
-                                       seed=args.seed)
+                                       seed=args.seed,
+                                       time_features=args.time_features)
 
     # Clip to uint8 range (hardware operates on [0, 255])
     X = np.clip(X, 0, 255)
@@ -515,41 +707,45 @@ def main():
     print(f"  Val:   {len(y_val)} samples\n")
 
     # --- Train ---
-    W1, b1, W2, b2 = train(X_train, y_train, X_val, y_val,
-                            epochs=args.epochs,
-                            batch_size=args.batch_size,
-                            lr=args.lr,
-                            seed=args.seed)
+    layers = train(X_train, y_train, X_val, y_val, sizes,
+                   epochs=args.epochs,
+                   batch_size=args.batch_size,
+                   lr=args.lr,
+                   seed=args.seed)
 
     # --- Float32 accuracy ---
-    _, _, _, probs = forward(X_val, W1, b1, W2, b2)
+    _, _, probs = forward(X_val, layers)
     preds = np.argmax(probs, axis=1)
     float_acc = np.mean(preds == y_val)
     print(f"\nFloat accuracy (validation): {float_acc*100:.1f}%")
 
-    # --- Quantize to INT8 ---
+    # --- Quantize to INT8 (INT4 where selected) ---
     print("\nQuantizing to INT8 ...")
-    W1_q, s1w = quantize_int8(W1)
-    b1_q, s1b = quantize_int8(b1)
-    W2_q, s2w = quantize_int8(W2)
-    b2_q, s2b = quantize_int8(b2)
-
-    int8_acc = evaluate_quantized(X_val, y_val, W1_q, b1_q, W2_q, b2_q)
-    print(f"INT8 accuracy (validation):  {int8_acc*100:.1f}%")
+    q_layers, scales = [], []
+    for (W, b), flag in zip(layers, int4):
+        W_q, sw = quantize_int4(W) if flag else quantize_int8(W)
+        b_q, sb = quantize_int8(b)
+        q_layers.append((W_q, b_q))
+        scales += [sw, sb]
+    prec = "INT4/8" if any(int4) else "INT8"
+
+    # Requantise shifts from the training set
+    X_int = np.round(X_train).astype(np.int64)
+    shifts = requant_shifts(X_int, q_layers)
+    print("Requantise shifts: " + ", ".join(
+        f"layer {i + 1} >> {sh}" for i, sh in enumerate(shifts)))
+
+    int8_acc, preds_q = evaluate_quantized(np.round(X_val).astype(np.int64),
+                                           y_val, q_layers, shifts)
+    print(f"{prec} accuracy (validation):  {int8_acc*100:.1f}%")
 
     if int8_acc < 0.90:
-        print("WARNING: INT8 accuracy below 90% target.")
+        print(f"WARNING: {prec} accuracy below 90% target.")
         print("         Consider increasing training epochs or adjusting lr.")
 
     # --- Per-class accuracy ---
-    _, _, _, probs_q = forward(
-        X_val,
-        W1_q.astype(np.float64), b1_q.astype(np.float64),
-        W2_q.astype(np.float64), b2_q.astype(np.float64),
-    )
-    preds_q = np.argmax(probs_q, axis=1)
     class_names = ["Healthy", "Bearing Wear", "Imbalance", "Misalignment"]
-    print("\nPer-class accuracy (INT8):")
+    print(f"\nPer-class accuracy ({prec}):")
     for c in range(4):
         mask = y_val == c
         if mask.sum() > 0:
@@ -557,8 +753,21 @@ def main():
             print(f"  Class {c} ({class_names[c]:>14s}): {cacc*100:.1f}%")
 
     # --- Save ---
-    scales = [s1w, s1b, s2w, s2b]
-    save_weights(args.output, W1_q, b1_q, W2_q, b2_q, scales)
+    save_weights(args.output, q_layers, shifts, scales, int4)
+
+    # --- Golden model check of the weight image as it will be flashed ---
+    if args.golden:
+        import senseedge_golden
+        model = senseedge_golden.Model.from_npz(args.output)
+        X_g = np.zeros((len(y_val), senseedge_golden.N_FEAT), dtype=np.uint8)
+        X_g[:, :X_val.shape[1]] = np.round(X_val)
+        res = senseedge_golden.nn(model, X_g)
+        agree = np.mean(res["class_id"] == preds_q)
+        print(f"\nGolden model (exported image): accuracy "
+              f"{np.mean(res['class_id'] == y_val)*100:.1f}%, "
+              f"{agree*100:.1f}% agreement with the integer model")
+        if agree < 1.0:
+            print("WARNING: golden model and integer model disagree.")
 
     print("\nDone.")
     return 0
@@ -15,6 +15,11 @@
 #define SE_IRQ_FLAGS     0x18
 #define SE_CLK_DIV       0x1C
 #define SE_NN_WEIGHTS    0x20
+#define SE_NN_CFG        0x7C
+
+#define NN_PARAMS        212
+#define NN_CFG_DEFAULT   0x00000200  // 2 layers, INT8
+#define NN_CFG_SWAP      (1 << 16)
 
 void main() {
     // Enable management GPIO as output indicator
@@ -46,36 +51,31 @@ void main() {
     ManagmentGpio_write(1);
 
     // --- Phase 1: Load NN weights ---
-    // Simple identity-like weights for testing
+    // Simple identity-like weights for testing, all others (and the
+    // biases) zero
     int i;
+    static unsigned char weights[NN_PARAMS];
 
-    // Layer 1 weights (128 bytes): zero all
-    for (i = 0; i < 128; i++)
-        USER_writeWord(0, SE_NN_WEIGHTS + i);
-
-    // Set diagonal weights: neuron K responds to input K
-    USER_writeWord(127, SE_NN_WEIGHTS + 0);    // w[0][0]
-    USER_writeWord(127, SE_NN_WEIGHTS + 9);    // w[1][1]
-    USER_writeWord(127, SE_NN_WEIGHTS + 18);   // w[2][2]
-    USER_writeWord(127, SE_NN_WEIGHTS + 27);   // w[3][3]
-
-    // Layer 1 biases (16 bytes): zero
-    for (i = 128; i < 144; i++)
-        USER_writeWord(0, SE_NN_WEIGHTS + i);
-
-    // Layer 2 weights (64 bytes): zero all
-    for (i = 144; i < 208; i++)
-        USER_writeWord(0, SE_NN_WEIGHTS + i);
+    // Diagonal weights: neuron K responds to input K
+    weights[0]   = 127;     // w[0][0]
+    weights[9]   = 127;     // w[1][1]
+    weights[18]  = 127;     // w[2][2]
+    weights[27]  = 127;     // w[3][3]
 
     // Class K responds to hidden neuron K
-    USER_writeWord(127, SE_NN_WEIGHTS + 144);  // class0 <- hidden0
-    USER_writeWord(127, SE_NN_WEIGHTS + 161);  // class1 <- hidden1
-    USER_writeWord(127, SE_NN_WEIGHTS + 178);  // class2 <- hidden2
-    USER_writeWord(127, SE_NN_WEIGHTS + 195);  // class3 <- hidden3
-
-    // Layer 2 biases (4 bytes): zero
-    for (i = 208; i < 212; i++)
-        USER_writeWord(0, SE_NN_WEIGHTS + i);
+    weights[144] = 127;     // class0 <- hidden0
+    weights[161] = 127;     // class1 <- hidden1
+    weights[178] = 127;     // class2 <- hidden2
+    weights[195] = 127;     // class3 <- hidden3
+
+    // 4 weights per word into the shadow bank, weight i in byte i % 4
+    for (i = 0; i < NN_PARAMS; i += 4)
+        USER_writeWord(weights[i] | (weights[i + 1] << 8) |
+                       (weights[i + 2] << 16) | (weights[i + 3] << 24),
+                       SE_NN_WEIGHTS + i);
+
+    // Make the loaded bank active
+    USER_writeWord(NN_CFG_DEFAULT | NN_CFG_SWAP, SE_NN_CFG);
 
     // --- Phase 2: Configure system ---
     // Set clock divider for SPI (fast for simulation)
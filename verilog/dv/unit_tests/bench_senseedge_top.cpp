@@ -0,0 +1,583 @@
+// SPDX-License-Identifier: Apache-2.0
+// Verilator Bench: SenseEdge Top
+// Regression and cycle budget of the whole pipeline: streams thousands of
+// frames through senseedge_top (Verilator model, see `make bench`), checks
+// every classification against the golden model (ml/golden) and reports
+// the PERF page stage counts and the frame rate at a given CLK_DIV and
+// user clock.
+//
+// Samples come from an MCP3201-style SPI ADC model, or with --inject are
+// written to SAMPLE_IN, each once SAMPLE_IN[0] says it would be taken.
+// The overrun policy is STALL and the hop the full window, so frame k of
+// the pipeline is samples kN to kN + N - 1 of the stream and no window is
+// lost; a drop, a rejected sample, an overflow or a result that differs
+// from the model fails the run.
+//
+// Bank 0 runs the boot model; banks 1 to NN_MODELS - 1 are loaded with it
+// over MODEL_CFG.EDIT, output neurons rotated by the bank number so every
+// bank classifies differently, and the last bank has an alarm PROFILE.
+// --model-cfg sets MODEL_CFG (PER_CH / ALL), and each result's bank
+// (RES_FIFO_CH) is checked as well.
+//
+// Options: --frames N, --clk-div D, --mhz F (user clock for the rates),
+// --seed S, --inject, --fft-size 0/1/2 (up to LOG2_NMAX),
+// --model nn_default_model.vh (the boot model), --model-cfg M
+// Build options, which the Makefile passes to Verilator and here alike:
+// SE_WINDOW, SE_REAL_FFT, SE_LOG2_NMAX, SE_NN_MODELS
+
+#include "Vsenseedge_top.h"
+#include "verilated.h"
+
+#include "senseedge_golden.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef SE_WINDOW
+#define SE_WINDOW       0
+#endif
+#ifndef SE_REAL_FFT
+#define SE_REAL_FFT     0
+#endif
+#ifndef SE_LOG2_NMAX
+#define SE_LOG2_NMAX    6
+#endif
+#ifndef SE_NN_MODELS
+#define SE_NN_MODELS    2
+#endif
+
+double sc_time_stamp() { return 0; }
+
+namespace {
+
+// --- Register page (wb_interface.v) ---
+const uint32_t ADDR_CTRL          = 0x00;
+const uint32_t ADDR_STATUS        = 0x04;
+const uint32_t ADDR_CLK_DIV       = 0x1C;
+const uint32_t ADDR_FRAME_CFG     = 0x78;
+const uint32_t ADDR_NN_CFG        = 0x7C;
+const uint32_t ADDR_NN_LAYER      = 0x80;   // + 8l SHAPE, + 8l + 4 BASE
+const uint32_t ADDR_NN_WT_ADDR    = 0xA0;
+const uint32_t ADDR_NN_WT_DATA    = 0xA4;
+const uint32_t ADDR_RES_FIFO      = 0xA8;
+const uint32_t ADDR_RES_FIFO_HI   = 0xAC;
+const uint32_t ADDR_RES_FIFO_CH   = 0xD4;
+const uint32_t ADDR_SAMPLE_IN     = 0xDC;
+const uint32_t ADDR_MODEL_CFG     = 0xE0;
+const uint32_t ADDR_PROFILE       = 0xE4;   // + 4m
+
+// PERF page (perf_counters.v), word offsets from 0x200
+const uint32_t ADDR_PERF          = 0x200;
+const int      PERF_FRAMES        = 0;
+const int      PERF_DROPS         = 1;
+const int      PERF_OVERRUNS      = 2;
+const int      PERF_STALLS        = 3;
+const int      PERF_STAGE         = 4;      // + 2s LAST, + 2s + 1 MAX
+const int      PERF_SKIPS         = 14;
+const int      PERF_REJECTS       = 15;
+const int      N_STAGES           = 5;
+const char    *STAGE_NAME[N_STAGES] = {"SPI", "FFT", "FE", "NN", "LAT"};
+
+const uint32_t CTRL_ENABLE        = 1u << 0;
+const uint32_t CTRL_INJECT        = 1u << 1;
+const uint32_t FRAME_CFG_STALL    = 2u << 12;
+const uint32_t MODEL_CFG_EDIT_EN  = 1u << 18;
+// Alarm profile of the last bank: threshold 96, two faults, enabled
+const uint32_t PROFILE_LAST       = (1u << 16) | (2u << 8) | 96;
+
+const uint64_t WB_TIMEOUT         = 1u << 22;   // Clocks a bus cycle may stall
+
+const double   PI                 = 3.14159265358979323846;
+
+struct Options {
+    long        frames   = 2000;
+    unsigned    clk_div  = 4;
+    double      mhz      = 25.0;
+    unsigned    seed     = 1;
+    bool        inject   = false;
+    int         fft_size = SE_LOG2_NMAX - 6;
+    std::string model    = "../../rtl/nn_default_model.vh";
+    uint32_t    model_cfg = 0;
+};
+
+// One RES_FIFO entry (word 0, RES_FIFO_HI and RES_FIFO_CH)
+struct HwResult {
+    unsigned frame;
+    int      class_id, confidence, alarm, second_id, reused, bank;
+    int      top_score, second_score;
+};
+
+struct StageStat {
+    uint64_t sum = 0, n = 0;
+    uint32_t min = UINT32_MAX, last = 0, max = 0;
+};
+
+// --- Test signal ---
+// Runs of frames of one machine state, each a few tones over noise like
+// the fault classes of ml/train_senseedge.py, as 12-bit two's-complement
+// codes around 0 (the RTL sign-extends them): 0 broadband noise, 1 bearing wear (high band tone plus
+// impacts), 2 imbalance (strong 1x), 3 misalignment (1x, 2x and 3x)
+class Signal {
+public:
+    explicit Signal(unsigned seed) : s_(seed ? seed : 1) {}
+
+    void frames(long n_frames, int n, std::vector<uint16_t> &codes)
+    {
+        codes.resize(size_t(n_frames) * n);
+        int state = 0, run = 0;
+        for (long f = 0; f < n_frames; f++) {
+            if (run-- <= 0) {
+                state = int(next() % 4);
+                run   = int(next() % 8);
+            }
+            const double f1  = 1.0 + (next() % 3);             // 1x bin (per 64 points)
+            const double amp = 200.0 + (next() % 600);
+            const double ph  = (next() % 1000) * 0.00628;
+            for (int i = 0; i < n; i++) {
+                const double t = 2.0 * PI * i / n * (n / 64);
+                double v = noise(60);
+                switch (state) {
+                case 1:
+                    v += 0.5 * amp * std::sin(t * (18 + f1) + ph);
+                    if (i % 16 == 0)
+                        v += amp;
+                    break;
+                case 2:
+                    v += 1.5 * amp * std::sin(t * f1 + ph);
+                    break;
+                case 3:
+                    v += amp * (std::sin(t * f1 + ph) + 0.8 * std::sin(2 * t * f1)
+                                + 0.5 * std::sin(3 * t * f1));
+                    break;
+                default:
+                    v += noise(100);
+                    break;
+                }
+                const long c = std::lround(v);
+                codes[size_t(f) * n + i] = uint16_t(std::min(2047L, std::max(-2048L, c)) & 0xFFF);
+            }
+        }
+    }
+
+private:
+    uint32_t next()
+    {
+        s_ ^= s_ << 13;
+        s_ ^= s_ >> 17;
+        s_ ^= s_ << 5;
+        return s_;
+    }
+
+    double noise(int amp) { return int(next() % (2 * amp + 1)) - amp; }
+
+    uint32_t s_;
+};
+
+class Bench {
+public:
+    Bench(VerilatedContext *ctx, const Options &o, const std::vector<uint16_t> &codes)
+        : top_(new Vsenseedge_top(ctx)), o_(o), codes_(codes) {}
+
+    ~Bench() { top_->final(); }
+
+    // One user clock; the ADC model answers what the edge shifted out
+    void tick()
+    {
+        top_->wb_clk_i = 0;
+        top_->eval();
+        top_->wb_clk_i = 1;
+        top_->eval();
+        cycle_++;
+        adc();
+        const unsigned frames = top_->la_data_out[1] & 0xFFFF;   // la_perf[15:0]
+        if (frames != la_frames_) {
+            la_frames_ = frames;
+            if (!first_done_)
+                first_done_ = cycle_;
+            last_done_ = cycle_;
+        }
+    }
+
+    void reset()
+    {
+        top_->wb_rst_i  = 1;
+        top_->wbs_cyc_i = 0;
+        top_->wbs_stb_i = 0;
+        top_->wbs_we_i  = 0;
+        top_->wbs_sel_i = 0;
+        top_->wbs_adr_i = 0;
+        top_->wbs_dat_i = 0;
+        for (int w = 0; w < 4; w++) {
+            top_->la_data_in[w] = 0;
+            top_->la_oenb[w]    = 0xFFFFFFFFu;    // LA inputs unused
+        }
+        top_->io_in = 0;
+        for (int i = 0; i < 20; i++)
+            tick();
+        top_->wb_rst_i = 0;
+        // NN boot: the ROM model is copied into bank 0
+        for (int i = 0; i < 200; i++)
+            tick();
+    }
+
+    // Classic Wishbone cycle, held until the ack
+    uint32_t wb(uint32_t addr, uint32_t data, bool we)
+    {
+        top_->wbs_cyc_i = 1;
+        top_->wbs_stb_i = 1;
+        top_->wbs_we_i  = we;
+        top_->wbs_sel_i = 0xF;
+        top_->wbs_adr_i = addr;
+        top_->wbs_dat_i = data;
+        uint64_t waited = 0;
+        do {
+            tick();
+            if (++waited > WB_TIMEOUT) {
+                std::fprintf(stderr, "ERROR: no ack for %s 0x%03x\n",
+                             we ? "write" : "read", addr);
+                std::exit(2);
+            }
+        } while (!top_->wbs_ack_o);
+        const uint32_t rd = top_->wbs_dat_o;
+        top_->wbs_cyc_i = 0;
+        top_->wbs_stb_i = 0;
+        top_->wbs_we_i  = 0;
+        tick();
+        return rd;
+    }
+
+    void     wb_write(uint32_t addr, uint32_t data) { wb(addr, data, true); }
+    uint32_t wb_read(uint32_t addr) { return wb(addr, 0, false); }
+    uint32_t perf(int word) { return wb_read(ADDR_PERF + 4 * word); }
+
+    // Weights, descriptors and NN_CFG of one bank, through MODEL_CFG.EDIT
+    void load_bank(int bank, const se_model &m)
+    {
+        wb_write(ADDR_MODEL_CFG, MODEL_CFG_EDIT_EN | (uint32_t(bank) << 16));
+        wb_write(ADDR_NN_CFG, m.nn_cfg & 0x7FF);
+        for (int l = 0; l < SE_MAX_LAYERS; l++) {
+            wb_write(ADDR_NN_LAYER + 8 * l, m.shape[l]);
+            wb_write(ADDR_NN_LAYER + 8 * l + 4, m.base[l]);
+        }
+        wb_write(ADDR_NN_WT_ADDR, 0);
+        for (int a = 0; a < SE_WT_BYTES; a += 4)
+            wb_write(ADDR_NN_WT_DATA, uint32_t(m.wt[a]) | uint32_t(m.wt[a + 1]) << 8 |
+                                      uint32_t(m.wt[a + 2]) << 16 | uint32_t(m.wt[a + 3]) << 24);
+    }
+
+    void start()
+    {
+        const uint32_t ctrl = CTRL_ENABLE | (o_.inject ? CTRL_INJECT : 0) |
+                              (uint32_t(o_.fft_size) << 4);
+        wb_write(ADDR_CLK_DIV, o_.clk_div);
+        wb_write(ADDR_FRAME_CFG, FRAME_CFG_STALL);      // Hop N, one channel
+        wb_write(ADDR_PROFILE + 4 * (SE_NN_MODELS - 1), PROFILE_LAST);
+        wb_write(ADDR_MODEL_CFG, o_.model_cfg & ~MODEL_CFG_EDIT_EN);
+        wb_write(ADDR_CTRL, ctrl);
+        enabled_ = cycle_;
+    }
+
+    // Pops every queued result; samples the stage counts when there were any
+    void drain()
+    {
+        const uint32_t st = wb_read(ADDR_STATUS);
+        if (st & (1u << 13))
+            overflow_ = true;
+        const unsigned level = (st >> 8) & 0x1F;
+        for (unsigned k = 0; k < level; k++) {
+            const uint32_t w0 = wb_read(ADDR_RES_FIFO);
+            const uint32_t w1 = wb_read(ADDR_RES_FIFO_HI);
+            const uint32_t ch = wb_read(ADDR_RES_FIFO_CH);
+            if (!(w0 & (1u << 11)))
+                continue;
+            HwResult r;
+            r.frame        = w0 >> 16;
+            r.class_id     = w0 & 3;
+            r.confidence   = (w0 >> 2) & 0xFF;
+            r.alarm        = (w0 >> 10) & 1;
+            r.second_id    = (w0 >> 12) & 3;
+            r.reused       = (w0 >> 14) & 1;
+            r.top_score    = int16_t(w1 & 0xFFFF);
+            r.second_score = int16_t(w1 >> 16);
+            r.bank         = (ch >> 4) & 3;
+            results.push_back(r);
+        }
+        if (level)
+            for (int s = 0; s < N_STAGES; s++) {
+                const uint32_t v = perf(PERF_STAGE + 2 * s);
+                StageStat &t = stage[s];
+                t.sum += v;
+                t.n++;
+                t.last = v;
+                t.min  = std::min(t.min, v);
+            }
+    }
+
+    // Streams the whole signal, until there are want results
+    bool run(size_t want)
+    {
+        const size_t n = size_t(64) << o_.fft_size;
+        // SPI: ~35 bit clocks of CLK_DIV + 1 per sample, plus the pipeline
+        const uint64_t limit = cycle_ + uint64_t(want + 4) * n * 40 * (o_.clk_div + 2) + 1000000;
+        if (o_.inject) {
+            for (size_t i = 0; i < codes_.size(); i++) {
+                while (!(wb_read(ADDR_SAMPLE_IN) & 1))
+                    ;
+                wb_write(ADDR_SAMPLE_IN, codes_[i]);
+                if ((i + 1) % n == 0)
+                    drain();
+            }
+        }
+        while (results.size() < want && cycle_ < limit) {
+            for (int i = 0; i < 256; i++)
+                tick();
+            drain();
+        }
+        return results.size() >= want;
+    }
+
+    void read_perf()
+    {
+        frames_hw = perf(PERF_FRAMES);
+        drops     = perf(PERF_DROPS);
+        overruns  = perf(PERF_OVERRUNS);
+        stalls    = perf(PERF_STALLS);
+        skips     = perf(PERF_SKIPS);
+        rejects   = perf(PERF_REJECTS);
+        for (int s = 0; s < N_STAGES; s++)
+            stage[s].max = perf(PERF_STAGE + 2 * s + 1);
+    }
+
+    uint64_t cycles() const { return cycle_; }
+    uint64_t enabled() const { return enabled_; }
+    uint64_t first_done() const { return first_done_; }
+    uint64_t last_done() const { return last_done_; }
+    bool     overflow() const { return overflow_; }
+
+    std::vector<HwResult> results;
+    StageStat stage[N_STAGES];
+    uint32_t  frames_hw = 0, drops = 0, overruns = 0, stalls = 0, skips = 0, rejects = 0;
+
+private:
+    // MCP3201-style ADC on GPIO 0-2: a conversion starts on the CS_N fall
+    // and its 16-bit frame goes out MSB first, one bit per SPI clock,
+    // changing after every falling edge (where the master samples), so the
+    // 12-bit code ends up in shift_reg[11:0]. Past the end of the signal it
+    // reads 0.
+    void adc()
+    {
+        const bool cs_n = (top_->io_out >> 2) & 1;
+        const bool sclk = (top_->io_out >> 1) & 1;
+        if (cs_prev_ && !cs_n) {
+            word_ = adc_idx_ < codes_.size() ? codes_[adc_idx_] : 0;
+            adc_idx_++;
+            falls_ = 0;
+        }
+        if (!cs_n && sclk_prev_ && !sclk)
+            falls_++;
+        cs_prev_   = cs_n;
+        sclk_prev_ = sclk;
+        const bool miso = !cs_n && falls_ < 16 && ((word_ >> (15 - falls_)) & 1);
+        top_->io_in = (top_->io_in & ~1u) | (miso ? 1u : 0u);
+    }
+
+    std::unique_ptr<Vsenseedge_top> top_;
+    const Options &o_;
+    const std::vector<uint16_t> &codes_;
+
+    uint64_t cycle_ = 0, enabled_ = 0, first_done_ = 0, last_done_ = 0;
+    unsigned la_frames_ = 0;
+    bool     overflow_ = false;
+
+    size_t   adc_idx_ = 0;
+    uint16_t word_ = 0;
+    unsigned falls_ = 0;
+    bool     cs_prev_ = true, sclk_prev_ = false;
+};
+
+bool parse(int argc, char **argv, Options &o)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (a == "--inject") {
+            o.inject = true;
+            continue;
+        }
+        if (!v)
+            return false;
+        if (a == "--frames")        o.frames   = std::atol(v);
+        else if (a == "--clk-div")  o.clk_div  = unsigned(std::atol(v));
+        else if (a == "--mhz")      o.mhz      = std::atof(v);
+        else if (a == "--seed")     o.seed     = unsigned(std::atol(v));
+        else if (a == "--fft-size") o.fft_size = std::atoi(v);
+        else if (a == "--model")    o.model    = v;
+        else if (a == "--model-cfg") o.model_cfg = uint32_t(std::strtoul(v, nullptr, 0));
+        else                        return false;
+        i++;
+    }
+    return o.frames > 0 && o.mhz > 0 && o.fft_size >= 0 && o.fft_size <= SE_LOG2_NMAX - 6;
+}
+
+// Bank b's model: the base one with its last layer's outputs rotated by b
+// (rows and biases), so output n of bank b is output n + b of the base
+se_model bank_model(const se_model &m, int b)
+{
+    se_model r = m;
+    const unsigned nl = (m.nn_cfg >> 8) & 7;
+    const unsigned l  = (nl ? nl : 1) - 1;
+    const unsigned nin  = m.shape[l] & 0x3F, nout = (m.shape[l] >> 8) & 0x3F;
+    const unsigned row  = ((m.nn_cfg >> l) & 1) ? (nin + 1) >> 1 : nin;
+    const unsigned wb   = m.base[l] & 0x3FF, bb = (m.base[l] >> 16) & 0x3FF;
+    if (!nout)
+        return r;
+    for (unsigned n = 0; n < nout; n++) {
+        const unsigned src = (n + unsigned(b)) % nout;
+        for (unsigned k = 0; k < row; k++)
+            r.wt[(wb + n * row + k) % SE_WT_BYTES] = m.wt[(wb + src * row + k) % SE_WT_BYTES];
+        r.wt[(bb + n) % SE_WT_BYTES] = m.wt[(bb + src) % SE_WT_BYTES];
+    }
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options o;
+    if (!parse(argc, argv, o)) {
+        std::fprintf(stderr, "usage: %s [--frames N] [--clk-div D] [--mhz F] [--seed S] "
+                     "[--inject] [--fft-size 0-%d] [--model file.vh] [--model-cfg M]\n",
+                     argv[0], SE_LOG2_NMAX - 6);
+        return 2;
+    }
+    const int n = 64 << o.fft_size;
+
+    se_model boot;
+    if (se_model_load_vh(o.model.c_str(), &boot) < 0) {
+        std::fprintf(stderr, "ERROR: %s: no boot model image\n", o.model.c_str());
+        return 2;
+    }
+    se_model banks[SE_NN_MODELS];
+    for (int b = 0; b < SE_NN_MODELS; b++)
+        banks[b] = bank_model(boot, b);
+
+    std::vector<uint16_t> codes;
+    Signal(o.seed).frames(o.frames, n, codes);
+
+    // Golden model: the same samples, as the ring stores them
+    std::vector<int16_t> x(codes.size());
+    for (size_t i = 0; i < codes.size(); i++)
+        x[i] = int16_t(codes[i] << 4) >> 4;
+    se_config cfg = {};
+    cfg.fft_size    = o.fft_size;
+    cfg.window      = SE_WINDOW;
+    cfg.real_fft    = SE_REAL_FFT;
+    cfg.n_ch        = 1;
+    cfg.alarm_thr   = 128;      // ALARM_CFG reset value
+    cfg.fault_count = 3;
+    cfg.n_models    = SE_NN_MODELS;
+    cfg.model_cfg   = o.model_cfg & ~MODEL_CFG_EDIT_EN;
+    cfg.profile[SE_NN_MODELS - 1] = PROFILE_LAST;
+    const int n_res = se_frame_results(&cfg);
+    std::vector<se_result> gold(size_t(o.frames) * n_res);
+    if (se_run_batch(&cfg, banks, x.data(), o.frames, 0, nullptr, nullptr, nullptr,
+                     gold.data(), 1) < 0) {
+        std::fprintf(stderr, "ERROR: the boot model has a descriptor table nn_engine cannot run\n");
+        return 2;
+    }
+
+    std::printf("==========================================\n");
+    std::printf("  SenseEdge Verilator Bench\n");
+    std::printf("  %ld frames of %d samples (%s), CLK_DIV %u, %.2f MHz\n", o.frames, n,
+                o.inject ? "SAMPLE_IN" : "SPI ADC", o.clk_div, o.mhz);
+    std::printf("  WINDOW %d, REAL_FFT %d, LOG2_NMAX %d\n", SE_WINDOW, SE_REAL_FFT, SE_LOG2_NMAX);
+    std::printf("  NN_MODELS %d, MODEL_CFG 0x%05x (%d result%s per frame)\n", SE_NN_MODELS,
+                cfg.model_cfg, n_res, n_res > 1 ? "s" : "");
+    std::printf("==========================================\n");
+
+    const std::unique_ptr<VerilatedContext> ctx(new VerilatedContext);
+    ctx->commandArgs(argc, argv);
+    Bench b(ctx.get(), o, codes);
+    b.reset();
+    for (int k = 1; k < SE_NN_MODELS; k++)
+        b.load_bank(k, banks[k]);
+    b.start();
+    const bool complete = b.run(gold.size());
+    b.read_perf();
+
+    // --- Regression ---
+    long mismatches = 0, missing = 0;
+    const size_t n_hw = std::min(b.results.size(), gold.size());
+    for (size_t k = 0; k < n_hw; k++) {
+        const HwResult &h = b.results[k];
+        const se_result &g = gold[k];
+        const bool ok = h.frame == ((k / n_res + 1) & 0xFFFF) && h.bank == g.model &&
+                        h.class_id == g.class_id &&
+                        h.confidence == g.confidence && h.second_id == g.second_id &&
+                        h.top_score == g.top_score && h.second_score == g.second_score &&
+                        h.alarm == g.alarm_active && h.reused == g.skipped;
+        if (!ok && mismatches++ < 10)
+            std::printf("  MISMATCH frame %zu (hw %u): hw bank %d class %d conf %d 2nd %d "
+                        "scores %d/%d alarm %d, model bank %d class %d conf %d 2nd %d "
+                        "scores %d/%d alarm %d\n",
+                        k / n_res + 1, h.frame, h.bank, h.class_id, h.confidence, h.second_id,
+                        h.top_score, h.second_score, h.alarm, g.model, g.class_id,
+                        g.confidence, g.second_id, g.top_score, g.second_score, g.alarm_active);
+    }
+    missing = long(gold.size()) - long(n_hw);
+    long per_class[4] = {0, 0, 0, 0}, alarms = 0;
+    for (const se_result &g : gold) {
+        per_class[g.class_id & 3]++;
+        alarms += g.alarm_irq;
+    }
+
+    // --- Cycle budget ---
+    std::printf("\nStage cycles (mean / min / last of %llu reads, PERF MAX):\n",
+                (unsigned long long)b.stage[0].n);
+    for (int s = 0; s < N_STAGES; s++) {
+        const StageStat &t = b.stage[s];
+        std::printf("  %-4s %10.1f %8u %8u  (MAX %u)\n", STAGE_NAME[s],
+                    t.n ? double(t.sum) / t.n : 0.0, t.n ? t.min : 0, t.last, t.max);
+    }
+    const double f_clk = o.mhz * 1e6;
+    const uint64_t span = b.last_done() - b.first_done();
+    const double cpf = o.frames > 1 && span ? double(span) / (o.frames - 1) : 0.0;
+    const double fe_nn = std::max(b.stage[2].n ? double(b.stage[2].sum) / b.stage[2].n : 0.0,
+                                  b.stage[3].n ? double(b.stage[3].sum) / b.stage[3].n : 0.0);
+    std::printf("\nThroughput:\n");
+    std::printf("  first result   %llu cycles after enable (%.1f us)\n",
+                (unsigned long long)(b.first_done() - b.enabled()),
+                (b.first_done() - b.enabled()) / o.mhz);
+    if (cpf > 0) {
+        std::printf("  steady state   %.1f cycles/frame: %.1f frames/s, %.0f samples/s\n",
+                    cpf, f_clk / cpf, f_clk / cpf * n);
+        std::printf("  compute bound  %.1f cycles/frame (FFT+FE or NN stage): %.1f frames/s, "
+                    "%.0f%% busy\n", fe_nn, fe_nn > 0 ? f_clk / fe_nn : 0.0,
+                    100.0 * fe_nn / cpf);
+    }
+    std::printf("  simulated      %llu cycles\n", (unsigned long long)b.cycles());
+
+    std::printf("\nPERF: %u frames, %u drops, %u overruns, %u stalls, %u skips, %u rejects\n",
+                b.frames_hw, b.drops, b.overruns, b.stalls, b.skips, b.rejects);
+    std::printf("Model: class 0/1/2/3 = %ld/%ld/%ld/%ld, %ld alarms raised\n",
+                per_class[0], per_class[1], per_class[2], per_class[3], alarms);
+
+    const bool pass = complete && !mismatches && !missing && !b.drops && !b.rejects &&
+                      !b.overflow();
+    std::printf("\n==========================================\n");
+    std::printf("  %zu of %zu results checked: %ld mismatches, %ld missing%s%s%s\n", n_hw,
+                gold.size(), mismatches, missing, b.drops ? ", windows dropped" : "",
+                b.rejects ? ", samples rejected" : "",
+                b.overflow() ? ", result FIFO overflow" : "");
+    std::printf("==========================================\n");
+    std::printf(pass ? "  *** ALL TESTS PASSED ***\n" : "  *** TEST FAILED ***\n");
+    return pass ? 0 : 1;
+}
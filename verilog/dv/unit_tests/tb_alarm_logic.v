@@ -6,6 +6,11 @@
 //   3. Alarm clears when machine returns to healthy
 //   4. Low-confidence faults don't trigger alarm
 //   5. Counter resets on healthy classification
+//   6. IRQ pulse on alarm trigger
+//   7. Channels: a fault on one of three among healthy ones raises the
+//      alarm, only that channel clears it
+// Tests 1-6 run on the default (single-channel) build, test 7 on a second
+// instance built for three ADC channels.
 
 `timescale 1ns / 1ps
 
@@ -22,11 +27,15 @@ module tb_alarm_logic;
     reg        classification_done;
     reg  [1:0] class_id;
     reg  [7:0] confidence;
+    reg  [1:0] channel;
     reg  [7:0] alarm_threshold;
     reg  [3:0] fault_count_cfg;
     wire       alarm_active;
     wire       alarm_irq;
     wire [1:0] last_fault_class;
+    wire       alarm_active3;
+    wire       alarm_irq3;
+    wire [1:0] last_fault_class3;
 
     // --- DUT ---
     alarm_logic dut (
@@ -35,6 +44,7 @@ module tb_alarm_logic;
         .classification_done(classification_done),
         .class_id           (class_id),
         .confidence         (confidence),
+        .channel            (2'd0),
         .alarm_threshold    (alarm_threshold),
         .fault_count_cfg    (fault_count_cfg),
         .alarm_active       (alarm_active),
@@ -42,6 +52,21 @@ module tb_alarm_logic;
         .last_fault_class   (last_fault_class)
     );
 
+    // Three-channel build, same results tagged with channel
+    alarm_logic #(.N_CH(3)) dut3 (
+        .clk                (clk),
+        .rst                (rst),
+        .classification_done(classification_done),
+        .class_id           (class_id),
+        .confidence         (confidence),
+        .channel            (channel),
+        .alarm_threshold    (alarm_threshold),
+        .fault_count_cfg    (fault_count_cfg),
+        .alarm_active       (alarm_active3),
+        .alarm_irq          (alarm_irq3),
+        .last_fault_class   (last_fault_class3)
+    );
+
     // --- Tasks ---
     task classify;
         input [1:0] cls;
@@ -73,6 +98,7 @@ module tb_alarm_logic;
         classification_done = 0;
         class_id            = 2'd0;
         confidence          = 8'd0;
+        channel             = 2'd0;
         alarm_threshold     = 8'd100;
         fault_count_cfg     = 4'd3;  // 3 consecutive faults before alarm
 
@@ -222,6 +248,36 @@ module tb_alarm_logic;
             end
         join
 
+        // ==================================================================
+        // Test 7: Per-channel fault counts
+        // ==================================================================
+        $display("");
+        $display("[TEST 7] Channel 1 faulty, channels 0 and 2 healthy");
+        rst = 1;
+        repeat (5) @(posedge clk);
+        rst = 0;
+        repeat (5) @(posedge clk);
+        begin : ch_block
+            integer errors;
+            errors = 0;
+            for (i = 0; i < 5; i = i + 1) begin
+                channel = 2'd0; classify(2'd0, 8'd200);
+                channel = 2'd1; classify(2'd2, 8'd200);
+                channel = 2'd2; classify(2'd0, 8'd200);
+            end
+            if (!alarm_active3 || last_fault_class3 !== 2'd2) errors = errors + 1;
+            channel = 2'd1; classify(2'd0, 8'd200);
+            if (alarm_active3) errors = errors + 1;
+            channel = 2'd0;
+            if (errors == 0) begin
+                $display("  PASS: Alarm on the faulty channel, cleared by it alone");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: alarm_active = %b after the healthy channel 1 result", alarm_active3);
+                fail_count = fail_count + 1;
+            end
+        end
+
         // --- Summary ---
         $display("");
         $display("==========================================");
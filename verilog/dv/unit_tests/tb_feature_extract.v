@@ -3,7 +3,17 @@
 // Tests:
 //   1. Known magnitude spectrum → verify band energies
 //   2. Single peak → verify peak detection
-//   3. All-zero input → verify zero features
+//   3. High-band energy → verify band energies
+//   4. All-zero input → verify zero features
+//   5. 64-bin (128-point) spectrum → same features as the 32-bin equivalent
+//   6. Stream with idle gaps → same features, done one clock after last bin
+//   7. Vector ports: both banks readable as one word, previous vector kept,
+//      last_vec on the completed bank
+//   8. Time-domain features of a square wave (RMS, peak, crest, kurtosis)
+//   9. Time-domain features of an impulse: high crest factor and kurtosis
+// The DUT is built for up to 128-point spectra (LOG2_NMAX = 7). Bins are
+// streamed from mag_mem the way the FFT magnitude pass produces them, after
+// smp_n raw samples from smp_mem the way its load pass reads them.
 
 `timescale 1ns / 1ps
 
@@ -18,41 +28,83 @@ module tb_feature_extract;
 
     // --- DUT signals ---
     reg         start;
-    wire [4:0]  mag_addr;
-    reg  [15:0] mag_in;
+    reg  [1:0]  fft_size;
+    reg         bin_valid;
+    reg  [5:0]  bin_idx;
+    reg  [15:0] bin_mag;
     wire        done;
     wire [7:0]  feature_out;
-    reg  [2:0]  feature_addr;
+    reg  [3:0]  feature_addr;
+    wire        feat_bank;
+    reg         vec_bank;
+    wire [95:0] feature_vec;
+    wire [95:0] last_vec;
     wire        busy;
 
-    // --- Magnitude memory ---
-    reg [15:0] mag_mem [0:31];
+    // --- Magnitude spectrum streamed to the DUT ---
+    reg [15:0] mag_mem [0:63];
 
-    always @(*) begin
-        mag_in = mag_mem[mag_addr];
-    end
+    // --- Raw window samples ---
+    reg         smp_valid;
+    reg  [15:0] smp_data;
+    reg  [15:0] smp_mem [0:127];
+    integer     smp_n;
 
     // --- DUT ---
-    feature_extract dut (
+    feature_extract #(.LOG2_NMAX(7)) dut (
         .clk         (clk),
         .rst         (rst),
         .start       (start),
-        .mag_addr    (mag_addr),
-        .mag_in      (mag_in),
+        .fft_size    (fft_size),
+        .bin_valid   (bin_valid),
+        .bin_idx     (bin_idx),
+        .bin_mag     (bin_mag),
+        .smp_valid   (smp_valid),
+        .smp_data    (smp_data),
         .done        (done),
         .feature_out (feature_out),
-        .feature_addr(feature_addr),
+        .feature_addr({feat_bank, feature_addr}),  // Read the latest vector
+        .feat_bank   (feat_bank),
+        .vec_bank    (vec_bank),
+        .feature_vec (feature_vec),
+        .last_vec    (last_vec),
         .busy        (busy)
     );
 
     // --- Tasks ---
+    integer gap;            // Idle clocks between streamed bins
+    integer done_lat;       // Clocks from the last bin until done is seen
+
     task run_extraction;
+        integer b;
         begin
             @(posedge clk);
             start <= 1;
             @(posedge clk);
             start <= 0;
 
+            // Load pass: the raw window, one sample per clock
+            for (b = 0; b < smp_n; b = b + 1) begin
+                smp_valid <= 1;
+                smp_data  <= smp_mem[b];
+                @(posedge clk);
+            end
+            smp_valid <= 0;
+            repeat (3) @(posedge clk);      // FFT butterflies
+
+            // Stream N/2 bins in order
+            for (b = 0; b < (32 << fft_size); b = b + 1) begin
+                bin_valid <= 1;
+                bin_idx   <= b[5:0];
+                bin_mag   <= mag_mem[b];
+                @(posedge clk);
+                if (gap > 0 && b != (32 << fft_size) - 1) begin
+                    bin_valid <= 0;
+                    repeat (gap) @(posedge clk);
+                end
+            end
+            bin_valid <= 0;
+
             begin : wait_extract_done
                 integer wait_cnt;
                 wait_cnt = 0;
@@ -62,6 +114,7 @@ module tb_feature_extract;
                 end
                 if (wait_cnt >= 10000)
                     $display("  TIMEOUT: Feature extraction did not complete");
+                done_lat = wait_cnt;
             end
 
             repeat (5) @(posedge clk);
@@ -71,8 +124,8 @@ module tb_feature_extract;
     task display_features;
         integer f;
         begin
-            for (f = 0; f < 8; f = f + 1) begin
-                feature_addr = f[2:0];
+            for (f = 0; f < 12; f = f + 1) begin
+                feature_addr = f[3:0];
                 repeat (2) @(posedge clk);
                 case (f)
                     0: $display("    [0] Band Low     = %3d", feature_out);
@@ -83,13 +136,17 @@ module tb_feature_extract;
                     5: $display("    [5] Peak Mag     = %3d", feature_out);
                     6: $display("    [6] Spect Cent   = %3d", feature_out);
                     7: $display("    [7] Total Energy = %3d", feature_out);
+                    8: $display("    [8] RMS          = %3d", feature_out);
+                    9: $display("    [9] Peak         = %3d", feature_out);
+                    10: $display("    [10] Crest       = %3d", feature_out);
+                    11: $display("    [11] Kurtosis    = %3d", feature_out);
                 endcase
             end
         end
     endtask
 
     task read_feature;
-        input [2:0] addr;
+        input [3:0] addr;
         output [7:0] val;
         begin
             feature_addr = addr;
@@ -113,7 +170,16 @@ module tb_feature_extract;
 
         rst   = 1;
         start = 0;
+        fft_size = 2'd0;
         feature_addr = 0;
+        vec_bank = 0;
+        bin_valid = 0;
+        bin_idx   = 0;
+        bin_mag   = 0;
+        gap       = 0;
+        smp_valid = 0;
+        smp_data  = 0;
+        smp_n     = 0;
 
         repeat (10) @(posedge clk);
         rst = 0;
@@ -167,14 +233,14 @@ module tb_feature_extract;
         run_extraction;
         display_features;
 
-        // Peak frequency should point to bin 15 (or nearby due to pipeline latency)
+        // Peak frequency should point to bin 15
         // Feature[4] = peak_bin * 8
         read_feature(3'd4, feat_val);
-        if (feat_val >= 8'd112 && feat_val <= 8'd120) begin
+        if (feat_val == 8'd120) begin
             $display("  PASS: Peak frequency index = %0d (bin %0d)", feat_val, feat_val / 8);
             pass_count = pass_count + 1;
         end else begin
-            $display("  FAIL: Expected peak index 112-120, got %0d", feat_val);
+            $display("  FAIL: Expected peak index 120, got %0d", feat_val);
             fail_count = fail_count + 1;
         end
 
@@ -246,6 +312,190 @@ module tb_feature_extract;
             end
         end
 
+        // ==================================================================
+        // Test 5: Length-independent features
+        // A tone in 64-point bin 8 shows up in 128-point bin 16 with twice
+        // the magnitude; both spectra must give the same feature vector.
+        // ==================================================================
+        $display("");
+        $display("[TEST 5] 128-point spectrum matches 64-point features");
+        begin : size_check
+            reg [7:0] ref_feat [0:7];
+            reg       all_match;
+            for (i = 0; i < 64; i = i + 1)
+                mag_mem[i] = 16'd0;
+            mag_mem[8] = 16'd10000;
+            run_extraction;
+            for (i = 0; i < 8; i = i + 1)
+                read_feature(i[2:0], ref_feat[i]);
+
+            mag_mem[8]  = 16'd0;
+            mag_mem[16] = 16'd20000;
+            fft_size = 2'd1;
+            run_extraction;
+            display_features;
+            all_match = 1;
+            for (i = 0; i < 8; i = i + 1) begin
+                read_feature(i[2:0], feat_val);
+                if (feat_val != ref_feat[i]) begin
+                    $display("    feature[%0d] = %0d, 64-point = %0d", i, feat_val, ref_feat[i]);
+                    all_match = 0;
+                end
+            end
+            fft_size = 2'd0;
+            if (all_match) begin
+                $display("  PASS: Features independent of FFT length");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Features differ between 64- and 128-point spectra");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 6: Streaming timing
+        // Bins arriving with idle clocks in between (the SRAM magnitude
+        // pass, or a slower producer) give the same features, and the
+        // vector is ready the clock after the last bin.
+        // ==================================================================
+        $display("");
+        $display("[TEST 6] Streamed bins with gaps, done latency");
+        begin : stream_check
+            reg [7:0] ref_feat [0:7];
+            reg       all_match;
+            for (i = 0; i < 32; i = i + 1)
+                mag_mem[i] = (i * 613) % 9000;
+            run_extraction;
+            for (i = 0; i < 8; i = i + 1)
+                read_feature(i[2:0], ref_feat[i]);
+            $display("  Back-to-back: done %0d clock(s) after the last bin", done_lat);
+            all_match = (done_lat == 1);
+
+            gap = 2;
+            run_extraction;
+            gap = 0;
+            $display("  With gaps:    done %0d clock(s) after the last bin", done_lat);
+            if (done_lat != 1) all_match = 0;
+            for (i = 0; i < 8; i = i + 1) begin
+                read_feature(i[2:0], feat_val);
+                if (feat_val != ref_feat[i]) begin
+                    $display("    feature[%0d] = %0d, back-to-back = %0d", i, feat_val, ref_feat[i]);
+                    all_match = 0;
+                end
+            end
+            if (all_match) begin
+                $display("  PASS: Streaming features ready one clock after the last bin");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Streaming timing or features mismatch");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 7: Vector port
+        // The whole vector of either bank reads at once; a new frame goes
+        // into the other bank and leaves the previous vector in place.
+        // ==================================================================
+        $display("");
+        $display("[TEST 7] Feature vector port (both banks)");
+        begin : vec_check
+            reg [95:0] prev_vec;
+            reg        all_match;
+            all_match = 1;
+            vec_bank  = feat_bank;
+            #1;
+            prev_vec  = feature_vec;
+            for (i = 0; i < 32; i = i + 1)
+                mag_mem[i] = (i == 20) ? 16'd30000 : 16'd10;
+            run_extraction;
+            for (i = 0; i < 12; i = i + 1) begin
+                read_feature(i[3:0], feat_val);
+                vec_bank = feat_bank;
+                #1;
+                if (feature_vec[8*i +: 8] !== feat_val) begin
+                    $display("    vec[%0d] = %0d, feature_out = %0d", i, feature_vec[8*i +: 8], feat_val);
+                    all_match = 0;
+                end
+            end
+            if (last_vec !== feature_vec) begin
+                $display("    last_vec 0x%024h, bank %0d 0x%024h", last_vec, feat_bank, feature_vec);
+                all_match = 0;
+            end
+            vec_bank = ~feat_bank;
+            #1;
+            if (feature_vec !== prev_vec) begin
+                $display("    previous bank 0x%024h, was 0x%024h", feature_vec, prev_vec);
+                all_match = 0;
+            end
+            if (all_match) begin
+                $display("  PASS: Vector port matches, previous vector kept");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Vector port mismatch");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 8: Time-domain features of a square wave
+        // ==================================================================
+        // x = +/-1000: RMS 1000 (>> 3 = 125), peak 125, crest 16 * 1 = 16,
+        // kurtosis 16 * 1 = 16
+        $display("");
+        $display("[TEST 8] Time-domain features, square wave +/-1000");
+        for (i = 0; i < 64; i = i + 1)
+            smp_mem[i] = i[2] ? 16'd1000 : -16'sd1000;
+        smp_n = 64;
+        run_extraction;
+        begin : time_sq
+            reg [7:0] f_rms, f_peak, f_crest, f_kurt;
+            read_feature(4'd8,  f_rms);
+            read_feature(4'd9,  f_peak);
+            read_feature(4'd10, f_crest);
+            read_feature(4'd11, f_kurt);
+            read_feature(4'd12, feat_val);
+            $display("    RMS %0d, peak %0d, crest %0d, kurtosis %0d", f_rms, f_peak,
+                     f_crest, f_kurt);
+            if (f_rms == 8'd125 && f_peak == 8'd125 && f_crest == 8'd16 &&
+                f_kurt == 8'd16 && feat_val == 8'd0) begin
+                $display("  PASS: Square wave statistics");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected 125 / 125 / 16 / 16, feature 12 = 0");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 9: Time-domain features of an impulse
+        // ==================================================================
+        // One 2000 sample in 63 zeros: mean 31, RMS isqrt(62500 - 961) = 248
+        // (31), peak 250, crest 16 * 2000 / 248 = 129, kurtosis saturates
+        $display("");
+        $display("[TEST 9] Time-domain features, single impulse");
+        for (i = 0; i < 64; i = i + 1)
+            smp_mem[i] = (i == 17) ? 16'd2000 : 16'd0;
+        run_extraction;
+        begin : time_imp
+            reg [7:0] f_rms, f_peak, f_crest, f_kurt;
+            read_feature(4'd8,  f_rms);
+            read_feature(4'd9,  f_peak);
+            read_feature(4'd10, f_crest);
+            read_feature(4'd11, f_kurt);
+            $display("    RMS %0d, peak %0d, crest %0d, kurtosis %0d", f_rms, f_peak,
+                     f_crest, f_kurt);
+            if (f_rms == 8'd31 && f_peak == 8'd250 && f_crest == 8'd129 &&
+                f_kurt == 8'd255) begin
+                $display("  PASS: Impulse statistics");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected 31 / 250 / 129 / 255");
+                fail_count = fail_count + 1;
+            end
+        end
+        smp_n = 0;
+
         // --- Summary ---
         $display("");
         $display("==========================================");
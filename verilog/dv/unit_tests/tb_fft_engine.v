@@ -1,13 +1,52 @@
 // SPDX-License-Identifier: Apache-2.0
-// Testbench: 64-Point FFT Engine
+// Testbench: 64/128/256-Point FFT Engine
+// The DUT is built for up to 256 points (LOG2_NMAX = 8); tests 1-6 run at
+// the default 64-point length.
 // Tests:
 //   1. DC input → energy concentrated in bin 0
 //   2. Single-tone at bin 8 → peak at bin 8
 //   3. Impulse → flat spectrum
 //   4. All-zero input → all-zero output
+//   5. Single-tone at bin 4 → peak at bin 4
+//   6. Datapath cycle count + bit-exact spectrum checksum
+//   7. 128- and 256-point tone at Fs/8 → peak at bin N/8, cycle count
+//   8. Off-bin tone (bin 8.5) → leakage far from the peak (-DWINDOW=1/2)
+// Test 1 also checks load_valid: every raw sample of the frame marked once.
+//
+// Build with -DFFT_ARCH=<n> to test another datapath. Cycles from start to
+// done (load 64 + 1 + butterflies + magnitude 32 + 2):
+//   FFT_ARCH 0  2 clk / butterfly      192 x 2 = 384  ->  483 cycles
+//   FFT_ARCH 1  1 clk / butterfly      192 x 1 = 192  ->  291 cycles
+//   FFT_ARCH 2  2 butterflies / clk     96 x 1 =  96  ->  195 cycles
+//   FFT_ARCH 3  radix-2^2, 3 passes     48 x 1 =  48  ->  147 cycles
+// At 25 MHz that is 19.3 / 11.6 / 7.8 / 5.9 us per frame.
+// With -DREAL_FFT=1 (32-point complex FFT + split, 80 butterflies):
+//   FFT_ARCH 0 / 1 / 2 / 3  ->  259 / 179 / 139 / 123 cycles
+// With -DUSE_SRAM=1 (SRAM working storage, always the FFT_ARCH 0 datapath)
+// the magnitude pass takes one more clock: FFT_ARCH 0 + 1.
+// -DWINDOW=1 (Hann) or 2 (Hamming) windows the load pass at no cycle cost.
+//
+// Cycle budget per length (FFT_ARCH 0 / 1 / 2 / 3):
+//   N    complex                      REAL_FFT
+//   64    483 /  291 / 195 / 147       259 / 179 / 139 / 123
+//   128  1091 /  643 / 419 / 323       579 / 387 / 291 / 243
+//   256  2435 / 1411 / 899 / 643      1283 / 835 / 611 / 515
 
 `timescale 1ns / 1ps
 
+`ifndef FFT_ARCH
+`define FFT_ARCH 0
+`endif
+`ifndef REAL_FFT
+`define REAL_FFT 0
+`endif
+`ifndef USE_SRAM
+`define USE_SRAM 0
+`endif
+`ifndef WINDOW
+`define WINDOW 0
+`endif
+
 module tb_fft_engine;
 
     // --- Clock and Reset ---
@@ -19,35 +58,106 @@ module tb_fft_engine;
 
     // --- DUT signals ---
     reg         start;
-    wire [5:0]  sample_addr;
+    reg  [1:0]  fft_size;
+    wire [7:0]  sample_addr;
     reg  [15:0] sample_in;
     wire        done;
     wire [15:0] mag_out;
-    reg  [4:0]  mag_addr;
+    reg  [6:0]  mag_addr;
+    wire        mag_bank;
+    wire [1:0]  mag_size;
     wire        busy;
+    wire        load_valid;
 
     // --- Sample memory (external to DUT) ---
-    reg signed [15:0] sample_mem [0:63];
+    reg signed [15:0] sample_mem [0:255];
 
-    // Connect sample memory to DUT
-    always @(*) begin
-        sample_in = sample_mem[sample_addr];
+    // Connect sample memory to DUT (synchronous read, like the sample ring)
+    always @(posedge clk) begin
+        sample_in <= sample_mem[sample_addr];
     end
 
     // --- DUT ---
-    fft_engine dut (
+    fft_engine #(
+        .FFT_ARCH   (`FFT_ARCH),
+        .REAL_FFT   (`REAL_FFT),
+        .LOG2_NMAX  (8),
+        .USE_SRAM   (`USE_SRAM),
+        .WINDOW     (`WINDOW)
+    ) dut (
         .clk        (clk),
         .rst        (rst),
         .start      (start),
+        .fft_size   (fft_size),
         .sample_in  (sample_in),
         .sample_addr(sample_addr),
         .done       (done),
         .mag_out    (mag_out),
-        .mag_addr   (mag_addr),
-        .busy       (busy)
+        .mag_addr   ({mag_bank, mag_addr}),  // Read the latest spectrum
+        .mag_bank   (mag_bank),
+        .mag_size   (mag_size),
+        .busy       (busy),
+        .load_valid (load_valid)
     );
 
+    // Raw samples marked by load_valid during the last run
+    integer ld_n;
+    integer ld_sum;
+
+    always @(posedge clk) begin
+        if (start) begin
+            ld_n   <= 0;
+            ld_sum <= 0;
+        end else if (load_valid) begin
+            ld_n   <= ld_n + 1;
+            ld_sum <= ld_sum + $signed(sample_in);
+        end
+    end
+
     // --- Tasks ---
+    integer fft_cycles;     // Clocks from start to done of the last run
+    integer n_bins;         // Bins in the current spectrum (N/2)
+
+    // Expected start-to-done cycles (see table above)
+    function integer cycle_budget;
+        input integer arch;
+        input integer real_fft;
+        input integer size;
+        integer a;
+        begin
+            a = `USE_SRAM ? 0 : arch;   // USE_SRAM builds FFT_ARCH 0
+            case ({real_fft[0], size[1:0], a[1:0]})
+                5'b0_00_00: cycle_budget = 483;
+                5'b0_00_01: cycle_budget = 291;
+                5'b0_00_10: cycle_budget = 195;
+                5'b0_00_11: cycle_budget = 147;
+                5'b0_01_00: cycle_budget = 1091;
+                5'b0_01_01: cycle_budget = 643;
+                5'b0_01_10: cycle_budget = 419;
+                5'b0_01_11: cycle_budget = 323;
+                5'b0_10_00: cycle_budget = 2435;
+                5'b0_10_01: cycle_budget = 1411;
+                5'b0_10_10: cycle_budget = 899;
+                5'b0_10_11: cycle_budget = 643;
+                5'b1_00_00: cycle_budget = 259;
+                5'b1_00_01: cycle_budget = 179;
+                5'b1_00_10: cycle_budget = 139;
+                5'b1_00_11: cycle_budget = 123;
+                5'b1_01_00: cycle_budget = 579;
+                5'b1_01_01: cycle_budget = 387;
+                5'b1_01_10: cycle_budget = 291;
+                5'b1_01_11: cycle_budget = 243;
+                5'b1_10_00: cycle_budget = 1283;
+                5'b1_10_01: cycle_budget = 835;
+                5'b1_10_10: cycle_budget = 611;
+                5'b1_10_11: cycle_budget = 515;
+                default:    cycle_budget = 0;
+            endcase
+            if (`USE_SRAM)
+                cycle_budget = cycle_budget + 1;
+        end
+    endfunction
+
     task run_fft;
         begin
             @(posedge clk);
@@ -65,6 +175,7 @@ module tb_fft_engine;
                 end
                 if (wait_cnt >= 100000)
                     $display("  TIMEOUT: FFT did not complete");
+                fft_cycles = wait_cnt;
             end
 
             repeat (5) @(posedge clk);
@@ -84,20 +195,20 @@ module tb_fft_engine;
 
     // Find peak bin
     task find_peak;
-        output [4:0] peak_bin;
+        output [6:0] peak_bin;
         output [15:0] peak_val;
         integer m;
         reg [15:0] max_val;
-        reg [4:0]  max_bin;
+        reg [6:0]  max_bin;
         begin
             max_val = 0;
             max_bin = 0;
-            for (m = 0; m < 32; m = m + 1) begin
-                mag_addr = m[4:0];
+            for (m = 0; m < n_bins; m = m + 1) begin
+                mag_addr = m[6:0];
                 repeat (2) @(posedge clk);
                 if (mag_out > max_val) begin
                     max_val = mag_out;
-                    max_bin = m[4:0];
+                    max_bin = m[6:0];
                 end
             end
             peak_bin = max_bin;
@@ -109,7 +220,7 @@ module tb_fft_engine;
     integer pass_count;
     integer fail_count;
     integer i;
-    reg [4:0]  peak_bin;
+    reg [6:0]  peak_bin;
     reg [15:0] peak_val;
 
     // Sine lookup for generating test tones (Q15 format scaled down)
@@ -125,6 +236,8 @@ module tb_fft_engine;
 
         rst   = 1;
         start = 0;
+        fft_size = 2'd0;
+        n_bins   = 32;
         mag_addr = 0;
 
         repeat (10) @(posedge clk);
@@ -152,14 +265,23 @@ module tb_fft_engine;
             fail_count = fail_count + 1;
         end
 
-        // Check bin 0 >> other bins
+        if (ld_n == 64 && ld_sum == 64000) begin
+            $display("  PASS: load_valid marks the 64 raw samples once");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: load_valid marked %0d samples, sum %0d", ld_n, ld_sum);
+            fail_count = fail_count + 1;
+        end
+
+        // Check bin 0 >> other bins (outside the window main lobe: a
+        // Hann / Hamming window spreads DC into bin 1)
         begin : dc_check
             reg [15:0] bin0_val, other_max;
             mag_addr = 5'd0;
             repeat (2) @(posedge clk);
             bin0_val = mag_out;
             other_max = 0;
-            for (i = 1; i < 32; i = i + 1) begin
+            for (i = (`WINDOW == 0) ? 1 : 2; i < 32; i = i + 1) begin
                 mag_addr = i[4:0];
                 repeat (2) @(posedge clk);
                 if (mag_out > other_max) other_max = mag_out;
@@ -210,12 +332,13 @@ module tb_fft_engine;
         // ==================================================================
         // Test 3: Impulse (sample[0] = 1000, rest = 0)
         // Expected: Flat spectrum (all bins equal)
+        // Windowed builds place it mid-frame, where the window is 1.0
         // ==================================================================
         $display("");
         $display("[TEST 3] Impulse Response");
         for (i = 0; i < 64; i = i + 1)
             sample_mem[i] = 16'd0;
-        sample_mem[0] = 16'd1000;
+        sample_mem[(`WINDOW == 0) ? 0 : 32] = 16'd1000;
 
         run_fft;
         $display("  Magnitudes (should be roughly equal):");
@@ -304,6 +427,138 @@ module tb_fft_engine;
             fail_count = fail_count + 1;
         end
 
+        // ==================================================================
+        // Test 6: Cycle count and bit-exact spectrum
+        // Every FFT_ARCH must produce the same magnitudes; the checksum
+        // sum((bin+1) * |X[bin]|) comes from the 2-clk reference datapath.
+        // The real-input path rounds differently and has its own checksum,
+        // and each window has its own pair.
+        // ==================================================================
+        $display("");
+        $display("[TEST 6] FFT_ARCH=%0d REAL_FFT=%0d USE_SRAM=%0d WINDOW=%0d Cycle Count / Bit-Exact Spectrum",
+                 `FFT_ARCH, `REAL_FFT, `USE_SRAM, `WINDOW);
+        for (i = 0; i < 64; i = i + 1)
+            sample_mem[i] = ((i * i * 37 + i * 101) % 4096) - 2048;
+
+        run_fft;
+        begin : arch_check
+            integer expected_cycles;
+            integer checksum;
+            integer expected_checksum;
+            expected_cycles = cycle_budget(`FFT_ARCH, `REAL_FFT, 0);
+            case (`WINDOW)
+                1:       expected_checksum = `REAL_FFT ? 3383114 : 3382809;  // Hann
+                2:       expected_checksum = `REAL_FFT ? 3473020 : 3473200;  // Hamming
+                default: expected_checksum = `REAL_FFT ? 4961242 : 4961521;
+            endcase
+            $display("  Cycles: %0d (expected %0d, %.1f us at 25 MHz)",
+                     fft_cycles, expected_cycles, fft_cycles * 0.04);
+            if (fft_cycles == expected_cycles) begin
+                $display("  PASS: Cycle count matches datapath");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Cycle count mismatch");
+                fail_count = fail_count + 1;
+            end
+
+            checksum = 0;
+            for (i = 0; i < 32; i = i + 1) begin
+                mag_addr = i[4:0];
+                repeat (2) @(posedge clk);
+                checksum = checksum + (i + 1) * mag_out;
+            end
+            $display("  Checksum: %0d (expected %0d)", checksum, expected_checksum);
+            if (checksum == expected_checksum) begin
+                $display("  PASS: Spectrum bit-exact with reference datapath");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Spectrum differs from reference datapath");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 7: 128- and 256-point transforms
+        // A tone at Fs/8 lands in bin N/8; the frame must take the
+        // documented cycle budget for its length.
+        // ==================================================================
+        begin : size_check
+            integer sz;
+            integer n_pts;
+            for (sz = 1; sz <= 2; sz = sz + 1) begin
+                n_pts = 64 << sz;
+                $display("");
+                $display("[TEST 7] %0d-Point Tone at Bin %0d", n_pts, n_pts / 8);
+                for (i = 0; i < n_pts; i = i + 1) begin
+                    case (i % 8)
+                        0: sample_mem[i] =  16'sd0;
+                        1: sample_mem[i] =  16'sd1414;
+                        2: sample_mem[i] =  16'sd2000;
+                        3: sample_mem[i] =  16'sd1414;
+                        4: sample_mem[i] =  16'sd0;
+                        5: sample_mem[i] = -16'sd1414;
+                        6: sample_mem[i] = -16'sd2000;
+                        7: sample_mem[i] = -16'sd1414;
+                    endcase
+                end
+
+                fft_size = sz[1:0];
+                n_bins   = n_pts / 2;
+                run_fft;
+                find_peak(peak_bin, peak_val);
+                $display("  Peak: bin=%0d, magnitude=%0d, cycles=%0d (expected %0d)",
+                         peak_bin, peak_val, fft_cycles,
+                         cycle_budget(`FFT_ARCH, `REAL_FFT, sz));
+
+                if (peak_bin == n_pts / 8 && mag_size == sz[1:0] &&
+                    fft_cycles == cycle_budget(`FFT_ARCH, `REAL_FFT, sz)) begin
+                    $display("  PASS: %0d-point tone at bin %0d", n_pts, n_pts / 8);
+                    pass_count = pass_count + 1;
+                end else begin
+                    $display("  FAIL: Expected peak at bin %0d in %0d cycles",
+                             n_pts / 8, cycle_budget(`FFT_ARCH, `REAL_FFT, sz));
+                    fail_count = fail_count + 1;
+                end
+            end
+            fft_size = 2'd0;
+            n_bins   = 32;
+        end
+
+        // ==================================================================
+        // Test 8: Spectral leakage of an off-bin tone
+        // A tone at bin 8.5 smears across the whole rectangular-window
+        // spectrum (far bins ~1/7 of the peak); Hann / Hamming keep every
+        // bin more than 4 bins from the tone below 1/32 of the peak.
+        // ==================================================================
+        $display("");
+        $display("[TEST 8] Off-Bin Tone Leakage (WINDOW=%0d)", `WINDOW);
+        if (`WINDOW == 0) begin
+            $display("  SKIP: rectangular window (build with -DWINDOW=1 or 2)");
+        end else begin : leak_check
+            reg [15:0] far_max;
+            for (i = 0; i < 64; i = i + 1)
+                sample_mem[i] = $rtoi(2000.0 * $sin(2.0 * 3.14159265358979 * 8.5 * i / 64.0));
+
+            run_fft;
+            find_peak(peak_bin, peak_val);
+            far_max = 0;
+            for (i = 0; i < 32; i = i + 1) begin
+                mag_addr = i[4:0];
+                repeat (2) @(posedge clk);
+                if ((i < 5 || i > 12) && mag_out > far_max)
+                    far_max = mag_out;
+            end
+            $display("  Peak: bin=%0d, magnitude=%0d, max leakage=%0d",
+                     peak_bin, peak_val, far_max);
+            if ((peak_bin == 8 || peak_bin == 9) && far_max * 32 < peak_val) begin
+                $display("  PASS: Leakage suppressed by the window");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Leakage above 1/32 of the peak");
+                fail_count = fail_count + 1;
+            end
+        end
+
         // --- Summary ---
         $display("");
         $display("==========================================");
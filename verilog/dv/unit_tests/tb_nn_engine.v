@@ -5,9 +5,34 @@
 //   2. Inference with known weights → verify classification
 //   3. Different input patterns → verify different classes
 //   4. Weight update and re-inference
+//   7. Random weights and features → bit-exact with a reference model,
+//      cycle count 14 + 192 / LANES, top-2 class scores
+//   8. INT4 packed weights in layer 1, layer 2 and both → bit-exact with
+//      the reference, one MAC step per two weights
+//   9. 3-layer network from the descriptor table, unaligned rows,
+//      requantise shifts, loaded with 32-bit writes → bit-exact with the
+//      reference
+//  10. Hot swap: bank 1 is loaded with another model during a bank-0
+//      inference, which is unaffected; both banks then run bit-exact
+//  11. Boot ROM: after reset bank 0 holds nn_default_model.vh, copied in
+//      NN_ROM_WORDS clocks (plus one per weight write), and runs bit-exact
+//  12. Resident models: a different model in every bank, inferences
+//      switching bank each run with nothing reloaded → bit-exact
+//  13. Out-of-range descriptors (0 / > 32 inputs or outputs, 0 or > 4
+//      layers, a single-output last layer) → done arrives, bit-exact with
+//      the clamped reference
+// Build with -DNN_LANES=<n> to test another MAC lane count and with
+// -DNN_BANKS=4 for four resident models.
 
 `timescale 1ns / 1ps
 
+`ifndef NN_LANES
+`define NN_LANES 1
+`endif
+`ifndef NN_BANKS
+`define NN_BANKS 2
+`endif
+
 module tb_nn_engine;
 
     // --- Clock and Reset ---
@@ -19,25 +44,37 @@ module tb_nn_engine;
 
     // --- DUT signals ---
     reg         start;
-    wire [2:0]  feature_addr;
+    wire [4:0]  feature_addr;
     reg  [7:0]  feature_in;
     wire        done;
     wire [1:0]  class_id;
     wire [7:0]  confidence;
+    wire [15:0] top_score;
+    wire [1:0]  second_id;
+    wire [15:0] second_score;
     wire        busy;
+    reg  [1:0]  bank;
+    reg  [3*`NN_BANKS-1:0]   n_layers;
+    reg  [256*`NN_BANKS-1:0] desc;
+    reg  [4*`NN_BANKS-1:0]   wt_int4;
     reg         wt_wr_en;
-    reg  [7:0]  wt_wr_addr;
-    reg  [7:0]  wt_wr_data;
+    reg  [1:0]  wt_wr_bank;
+    reg  [9:0]  wt_wr_addr;
+    reg  [3:0]  wt_wr_sel;
+    reg  [31:0] wt_wr_data;
 
     // --- Feature memory ---
-    reg [7:0] feature_mem [0:7];
+    reg [7:0] feature_mem [0:31];
 
     always @(*) begin
         feature_in = feature_mem[feature_addr];
     end
 
     // --- DUT ---
-    nn_engine dut (
+    nn_engine #(
+        .LANES       (`NN_LANES),
+        .N_BANKS     (`NN_BANKS)
+    ) dut (
         .clk         (clk),
         .rst         (rst),
         .start       (start),
@@ -46,26 +83,96 @@ module tb_nn_engine;
         .done        (done),
         .class_id    (class_id),
         .confidence  (confidence),
+        .top_score   (top_score),
+        .second_id   (second_id),
+        .second_score(second_score),
         .busy        (busy),
+        .bank        (bank),
+        .n_layers    (n_layers),
+        .desc        (desc),
+        .wt_int4     (wt_int4),
         .wt_wr_en    (wt_wr_en),
+        .wt_wr_bank  (wt_wr_bank),
         .wt_wr_addr  (wt_wr_addr),
+        .wt_wr_sel   (wt_wr_sel),
         .wt_wr_data  (wt_wr_data)
     );
 
     // --- Tasks ---
+    `include "nn_default_model.vh"
+
+    reg [7:0] wt_shadow [0:512*`NN_BANKS-1];    // Copy of every weight written, bank b at 512 * b
+    reg [1:0] wr_bank;              // Bank written by write_weight / write_word
+    integer   nn_cycles;            // Clocks from start to done of the last run
+
+    // Layer descriptor: inputs, outputs, ReLU, shift, weight base, bias base
+    function [63:0] layer_desc;
+        input [5:0] n_in;
+        input [5:0] n_out;
+        input       relu;
+        input [3:0] shift;
+        input [9:0] wbase;
+        input [9:0] bbase;
+        layer_desc = {6'd0, bbase, 6'd0, wbase,
+                      8'd0, shift, 3'd0, relu, 2'd0, n_out, 2'd0, n_in};
+    endfunction
+
+    // Default table: 8 → 16 (ReLU) → 4, as wb_interface resets it
+    localparam [255:0] DEFAULT_DESC = {128'd0,
+                                       6'd0, 10'd208, 6'd0, 10'd144, 32'h0000_0410,
+                                       6'd0, 10'd128, 6'd0, 10'd0,   32'h0001_1008};
+
+    // One byte: a 32-bit write with a single byte lane selected
     task write_weight;
-        input [7:0] addr;
+        input [9:0] addr;
         input [7:0] data;
         begin
+            wt_shadow[512*wr_bank + addr[8:0]] = data;
             @(posedge clk);
             wt_wr_en   <= 1'b1;
-            wt_wr_addr <= addr;
+            wt_wr_bank <= wr_bank;
+            wt_wr_addr <= addr & 10'h3FC;
+            wt_wr_sel  <= 4'b0001 << addr[1:0];
+            wt_wr_data <= {4{data}};
+            @(posedge clk);
+            wt_wr_en   <= 1'b0;
+        end
+    endtask
+
+    // Four bytes at the word address addr, byte k at addr + k
+    task write_word;
+        input [9:0]  addr;
+        input [31:0] data;
+        integer k;
+        begin
+            for (k = 0; k < 4; k = k + 1)
+                wt_shadow[512*wr_bank + {addr[8:2], 2'd0} + k] = data[8*k +: 8];
+            @(posedge clk);
+            wt_wr_en   <= 1'b1;
+            wt_wr_bank <= wr_bank;
+            wt_wr_addr <= addr & 10'h3FC;
+            wt_wr_sel  <= 4'b1111;
             wt_wr_data <= data;
             @(posedge clk);
             wt_wr_en   <= 1'b0;
         end
     endtask
 
+    // Wait for the boot copy after reset; bank 0 then holds the ROM image
+    integer boot_cycles;
+
+    task boot_wait;
+        integer k;
+        time    t0;
+        begin
+            t0 = $time;
+            wait (busy === 1'b0);
+            boot_cycles = ($time - t0) / 40;
+            for (k = 0; k < 4 * NN_ROM_WORDS; k = k + 1)
+                wt_shadow[k] = nn_rom_word(k / 4) >> (8 * (k % 4));
+        end
+    endtask
+
     task run_inference;
         begin
             @(posedge clk);
@@ -82,12 +189,129 @@ module tb_nn_engine;
                 end
                 if (wait_cnt >= 100000)
                     $display("  TIMEOUT: Inference did not complete");
+                nn_cycles = wait_cnt;
             end
 
             repeat (5) @(posedge clk);
         end
     endtask
 
+    // --- Reference model ---
+    // Walks bank's desc / n_layers / wt_int4 over wt_shadow and feature_mem
+    // like the engine: 24-bit wrapping sums, bias, arithmetic shift, 16-bit
+    // saturation, optional ReLU, argmax of the last layer's first four
+    // outputs and the runner-up, with out-of-range counts clamped as the
+    // engine clamps them (inputs / outputs to 1..32, layers to 1..4). Cycles: 2 + layer-0 inputs, plus per layer 2 + the number of
+    // memory words its rows touch (a row is split at LANES-byte words).
+    reg [1:0] ref_class;
+    reg [7:0] ref_conf;
+    reg [1:0] ref_class2;
+    reg signed [15:0] ref_top;
+    reg signed [15:0] ref_second;
+    integer   ref_cycles;
+
+    function integer clamp_n;
+        input integer v;
+        input integer hi;
+        clamp_n = (v < 1) ? 1 : (v > hi) ? hi : v;
+    endfunction
+
+    task ref_infer;
+        integer ly, nl, n, k, nin, nout, relu, sh, wb, bb, rb, int4, p, e, nb;
+        reg signed [15:0] x [0:63];     // Ping-pong activations, 32 each
+        reg signed [23:0] s24;
+        reg signed [15:0] y, best, best2;
+        reg signed [7:0]  w8;
+        reg signed [3:0]  w4;
+        reg [7:0]         wbyte;
+        reg [255:0]       bd;
+        reg [3:0]         b4;
+        begin
+            bd = desc[256*bank +: 256];
+            nl = clamp_n(n_layers[3*bank +: 3], 4);
+            b4 = wt_int4[4*bank +: 4];
+            for (k = 0; k < 32; k = k + 1)
+                x[k] = feature_mem[k];
+            ref_cycles = 2 + clamp_n(bd[5:0], 32);
+            best = 0;
+            best2 = 0;
+            ref_class = 0;
+            ref_class2 = 0;
+            for (ly = 0; ly < nl; ly = ly + 1) begin
+                nin  = clamp_n(bd[64*ly +: 6], 32);
+                nout = clamp_n(bd[64*ly + 8 +: 6], 32);
+                relu = bd[64*ly + 16];
+                sh   = bd[64*ly + 20 +: 4];
+                wb   = bd[64*ly + 32 +: 10] + 512 * bank;
+                bb   = bd[64*ly + 48 +: 10] + 512 * bank;
+                int4 = b4[ly];
+                rb   = int4 ? (nin + 1) / 2 : nin;
+                ref_cycles = ref_cycles + 2;
+                for (n = 0; n < nout; n = n + 1) begin
+                    s24 = 0;
+                    for (k = 0; k < nin; k = k + 1) begin
+                        if (int4) begin
+                            wbyte = wt_shadow[wb + n*rb + k/2];
+                            w4    = k[0] ? wbyte[7:4] : wbyte[3:0];
+                            s24   = s24 + x[32*(ly%2) + k] * w4;
+                        end else begin
+                            w8    = wt_shadow[wb + n*rb + k];
+                            s24   = s24 + x[32*(ly%2) + k] * w8;
+                        end
+                    end
+                    s24 = s24 + $signed(wt_shadow[bb + n]);
+                    s24 = s24 >>> sh;
+                    y   = (s24 > 32767) ? 16'sd32767 : (s24 < -32768) ? -16'sd32768 : s24[15:0];
+                    if (relu && y < 0) y = 0;
+                    x[32*((ly+1)%2) + n] = y;
+                    if (ly == nl - 1 && n < 4) begin
+                        if (n == 0 || y > best) begin
+                            best2      = best;
+                            ref_class2 = ref_class;
+                            best       = y;
+                            ref_class  = n;
+                        end else if (n == 1 || y > best2) begin
+                            best2      = y;
+                            ref_class2 = n;
+                        end
+                    end
+                    // MAC steps: one per LANES-byte block the row touches
+                    p = wb + n*rb;
+                    e = p + rb;
+                    while (p < e) begin
+                        nb = `NN_LANES - p % `NN_LANES;
+                        if (nb > e - p) nb = e - p;
+                        p = p + nb;
+                        ref_cycles = ref_cycles + 1;
+                    end
+                end
+            end
+            ref_conf = best[15] ? 8'd0 : (best[15:8] != 0) ? 8'hFF : best[7:0];
+            ref_top    = best;
+            ref_second = best2;
+        end
+    endtask
+
+    // Run one inference and compare it with the reference
+    task check_run;
+        input   integer t;
+        inout   integer errors;
+        begin
+            ref_infer;
+            run_inference;
+            if (class_id !== ref_class || confidence !== ref_conf ||
+                top_score !== ref_top || second_id !== ref_class2 ||
+                second_score !== ref_second || nn_cycles != ref_cycles) begin
+                $display("    run %0d: class %0d conf %0d in %0d cycles, expected %0d / %0d in %0d",
+                         t, class_id, confidence, nn_cycles, ref_class, ref_conf, ref_cycles);
+                $display("      scores %0d, runner-up %0d: %0d, expected %0d, %0d: %0d",
+                         $signed(top_score), second_id, $signed(second_score),
+                         ref_top, ref_class2, ref_second);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
     // --- Test sequence ---
     integer pass_count;
     integer fail_count;
@@ -102,12 +326,20 @@ module tb_nn_engine;
 
         rst       = 1;
         start     = 0;
+        bank      = 0;
+        n_layers  = {`NN_BANKS{3'd2}};
+        desc      = {`NN_BANKS{DEFAULT_DESC}};
+        wt_int4   = 0;
         wt_wr_en  = 0;
+        wt_wr_bank = 0;
         wt_wr_addr = 0;
+        wt_wr_sel  = 0;
         wt_wr_data = 0;
+        wr_bank    = 0;
 
         repeat (10) @(posedge clk);
         rst = 0;
+        boot_wait;
         repeat (5) @(posedge clk);
 
         // ==================================================================
@@ -293,6 +525,309 @@ module tb_nn_engine;
         $display("  PASS: Inference completed without hang (class=%0d)", class_id);
         pass_count = pass_count + 1;
 
+        // ==================================================================
+        // Test 7: Random network vs. reference model, cycle count
+        // The reference wraps sums at 24 bits and requantises to 16-bit
+        // activations exactly like the engine, so any lane count must
+        // match it and its classification bit for bit.
+        // ==================================================================
+        $display("");
+        $display("[TEST 7] NN_LANES=%0d random network vs. reference", `NN_LANES);
+        begin : ref_check
+            integer seed, t, errors;
+            seed   = 7;
+            errors = 0;
+            for (i = 0; i < 212; i = i + 1)
+                write_weight(i[9:0], $random(seed) % 48);
+            for (t = 0; t < 8; t = t + 1) begin
+                for (i = 0; i < 8; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                check_run(t, errors);
+            end
+            $display("  %0d runs, %0d cycles per inference", t, nn_cycles);
+            if (errors == 0) begin
+                $display("  PASS: Bit-exact with reference, %0d MAC lane(s)", `NN_LANES);
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 8: INT4 packed weights vs. reference model
+        // Layer rows are packed two weights per byte (even input in the low
+        // nibble) at bytes n*4 (layer 1) and 144 + n*8 (layer 2), then the
+        // same inference is checked in each precision mode.
+        // ==================================================================
+        $display("");
+        $display("[TEST 8] NN_LANES=%0d INT4 packed weights vs. reference", `NN_LANES);
+        begin : int4_check
+            integer seed, t, m, errors;
+            seed   = 11;
+            errors = 0;
+            for (i = 0; i < 212; i = i + 1)
+                write_weight(i[9:0], $random(seed));
+            for (m = 1; m < 4; m = m + 1) begin
+                wt_int4[3:0] = m[3:0];
+                for (t = 0; t < 4; t = t + 1) begin
+                    for (i = 0; i < 8; i = i + 1)
+                        feature_mem[i] = $random(seed);
+                    check_run(t, errors);
+                end
+                $display("  NN_CFG=%b: %0d cycles per inference", wt_int4[1:0], nn_cycles);
+            end
+            wt_int4[3:0] = 4'd0;
+            if (errors == 0) begin
+                $display("  PASS: INT4 modes bit-exact with reference");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 9: Descriptor-driven 3-layer network
+        // 12 → 24 (ReLU, >>> 4) → 9 INT4 (ReLU, >>> 3) → 4 (>>> 2), with
+        // odd row lengths and unaligned bases, so rows straddle LANES-byte
+        // blocks on every lane count. Loaded 4 weights per write.
+        // ==================================================================
+        $display("");
+        $display("[TEST 9] NN_LANES=%0d 3-layer descriptor network vs. reference", `NN_LANES);
+        begin : desc_check
+            integer seed, t, errors;
+            seed   = 19;
+            errors = 0;
+            desc[255:0]   = 256'd0;
+            desc[63:0]    = layer_desc(12, 24, 1, 4, 0,   288);
+            desc[127:64]  = layer_desc(24,  9, 1, 3, 313, 421);
+            desc[191:128] = layer_desc( 9,  4, 0, 2, 431, 467);
+            n_layers[2:0] = 3'd3;
+            wt_int4[3:0]  = 4'b0010;
+            for (i = 0; i < 471; i = i + 4)
+                write_word(i[9:0], $random(seed));
+            for (t = 0; t < 8; t = t + 1) begin
+                for (i = 0; i < 12; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                check_run(t, errors);
+            end
+            $display("  %0d runs, %0d cycles per inference", t, nn_cycles);
+            desc[255:0]   = DEFAULT_DESC;
+            n_layers[2:0] = 3'd2;
+            wt_int4[3:0]  = 4'd0;
+            if (errors == 0) begin
+                $display("  PASS: 3-layer network bit-exact with reference");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 10: Hot swap between the weight banks
+        // Bank 1 gets an 8 → 20 INT4 (ReLU, >>> 3) → 4 (>>> 1) model while
+        // a bank-0 inference runs, and bank is flipped mid-inference: the
+        // run keeps the bank it started on. Then both banks must match the
+        // reference, cycle count included.
+        // ==================================================================
+        $display("");
+        $display("[TEST 10] NN_LANES=%0d hot swap to the shadow bank", `NN_LANES);
+        begin : swap_check
+            integer seed, t, errors;
+            reg [1:0] exp_class;
+            reg [7:0] exp_conf;
+            seed   = 23;
+            errors = 0;
+            desc[511:256]  = 256'd0;
+            desc[319:256]  = layer_desc( 8, 20, 1, 3, 5,   85);
+            desc[383:320]  = layer_desc(20,  4, 0, 1, 105, 185);
+            n_layers[5:3]  = 3'd2;
+            wt_int4[7:4]   = 4'b0001;
+            for (i = 0; i < 8; i = i + 1)
+                feature_mem[i] = $random(seed);
+            bank = 0;
+            ref_infer;
+            exp_class = ref_class;
+            exp_conf  = ref_conf;
+            wr_bank   = 1;
+            fork
+                run_inference;
+                begin
+                    repeat (4) @(posedge clk);
+                    bank <= 1;
+                end
+                for (i = 0; i < 189; i = i + 4)
+                    write_word(i[9:0], $random(seed));
+            join
+            if (class_id !== exp_class || confidence !== exp_conf) begin
+                $display("    bank 0 during the load: class %0d conf %0d, expected %0d / %0d",
+                         class_id, confidence, exp_class, exp_conf);
+                errors = errors + 1;
+            end
+            for (t = 0; t < 4; t = t + 1) begin
+                for (i = 0; i < 8; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                bank = 1;
+                check_run(t, errors);
+                bank = 0;
+                check_run(t, errors);
+            end
+            wr_bank = 0;
+            if (errors == 0) begin
+                $display("  PASS: Bank 1 loaded under a bank-0 inference, both bit-exact");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 11: Boot ROM model
+        // A reset copies nn_default_model.vh into bank 0 with busy high; a
+        // bank-1 write during the copy takes the memory for a clock. Bank 0
+        // then runs the ROM model's table bit-exact.
+        // ==================================================================
+        $display("");
+        $display("[TEST 11] NN_LANES=%0d boot ROM model", `NN_LANES);
+        begin : boot_check
+            integer seed, t, errors;
+            seed   = 29;
+            errors = 0;
+            @(posedge clk);
+            rst = 1;
+            repeat (2) @(posedge clk);
+            rst = 0;
+            wr_bank = 1;
+            fork
+                boot_wait;
+                begin
+                    repeat (10) @(posedge clk);
+                    write_word(10'd0, 32'h1234_5678);
+                end
+            join
+            wr_bank = 0;
+            if (boot_cycles != NN_ROM_WORDS + 1) begin
+                $display("    boot copy took %0d cycles, expected %0d",
+                         boot_cycles, NN_ROM_WORDS + 1);
+                errors = errors + 1;
+            end
+            bank          = 0;
+            desc[255:0]   = NN_ROM_DESC;
+            n_layers[2:0] = NN_ROM_LAYERS;
+            wt_int4[3:0]  = NN_ROM_INT4;
+            for (t = 0; t < 4; t = t + 1) begin
+                for (i = 0; i < 8; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                check_run(t, errors);
+            end
+            if (errors == 0) begin
+                $display("  PASS: ROM model booted in %0d cycles, bit-exact", boot_cycles);
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 12: Resident models
+        // Bank 0 keeps the ROM model; bank b > 0 gets an 8 → 8 + 4b (ReLU,
+        // >>> 3) → 4 (>>> 1) model, layer 1 INT4 on odd banks. Runs then
+        // pick another bank on almost every start (with repeats and jumps
+        // between the steps), and each must match its own bank's reference.
+        // ==================================================================
+        $display("");
+        $display("[TEST 12] NN_LANES=%0d %0d resident models", `NN_LANES, `NN_BANKS);
+        begin : resident_check
+            integer seed, t, b, h, b0, w1, b1, errors;
+            seed   = 31;
+            errors = 0;
+            for (b = 1; b < `NN_BANKS; b = b + 1) begin
+                h  = 8 + 4 * b;
+                b0 = h * (b[0] ? 4 : 8);        // Layer 1 biases after its rows
+                w1 = b0 + h;
+                b1 = w1 + 4 * h;
+                desc[256*b +: 256]     = 256'd0;
+                desc[256*b +: 64]      = layer_desc(8, h, 1, 3, 0,  b0);
+                desc[256*b + 64 +: 64] = layer_desc(h, 4, 0, 1, w1, b1);
+                n_layers[3*b +: 3]     = 3'd2;
+                wt_int4[4*b +: 4]      = {3'd0, b[0]};
+                wr_bank = b;
+                for (i = 0; i < b1 + 4; i = i + 4)
+                    write_word(i[9:0], $random(seed));
+            end
+            wr_bank = 0;
+            for (t = 0; t < 4 * `NN_BANKS; t = t + 1) begin
+                for (i = 0; i < 8; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                bank = (t + t / `NN_BANKS) % `NN_BANKS;
+                check_run(t, errors);
+            end
+            bank = 0;
+            if (errors == 0) begin
+                $display("  PASS: %0d banks bit-exact, switched per inference", `NN_BANKS);
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 13: Out-of-range descriptors
+        // Shapes and layer counts wb_interface accepts but no model uses:
+        // each run must still raise done and match the reference, which
+        // clamps them as the engine does. The single-output last layer
+        // follows a run with a non-zero runner-up, which must not leak.
+        // ==================================================================
+        $display("");
+        $display("[TEST 13] NN_LANES=%0d out-of-range descriptors", `NN_LANES);
+        begin : bad_desc_check
+            integer seed, t, errors;
+            reg [255:0] bad_desc [0:4];
+            reg [2:0]   bad_nl   [0:4];
+            seed   = 37;
+            errors = 0;
+            bad_desc[0] = {128'd0, layer_desc( 0, 63, 1, 4, 0, 400),
+                                   layer_desc( 0,  0, 1, 2, 0, 300)};
+            bad_nl[0]   = 3'd2;
+            bad_desc[1] = {layer_desc( 3,  0, 0, 0, 500, 503),
+                           layer_desc(50,  3, 0, 2, 400, 496),
+                           layer_desc( 0, 40, 1, 3, 320, 360),
+                           layer_desc(40,  9, 1, 4, 0,   300)};
+            bad_nl[1]   = 3'd7;
+            bad_desc[2] = DEFAULT_DESC;
+            bad_nl[2]   = 3'd0;
+            bad_desc[3] = DEFAULT_DESC;
+            bad_nl[3]   = 3'd5;
+            bad_desc[4] = {192'd0, layer_desc(8, 1, 0, 0, 0, 500)};
+            bad_nl[4]   = 3'd1;
+            for (i = 0; i < 512; i = i + 4)
+                write_word(i[9:0], $random(seed));
+            for (t = 0; t < 5; t = t + 1) begin
+                for (i = 0; i < 32; i = i + 1)
+                    feature_mem[i] = $random(seed);
+                check_run(-1, errors);
+                desc[255:0]   = bad_desc[t];
+                n_layers[2:0] = bad_nl[t];
+                check_run(t, errors);
+                if (nn_cycles >= 100000)
+                    errors = errors + 1;
+                desc[255:0]   = DEFAULT_DESC;
+                n_layers[2:0] = 3'd2;
+            end
+            if (errors == 0) begin
+                $display("  PASS: Every out-of-range table ran to done, bit-exact");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatching runs", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
         // --- Summary ---
         $display("");
         $display("==========================================");
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+// Testbench: Change-Gated Inference
+// Tests:
+//   1. threshold 0: the gate never skips
+//   2. L1 distance over the 12 features, skip only below the threshold
+//   3. The reference moves with every run, not with a skip
+//   4. max_skip forces a run after that many skips in a row
+//   5. A model bank swap or a disable forces a run
+//   6. Only a vector of the channel last classified may skip
+
+`timescale 1ns / 1ps
+
+module tb_nn_gate;
+
+    // --- Clock and Reset ---
+    reg clk;
+    reg rst;
+
+    initial clk = 0;
+    always #20 clk = ~clk; // 25 MHz
+
+    // --- DUT signals ---
+    reg         enable;
+    reg  [11:0] threshold;
+    reg  [7:0]  max_skip;
+    reg  [1:0]  model_bank;
+    reg  [1:0]  channel;
+    reg  [95:0] vec;
+    reg         take;
+    wire        skip;
+    wire [11:0] distance;
+
+    // --- DUT ---
+    nn_gate dut (
+        .clk        (clk),
+        .rst        (rst),
+        .enable     (enable),
+        .threshold  (threshold),
+        .max_skip   (max_skip),
+        .model_bank (model_bank),
+        .channel    (channel),
+        .vec        (vec),
+        .take       (take),
+        .skip       (skip),
+        .distance   (distance)
+    );
+
+    // --- Tasks ---
+    // All 12 features set to one value
+    function [95:0] flat;
+        input [7:0] f;
+        begin
+            flat = {12{f}};
+        end
+    endfunction
+
+    // Hand vec over on one clock; skipped = what the gate decided
+    reg skipped;
+
+    task offer;
+        input [95:0] v;
+        begin
+            @(negedge clk);
+            vec  = v;
+            take = 1'b1;
+            #1 skipped = skip;
+            @(negedge clk);
+            take = 1'b0;
+        end
+    endtask
+
+    // --- Test sequence ---
+    integer pass_count;
+    integer fail_count;
+    integer i;
+    integer errors;
+
+    initial begin
+        $dumpfile("tb_nn_gate.vcd");
+        $dumpvars(0, tb_nn_gate);
+
+        pass_count = 0;
+        fail_count = 0;
+
+        rst        = 1;
+        enable     = 1;
+        threshold  = 12'd0;
+        max_skip   = 8'd0;
+        model_bank = 2'd0;
+        channel    = 2'd0;
+        vec        = 96'd0;
+        take       = 0;
+        skipped    = 0;
+
+        repeat (10) @(posedge clk);
+        rst = 0;
+        repeat (5) @(posedge clk);
+
+        // ==================================================================
+        // Test 1: Gate off
+        // ==================================================================
+        $display("");
+        $display("[TEST 1] threshold 0: every vector runs");
+        errors = 0;
+        for (i = 0; i < 4; i = i + 1) begin
+            offer(flat(8'd50));
+            if (skipped) errors = errors + 1;
+        end
+        if (errors == 0) begin
+            $display("  PASS: No skips with the gate off");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d of 4 identical vectors skipped", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 2: Distance and threshold
+        // ==================================================================
+        // Reference all 50 (last run with the gate off): feature 3 at 60
+        // and feature 11 at 45 is 15 off
+        $display("");
+        $display("[TEST 2] L1 distance against the threshold");
+        errors = 0;
+        threshold = 12'd16;
+        vec = flat(8'd50);
+        vec[8*3 +: 8]  = 8'd60;
+        vec[8*11 +: 8] = 8'd45;
+        #1;
+        $display("    distance = %0d", distance);
+        if (distance !== 12'd15 || !skip) errors = errors + 1;
+        threshold = 12'd15;                 // Strictly below
+        #1;
+        if (skip) errors = errors + 1;
+        // Far vectors: 12 x 205 and 12 x 50
+        vec = flat(8'd255);
+        #1;
+        if (distance !== 12'd2460) errors = errors + 1;
+        vec = flat(8'd0);
+        #1;
+        if (distance !== 12'd600) errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: Distance 15 skips at 16, runs at 15");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d mismatches", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 3: Reference update
+        // ==================================================================
+        // Steps of 1 per feature (12 each) never run with threshold 16;
+        // the drift reaches 24 after two skips and runs
+        $display("");
+        $display("[TEST 3] Reference follows runs only");
+        errors = 0;
+        threshold = 12'd16;
+        offer(flat(8'd51));  if (!skipped) errors = errors + 1;    // 12
+        offer(flat(8'd52));  if (skipped)  errors = errors + 1;    // 24: run
+        offer(flat(8'd53));  if (!skipped) errors = errors + 1;    // 12 from 52
+        offer(flat(8'd52));  if (!skipped) errors = errors + 1;    // 0
+        if (errors == 0) begin
+            $display("  PASS: Drift caught, reference at the last run");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d wrong decisions", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 4: Forced run after max_skip
+        // ==================================================================
+        $display("");
+        $display("[TEST 4] max_skip 3: a run after 3 skips in a row");
+        errors = 0;
+        max_skip = 8'd3;
+        offer(flat(8'd90));                 // Run, new reference
+        for (i = 0; i < 8; i = i + 1) begin
+            offer(flat(8'd90));
+            if (skipped != (i % 4 != 3)) begin
+                $display("    vector %0d: skip %b", i, skipped);
+                errors = errors + 1;
+            end
+        end
+        max_skip = 8'd0;
+        if (errors == 0) begin
+            $display("  PASS: Skip, skip, skip, run");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Wrong forced-run pattern");
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 5: Bank swap and disable
+        // ==================================================================
+        $display("");
+        $display("[TEST 5] Bank swap and disable force a run");
+        errors = 0;
+        model_bank = 2'd1;
+        offer(flat(8'd90));  if (skipped)  errors = errors + 1;
+        offer(flat(8'd90));  if (!skipped) errors = errors + 1;
+        enable = 0;
+        repeat (2) @(posedge clk);
+        enable = 1;
+        offer(flat(8'd90));  if (skipped)  errors = errors + 1;
+        offer(flat(8'd90));  if (!skipped) errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: First vector after each ran");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d wrong decisions", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 6: Channels
+        // ==================================================================
+        $display("");
+        $display("[TEST 6] Another channel's vector runs");
+        errors = 0;
+        channel = 2'd2;
+        offer(flat(8'd90));  if (skipped)  errors = errors + 1;
+        offer(flat(8'd90));  if (!skipped) errors = errors + 1;
+        channel = 2'd0;
+        offer(flat(8'd90));  if (skipped)  errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: Same vector, new channel: NN runs");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d wrong decisions", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Summary ---
+        $display("");
+        $display("==========================================");
+        $display("  Change-Gated Inference Testbench Results");
+        $display("  PASSED: %0d  FAILED: %0d", pass_count, fail_count);
+        $display("==========================================");
+        if (fail_count > 0) $display("  *** TEST FAILED ***");
+        else                $display("  *** ALL TESTS PASSED ***");
+
+        #100;
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #1_000_000;
+        $display("WATCHDOG: Simulation timeout");
+        $finish;
+    end
+
+endmodule
@@ -0,0 +1,395 @@
+// SPDX-License-Identifier: Apache-2.0
+// Testbench: Performance Counters
+// Tests:
+//   1. Everything reads 0 after reset
+//   2. One frame: FFT, FE, NN and end-to-end latency cycle counts
+//   3. MAX keeps the longest frame and a MAX read clears it, LAST stays
+//   4. SPI window interval between hand-overs, not counted across a disable
+//   5. Drop and overrun counts clear on read, FRAMES runs free
+//   6. Logic analyzer mirror
+//   7. Stall count clears on read
+//   8. Change-gate skips count as frames and in SKIPS, not in the NN stage
+//   9. Rejected bus samples count in REJECTS, clear on read
+
+`timescale 1ns / 1ps
+
+module tb_perf_counters;
+
+    // --- Clock and Reset ---
+    reg clk;
+    reg rst;
+
+    initial clk = 0;
+    always #20 clk = ~clk; // 25 MHz
+
+    // --- DUT signals ---
+    reg         enable;
+    reg         win_valid;
+    reg         win_drop;
+    reg         win_overrun;
+    reg         win_stall;
+    reg         fft_start;
+    reg         fft_done;
+    reg         fe_done;
+    reg         nn_start;
+    reg         nn_done;
+    reg         nn_skip;
+    reg         smp_reject;
+    reg         rd_en;
+    reg  [3:0]  rd_addr;
+    wire [31:0] rd_data;
+    wire [95:0] la_perf;
+
+    // --- DUT ---
+    perf_counters #(.CW(24)) dut (
+        .clk        (clk),
+        .rst        (rst),
+        .enable     (enable),
+        .win_valid  (win_valid),
+        .win_drop   (win_drop),
+        .win_overrun(win_overrun),
+        .win_stall  (win_stall),
+        .smp_reject (smp_reject),
+        .fft_start  (fft_start),
+        .fft_done   (fft_done),
+        .fe_done    (fe_done),
+        .nn_start   (nn_start),
+        .nn_done    (nn_done),
+        .nn_skip    (nn_skip),
+        .rd_en      (rd_en),
+        .rd_addr    (rd_addr),
+        .rd_data    (rd_data),
+        .la_perf    (la_perf)
+    );
+
+    // Register word offsets
+    localparam [3:0] R_FRAMES   = 4'd0;
+    localparam [3:0] R_DROPS    = 4'd1;
+    localparam [3:0] R_OVERRUNS = 4'd2;
+    localparam [3:0] R_STALLS   = 4'd3;
+    localparam [3:0] R_SKIPS    = 4'd14;
+    localparam [3:0] R_REJECTS  = 4'd15;
+    localparam       S_SPI = 0, S_FFT = 1, S_FE = 2, S_NN = 3, S_LAT = 4;
+
+    function [3:0] r_last;
+        input integer s;
+        begin
+            r_last = 4 + 2 * s;
+        end
+    endfunction
+
+    function [3:0] r_max;
+        input integer s;
+        begin
+            r_max = 5 + 2 * s;
+        end
+    endfunction
+
+    // --- Tasks ---
+    // One read strobe; the data is taken before the clearing edge
+    task rd;
+        input  [3:0]  addr;
+        output [31:0] data;
+        begin
+            @(negedge clk);
+            rd_en   = 1'b1;
+            rd_addr = addr;
+            #1 data = rd_data;
+            @(negedge clk);
+            rd_en   = 1'b0;
+        end
+    endtask
+
+    // Idle clocks between events
+    task wait_clk;
+        input integer n;
+        begin
+            if (n > 0) repeat (n) @(negedge clk);
+        end
+    endtask
+
+    // One frame through the pipeline, every gap in clocks after the
+    // previous event: window, FFT start, FFT done, FE done, NN start, NN done
+    task frame;
+        input integer g_start;
+        input integer g_fft;
+        input integer g_fe;
+        input integer g_nn_start;
+        input integer g_nn;
+        begin
+            @(negedge clk); win_valid = 1'b1; @(negedge clk); win_valid = 1'b0;
+            wait_clk(g_start - 1);
+            fft_start = 1'b1; @(negedge clk); fft_start = 1'b0;
+            wait_clk(g_fft - 1);
+            fft_done  = 1'b1; @(negedge clk); fft_done  = 1'b0;
+            wait_clk(g_fe - 1);
+            fe_done   = 1'b1; @(negedge clk); fe_done   = 1'b0;
+            wait_clk(g_nn_start - 1);
+            nn_start  = 1'b1; @(negedge clk); nn_start  = 1'b0;
+            wait_clk(g_nn - 1);
+            nn_done   = 1'b1; @(negedge clk); nn_done   = 1'b0;
+        end
+    endtask
+
+    // --- Test sequence ---
+    integer pass_count;
+    integer fail_count;
+    integer i;
+    integer errors;
+    reg [31:0] d;
+    reg [31:0] d2;
+    reg [31:0] d3;
+    reg [31:0] d4;
+
+    initial begin
+        $dumpfile("tb_perf_counters.vcd");
+        $dumpvars(0, tb_perf_counters);
+
+        pass_count = 0;
+        fail_count = 0;
+
+        rst         = 1;
+        enable      = 1;
+        win_valid   = 0;
+        win_drop    = 0;
+        win_overrun = 0;
+        win_stall   = 0;
+        fft_start   = 0;
+        fft_done    = 0;
+        fe_done     = 0;
+        nn_start    = 0;
+        nn_done     = 0;
+        nn_skip     = 0;
+        smp_reject  = 0;
+        rd_en       = 0;
+        rd_addr     = 4'd0;
+
+        repeat (10) @(posedge clk);
+        rst = 0;
+        repeat (5) @(posedge clk);
+
+        // ==================================================================
+        // Test 1: Reset state
+        // ==================================================================
+        $display("");
+        $display("[TEST 1] All counters 0 after reset");
+        errors = 0;
+        for (i = 0; i < 16; i = i + 1) begin
+            rd(i, d);
+            if (d !== 32'd0) errors = errors + 1;
+        end
+        if (errors == 0 && la_perf === 96'd0) begin
+            $display("  PASS: 16 words and LA mirror read 0");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d non-zero words, la_perf = 0x%024h", errors, la_perf);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 2: One frame
+        // ==================================================================
+        // Window at t, FFT t+3 .. t+103, FE done t+113, NN t+118 .. t+158
+        $display("");
+        $display("[TEST 2] Stage cycle counts of one frame");
+        frame(3, 100, 10, 5, 40);
+        errors = 0;
+        rd(r_last(S_FFT), d); if (d !== 32'd100) begin errors = errors + 1; $display("    FFT %0d", d); end
+        rd(r_last(S_FE),  d); if (d !== 32'd110) begin errors = errors + 1; $display("    FE %0d",  d); end
+        rd(r_last(S_NN),  d); if (d !== 32'd40)  begin errors = errors + 1; $display("    NN %0d",  d); end
+        rd(r_last(S_LAT), d); if (d !== 32'd158) begin errors = errors + 1; $display("    LAT %0d", d); end
+        rd(R_FRAMES, d);      if (d !== 32'd1)   begin errors = errors + 1; $display("    FRAMES %0d", d); end
+        if (errors == 0) begin
+            $display("  PASS: FFT 100, FE 110, NN 40, latency 158 cycles");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d wrong counts", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 3: Running max and read-clear
+        // ==================================================================
+        $display("");
+        $display("[TEST 3] MAX holds the longest frame, a read clears it");
+        frame(3, 60, 10, 5, 20);
+        errors = 0;
+        rd(r_last(S_FFT), d);  if (d !== 32'd60)  errors = errors + 1;
+        rd(r_max(S_FFT), d);   if (d !== 32'd100) errors = errors + 1;
+        rd(r_max(S_FFT), d);   if (d !== 32'd0)   errors = errors + 1;  // Cleared
+        rd(r_last(S_FFT), d);  if (d !== 32'd60)  errors = errors + 1;  // LAST kept
+        rd(r_max(S_NN), d);    if (d !== 32'd40)  errors = errors + 1;  // Others kept
+        frame(3, 60, 10, 5, 20);
+        rd(r_max(S_FFT), d);   if (d !== 32'd60)  errors = errors + 1;  // Tracking again
+        rd(r_max(S_LAT), d);   if (d !== 32'd158) errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: MAX 100 over LAST 60, cleared by the read and tracking again");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d mismatches", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 4: SPI window interval
+        // ==================================================================
+        $display("");
+        $display("[TEST 4] Window hand-over interval");
+        for (i = 0; i < 3; i = i + 1) begin
+            @(negedge clk); win_valid = 1'b1; @(negedge clk); win_valid = 1'b0;
+            wait_clk(298);
+        end
+        @(negedge clk); win_valid = 1'b1; @(negedge clk); win_valid = 1'b0;
+        rd(r_last(S_SPI), d);
+        // Disabled for a while: the first window after it starts afresh
+        enable = 1'b0;
+        wait_clk(1000);
+        enable = 1'b1;
+        @(negedge clk); win_valid = 1'b1; @(negedge clk); win_valid = 1'b0;
+        rd(r_last(S_SPI), d2);
+        if (d2 !== 32'd300) d = 32'd0;
+        wait_clk(196);
+        @(negedge clk); win_valid = 1'b1; @(negedge clk); win_valid = 1'b0;
+        rd(r_last(S_SPI), d2);
+        if (d === 32'd300 && d2 === 32'd200) begin
+            $display("  PASS: 300 cycles between windows, 200 after a disable");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: SPI interval %0d / %0d, expected 300 / 200", d, d2);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 5: Event counts
+        // ==================================================================
+        $display("");
+        $display("[TEST 5] Drop / overrun counts clear on read, FRAMES does not");
+        for (i = 0; i < 5; i = i + 1) begin
+            @(negedge clk);
+            win_drop    = 1'b1;
+            win_overrun = (i < 3);
+        end
+        @(negedge clk);
+        win_drop    = 1'b0;
+        win_overrun = 1'b0;
+        errors = 0;
+        rd(R_DROPS, d);     if (d !== 32'd5) errors = errors + 1;
+        rd(R_DROPS, d);     if (d !== 32'd0) errors = errors + 1;
+        rd(R_OVERRUNS, d);  if (d !== 32'd3) errors = errors + 1;
+        rd(R_OVERRUNS, d);  if (d !== 32'd0) errors = errors + 1;
+        rd(R_FRAMES, d);
+        rd(R_FRAMES, d2);
+        if (d !== 32'd3 || d2 !== 32'd3) errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: 5 drops, 3 overruns, cleared; 3 frames kept");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d mismatches", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 6: LA mirror
+        // ==================================================================
+        $display("");
+        $display("[TEST 6] Logic analyzer mirror");
+        @(negedge clk); win_drop = 1'b1; win_overrun = 1'b1;
+        @(negedge clk); win_drop = 1'b0; win_overrun = 1'b0;
+        @(negedge clk);
+        if (la_perf[15:0] === 16'd3 && la_perf[31:16] === 16'd60 &&
+            la_perf[47:32] === 16'd20 && la_perf[79:64] === 16'd200 &&
+            la_perf[87:80] === 8'd1 && la_perf[95:88] === 8'd1) begin
+            $display("  PASS: frames, FFT, NN, SPI and counts on la_perf");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: la_perf = 0x%024h", la_perf);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 7: Stall count
+        // ==================================================================
+        $display("");
+        $display("[TEST 7] Stall count clears on read");
+        for (i = 0; i < 4; i = i + 1) begin
+            @(negedge clk); win_stall = 1'b1;
+            @(negedge clk); win_stall = 1'b0;
+        end
+        errors = 0;
+        rd(R_STALLS, d);    if (d !== 32'd4) errors = errors + 1;
+        rd(R_STALLS, d2);   if (d2 !== 32'd0) errors = errors + 1;
+        rd(R_DROPS, d2);    if (d2 !== 32'd0) errors = errors + 1;  // Not counted there
+        if (errors == 0) begin
+            $display("  PASS: 4 stalls, cleared by the read");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d stalls, %0d mismatches", d, errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 8: Change-gate skips
+        // ==================================================================
+        $display("");
+        $display("[TEST 8] Skips count as frames and in SKIPS");
+        errors = 0;
+        rd(R_FRAMES, d2);
+        rd(r_last(S_NN), d3);
+        for (i = 0; i < 3; i = i + 1) begin
+            @(negedge clk); nn_skip = 1'b1;
+            @(negedge clk); nn_skip = 1'b0;
+        end
+        rd(R_SKIPS, d);     if (d !== 32'd3) errors = errors + 1;
+        rd(R_FRAMES, d4);   if (d4 !== d2 + 32'd3) errors = errors + 1;
+        rd(R_SKIPS, d4);    if (d4 !== 32'd0) errors = errors + 1;
+        rd(r_last(S_NN), d4); if (d4 !== d3) errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: 3 skips, FRAMES +3, NN stage untouched");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d skips, %0d mismatches", d, errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 9: Rejected bus samples
+        // ==================================================================
+        $display("");
+        $display("[TEST 9] Rejected SAMPLE_IN samples clear on read");
+        for (i = 0; i < 5; i = i + 1) begin
+            @(negedge clk); smp_reject = 1'b1;
+            @(negedge clk); smp_reject = 1'b0;
+        end
+        errors = 0;
+        rd(R_REJECTS, d);   if (d !== 32'd5) errors = errors + 1;
+        rd(R_REJECTS, d2);  if (d2 !== 32'd0) errors = errors + 1;
+        rd(R_STALLS, d2);   if (d2 !== 32'd0) errors = errors + 1;  // Not counted there
+        if (errors == 0) begin
+            $display("  PASS: 5 rejected samples, cleared by the read");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d rejects, %0d mismatches", d, errors);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Summary ---
+        $display("");
+        $display("==========================================");
+        $display("  Perf Counters Testbench Results");
+        $display("  PASSED: %0d  FAILED: %0d", pass_count, fail_count);
+        $display("==========================================");
+        if (fail_count > 0) $display("  *** TEST FAILED ***");
+        else                $display("  *** ALL TESTS PASSED ***");
+
+        #100;
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #1_000_000;
+        $display("WATCHDOG: Simulation timeout");
+        $finish;
+    end
+
+endmodule
@@ -35,7 +35,10 @@ module tb_senseedge_top;
     wire [2:0] irq;
 
     // --- DUT ---
-    senseedge_top dut (
+    // Built for three ADC channels; phases 1-16 sample channel 0 only
+    senseedge_top #(
+        .N_CH     (3)
+    ) dut (
     `ifdef USE_POWER_PINS
         .vccd1(1'b1),
         .vssd1(1'b0),
@@ -62,8 +65,10 @@ module tb_senseedge_top;
     // =========================================================================
     // Simulated SPI ADC (MCP3201-style)
     // =========================================================================
+    // One model answers all three chip selects (GPIO 2, 8, 9), continuing
+    // the same waveform from channel to channel
     wire spi_clk_w  = io_out[1];
-    wire spi_cs_n_w = io_out[2];
+    wire spi_cs_n_w = io_out[2] & io_out[8] & io_out[9];
 
     reg [15:0] adc_shift_reg;
     reg [4:0]  adc_bit_cnt;
@@ -89,6 +94,10 @@ module tb_senseedge_top;
         adc_sample_idx = 0;
     end
 
+    integer    cs_falls;        // Conversions started
+    initial cs_falls = 0;
+    always @(negedge spi_cs_n_w) cs_falls = cs_falls + 1;
+
     // SPI ADC behavior
     always @(negedge spi_cs_n_w) begin
         adc_shift_reg = {3'b000, adc_data[adc_sample_idx % 64], 1'b0};
@@ -154,12 +163,16 @@ module tb_senseedge_top;
         end
     endtask
 
-    task wb_write_weight;
-        input [7:0] addr;
-        input [7:0] data;
+    // Weight image, streamed 4 bytes per write through NN_WT_DATA (0xA4)
+    // from NN_WT_ADDR (0xA0) into the shadow bank
+    reg [7:0] wt_img [0:211];
+
+    task wb_load_weights;
+        integer k;
         begin
-            // Weight register base = 0x20, each word holds 1 byte (byte 0)
-            wb_write(32'h20 + {24'd0, addr}, {24'd0, data});
+            wb_write(32'hA0, 32'h00000000);
+            for (k = 0; k < 212; k = k + 4)
+                wb_write(32'hA4, {wt_img[k + 3], wt_img[k + 2], wt_img[k + 1], wt_img[k]});
         end
     endtask
 
@@ -204,38 +217,33 @@ module tb_senseedge_top;
         $display("");
         $display("[PHASE 1] Loading neural network weights...");
 
-        // Layer 1 weights: 128 entries (all zero except diagonal-ish)
-        for (i = 0; i < 128; i = i + 1)
-            wb_write_weight(i[7:0], 8'd0);
+        // All weights and biases zero except the diagonal-ish ones
+        for (i = 0; i < 212; i = i + 1)
+            wt_img[i] = 8'd0;
 
         // Set up weights so each output class responds to a different band
-        // Neuron 0 → input 0 (low band)
-        wb_write_weight(8'd0, 8'd127);
-        // Neuron 1 → input 1 (mid-low band)
-        wb_write_weight(8'd9, 8'd127);
-        // Neuron 2 → input 2 (mid-hi band)
-        wb_write_weight(8'd18, 8'd127);
-        // Neuron 3 → input 3 (high band)
-        wb_write_weight(8'd27, 8'd127);
-
-        // Layer 1 biases: all zero
-        for (i = 128; i < 144; i = i + 1)
-            wb_write_weight(i[7:0], 8'd0);
+        wt_img[0]   = 8'd127;   // Neuron 0 → input 0 (low band)
+        wt_img[9]   = 8'd127;   // Neuron 1 → input 1 (mid-low band)
+        wt_img[18]  = 8'd127;   // Neuron 2 → input 2 (mid-hi band)
+        wt_img[27]  = 8'd127;   // Neuron 3 → input 3 (high band)
 
         // Layer 2 weights: map hidden to output classes
-        for (i = 144; i < 208; i = i + 1)
-            wb_write_weight(i[7:0], 8'd0);
-
-        wb_write_weight(8'd144, 8'd127); // Class 0 ← Hidden 0
-        wb_write_weight(8'd161, 8'd127); // Class 1 ← Hidden 1
-        wb_write_weight(8'd178, 8'd127); // Class 2 ← Hidden 2
-        wb_write_weight(8'd195, 8'd127); // Class 3 ← Hidden 3
+        wt_img[144] = 8'd127;   // Class 0 ← Hidden 0
+        wt_img[161] = 8'd127;   // Class 1 ← Hidden 1
+        wt_img[178] = 8'd127;   // Class 2 ← Hidden 2
+        wt_img[195] = 8'd127;   // Class 3 ← Hidden 3
 
-        // Layer 2 biases
-        for (i = 208; i < 212; i = i + 1)
-            wb_write_weight(i[7:0], 8'd0);
+        wb_load_weights;
+        wb_write(32'h7C, 32'h00010200); // Default model, swap the bank in
 
-        $display("  212 weights loaded");
+        wb_read(32'h7C, rd_data);
+        if (rd_data[17] == 1'b1) begin
+            $display("  PASS: 212 weights loaded in 53 writes, bank 1 active");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: NN_CFG = 0x%08h after the bank swap", rd_data);
+            fail_count = fail_count + 1;
+        end
 
         // ==================================================================
         // Phase 2: Configure alarm
@@ -299,6 +307,21 @@ module tb_senseedge_top;
             pass_count = pass_count + 1; // Not necessarily a failure
         end
 
+        // The same result, queued with its frame number (window 1)
+        begin : res_fifo_block
+            reg [31:0] fifo_w;
+            wb_read(32'hA8, fifo_w);
+            $display("  RES_FIFO: frame=%0d, class=%0d, confidence=%0d, runner-up=%0d",
+                     fifo_w[31:16], fifo_w[1:0], fifo_w[9:2], fifo_w[13:12]);
+            if (fifo_w[11] && fifo_w[9:0] == rd_data[9:0] && fifo_w[31:16] == 16'd1) begin
+                $display("  PASS: Result FIFO holds the classification of frame 1");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: RES_FIFO = 0x%08h, CLASS_RESULT = 0x%08h", fifo_w, rd_data);
+                fail_count = fail_count + 1;
+            end
+        end
+
         // Read status
         wb_read(32'h04, rd_data);
         $display("  STATUS: 0x%08h (enable=%b fft_busy=%b nn_busy=%b fe_busy=%b alarm=%b)",
@@ -362,8 +385,10 @@ module tb_senseedge_top;
         $display("  io_oeb[3] (ALRM) = %b (expect 0=output)", io_oeb[3]);
         $display("  io_out[3] (ALRM) = %b", io_out[3]);
         $display("  io_out[4] (LED)  = %b", io_out[4]);
+        $display("  io_out[5] (UART) = %b (expect 1=idle)", io_out[5]);
 
-        if (io_oeb[0] == 1'b1 && io_oeb[1] == 1'b0 && io_oeb[2] == 1'b0) begin
+        if (io_oeb[0] == 1'b1 && io_oeb[1] == 1'b0 && io_oeb[2] == 1'b0 &&
+            io_oeb[5] == 1'b0 && io_out[5] == 1'b1) begin
             $display("  PASS: GPIO directions correct");
             pass_count = pass_count + 1;
         end else begin
@@ -403,6 +428,536 @@ module tb_senseedge_top;
             fail_count = fail_count + 1;
         end
 
+        // ==================================================================
+        // Phase 10: Pipelined throughput
+        // ==================================================================
+        // clk_div=0 with hop=16 hands over a window every ~580 cycles: less
+        // than FFT + NN back to back, more than the FFT (with the features
+        // extracted on its magnitude stream) alone.
+        // With the stages overlapped every window must still be classified.
+        $display("");
+        $display("[PHASE 10] Overlapped pipeline throughput...");
+        wb_write(32'h1C, 32'h00000000); // divider=0 (fastest SPI)
+        wb_write(32'h78, 32'h00000010); // hop=16
+        wb_write(32'h00, 32'h00000001); // Enable
+        begin : throughput_block
+            integer cyc;
+            integer n_frames;
+            integer n_results;
+            // Let the first window fill and the pipeline prime
+            cyc = 0;
+            while (la_data_out[15] !== 1'b1 && cyc < 500_000) begin
+                @(posedge clk);
+                cyc = cyc + 1;
+            end
+            n_frames  = 0;
+            n_results = 0;
+            for (cyc = 0; cyc < 20_000; cyc = cyc + 1) begin
+                @(posedge clk);
+                if (la_data_out[22] === 1'b1) n_frames  = n_frames + 1;  // samples_valid
+                if (la_data_out[15] === 1'b1) n_results = n_results + 1; // nn_done
+            end
+            $display("  %0d windows handed over, %0d classified in 20000 cycles",
+                     n_frames, n_results);
+            if (n_frames > 10 && n_results + 1 >= n_frames) begin
+                $display("  PASS: Pipeline keeps up with overlapped frames");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Frames lost in the pipeline");
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable
+
+        // ==================================================================
+        // Phase 11: Boot strap
+        // ==================================================================
+        // A reset with io_in[7] high runs the boot ROM model at the reset
+        // clock divider: the first window is classified with no Wishbone
+        // access at all.
+        $display("");
+        $display("[PHASE 11] Boot strap - classifying without firmware...");
+        io_in[7] = 1'b1;
+        rst = 1;
+        repeat (20) @(posedge clk);
+        rst = 0;
+        io_in[7] = 1'b0;
+        begin : boot_block
+            integer cyc;
+            cyc = 0;
+            while (la_data_out[15] !== 1'b1 && cyc < 2_000_000) begin
+                @(posedge clk);
+                cyc = cyc + 1;
+            end
+            repeat (10) @(posedge clk);
+            wb_read(32'h08, rd_data);
+            if (cyc < 2_000_000 && ^rd_data[9:0] !== 1'bx) begin
+                $display("  PASS: Classified at cycle %0d from reset (class=%0d, confidence=%0d)",
+                         cyc, rd_data[1:0], rd_data[9:2]);
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: No classification in %0d cycles (CLASS_RESULT = 0x%08h)",
+                         cyc, rd_data);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable
+
+        // ==================================================================
+        // Phase 12: Readback snapshot
+        // ==================================================================
+        // With the pipeline running flat out, a snapshot pins one frame's
+        // spectrum and features: the packed window matches FFT_DATA, and
+        // both stay put while the pipeline classifies on.
+        $display("");
+        $display("[PHASE 12] Readback snapshot while the pipeline runs...");
+        wb_write(32'h1C, 32'h00000000); // divider=0 (fastest SPI)
+        wb_write(32'h78, 32'h00000010); // hop=16
+        wb_write(32'h00, 32'h00000001); // Enable
+        begin : snap_block
+            integer cyc, k, errors, n_results;
+            reg [31:0] win [0:17];
+            reg [31:0] snap_ctrl;
+            errors = 0;
+            cyc = 0;
+            while (la_data_out[15] !== 1'b1 && cyc < 500_000) begin
+                @(posedge clk);
+                cyc = cyc + 1;
+            end
+            wb_write(32'hBC, 32'h00000001); // Take
+            snap_ctrl = 0;
+            for (k = 0; k < 100 && !snap_ctrl[1]; k = k + 1)
+                wb_read(32'hBC, snap_ctrl);
+            // 18 reads: 2 feature words, 16 spectrum words
+            wb_read(32'hC0, win[16]);
+            wb_read(32'hC4, win[17]);
+            for (k = 0; k < 16; k = k + 1)
+                wb_read(32'h100 + 4 * k, win[k]);
+            wb_write(32'h10, 32'h00000000);
+            for (k = 0; k < 32; k = k + 1) begin
+                wb_read(32'h10, rd_data);
+                if (rd_data[15:0] !== (k[0] ? win[k / 2][31:16] : win[k / 2][15:0]))
+                    errors = errors + 1;
+            end
+            // Several frame times later: same frame, same data
+            n_results = 0;
+            for (cyc = 0; cyc < 5000; cyc = cyc + 1) begin
+                @(posedge clk);
+                if (la_data_out[15] === 1'b1) n_results = n_results + 1;
+            end
+            wb_read(32'hBC, rd_data);
+            if (rd_data !== snap_ctrl) errors = errors + 1;
+            wb_read(32'hC0, rd_data);
+            if (rd_data !== win[16]) errors = errors + 1;
+            wb_read(32'hC4, rd_data);
+            if (rd_data !== win[17]) errors = errors + 1;
+            for (k = 0; k < 16; k = k + 1) begin
+                wb_read(32'h100 + 4 * k, rd_data);
+                if (rd_data !== win[k]) errors = errors + 1;
+            end
+            wb_write(32'hBC, 32'h00000000); // Release
+            wb_read(32'hBC, rd_data);
+            $display("  Snapshot of frame %0d (held=%b), %0d classified while held",
+                     snap_ctrl[31:16], snap_ctrl[1], n_results);
+            if (snap_ctrl[1] && errors == 0 && n_results >= 1 && !rd_data[1]) begin
+                $display("  PASS: Packed window matches FFT_DATA and holds while the pipeline runs");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d snapshot mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable
+
+        // ==================================================================
+        // Phase 13: Performance counters
+        // ==================================================================
+        // A burst of frames at the Phase 10 rate: FRAMES counts every
+        // classification, the stage counts add up and the LA mirrors them.
+        $display("");
+        $display("[PHASE 13] Performance counters...");
+        begin : perf_block
+            integer cyc, n_results, errors;
+            reg [31:0] f0, f1, spi_last, fft_last, fft_max, fe_last, nn_last, lat_last, drops;
+            errors = 0;
+            repeat (5000) @(posedge clk);   // Phase 12 frames drained
+            wb_read(32'h200, f0);
+            wb_write(32'h00, 32'h00000001); // Enable (divider 0, hop 16)
+            n_results = 0;
+            fork
+                begin
+                    repeat (20_000) @(posedge clk);
+                    wb_write(32'h00, 32'h00000000); // Disable, then drain
+                end
+                for (cyc = 0; cyc < 30_000; cyc = cyc + 1) begin
+                    @(posedge clk);
+                    if (la_data_out[15] === 1'b1) n_results = n_results + 1;
+                end
+            join
+            wb_read(32'h200, f1);
+            wb_read(32'h204, drops);
+            wb_read(32'h210, spi_last);
+            wb_read(32'h218, fft_last);
+            wb_read(32'h21C, fft_max);
+            wb_read(32'h220, fe_last);
+            wb_read(32'h228, nn_last);
+            wb_read(32'h230, lat_last);
+            $display("  %0d frames (%0d dropped): SPI %0d, FFT %0d (max %0d), FE %0d, NN %0d, latency %0d cycles",
+                     f1 - f0, drops, spi_last, fft_last, fft_max, fe_last, nn_last, lat_last);
+            if (f1 - f0 !== n_results || n_results < 10) errors = errors + 1;
+            if (fft_last == 0 || fft_last > fft_max || fe_last < fft_last || nn_last == 0)
+                errors = errors + 1;
+            if (lat_last < fe_last + nn_last || spi_last < 100 || spi_last > 2000)
+                errors = errors + 1;
+            if (la_data_out[47:32] !== f1[15:0] || la_data_out[63:48] !== fft_last[15:0] ||
+                la_data_out[79:64] !== nn_last[15:0])
+                errors = errors + 1;
+            wb_read(32'h21C, rd_data);      // MAX cleared by the read above
+            if (rd_data !== 32'd0) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Counters track the pipeline, MAX clears on read");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed (%0d classifications seen)", errors, n_results);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Phase 14: Overrun policies
+        // ==================================================================
+        // hop=4 hands windows over faster than the FFT takes them. Drop
+        // oldest loses windows (DROPS, overrun IRQ flag, LA bit 31); stall
+        // loses none and stalls the sampling instead.
+        $display("");
+        $display("[PHASE 14] Overrun policies at hop=4...");
+        begin : ovr_block
+            integer cyc, n_ovr, errors;
+            reg [31:0] drops0, stalls0, drops2, stalls2, f0, f1;
+            errors = 0;
+            wb_read(32'h204, rd_data);      // Clear DROPS / STALLS
+            wb_read(32'h20C, rd_data);
+            wb_write(32'h18, 32'h0000000F);
+            wb_write(32'h78, 32'h00000004); // hop=4, drop oldest
+            wb_write(32'h00, 32'h00000001);
+            n_ovr = 0;
+            for (cyc = 0; cyc < 10_000; cyc = cyc + 1) begin
+                @(posedge clk);
+                if (la_data_out[31] === 1'b1) n_ovr = n_ovr + 1;
+            end
+            wb_write(32'h00, 32'h00000000);
+            repeat (5000) @(posedge clk);
+            wb_read(32'h204, drops0);
+            wb_read(32'h20C, stalls0);
+            wb_read(32'h18, rd_data);
+            if (drops0 == 0 || stalls0 != 0 || !rd_data[3] || n_ovr == 0) errors = errors + 1;
+
+            wb_write(32'h18, 32'h0000000F);
+            wb_write(32'h78, 32'h00002004); // hop=4, stall
+            wb_read(32'h200, f0);
+            wb_write(32'h00, 32'h00000001);
+            repeat (20_000) @(posedge clk);
+            wb_write(32'h00, 32'h00000000);
+            repeat (5000) @(posedge clk);
+            wb_read(32'h200, f1);
+            wb_read(32'h204, drops2);
+            wb_read(32'h20C, stalls2);
+            $display("  Drop oldest: %0d drops, %0d overrun events; stall: %0d frames, %0d drops, %0d stalls",
+                     drops0, n_ovr, f1 - f0, drops2, stalls2);
+            if (drops2 != 0 || stalls2 == 0 || f1 - f0 < 10) errors = errors + 1;
+            wb_write(32'h78, 32'h00000040); // Back to the defaults
+            wb_write(32'h18, 32'h0000000F);
+            if (errors == 0) begin
+                $display("  PASS: Drop oldest flags lost windows, stall loses none");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Phase 15: Spectral averaging
+        // ==================================================================
+        // AVG_CFG shift 2, every 4th frame: the windows of phase 10 still
+        // all go through the FFT, but only one in four is classified.
+        $display("");
+        $display("[PHASE 15] Spectral averaging, one result per 4 windows...");
+        wb_write(32'h1C, 32'h00000000); // divider=0 (fastest SPI)
+        wb_write(32'h78, 32'h00000010); // hop=16
+        wb_write(32'hCC, 32'h00000302); // shift 2, classify every 4 frames
+        wb_read(32'hCC, rd_data);
+        wb_write(32'h00, 32'h00000001); // Enable
+        begin : avg_block
+            integer cyc;
+            integer n_frames;
+            integer n_results;
+            cyc = 0;
+            while (la_data_out[15] !== 1'b1 && cyc < 500_000) begin
+                @(posedge clk);
+                cyc = cyc + 1;
+            end
+            n_frames  = 0;
+            n_results = 0;
+            for (cyc = 0; cyc < 20_000; cyc = cyc + 1) begin
+                @(posedge clk);
+                if (la_data_out[22] === 1'b1) n_frames  = n_frames + 1;  // samples_valid
+                if (la_data_out[15] === 1'b1) n_results = n_results + 1; // nn_done
+            end
+            $display("  AVG_CFG = 0x%08h: %0d windows handed over, %0d classified",
+                     rd_data, n_frames, n_results);
+            if (rd_data == 32'h00000302 && n_frames > 10 &&
+                4 * n_results <= n_frames + 4 && 4 * n_results + 8 >= n_frames) begin
+                $display("  PASS: One classification per 4 averaged frames");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected about %0d results", n_frames / 4);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable
+        wb_write(32'hCC, 32'h00000000); // Averaging off
+
+        // ==================================================================
+        // Phase 16: Change-gated inference
+        // ==================================================================
+        // GATE_CFG threshold above any distance, at most 3 skips in a row:
+        // every frame gets a result, the NN runs on one in four (nn_done on
+        // LA bit 15) and the rest count in SKIPS.
+        $display("");
+        $display("[PHASE 16] Change-gated inference, NN on one frame in 4...");
+        begin : gate_block
+            integer cyc, n_runs;
+            reg [31:0] f0, f1, skips;
+            repeat (5000) @(posedge clk);   // Phase 15 frames drained
+            wb_read(32'h238, rd_data);      // Clear SKIPS
+            wb_read(32'h200, f0);
+            wb_write(32'hD0, 32'h00030FFF); // Threshold 4095, 3 skips at most
+            wb_write(32'h00, 32'h00000001); // Enable (divider 0, hop 16)
+            n_runs = 0;
+            fork
+                begin
+                    repeat (20_000) @(posedge clk);
+                    wb_write(32'h00, 32'h00000000); // Disable, then drain
+                end
+                for (cyc = 0; cyc < 30_000; cyc = cyc + 1) begin
+                    @(posedge clk);
+                    if (la_data_out[15] === 1'b1) n_runs = n_runs + 1;
+                end
+            join
+            wb_read(32'h200, f1);
+            wb_read(32'h238, skips);
+            $display("  %0d frames classified: %0d NN runs, %0d reused", f1 - f0, n_runs, skips);
+            // The first frame and one drained after the disable run too
+            if (n_runs >= 3 && f1 - f0 == n_runs + skips &&
+                skips <= 3 * n_runs && skips + 6 >= 3 * n_runs) begin
+                $display("  PASS: Skipped frames reuse the last result");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected 3 skips per NN run");
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'hD0, 32'h00000000); // Gate off
+
+        // ==================================================================
+        // Phase 17: Three ADC channels
+        // ==================================================================
+        // FRAME_CFG.CH = 2: every set of windows is classified once per
+        // channel, in channel order, the three results sharing the frame
+        // number (stall: no set is lost part way)
+        $display("");
+        $display("[PHASE 17] Three ADC channels, one result each per frame...");
+        begin : ch_block
+            integer cyc, k, errors;
+            reg [31:0] res [0:5];
+            reg [1:0]  ch  [0:5];
+            errors = 0;
+            repeat (5000) @(posedge clk);
+            wb_write(32'hB0, 32'h00000100); // Flush the result FIFO
+            wb_write(32'h78, 32'h00022010); // hop=16, stall, 3 channels
+            if (io_oeb[8] !== 1'b0 || io_oeb[9] !== 1'b0 || io_oeb[10] !== 1'b1) begin
+                $display("  io_oeb[10:8] = %b (expect 100)", io_oeb[10:8]);
+                errors = errors + 1;
+            end
+            wb_write(32'h00, 32'h00000001); // Enable
+            cyc = 0;
+            rd_data = 0;
+            while (rd_data[12:8] < 6 && cyc < 2000) begin
+                wb_read(32'h04, rd_data);
+                cyc = cyc + 1;
+            end
+            wb_write(32'h00, 32'h00000000); // Disable, then drain
+            repeat (5000) @(posedge clk);
+            for (k = 0; k < 6; k = k + 1) begin
+                wb_read(32'hA8, res[k]);
+                wb_read(32'hD4, rd_data);
+                ch[k] = rd_data[1:0];
+                $display("  result %0d: class %0d, frame %0d, channel %0d", k,
+                         res[k][1:0], res[k][31:16], ch[k]);
+                if (!res[k][11] || ch[k] != k % 3 ||
+                    res[k][31:16] != res[k - k % 3][31:16])
+                    errors = errors + 1;
+            end
+            if (res[3][31:16] <= res[0][31:16]) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Channels 0, 1, 2 of each frame in turn");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h78, 32'h00000010); // One channel, hop=16
+
+        // ==================================================================
+        // Phase 18: Bus samples
+        // ==================================================================
+        // CTRL.INJECT: the 64 samples of the ADC model written to SAMPLE_IN
+        // make one window and one result, with the SPI bus quiet; 16 more
+        // and CTRL.TRIG classify the newest 64 at once
+        $display("");
+        $display("[PHASE 18] Bus samples and the software trigger...");
+        begin : inject_block
+            integer k, n_cs, errors;
+            reg [31:0] res0, res1;
+            errors = 0;
+            repeat (5000) @(posedge clk);
+            wb_write(32'hB0, 32'h00000100); // Flush the result FIFO
+            wb_write(32'h78, 32'h00000040); // hop=64
+            wb_write(32'h00, 32'h00000003); // Enable, samples from SAMPLE_IN
+            n_cs = cs_falls;
+            for (k = 0; k < 64; k = k + 1)
+                wb_write(32'hDC, {20'd0, adc_data[k]});
+            repeat (5000) @(posedge clk);
+            wb_read(32'h04, rd_data);
+            if (rd_data[12:8] != 5'd1) errors = errors + 1;
+            for (k = 0; k < 16; k = k + 1)
+                wb_write(32'hDC, {20'd0, adc_data[k]});
+            wb_write(32'h00, 32'h00000007); // TRIG
+            repeat (5000) @(posedge clk);
+            wb_read(32'hA8, res0);
+            wb_read(32'hA8, res1);
+            $display("  result 0: class %0d, frame %0d; result 1: class %0d, frame %0d",
+                     res0[1:0], res0[31:16], res1[1:0], res1[31:16]);
+            $display("  %0d conversions on the SPI bus", cs_falls - n_cs);
+            if (!res0[11] || !res1[11] || res1[31:16] != res0[31:16] + 16'd1 ||
+                cs_falls != n_cs)
+                errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Two windows of bus samples classified, SPI idle");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable, back to the ADC
+
+        // ==================================================================
+        // Phase 19: Resident models back to back
+        // ==================================================================
+        // Bank 0 holds the boot model since phase 11 and bank 1 gets the
+        // phase 1 weights. MODEL_CFG.ALL with LAST = 1 classifies every
+        // window on both: two results per frame, bank 0 then bank 1 in
+        // RES_FIFO_CH[5:4], nothing reloaded in between.
+        $display("");
+        $display("[PHASE 19] Two resident models on every window...");
+        begin : model_block
+            integer cyc, k, errors;
+            reg [31:0] res [0:3];
+            reg [1:0]  bank [0:3];
+            errors = 0;
+            repeat (5000) @(posedge clk);
+            wb_load_weights;                // Shadow bank 1
+            wb_write(32'hB0, 32'h00000100); // Flush the result FIFO
+            wb_write(32'h78, 32'h00002040); // hop=64, stall
+            wb_write(32'hE0, 32'h00000012); // ALL, banks 0-1
+            wb_write(32'h00, 32'h00000001); // Enable
+            cyc = 0;
+            rd_data = 0;
+            while (rd_data[12:8] < 4 && cyc < 2000) begin
+                wb_read(32'h04, rd_data);
+                cyc = cyc + 1;
+            end
+            wb_write(32'h00, 32'h00000000); // Disable, then drain
+            repeat (5000) @(posedge clk);
+            for (k = 0; k < 4; k = k + 1) begin
+                wb_read(32'hA8, res[k]);
+                wb_read(32'hD4, rd_data);
+                bank[k] = rd_data[5:4];
+                $display("  result %0d: class %0d, conf %0d, frame %0d, bank %0d", k,
+                         res[k][1:0], res[k][9:2], res[k][31:16], bank[k]);
+                if (!res[k][11] || res[k][14] || bank[k] != k % 2 ||
+                    res[k][31:16] != res[k - k % 2][31:16])
+                    errors = errors + 1;
+            end
+            if (res[2][31:16] <= res[0][31:16]) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Banks 0 and 1 on each frame in turn");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'hE0, 32'h00000000); // One model, the active bank
+        wb_write(32'h78, 32'h00000040);
+
+        // ==================================================================
+        // Phase 20: Bus samples against a held snapshot
+        // ==================================================================
+        // Stall policy with a snapshot held: the FFT waits for the release,
+        // windows back up and sampling stalls. SAMPLE_IN writes must still
+        // be acked (the CPU can then release the snapshot); the samples
+        // spi_adc_if cannot take are dropped and counted in PERF_REJECTS,
+        // and SAMPLE_IN[0] reads 0 until the release.
+        $display("");
+        $display("[PHASE 20] SAMPLE_IN with stall and a held snapshot...");
+        begin : inj_stall_block
+            integer k, errors;
+            reg [31:0] snap_ctrl, ready0, rejects;
+            errors = 0;
+            repeat (5000) @(posedge clk);
+            wb_read(32'h23C, rd_data);      // Clear REJECTS
+            wb_write(32'hB0, 32'h00000100); // Flush the result FIFO
+            wb_write(32'h78, 32'h00002040); // hop=64, stall
+            wb_write(32'h00, 32'h00000003); // Enable, samples from SAMPLE_IN
+            wb_write(32'hBC, 32'h00000001); // Take the next frame
+            for (k = 0; k < 64; k = k + 1) begin
+                rd_data = 0;
+                while (!rd_data[0])
+                    wb_read(32'hDC, rd_data);
+                wb_write(32'hDC, {20'd0, adc_data[k]});
+            end
+            snap_ctrl = 0;
+            for (k = 0; k < 1000 && !snap_ctrl[1]; k = k + 1)
+                wb_read(32'hBC, snap_ctrl);
+            // Unthrottled: every write acked, the surplus rejected
+            for (k = 0; k < 400; k = k + 1)
+                wb_write(32'hDC, {20'd0, adc_data[k % 64]});
+            wb_read(32'hDC, ready0);
+            wb_read(32'h23C, rejects);
+            wb_write(32'hBC, 32'h00000000); // Release
+            repeat (5000) @(posedge clk);
+            wb_read(32'hDC, rd_data);
+            $display("  snapshot held=%b, %0d samples rejected, ready %b held / %b released",
+                     snap_ctrl[1], rejects, ready0[0], rd_data[0]);
+            if (!snap_ctrl[1] || rejects == 0 || ready0[0] || !rd_data[0])
+                errors = errors + 1;
+            wb_read(32'h04, rd_data);
+            if (rd_data[12:8] == 5'd0) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: SAMPLE_IN acked under a stall, rejects counted, release works");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d checks failed", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        wb_write(32'h00, 32'h00000000); // Disable, back to the ADC
+        wb_write(32'h78, 32'h00000040);
+
         // --- Summary ---
         $display("");
         $display("==========================================");
@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: Apache-2.0
+// Testbench: Spectral Averaging
+// Tests:
+//   1. avg_shift 0: bins pass through unchanged, one clock later
+//   2. Exponential average: the first frame fills, later ones blend by 1/4
+//   3. A constant spectrum is reached to within one LSB
+//   4. avg_every 3: only every 4th frame is published and streamed on
+//   5. An FFT length change or a disable restarts the average
+//   6. Two channels keep separate averages
+// The DUT is built for up to 128-point spectra (LOG2_NMAX = 7) and two
+// channels. Bins are streamed from in_mem the way the FFT magnitude pass
+// produces them.
+
+`timescale 1ns / 1ps
+
+module tb_spec_avg;
+
+    // --- Clock and Reset ---
+    reg clk;
+    reg rst;
+
+    initial clk = 0;
+    always #20 clk = ~clk; // 25 MHz
+
+    // --- DUT signals ---
+    reg         enable;
+    reg  [2:0]  avg_shift;
+    reg  [3:0]  avg_every;
+    reg         start;
+    reg  [1:0]  fft_size;
+    reg  [1:0]  ch;
+    wire        publish;
+    reg         in_valid;
+    reg  [5:0]  in_idx;
+    reg  [15:0] in_mag;
+    wire        out_valid;
+    wire [5:0]  out_idx;
+    wire [15:0] out_mag;
+
+    // --- DUT ---
+    spec_avg #(
+        .LOG2_NMAX  (7),
+        .N_CH       (2)
+    ) dut (
+        .clk        (clk),
+        .rst        (rst),
+        .enable     (enable),
+        .avg_shift  (avg_shift),
+        .avg_every  (avg_every),
+        .start      (start),
+        .fft_size   (fft_size),
+        .ch         (ch),
+        .publish    (publish),
+        .in_valid   (in_valid),
+        .in_idx     (in_idx),
+        .in_mag     (in_mag),
+        .out_valid  (out_valid),
+        .out_idx    (out_idx),
+        .out_mag    (out_mag)
+    );
+
+    // --- Stream capture ---
+    // out_mem[k] is the last bin k streamed on; out_n counts them and
+    // out_bad counts bins out of order
+    reg [15:0] in_mem  [0:63];
+    reg [15:0] out_mem [0:63];
+    integer    out_n;
+    integer    out_bad;
+    integer    out_next;
+
+    always @(posedge clk) begin
+        if (out_valid) begin
+            out_mem[out_idx] <= out_mag;
+            if (out_idx != out_next[5:0])
+                out_bad = out_bad + 1;
+            out_next = out_next + 1;
+            out_n    = out_n + 1;
+        end
+    end
+
+    // --- Tasks ---
+    reg pub_seen;           // publish at the start of the last frame
+
+    // One frame of n_bins bins from in_mem
+    task run_frame;
+        input integer n_bins;
+        integer b;
+        begin
+            out_n    = 0;
+            out_bad  = 0;
+            out_next = 0;
+            @(posedge clk);
+            start    <= 1;
+            pub_seen <= publish;
+            @(posedge clk);
+            start <= 0;
+            repeat (4) @(posedge clk);
+            for (b = 0; b < n_bins; b = b + 1) begin
+                in_valid <= 1;
+                in_idx   <= b[5:0];
+                in_mag   <= in_mem[b];
+                @(posedge clk);
+            end
+            in_valid <= 0;
+            repeat (4) @(posedge clk);
+        end
+    endtask
+
+    task fill_bins;
+        input [15:0] base;
+        input [15:0] step;
+        integer b;
+        begin
+            for (b = 0; b < 64; b = b + 1)
+                in_mem[b] = base + step * b;
+        end
+    endtask
+
+    // --- Test sequence ---
+    integer pass_count;
+    integer fail_count;
+    integer i;
+    integer errors;
+
+    initial begin
+        $dumpfile("tb_spec_avg.vcd");
+        $dumpvars(0, tb_spec_avg);
+
+        pass_count = 0;
+        fail_count = 0;
+
+        rst       = 1;
+        enable    = 1;
+        avg_shift = 3'd0;
+        avg_every = 4'd0;
+        start     = 0;
+        fft_size  = 2'd0;
+        ch        = 2'd0;
+        in_valid  = 0;
+        in_idx    = 0;
+        in_mag    = 0;
+        out_n     = 0;
+        out_bad   = 0;
+        out_next  = 0;
+
+        repeat (10) @(posedge clk);
+        rst = 0;
+        repeat (5) @(posedge clk);
+
+        // ==================================================================
+        // Test 1: Pass-through
+        // ==================================================================
+        $display("");
+        $display("[TEST 1] avg_shift 0: spectrum passes through");
+        fill_bins(16'd100, 16'd37);
+        run_frame(32);
+        fill_bins(16'd5000, 16'd3);
+        run_frame(32);
+        errors = 0;
+        for (i = 0; i < 32; i = i + 1)
+            if (out_mem[i] !== in_mem[i]) errors = errors + 1;
+        if (pub_seen && out_n == 32 && out_bad == 0 && errors == 0) begin
+            $display("  PASS: 32 bins in order, unchanged");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d bins, %0d out of order, %0d changed", out_n, out_bad, errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 2: Exponential average, weight 1/4
+        // ==================================================================
+        // 1000, then 2000 twice: 1000, 1250, 1437 (1437.5 truncated)
+        $display("");
+        $display("[TEST 2] avg_shift 2: fill, then blend by 1/4");
+        avg_shift = 3'd2;
+        fill_bins(16'd1000, 16'd0);
+        run_frame(32);
+        errors = (out_mem[0] != 16'd1000 || out_mem[31] != 16'd1000);
+        fill_bins(16'd2000, 16'd0);
+        run_frame(32);
+        if (out_mem[0] != 16'd1250 || out_mem[31] != 16'd1250) errors = errors + 1;
+        run_frame(32);
+        $display("    Frame 3 bin 0 = %0d, bin 31 = %0d", out_mem[0], out_mem[31]);
+        if (out_mem[0] != 16'd1437 || out_mem[31] != 16'd1437) errors = errors + 1;
+        if (errors == 0 && out_n == 32) begin
+            $display("  PASS: 1000 -> 1250 -> 1437");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d frames off", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 3: Convergence
+        // ==================================================================
+        $display("");
+        $display("[TEST 3] avg_shift 3: a constant spectrum is reached");
+        avg_shift = 3'd3;
+        fill_bins(16'd3000, 16'd100);
+        for (i = 0; i < 120; i = i + 1)
+            run_frame(32);
+        errors = 0;
+        for (i = 0; i < 32; i = i + 1)
+            if (out_mem[i] > in_mem[i] || out_mem[i] + 16'd1 < in_mem[i])
+                errors = errors + 1;
+        if (errors == 0) begin
+            $display("  PASS: All bins within one LSB (bin 0 = %0d)", out_mem[0]);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d bins off (bin 0 = %0d)", errors, out_mem[0]);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 4: Decimation
+        // ==================================================================
+        $display("");
+        $display("[TEST 4] avg_every 3: every 4th frame published");
+        avg_every = 4'd3;
+        // Let the frame counter line up with a published frame
+        pub_seen = 0;
+        while (!pub_seen)
+            run_frame(32);
+        errors = 0;
+        for (i = 0; i < 8; i = i + 1) begin
+            run_frame(32);
+            if (pub_seen != (i % 4 == 3) || out_n != (pub_seen ? 32 : 0)) begin
+                $display("    frame %0d: publish %b, %0d bins", i, pub_seen, out_n);
+                errors = errors + 1;
+            end
+        end
+        if (errors == 0) begin
+            $display("  PASS: Frames 4 and 8 streamed, the rest held back");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Wrong publish pattern");
+            fail_count = fail_count + 1;
+        end
+        avg_every = 4'd0;
+
+        // ==================================================================
+        // Test 5: Restart on a length change and on disable
+        // ==================================================================
+        $display("");
+        $display("[TEST 5] FFT length change and disable restart the average");
+        errors = 0;
+        fft_size = 2'd1;                // 64 bins
+        fill_bins(16'd800, 16'd1);
+        run_frame(64);
+        if (out_n != 64 || out_mem[0] != 16'd800 || out_mem[63] != 16'd863) begin
+            $display("    128-point: %0d bins, bin 0 = %0d, bin 63 = %0d", out_n,
+                     out_mem[0], out_mem[63]);
+            errors = errors + 1;
+        end
+        enable = 0;
+        repeat (2) @(posedge clk);
+        enable = 1;
+        fill_bins(16'd40000, 16'd0);
+        run_frame(64);
+        if (out_mem[0] != 16'd40000 || out_mem[63] != 16'd40000) begin
+            $display("    after disable: bin 0 = %0d, bin 63 = %0d", out_mem[0], out_mem[63]);
+            errors = errors + 1;
+        end
+        if (errors == 0) begin
+            $display("  PASS: First frame of each restart taken as is");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Average carried across a restart");
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 6: Per-channel averages
+        // ==================================================================
+        // Channel 0: 1000, then 2000 -> 1250; channel 1 stays at 3000 in
+        // between, each filled by its own first frame
+        $display("");
+        $display("[TEST 6] Two channels: separate averages");
+        errors   = 0;
+        fft_size = 2'd0;
+        enable   = 0;
+        repeat (2) @(posedge clk);
+        enable   = 1;
+        avg_shift = 3'd2;
+        ch = 2'd0; fill_bins(16'd1000, 16'd0); run_frame(32);
+        if (out_mem[0] != 16'd1000) errors = errors + 1;
+        ch = 2'd1; fill_bins(16'd3000, 16'd0); run_frame(32);
+        if (out_mem[0] != 16'd3000) errors = errors + 1;
+        ch = 2'd0; fill_bins(16'd2000, 16'd0); run_frame(32);
+        $display("    channel 0 bin 0 = %0d", out_mem[0]);
+        if (out_mem[0] != 16'd1250 || out_mem[31] != 16'd1250) errors = errors + 1;
+        ch = 2'd1; fill_bins(16'd3000, 16'd0); run_frame(32);
+        $display("    channel 1 bin 0 = %0d", out_mem[0]);
+        if (out_mem[0] != 16'd3000 || out_mem[31] != 16'd3000) errors = errors + 1;
+        ch = 2'd0;
+        if (errors == 0) begin
+            $display("  PASS: No mixing between the channels");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d frames off", errors);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Summary ---
+        $display("");
+        $display("==========================================");
+        $display("  Spectral Averaging Testbench Results");
+        $display("  PASSED: %0d  FAILED: %0d", pass_count, fail_count);
+        $display("==========================================");
+        if (fail_count > 0) $display("  *** TEST FAILED ***");
+        else                $display("  *** ALL TESTS PASSED ***");
+
+        #100;
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #50_000_000;
+        $display("WATCHDOG: Simulation timeout");
+        $finish;
+    end
+
+endmodule
@@ -1,7 +1,15 @@
 // SPDX-License-Identifier: Apache-2.0
 // Testbench: SPI ADC Interface
 // Simulates an MCP3201-style 12-bit ADC responding over SPI
-// Verifies sample collection and buffer fill signaling
+// Verifies sample collection, buffer fill signaling, ping-pong banking,
+// overlapped (hop < 64) frame handover and the overrun policies (drop
+// oldest, drop newest, stall). The DUT is built for windows up to 128
+// samples (LOG2_NMAX = 7) to cover the runtime length select. win_busy
+// stands in for the consumer's waiting-window flag. A second DUT built for
+// 3 channels (N_CH = 3) checks round-robin sampling into per-channel
+// windows, one ADC model per chip select on the shared MISO. The last tests
+// run the sample timer (sample_period) against the bit clock and feed
+// samples from the bus (inject) instead of the ADC.
 
 `timescale 1ns / 1ps
 
@@ -17,26 +25,58 @@ module tb_spi_adc_if;
     // --- DUT signals ---
     reg         enable;
     reg  [15:0] clk_div;
+    reg  [23:0] sample_period;
+    reg         inject;
+    reg         inj_valid;
+    reg  [11:0] inj_data;
+    wire        inj_ready;
+    reg         sw_trig;
+    reg  [8:0]  hop_size;
+    reg  [1:0]  fft_size;
     wire        spi_clk;
     wire        spi_cs_n;
     reg         spi_miso;
     wire        samples_valid;
     wire [15:0] sample_out;
-    reg  [5:0]  sample_addr;
+    reg  [6:0]  sample_addr;
+    wire [7:0]  frame_base;
+    wire [1:0]  frame_size;
+    reg         bank_lock;
+    reg  [1:0]  ovr_mode;
+    reg         win_busy;
+    wire        win_drop;
+    wire        win_stall;
     wire [5:0]  sample_count;
 
     // --- DUT ---
-    spi_adc_if dut (
+    spi_adc_if #(.LOG2_NMAX(7)) dut (
         .clk          (clk),
         .rst          (rst),
         .enable       (enable),
         .clk_div      (clk_div),
+        .sample_period(sample_period),
+        .hop_size     (hop_size),
+        .fft_size     (fft_size),
+        .ovr_mode     (ovr_mode),
+        .n_ch         (2'd0),
+        .inject       (inject),
+        .inj_valid    (inj_valid),
+        .inj_data     (inj_data),
+        .inj_ready    (inj_ready),
+        .sw_trig      (sw_trig),
         .spi_clk      (spi_clk),
         .spi_cs_n     (spi_cs_n),
         .spi_miso     (spi_miso),
         .samples_valid(samples_valid),
         .sample_out   (sample_out),
         .sample_addr  (sample_addr),
+        .sample_ch    (2'd0),
+        .frame_base   (frame_base),
+        .frame_size   (frame_size),
+        .bank_lock    (bank_lock),
+        .win_busy     (win_busy),
+        .win_drop     (win_drop),
+        .win_stall    (win_stall),
         .sample_count (sample_count)
     );
 
@@ -83,6 +123,180 @@ module tb_spi_adc_if;
         spi_miso <= 1'bz;
     end
 
+    // --- Multi-channel DUT ---
+    reg         mc_enable;
+    reg  [1:0]  mc_n_ch;
+    wire        mc_spi_clk;
+    wire [2:0]  mc_cs_n;
+    reg         mc_miso;
+    wire        mc_valid;
+    wire [15:0] mc_sample;
+    reg  [5:0]  mc_addr;
+    reg  [1:0]  mc_ch;
+    reg         mc_lock;
+
+    spi_adc_if #(.LOG2_NMAX(6), .N_CH(3)) dut_mc (
+        .clk          (clk),
+        .rst          (rst),
+        .enable       (mc_enable),
+        .clk_div      (16'd4),
+        .sample_period(24'd0),
+        .hop_size     (9'd64),
+        .fft_size     (2'd0),
+        .ovr_mode     (2'd0),
+        .n_ch         (mc_n_ch),
+        .inject       (1'b0),
+        .inj_valid    (1'b0),
+        .inj_data     (12'd0),
+        .inj_ready    (),
+        .sw_trig      (1'b0),
+        .spi_clk      (mc_spi_clk),
+        .spi_cs_n     (mc_cs_n),
+        .spi_miso     (mc_miso),
+        .samples_valid(mc_valid),
+        .sample_out   (mc_sample),
+        .sample_addr  (mc_addr),
+        .sample_ch    (mc_ch),
+        .frame_base   (),
+        .frame_size   (),
+        .bank_lock    (mc_lock),
+        .win_busy     (1'b0),
+        .win_drop     (),
+        .win_stall    (),
+        .sample_count ()
+    );
+
+    // ADC c returns 500 * (c + 1) + its conversion count (mod 256)
+    reg [15:0] mc_shift;
+    reg [4:0]  mc_bit;
+    integer    mc_cnt [0:2];
+    integer    mc_overlap;          // Chip selects low at the same time
+
+    task mc_convert;
+        input integer c;
+        reg [11:0] v;
+        begin
+            v        = 500 * (c + 1) + mc_cnt[c] % 256;
+            mc_shift = {3'b000, v, 1'b0};
+            mc_bit   = 0;
+            mc_cnt[c] = mc_cnt[c] + 1;
+        end
+    endtask
+
+    initial begin
+        mc_cnt[0]  = 0;
+        mc_cnt[1]  = 0;
+        mc_cnt[2]  = 0;
+        mc_overlap = 0;
+    end
+
+    always @(negedge mc_cs_n[0]) mc_convert(0);
+    always @(negedge mc_cs_n[1]) mc_convert(1);
+    always @(negedge mc_cs_n[2]) mc_convert(2);
+
+    always @(posedge mc_spi_clk) begin
+        if (mc_cs_n != 3'b111) begin
+            mc_miso <= mc_shift[15 - mc_bit];
+            mc_bit  <= mc_bit + 1;
+        end
+    end
+
+    always @(posedge clk)
+        if (mc_cs_n != 3'b111 && mc_cs_n != 3'b110 && mc_cs_n != 3'b101 && mc_cs_n != 3'b011)
+            mc_overlap = mc_overlap + 1;
+
+    // --- Event counters ---
+    integer valid_n;
+    integer drop_n;
+    integer stall_n;
+    integer cs_n;                   // Conversions started
+
+    initial begin
+        valid_n = 0;
+        drop_n  = 0;
+        stall_n = 0;
+    end
+
+    always @(posedge clk) begin
+        if (samples_valid === 1'b1) valid_n = valid_n + 1;
+        if (win_drop === 1'b1)      drop_n  = drop_n + 1;
+        if (win_stall === 1'b1)     stall_n = stall_n + 1;
+    end
+
+    initial cs_n = 0;
+    always @(negedge spi_cs_n) cs_n = cs_n + 1;
+
+    // Clocks between chip select falling edges, smallest and largest since
+    // gap_min was set high
+    integer clk_n;
+    integer cs_last;
+    integer gap_min;
+    integer gap_max;
+
+    initial begin
+        clk_n   = 0;
+        cs_last = -1;
+        gap_min = 32'h7FFF_FFFF;
+        gap_max = 0;
+    end
+
+    always @(posedge clk) clk_n = clk_n + 1;
+
+    always @(negedge spi_cs_n) begin
+        if (cs_last >= 0) begin
+            if (clk_n - cs_last < gap_min) gap_min = clk_n - cs_last;
+            if (clk_n - cs_last > gap_max) gap_max = clk_n - cs_last;
+        end
+        cs_last = clk_n;
+    end
+
+    // Clear the counters, then run n clocks
+    task count_clk;
+        input integer n;
+        begin
+            valid_n = 0;
+            drop_n  = 0;
+            stall_n = 0;
+            cs_n    = 0;
+            repeat (n) @(posedge clk);
+        end
+    endtask
+
+    // One bus sample, once the DUT takes it
+    task inj_push;
+        input [11:0] code;
+        begin
+            @(negedge clk);
+            while (inj_ready !== 1'b1) @(negedge clk);
+            inj_data  = code;
+            inj_valid = 1;
+            @(negedge clk);
+            inj_valid = 0;
+        end
+    endtask
+
+    // Bus sample k of the test pattern (both signs)
+    function [11:0] inj_code;
+        input integer k;
+        begin
+            inj_code = k * 197 + 5;
+        end
+    endfunction
+
+    // Up to the clock after the next samples_valid
+    task wait_valid;
+        integer wait_cnt;
+        begin
+            wait_cnt = 0;
+            @(posedge clk);
+            while (samples_valid !== 1'b1 && wait_cnt < 500000) begin
+                @(posedge clk);
+                wait_cnt = wait_cnt + 1;
+            end
+            @(posedge clk);
+        end
+    endtask
+
     // --- Test sequence ---
     integer pass_count;
     integer fail_count;
@@ -99,8 +313,24 @@ module tb_spi_adc_if;
         rst         = 1;
         enable      = 0;
         clk_div     = 16'd4;  // Fast SPI for simulation
+        sample_period = 24'd0;  // Free running
+        inject      = 0;      // Samples from the ADC
+        inj_valid   = 0;
+        inj_data    = 0;
+        sw_trig     = 0;
+        hop_size    = 9'd64;  // Non-overlapped frames
+        fft_size    = 2'd0;   // 64-sample windows
         spi_miso    = 0;
         sample_addr = 0;
+        bank_lock   = 0;
+        ovr_mode    = 2'd0;   // Drop oldest
+        win_busy    = 0;
+        mc_enable   = 0;
+        mc_n_ch     = 2'd2;   // 3 channels
+        mc_miso     = 0;
+        mc_addr     = 0;
+        mc_ch       = 0;
+        mc_lock     = 0;
 
         // Reset
         repeat (10) @(posedge clk);
@@ -149,6 +379,8 @@ module tb_spi_adc_if;
         enable = 0;
         repeat (10) @(posedge clk);
 
+        // The ring is read through its synchronous port, enabled by bank_lock
+        bank_lock = 1;
         begin : verify_block
             reg test3_pass;
             test3_pass = 0;
@@ -166,6 +398,7 @@ module tb_spi_adc_if;
                 fail_count = fail_count + 1;
             end
         end
+        bank_lock = 0;
 
         // --- Test 4: Second collection cycle ---
         $display("[TEST 4] Second collection cycle");
@@ -192,6 +425,388 @@ module tb_spi_adc_if;
             fail_count = fail_count + 1;
         end
 
+        // --- Test 5: Second frame lands in the other bank ---
+        $display("[TEST 5] Ping-pong bank swap");
+        @(posedge clk);
+        if (frame_base === 7'd64) begin
+            $display("  PASS: Second frame handed over in bank 1");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Expected frame_base=64 after second frame, got %0d", frame_base);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Test 6: No handover while locked ---
+        // Hold bank_lock across a few frames: frame_base must stay stable,
+        // the due window waits, and each one replaced while waiting is
+        // flagged on win_drop.
+        $display("[TEST 6] Bank lock holds the handover back");
+        bank_lock = 1;
+        count_clk(30000);
+        if (valid_n == 0 && frame_base === 7'd64 && drop_n >= 1) begin
+            $display("  PASS: No handover while locked (frame_base=%0d, %0d drops)",
+                     frame_base, drop_n);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d handovers while locked, frame_base=%0d, %0d drops",
+                     valid_n, frame_base, drop_n);
+            fail_count = fail_count + 1;
+        end
+        bank_lock = 0;
+
+        begin : wait_samples_valid_3
+            integer wait_cnt;
+            wait_cnt = 0;
+            while (samples_valid !== 1'b1 && wait_cnt < 500000) begin
+                @(posedge clk);
+                wait_cnt = wait_cnt + 1;
+            end
+        end
+        @(posedge clk);
+        if (frame_base[5:0] === 6'd0) begin
+            $display("  PASS: Handover resumes after unlock (frame_base=%0d)", frame_base);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Expected a bank-aligned frame_base after unlock, got %0d",
+                     frame_base);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Test 7: Overlapped frames with hop_size = 16 ---
+        // After the window is full, a new frame must be handed over every
+        // 16 samples and frame_base must advance by exactly 16.
+        $display("[TEST 7] Hop size 16 (75%% overlap)");
+        hop_size = 9'd16;
+        begin : hop_block
+            integer   wait_cnt;
+            integer   samples_between;
+            reg [6:0] prev_base;
+            reg [6:0] prev_count;
+            // Align to the next handover
+            wait_cnt = 0;
+            while (samples_valid !== 1'b1 && wait_cnt < 500000) begin
+                @(posedge clk);
+                wait_cnt = wait_cnt + 1;
+            end
+            @(posedge clk);
+            prev_base  = frame_base;
+            prev_count = {1'b0, sample_count};
+            // Wait for the following handover
+            @(posedge clk);
+            wait_cnt = 0;
+            while (samples_valid !== 1'b1 && wait_cnt < 500000) begin
+                @(posedge clk);
+                wait_cnt = wait_cnt + 1;
+            end
+            @(posedge clk);
+            samples_between = (sample_count - prev_count[5:0]) & 6'h3F;
+            $display("  frame_base %0d -> %0d, %0d new samples", prev_base, frame_base,
+                     samples_between);
+            if (((frame_base - prev_base) & 7'h7F) == 7'd16 && samples_between == 16) begin
+                $display("  PASS: Frame handed over every 16 samples");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected a 16-sample hop");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 8: 128-sample windows ---
+        // With fft_size = 1 and hop_size = 0 (one full window) consecutive
+        // handovers must be 128 samples apart and tagged with their size.
+        $display("[TEST 8] 128-sample windows (fft_size = 1)");
+        fft_size = 2'd1;
+        hop_size = 9'd0;
+        begin : size_block
+            integer   wait_cnt;
+            integer   n;
+            reg [7:0] prev_base;
+            // Skip the first handover after the change, then measure
+            for (n = 0; n < 3; n = n + 1) begin
+                if (n == 2) prev_base = frame_base;
+                @(posedge clk);
+                wait_cnt = 0;
+                while (samples_valid !== 1'b1 && wait_cnt < 500000) begin
+                    @(posedge clk);
+                    wait_cnt = wait_cnt + 1;
+                end
+                @(posedge clk);
+            end
+            $display("  frame_base %0d -> %0d, frame_size=%0d", prev_base, frame_base,
+                     frame_size);
+            if (frame_base - prev_base == 8'd128 && frame_size == 2'd1) begin
+                $display("  PASS: 128-sample window every 128 samples");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected a 128-sample hop with frame_size=1");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 9: Drop newest ---
+        // With a window waiting, new ones are discarded (win_drop) and
+        // frame_base keeps the waiting window until the consumer takes it.
+        $display("[TEST 9] Overrun policy: drop newest");
+        fft_size = 2'd0;
+        hop_size = 9'd16;
+        ovr_mode = 2'd1;
+        wait_valid;
+        begin : newest_block
+            reg [6:0] held_base;
+            held_base = frame_base;
+            win_busy  = 1;
+            // ~40 samples: two or three hops, well before the writer
+            // reaches the waiting window
+            count_clk(40 * 180);
+            $display("  %0d handovers, %0d drops, frame_base %0d", valid_n, drop_n,
+                     frame_base);
+            win_busy = 0;
+            if (valid_n == 0 && drop_n >= 2 && frame_base === held_base) begin
+                wait_valid;
+                $display("  PASS: Newer windows dropped, handover resumes once taken");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected no handover and at least 2 drops");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 10: Stall ---
+        // A due window with one still waiting stops the conversions
+        // (one win_stall pulse); nothing is dropped, and the due window
+        // goes out as soon as the waiting one is taken.
+        $display("[TEST 10] Overrun policy: stall");
+        ovr_mode = 2'd2;
+        wait_valid;
+        win_busy = 1;
+        count_clk(40 * 180);
+        begin : stall_block
+            integer n_cs;
+            integer n_stall;
+            n_cs    = cs_n;
+            n_stall = stall_n;
+            // Sampling must stay stopped from here on
+            count_clk(5000);
+            $display("  %0d conversions before the stall, %0d stalls, %0d after",
+                     n_cs, n_stall, cs_n);
+            if (n_stall == 1 && drop_n == 0 && valid_n == 0 && cs_n == 0 && n_cs <= 17) begin
+                win_busy = 0;
+                count_clk(20);
+                if (valid_n == 1) begin
+                    count_clk(2000);
+                    if (cs_n >= 5 && drop_n == 0) begin
+                        $display("  PASS: Sampling stalled, resumed after the handover");
+                        pass_count = pass_count + 1;
+                    end else begin
+                        $display("  FAIL: %0d conversions after the release", cs_n);
+                        fail_count = fail_count + 1;
+                    end
+                end else begin
+                    $display("  FAIL: Due window not handed over after the release");
+                    fail_count = fail_count + 1;
+                end
+            end else begin
+                $display("  FAIL: Expected 1 stall, no drops and no conversions");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 11: Three channels ---
+        // One conversion per channel per sample period, round robin: every
+        // channel window holds 64 consecutive conversions of its own ADC
+        $display("[TEST 11] Three channels, round robin into per-channel windows");
+        enable    = 0;
+        mc_enable = 1;
+        begin : mc_block
+            integer c, errors, wait_cnt;
+            reg [15:0] first;
+            errors = 0;
+            for (i = 0; i < 2; i = i + 1) begin    // The second window is full
+                wait_cnt = 0;
+                @(posedge clk);
+                while (mc_valid !== 1'b1 && wait_cnt < 500000) begin
+                    @(posedge clk);
+                    wait_cnt = wait_cnt + 1;
+                end
+            end
+            mc_lock = 1;
+            for (c = 0; c < 3; c = c + 1) begin
+                mc_ch = c;
+                for (i = 0; i < 64; i = i + 1) begin
+                    mc_addr = i[5:0];
+                    repeat (2) @(posedge clk);
+                    if (i == 0) first = mc_sample;
+                    if (mc_sample !== 500 * (c + 1) + (first - 500 * (c + 1) + i) % 256)
+                        errors = errors + 1;
+                end
+                $display("  Channel %0d: sample[0] = %0d, sample[63] = %0d", c, first, mc_sample);
+                if (first < 500 * (c + 1) || first > 500 * (c + 1) + 255)
+                    errors = errors + 1;
+            end
+            mc_lock = 0;
+            if (mc_cnt[0] - mc_cnt[2] > 1 || mc_cnt[2] > mc_cnt[0] || mc_overlap != 0)
+                errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: 3 windows of consecutive samples, one chip select at a time");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches (%0d/%0d/%0d conversions, %0d overlaps)", errors,
+                         mc_cnt[0], mc_cnt[1], mc_cnt[2], mc_overlap);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 12: Fewer active channels ---
+        $display("[TEST 12] n_ch = 1: channel 2 is not converted");
+        mc_n_ch = 2'd1;
+        begin : mc2_block
+            integer n2, n0;
+            repeat (200) @(posedge clk);
+            n0 = mc_cnt[0];
+            n2 = mc_cnt[2];
+            repeat (20_000) @(posedge clk);
+            $display("  %0d conversions on channel 0, %0d on channel 2", mc_cnt[0] - n0, mc_cnt[2] - n2);
+            if (mc_cnt[2] == n2 && mc_cnt[0] - n0 >= 40 && mc_cnt[0] - mc_cnt[1] <= 1 &&
+                mc_overlap == 0) begin
+                $display("  PASS: Channels 0 and 1 alternate");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Wrong channel sequence");
+                fail_count = fail_count + 1;
+            end
+        end
+        mc_enable = 0;
+
+        // --- Test 13: Sample timer ---
+        // Bit clock at the fastest setting, one conversion every 1000
+        // clocks: the chip select falls exactly on the period
+        $display("[TEST 13] Sample timer: conversions 1000 clocks apart");
+        ovr_mode = 2'd0;
+        win_busy = 0;
+        clk_div  = 16'd0;
+        sample_period = 24'd1000;
+        enable   = 1;
+        count_clk(2000);                // Settled on the period
+        gap_min  = 32'h7FFF_FFFF;
+        gap_max  = 0;
+        count_clk(20_000);
+        $display("  %0d conversions, gaps %0d-%0d clocks, %0d stalls", cs_n, gap_min, gap_max, stall_n);
+        if (cs_n == 20 && gap_min == 1000 && gap_max == 1000 && stall_n == 0) begin
+            $display("  PASS: Conversion start locked to the sample period");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Expected 20 conversions, all 1000 clocks apart");
+            fail_count = fail_count + 1;
+        end
+
+        // --- Test 14: Period shorter than the transfer ---
+        // clk_div 4 needs about 170 clocks per conversion: a 100-clock
+        // period loses about every other tick, each one a stall event
+        $display("[TEST 14] Sample period shorter than the transfer");
+        clk_div = 16'd4;
+        sample_period = 24'd100;
+        count_clk(500);
+        count_clk(10_000);
+        $display("  %0d conversions, %0d stalls", cs_n, stall_n);
+        if (cs_n > 20 && stall_n > 20 && cs_n + stall_n >= 95 && cs_n + stall_n <= 101) begin
+            $display("  PASS: Lost periods counted as stalls");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Expected conversions + stalls = 100 periods");
+            fail_count = fail_count + 1;
+        end
+        enable = 0;
+        sample_period = 24'd0;
+
+        // --- Test 15: Bus samples ---
+        // inject: the SPI master stays idle, 64 bus samples make one
+        // window, stored sign-extended like ADC codes
+        $display("[TEST 15] Bus samples fill a window, SPI idle");
+        hop_size = 9'd64;
+        inject   = 1;
+        enable   = 1;
+        count_clk(2);
+        for (i = 0; i < 64; i = i + 1)
+            inj_push(inj_code(i));
+        repeat (4) @(posedge clk);
+        begin : inject_block
+            integer errors;
+            reg [11:0] c;
+            errors = 0;
+            bank_lock = 1;
+            for (i = 0; i < 64; i = i + 1) begin
+                sample_addr = i[6:0];
+                repeat (2) @(posedge clk);
+                c = inj_code(i);
+                if (sample_out !== {{4{c[11]}}, c}) begin
+                    if (errors < 4)
+                        $display("    sample %0d = 0x%04h (code 0x%03h)", i, sample_out, c);
+                    errors = errors + 1;
+                end
+            end
+            bank_lock = 0;
+            $display("  %0d windows, %0d conversions, %0d samples wrong", valid_n, cs_n, errors);
+            if (valid_n == 1 && cs_n == 0 && errors == 0) begin
+                $display("  PASS: One window of the bus samples, in order");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: Expected one window, no SPI traffic");
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // --- Test 16: Software trigger, stall back-pressure ---
+        // 10 more samples, then sw_trig: the newest 64 go out at once (a
+        // second trigger without new samples does nothing). With stall and
+        // a window waiting, inj_ready holds the next sample back.
+        $display("[TEST 16] sw_trig hands the newest window over; stall blocks inj_ready");
+        begin : trig_block
+            integer errors;
+            errors = 0;
+            count_clk(2);
+            for (i = 64; i < 74; i = i + 1)
+                inj_push(inj_code(i));
+            repeat (4) @(posedge clk);
+            if (valid_n != 0) errors = errors + 1;
+            @(negedge clk) sw_trig = 1;
+            @(negedge clk) sw_trig = 0;
+            repeat (4) @(posedge clk);
+            if (valid_n != 1) errors = errors + 1;
+            bank_lock = 1;
+            sample_addr = 7'd0;
+            repeat (2) @(posedge clk);
+            if (sample_out[11:0] !== inj_code(10)) errors = errors + 1;
+            sample_addr = 7'd63;
+            repeat (2) @(posedge clk);
+            if (sample_out[11:0] !== inj_code(73)) errors = errors + 1;
+            bank_lock = 0;
+            @(negedge clk) sw_trig = 1;
+            @(negedge clk) sw_trig = 0;
+            repeat (4) @(posedge clk);
+            if (valid_n != 1) errors = errors + 1;
+            $display("    after the triggers: %0d windows", valid_n);
+            // Stall: the next full window waits for win_busy
+            ovr_mode = 2'd2;
+            win_busy = 1;
+            for (i = 0; i < 64; i = i + 1)
+                inj_push(inj_code(i));
+            repeat (4) @(posedge clk);
+            if (inj_ready !== 1'b0 || valid_n != 1) errors = errors + 1;
+            win_busy = 0;
+            repeat (4) @(posedge clk);
+            if (inj_ready !== 1'b1 || valid_n != 2) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Triggered window of the newest samples, bus held by a stall");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+        enable   = 0;
+        inject   = 0;
+        ovr_mode = 2'd0;
+
         // --- Summary ---
         $display("");
         $display("==========================================");
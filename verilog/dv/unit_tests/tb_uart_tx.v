@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: Apache-2.0
+// Testbench: UART Transmitter
+// Tests:
+//   1. Line idles high after reset
+//   2. One byte: start bit, 8 data bits LSB first, stop bit, bit timing
+//   3. Queued bytes go out back to back (no idle between stop and start)
+//   4. Writes to a full FIFO are dropped, level and busy track the FIFO
+
+`timescale 1ns / 1ps
+
+module tb_uart_tx;
+
+    // --- Clock and Reset ---
+    reg clk;
+    reg rst;
+
+    initial clk = 0;
+    always #20 clk = ~clk; // 25 MHz
+
+    localparam [15:0] DIV = 16'd9;  // 10 clocks per bit
+
+    // --- DUT signals ---
+    reg        wr_en;
+    reg  [7:0] wr_data;
+    wire [4:0] level;
+    wire       busy;
+    wire       tx;
+
+    // --- DUT ---
+    uart_tx #(.AW(4)) dut (
+        .clk     (clk),
+        .rst     (rst),
+        .clk_div (DIV),
+        .wr_en   (wr_en),
+        .wr_data (wr_data),
+        .level   (level),
+        .busy    (busy),
+        .tx      (tx)
+    );
+
+    // --- Line receiver ---
+    // Samples every bit mid-period; rx_gap counts idle clocks seen between a
+    // stop bit and the next start bit.
+    integer    rx_n;
+    integer    rx_bad;              // Framing errors (start or stop bit wrong)
+    integer    rx_gap;
+    reg [7:0]  rx_log [0:31];
+
+    initial begin : receiver
+        integer b, idle;
+        reg [7:0] d;
+        rx_n   = 0;
+        rx_bad = 0;
+        rx_gap = 0;
+        forever begin
+            idle = 0;
+            @(posedge clk);
+            while (tx !== 1'b0) begin
+                idle = idle + 1;
+                @(posedge clk);
+            end
+            if (rx_n > 0) rx_gap = rx_gap + idle;
+            repeat ((DIV + 1) / 2) @(posedge clk);
+            if (tx !== 1'b0) rx_bad = rx_bad + 1;
+            for (b = 0; b < 8; b = b + 1) begin
+                repeat (DIV + 1) @(posedge clk);
+                d[b] = tx;
+            end
+            repeat (DIV + 1) @(posedge clk);
+            if (tx !== 1'b1) rx_bad = rx_bad + 1;
+            if (rx_n < 32) rx_log[rx_n] = d;
+            rx_n = rx_n + 1;
+            // Back to the end of the stop bit
+            repeat (DIV / 2) @(posedge clk);
+        end
+    end
+
+    // --- Tasks ---
+    task send;
+        input [7:0] b;
+        begin
+            @(posedge clk);
+            wr_en   <= 1'b1;
+            wr_data <= b;
+            @(posedge clk);
+            wr_en   <= 1'b0;
+        end
+    endtask
+
+    // Byte k of the test pattern
+    function [7:0] pattern;
+        input integer k;
+        begin
+            pattern = 8'h30 + k * 7;
+        end
+    endfunction
+
+    // --- Test sequence ---
+    integer pass_count;
+    integer fail_count;
+    integer i;
+    integer t0;
+    integer errors;
+
+    initial begin
+        $dumpfile("tb_uart_tx.vcd");
+        $dumpvars(0, tb_uart_tx);
+
+        pass_count = 0;
+        fail_count = 0;
+
+        rst     = 1;
+        wr_en   = 0;
+        wr_data = 8'd0;
+
+        repeat (10) @(posedge clk);
+        rst = 0;
+        repeat (5) @(posedge clk);
+
+        // ==================================================================
+        // Test 1: Idle line
+        // ==================================================================
+        $display("");
+        $display("[TEST 1] Line idles high");
+        repeat (50) @(posedge clk);
+        if (tx === 1'b1 && !busy && level == 5'd0) begin
+            $display("  PASS: tx high, FIFO empty");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: tx=%b busy=%b level=%0d", tx, busy, level);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 2: One byte
+        // ==================================================================
+        $display("");
+        $display("[TEST 2] Single byte 0xA5");
+        send(8'hA5);
+        t0 = $time;
+        wait (!busy);
+        t0 = ($time - t0) / 40;     // Clocks on the line
+        repeat (2 * (DIV + 1)) @(posedge clk);
+        if (rx_n == 1 && rx_log[0] == 8'hA5 && rx_bad == 0 &&
+            t0 >= 10 * (DIV + 1) - 2 && t0 <= 10 * (DIV + 1) + 2) begin
+            $display("  PASS: 0xA5 received, %0d clocks per frame", t0);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d bytes, first 0x%02h, %0d framing errors, %0d clocks",
+                     rx_n, rx_log[0], rx_bad, t0);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 3: Back-to-back bytes
+        // ==================================================================
+        $display("");
+        $display("[TEST 3] Queued bytes sent back to back");
+        rx_n   = 0;
+        rx_gap = 0;
+        for (i = 0; i < 8; i = i + 1)
+            send(pattern(i));
+        wait (!busy);
+        repeat (2 * (DIV + 1)) @(posedge clk);
+        errors = 0;
+        for (i = 0; i < 8; i = i + 1)
+            if (rx_log[i] !== pattern(i)) errors = errors + 1;
+        if (rx_n == 8 && errors == 0 && rx_bad == 0 && rx_gap <= 7) begin
+            $display("  PASS: 8 bytes in order, %0d idle clocks between them", rx_gap);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d bytes, %0d wrong, %0d framing errors, %0d idle clocks",
+                     rx_n, errors, rx_bad, rx_gap);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 4: Full FIFO
+        // ==================================================================
+        $display("");
+        $display("[TEST 4] Writes to a full FIFO are dropped");
+        rx_n = 0;
+        // One byte goes straight to the shifter, 16 fill the FIFO, 3 drop
+        for (i = 0; i < 20; i = i + 1)
+            send(pattern(i));
+        errors = 0;
+        if (level != 5'd16 || !busy) begin
+            $display("    level %0d after 20 writes", level);
+            errors = errors + 1;
+        end
+        wait (!busy);
+        repeat (2 * (DIV + 1)) @(posedge clk);
+        for (i = 0; i < 17; i = i + 1)
+            if (rx_log[i] !== pattern(i)) errors = errors + 1;
+        if (rx_n == 17 && errors == 0 && rx_bad == 0 && level == 5'd0) begin
+            $display("  PASS: First 17 bytes sent, the rest dropped");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d bytes, %0d errors", rx_n, errors);
+            fail_count = fail_count + 1;
+        end
+
+        // --- Summary ---
+        $display("");
+        $display("==========================================");
+        $display("  UART TX Testbench Results");
+        $display("  PASSED: %0d  FAILED: %0d", pass_count, fail_count);
+        $display("==========================================");
+        if (fail_count > 0) $display("  *** TEST FAILED ***");
+        else                $display("  *** ALL TESTS PASSED ***");
+
+        #100;
+        $finish;
+    end
+
+    // Timeout watchdog
+    initial begin
+        #10_000_000;
+        $display("WATCHDOG: Simulation timeout");
+        $finish;
+    end
+
+endmodule
@@ -3,10 +3,32 @@
 // Tests:
 //   1. Control register write/read
 //   2. Status register read
-//   3. NN weight write
+//   3. NN weight write (4 bytes per word)
 //   4. FFT data readback
 //   5. Alarm configuration
-//   6. IRQ flag handling
+//   6. IRQ flag handling (an event on the clear's clock wins)
+//   7. Frame hop size
+//   8. FFT length select (CTRL[5:4]) and 9-bit hop size
+//   9. NN_CFG: INT4 layers and layer count
+//  10. NN layer descriptor table (reset model, field masks)
+//  11. Weight streaming port (NN_WT_ADDR / NN_WT_DATA)
+//  12. Model bank swap (NN_CFG.SWAP)
+//  13. Boot strap: reset with boot_run enables the pipeline on the boot model
+//  14. Result FIFO: entry fields, level IRQ, overflow, flag clear and flush
+//  15. UART: UART_DATA bytes, UART_CFG divider, AUTO RESULT frames (CRC-8)
+//  16. Readback snapshot: SNAP_CTRL, packed feature words, spectrum window
+//  17. PERF page: perf_counters reads, one read strobe each, writes ignored
+//  18. Overrun: FRAME_CFG policy field, IRQ flag 3, STATUS[14], CTRL[11]
+//  19. AVG_CFG: spectral averaging shift and classification interval
+//  20. GATE_CFG: change gate threshold and skip limit, reused bit of RES_FIFO
+//  21. ADC channels: FRAME_CFG.CH, RES_FIFO_CH, SNAP_CTRL channel, AUTO
+//      channel byte
+//  22. SAMPLE_PERIOD: 24-bit sample timer period
+//  23. Bus samples: CTRL.INJECT / TRIG, SAMPLE_IN pulses, ready bit, ack
+//      at once when not ready
+//  24. Resident models: MODEL_CFG fields, PROFILE alarm settings by result
+//      bank, EDIT bank for NN_CFG / descriptors / weights, RES_FIFO_CH and
+//      AUTO bank field
 
 `timescale 1ns / 1ps
 
@@ -29,39 +51,100 @@ module tb_wb_interface;
     wire        wb_ack_o;
     wire [31:0] wb_dat_o;
 
+    reg         boot_run;
     wire        enable;
     wire [15:0] clk_div;
+    wire [23:0] sample_period;
+    wire [8:0]  hop_size;
+    wire [1:0]  ovr_mode;
+    wire [1:0]  fft_size;
+    wire [1:0]  n_ch;
+    wire [2:0]  avg_shift;
+    wire [3:0]  avg_every;
+    wire [11:0] gate_thr;
+    wire [7:0]  gate_max;
     wire [7:0]  alarm_threshold;
     wire [3:0]  fault_count_cfg;
+    wire [7:0]  nn_int4;
+    wire [5:0]  nn_layers;
+    wire [511:0] nn_desc;
+    wire [1:0]  nn_bank;
+    wire        model_per_ch;
+    wire [7:0]  model_map;
+    wire        model_all;
+    wire [1:0]  model_last;
+    wire        inject;
+    wire        inj_valid;
+    wire [11:0] inj_data;
+    reg         inj_ready;
+    wire        sw_trig;
 
     reg  [1:0]  class_id;
     reg  [7:0]  confidence;
+    reg  [15:0] frame_id;
+    reg  [15:0] top_score;
+    reg  [1:0]  second_id;
+    reg  [15:0] second_score;
+    reg         result_reused;
+    reg  [1:0]  result_ch;
+    reg  [1:0]  result_model;
     reg         fft_busy;
     reg         nn_busy;
     reg         fe_busy;
     reg         alarm_active;
 
-    wire [4:0]  fft_rd_addr;
+    wire [6:0]  fft_rd_addr;
     reg  [15:0] fft_rd_data;
-    wire [2:0]  feature_rd_addr;
+    wire [3:0]  feature_rd_addr;
     reg  [7:0]  feature_rd_data;
 
     wire        wt_wr_en;
-    wire [7:0]  wt_wr_addr;
-    wire [7:0]  wt_wr_data;
+    wire [1:0]  wt_wr_bank;
+    wire [9:0]  wt_wr_addr;
+    wire [3:0]  wt_wr_sel;
+    wire [31:0] wt_wr_data;
+
+    wire [15:0] uart_div;
+    wire        uart_wr_en;
+    wire [7:0]  uart_wr_data;
+    reg  [4:0]  uart_level;
+    reg         uart_busy;
 
     reg         classification_done;
     reg         alarm_irq_in;
+    reg         overrun_in;
     wire [2:0]  irq;
 
-    // --- FFT data memory (simulated) ---
-    reg [15:0] fft_mem [0:31];
-    always @(*) fft_rd_data = fft_mem[fft_rd_addr];
+    wire        snap_req;
+    reg         snap_held;
+    reg  [15:0] snap_frame;
+    reg  [1:0]  snap_size;
+    reg  [1:0]  snap_ch;
+    reg  [95:0] snap_feat;
+
+    wire        perf_rd;
+    wire [3:0]  perf_addr;
+    reg  [31:0] perf_data;
+
+    // --- FFT data memory (simulated, one clock read latency like the
+    // spectrum buffer) ---
+    reg [15:0] fft_mem [0:127];
+    always @(posedge clk) fft_rd_data <= fft_mem[fft_rd_addr];
 
     // Feature data
-    reg [7:0] feat_mem [0:7];
+    reg [7:0] feat_mem [0:15];
     always @(*) feature_rd_data = feat_mem[feature_rd_addr];
 
+    // Perf counters: the word offset in a recognisable pattern
+    always @(*) perf_data = {16'hBEEF, 12'd0, perf_addr};
+
+    integer perf_rd_n;
+    initial perf_rd_n = 0;
+    always @(posedge clk) if (perf_rd) perf_rd_n <= perf_rd_n + 1;
+
+    // Boot model the registers reset to
+    `include "nn_default_model.vh"
+
     // --- DUT ---
     wb_interface dut (
         .clk              (clk),
@@ -74,12 +157,42 @@ module tb_wb_interface;
         .wb_dat_i         (wb_dat_i),
         .wb_ack_o         (wb_ack_o),
         .wb_dat_o         (wb_dat_o),
+        .boot_run         (boot_run),
         .enable           (enable),
         .clk_div          (clk_div),
+        .sample_period    (sample_period),
+        .inject           (inject),
+        .hop_size         (hop_size),
+        .ovr_mode         (ovr_mode),
+        .fft_size         (fft_size),
+        .n_ch             (n_ch),
+        .avg_shift        (avg_shift),
+        .avg_every        (avg_every),
+        .gate_thr         (gate_thr),
+        .gate_max         (gate_max),
         .alarm_threshold  (alarm_threshold),
         .fault_count_cfg  (fault_count_cfg),
+        .nn_int4          (nn_int4),
+        .nn_layers        (nn_layers),
+        .nn_desc          (nn_desc),
+        .nn_bank          (nn_bank),
+        .model_per_ch     (model_per_ch),
+        .model_map        (model_map),
+        .model_all        (model_all),
+        .model_last       (model_last),
+        .inj_valid        (inj_valid),
+        .inj_data         (inj_data),
+        .inj_ready        (inj_ready),
+        .sw_trig          (sw_trig),
         .class_id         (class_id),
         .confidence       (confidence),
+        .frame_id         (frame_id),
+        .top_score        (top_score),
+        .second_id        (second_id),
+        .second_score     (second_score),
+        .result_reused    (result_reused),
+        .result_ch        (result_ch),
+        .result_model     (result_model),
         .fft_busy         (fft_busy),
         .nn_busy          (nn_busy),
         .fe_busy          (fe_busy),
@@ -88,14 +201,79 @@ module tb_wb_interface;
         .fft_rd_data      (fft_rd_data),
         .feature_rd_addr  (feature_rd_addr),
         .feature_rd_data  (feature_rd_data),
+        .snap_req         (snap_req),
+        .snap_held        (snap_held),
+        .snap_frame       (snap_frame),
+        .snap_size        (snap_size),
+        .snap_ch          (snap_ch),
+        .snap_feat        (snap_feat),
+        .perf_rd          (perf_rd),
+        .perf_addr        (perf_addr),
+        .perf_data        (perf_data),
         .wt_wr_en         (wt_wr_en),
+        .wt_wr_bank       (wt_wr_bank),
         .wt_wr_addr       (wt_wr_addr),
+        .wt_wr_sel        (wt_wr_sel),
         .wt_wr_data       (wt_wr_data),
+        .uart_div         (uart_div),
+        .uart_wr_en       (uart_wr_en),
+        .uart_wr_data     (uart_wr_data),
+        .uart_level       (uart_level),
+        .uart_busy        (uart_busy),
         .classification_done(classification_done),
         .alarm_irq_in     (alarm_irq_in),
+        .overrun_in       (overrun_in),
         .irq              (irq)
     );
 
+    // --- Weight write capture (wt_wr_en is a single-cycle pulse) ---
+    integer     wt_n;
+    reg  [1:0]  wt_bank_q;
+    reg  [9:0]  wt_addr_q;
+    reg  [3:0]  wt_sel_q;
+    reg  [31:0] wt_data_q;
+
+    initial wt_n = 0;
+    always @(posedge clk) begin
+        if (wt_wr_en) begin
+            wt_n      <= wt_n + 1;
+            wt_bank_q <= wt_wr_bank;
+            wt_addr_q <= wt_wr_addr;
+            wt_sel_q  <= wt_wr_sel;
+            wt_data_q <= wt_wr_data;
+        end
+    end
+
+    // --- Bus sample capture ---
+    integer     inj_n;
+    integer     trig_n;
+    reg  [11:0] inj_data_q;
+
+    initial begin
+        inj_n  = 0;
+        trig_n = 0;
+    end
+    always @(posedge clk) begin
+        if (inj_valid) begin
+            inj_n      <= inj_n + 1;
+            inj_data_q <= inj_data;
+        end
+        if (sw_trig)
+            trig_n <= trig_n + 1;
+    end
+
+    // --- UART byte capture ---
+    integer    uart_n;
+    reg [7:0]  uart_log [0:63];
+
+    initial uart_n = 0;
+    always @(posedge clk) begin
+        if (uart_wr_en) begin
+            if (uart_n < 64) uart_log[uart_n] <= uart_wr_data;
+            uart_n <= uart_n + 1;
+        end
+    end
+
     // --- Wishbone bus tasks ---
     task wb_write;
         input [31:0] addr;
@@ -138,11 +316,85 @@ module tb_wb_interface;
         end
     endtask
 
+    // One classification k into the result FIFO, alarm on for odd k
+    task push_result;
+        input integer k;
+        begin
+            @(posedge clk);
+            class_id     <= k;
+            confidence   <= 100 + k;
+            frame_id     <= 500 + k;
+            top_score    <= 256 + k;
+            second_id    <= ~k;
+            second_score <= -k;
+            alarm_active <= k % 2;
+            classification_done <= 1;
+            @(posedge clk);
+            classification_done <= 0;
+            repeat (2) @(posedge clk);
+        end
+    endtask
+
+    // The RES_FIFO / RES_FIFO_HI words push_result(k) should give
+    function [63:0] res_entry;
+        input integer k;
+        reg [15:0] frame, top, second;
+        reg [1:0]  cls, cls2;
+        reg [7:0]  conf;
+        begin
+            frame  = 500 + k;
+            top    = 256 + k;
+            second = -k;
+            cls    = k;
+            cls2   = ~k;
+            conf   = 100 + k;
+            res_entry = {second, top, frame, 2'd0, cls2, 1'b1, k[0], conf, cls};
+        end
+    endfunction
+
+    // CRC-8 (polynomial 0x07) of the link frames
+    function [7:0] crc8;
+        input [7:0] crc;
+        input [7:0] data;
+        integer b;
+        begin
+            crc8 = crc ^ data;
+            for (b = 0; b < 8; b = b + 1)
+                crc8 = crc8[7] ? ((crc8 << 1) ^ 8'h07) : (crc8 << 1);
+        end
+    endfunction
+
+    // Byte i of the RESULT frame of push_result(k), with or without scores
+    function [7:0] frame_byte;
+        input integer k;
+        input         scores;
+        input integer i;
+        reg [63:0] e;
+        reg [7:0]  b, crc;
+        integer    j, len;
+        begin
+            e   = res_entry(k);
+            len = scores ? 8 : 4;
+            crc = 8'd0;
+            for (j = 0; j <= i; j = j + 1) begin
+                case (j)
+                    0:       b = 8'hA5;
+                    1:       b = 8'h01;
+                    2:       b = len;
+                    default: b = (j == len + 3) ? crc : e[8 * (j - 3) +: 8];
+                endcase
+                if (j > 0) crc = crc8(crc, b);
+            end
+            frame_byte = b;
+        end
+    endfunction
+
     // --- Test sequence ---
     integer pass_count;
     integer fail_count;
     integer i;
     reg [31:0] rd_data;
+    reg [31:0] rd_data2;
 
     initial begin
         $dumpfile("tb_wb_interface.vcd");
@@ -153,6 +405,7 @@ module tb_wb_interface;
 
         // Initialize
         rst       = 1;
+        boot_run  = 0;
         wb_cyc_i  = 0;
         wb_stb_i  = 0;
         wb_we_i   = 0;
@@ -161,17 +414,33 @@ module tb_wb_interface;
         wb_dat_i  = 32'd0;
         class_id  = 2'd0;
         confidence = 8'd0;
+        frame_id  = 16'd0;
+        top_score = 16'd0;
+        second_id = 2'd0;
+        second_score = 16'd0;
+        result_reused = 0;
+        result_ch = 2'd0;
+        result_model = 2'd0;
+        inj_ready = 0;
         fft_busy  = 0;
         nn_busy   = 0;
         fe_busy   = 0;
         alarm_active = 0;
         classification_done = 0;
         alarm_irq_in = 0;
+        overrun_in   = 0;
+        uart_level   = 5'd0;
+        uart_busy    = 0;
+        snap_held    = 0;
+        snap_frame   = 16'd0;
+        snap_size    = 2'd0;
+        snap_ch      = 2'd0;
+        snap_feat    = 96'h0C0B_0A09_0807_0605_0403_0201;
 
         // Initialize simulated data
         for (i = 0; i < 32; i = i + 1)
             fft_mem[i] = i[15:0] * 16'd100;
-        for (i = 0; i < 8; i = i + 1)
+        for (i = 0; i < 16; i = i + 1)
             feat_mem[i] = (i[7:0] + 1) * 8'd20;
 
         repeat (10) @(posedge clk);
@@ -298,15 +567,17 @@ module tb_wb_interface;
         // ==================================================================
         $display("");
         $display("[TEST 7] NN weight write");
-        wb_write(32'h20, 32'h0000007F); // Write weight 0 = 127
+        wt_n = 0;
+        wb_write(32'h24, 32'h8104_FF7F); // Weights 4-7 = 127, -1, 4, -127
 
-        if (wt_wr_en === 1'b0) begin
-            // wt_wr_en is single-cycle, might have already deasserted
-            $display("  PASS: Weight write issued (single-cycle pulse)");
+        if (wt_n == 1 && wt_addr_q == 10'd4 && wt_sel_q == 4'hF &&
+            wt_data_q == 32'h8104_FF7F && wt_bank_q == 1'b1) begin
+            $display("  PASS: One write carries weights 4-7 into shadow bank 1");
             pass_count = pass_count + 1;
         end else begin
-            $display("  PASS: Weight write active");
-            pass_count = pass_count + 1;
+            $display("  FAIL: %0d writes, addr %0d sel %b data 0x%08h bank %b",
+                     wt_n, wt_addr_q, wt_sel_q, wt_data_q, wt_bank_q);
+            fail_count = fail_count + 1;
         end
 
         // ==================================================================
@@ -343,6 +614,871 @@ module tb_wb_interface;
             fail_count = fail_count + 1;
         end
 
+        // An event on the clock of the clear wins over it
+        fork
+            wb_write(32'h18, 32'h00000001);
+            begin
+                @(posedge clk);
+                classification_done <= 1;
+                wait (wb_ack_o === 1'b1);
+                classification_done <= 0;
+            end
+        join
+        wb_read(32'h18, rd_data);
+        if (rd_data[0] === 1'b1) begin
+            $display("  PASS: Event during the clear keeps its flag");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Event during the clear lost");
+            fail_count = fail_count + 1;
+        end
+        wb_write(32'h18, 32'h00000001);
+
+        // ==================================================================
+        // Test 9: Frame hop size
+        // ==================================================================
+        $display("");
+        $display("[TEST 9] Frame hop size register");
+        if (hop_size == 9'd64) begin
+            $display("  PASS: Hop size resets to 64 (no overlap)");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Hop size reset value = %0d (expected 64)", hop_size);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h78, 32'h00000020); // 50% overlap
+        wb_read(32'h78, rd_data);
+        if (hop_size == 9'd32 && rd_data[8:0] == 9'd32) begin
+            $display("  PASS: Hop size = 32");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Hop size = %0d, readback = %0d (expected 32)",
+                     hop_size, rd_data[8:0]);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 10: FFT length select
+        // ==================================================================
+        $display("");
+        $display("[TEST 10] FFT length select");
+        if (fft_size == 2'd0) begin
+            $display("  PASS: FFT length resets to 64-point");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: fft_size reset value = %0d (expected 0)", fft_size);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h00, 32'h00000021); // Enable, 256-point
+        wb_read(32'h00, rd_data);
+        if (fft_size == 2'd2 && rd_data[5:4] == 2'd2 && enable === 1'b1) begin
+            $display("  PASS: CTRL[5:4] selects 256-point (CTRL=0x%08h)", rd_data);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: fft_size = %0d, CTRL = 0x%08h", fft_size, rd_data);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h78, 32'h00000100); // One full 256-sample hop
+        wb_read(32'h78, rd_data);
+        if (hop_size == 9'd256 && rd_data[8:0] == 9'd256) begin
+            $display("  PASS: Hop size = 256");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: Hop size = %0d, readback = %0d (expected 256)",
+                     hop_size, rd_data[8:0]);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 11: NN weight precision and layer count
+        // ==================================================================
+        $display("");
+        $display("[TEST 11] NN weight precision and layer count (NN_CFG)");
+        if (nn_int4 == 8'd0 && nn_layers == {3'd2, 3'd2} && nn_bank == 2'd0) begin
+            $display("  PASS: 2 layers, all INT8 after reset");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: nn_int4 = %b, nn_layers = %o (expected 0 / 22)",
+                     nn_int4, nn_layers);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h7C, 32'h00000302); // 3 layers, layer 1 INT4 (shadow bank 1)
+        wb_read(32'h7C, rd_data);
+        if (nn_int4 == 8'b0010_0000 && nn_layers == {3'd3, 3'd2} &&
+            rd_data == 32'h00000302) begin
+            $display("  PASS: NN_CFG = 0x%08h, 3 layers, layer 1 INT4", rd_data);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: nn_int4 = %b, nn_layers = %0d, NN_CFG = 0x%08h",
+                     nn_int4, nn_layers, rd_data);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 12: NN layer descriptor table
+        // ==================================================================
+        $display("");
+        $display("[TEST 12] NN layer descriptors");
+        wb_read(32'h80, rd_data);
+        wb_read(32'h8C, rd_data2);
+        if (rd_data == 32'h0001_1008 && rd_data2 == 32'h00D0_0090) begin
+            $display("  PASS: Reset table is the 8 -> 16 -> 4 model");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: LAYER0_SHAPE = 0x%08h, LAYER1_BASE = 0x%08h",
+                     rd_data, rd_data2);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h90, 32'hFFFF_FFFF);    // Layer 2 SHAPE, reserved bits dropped
+        wb_write(32'h94, 32'h01D7_0131);    // Layer 2 BASE: weights 0x131, biases 0x1D7
+        wb_read(32'h90, rd_data);
+        wb_read(32'h94, rd_data2);
+        if (rd_data == 32'h00F1_3F3F && rd_data2 == 32'h01D7_0131 &&
+            nn_desc[447:384] == {32'h01D7_0131, 32'h00F1_3F3F} &&
+            nn_desc[191:128] == 64'd0) begin
+            $display("  PASS: LAYER2 SHAPE/BASE = 0x%08h / 0x%08h", rd_data, rd_data2);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: LAYER2 SHAPE/BASE = 0x%08h / 0x%08h, desc = 0x%016h",
+                     rd_data, rd_data2, nn_desc[447:384]);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 13: Weight streaming port
+        // ==================================================================
+        $display("");
+        $display("[TEST 13] Weight streaming port (NN_WT_ADDR / NN_WT_DATA)");
+        wb_write(32'hA0, 32'h0000_01F3);    // Rounded down to the word at 0x1F0
+        wt_n = 0;
+        wb_write(32'hA4, 32'h0403_0201);
+        wb_write(32'hA4, 32'h0807_0605);
+        wb_read(32'hA0, rd_data);
+        if (wt_n == 2 && wt_addr_q == 10'h1F4 && wt_data_q == 32'h0807_0605 &&
+            wt_bank_q == 1'b1 && rd_data == 32'h0000_01F8) begin
+            $display("  PASS: 2 words streamed from 0x1F0, NN_WT_ADDR = 0x%03h", rd_data);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: %0d writes, last addr 0x%03h data 0x%08h, NN_WT_ADDR = 0x%08h",
+                     wt_n, wt_addr_q, wt_data_q, rd_data);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 14: Model bank swap
+        // ==================================================================
+        $display("");
+        $display("[TEST 14] Model bank swap (NN_CFG.SWAP)");
+        wb_write(32'h7C, 32'h0001_0303);    // Last shadow edit and swap in one write
+        wb_read(32'h7C, rd_data);
+        wb_read(32'h90, rd_data2);
+        if (nn_bank == 2'd1 && nn_int4 == 8'b0011_0000 && nn_layers == {3'd3, 3'd2} &&
+            rd_data == 32'h0002_0200 && rd_data2 == 32'd0) begin
+            $display("  PASS: Bank 1 active, registers show bank 0 (NN_CFG = 0x%08h)", rd_data);
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: bank %b, nn_int4 = %b, NN_CFG = 0x%08h, LAYER2_SHAPE = 0x%08h",
+                     nn_bank, nn_int4, rd_data, rd_data2);
+            fail_count = fail_count + 1;
+        end
+
+        wb_write(32'h20, 32'h0000_0055);
+        wb_write(32'h80, 32'h0000_0408);    // Bank 0 layer 0: 8 -> 4
+        if (wt_bank_q == 1'b0 && wt_addr_q == 10'd0 &&
+            nn_desc[63:0] == {32'h0080_0000, 32'h0000_0408} &&
+            nn_desc[319:256] == {32'h0080_0000, 32'h0001_1008}) begin
+            $display("  PASS: Weight and descriptor writes now go to bank 0");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: weight bank %b, bank 0 / 1 layer 0 = 0x%016h / 0x%016h",
+                     wt_bank_q, nn_desc[63:0], nn_desc[319:256]);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 15: Boot strap
+        // ==================================================================
+        $display("");
+        $display("[TEST 15] Boot strap (boot_run)");
+        boot_run = 1;
+        rst = 1;
+        repeat (2) @(posedge clk);
+        rst = 0;
+        boot_run = 0;                       // Sampled in reset only
+        repeat (2) @(posedge clk);
+        wb_read(32'h00, rd_data);
+        wb_read(32'h7C, rd_data2);
+        if (enable === 1'b1 && rd_data[0] == 1'b1 && nn_bank == 2'd0 &&
+            rd_data2 == {21'd0, NN_ROM_LAYERS, 4'd0, NN_ROM_INT4} &&
+            nn_desc == {2{NN_ROM_DESC}}) begin
+            $display("  PASS: Enabled out of reset, both banks hold the boot model");
+            pass_count = pass_count + 1;
+        end else begin
+            $display("  FAIL: enable %b, CTRL = 0x%08h, NN_CFG = 0x%08h", enable, rd_data, rd_data2);
+            fail_count = fail_count + 1;
+        end
+
+        // ==================================================================
+        // Test 16: Result FIFO
+        // ==================================================================
+        $display("");
+        $display("[TEST 16] Result FIFO (RES_FIFO / RES_CFG)");
+        begin : res_fifo_check
+            integer errors, k;
+            reg [63:0] e;
+            errors = 0;
+            wb_write(32'h18, 32'h0000_0007);    // Clear the IRQ flags
+            wb_write(32'hB0, 32'h0000_0003);    // IRQ at 3 entries
+            for (k = 0; k < 3; k = k + 1) begin
+                wb_read(32'h18, rd_data);
+                if (rd_data[2] !== 1'b0) errors = errors + 1;
+                push_result(k);
+            end
+            wb_read(32'h18, rd_data);
+            wb_read(32'h04, rd_data2);
+            if (rd_data[2] !== 1'b1 || rd_data2[13:8] !== 6'd3) begin
+                $display("    IRQ_FLAGS = 0x%08h, STATUS = 0x%08h after 3 results", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            for (k = 0; k < 4; k = k + 1) begin
+                wb_read(32'hA8, rd_data);
+                wb_read(32'hAC, rd_data2);
+                if ({rd_data2, rd_data} !== ((k < 3) ? res_entry(k) : 64'd0)) begin
+                    $display("    pop %0d: 0x%08h_%08h", k, rd_data2, rd_data);
+                    errors = errors + 1;
+                end
+            end
+            // Overflow: the oldest 8 are kept
+            for (k = 10; k < 19; k = k + 1)
+                push_result(k);
+            e = res_entry(10);
+            wb_read(32'h04, rd_data);
+            wb_read(32'hA8, rd_data2);
+            if (rd_data[13:8] !== 6'b1_01000 || rd_data2 !== e[31:0]) begin
+                $display("    full: STATUS = 0x%08h, head 0x%08h", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            wb_write(32'hB0, 32'h0000_0203);    // Clear the overflow flag only
+            wb_read(32'h04, rd_data);
+            if (rd_data[13:8] !== 6'd7) begin
+                $display("    overflow cleared: STATUS = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            wb_write(32'hB0, 32'h0000_0103);    // Flush
+            wb_read(32'h04, rd_data);
+            wb_read(32'hA8, rd_data2);
+            if (rd_data[13:8] !== 6'd0 || rd_data2 !== 32'd0) begin
+                $display("    flushed: STATUS = 0x%08h, RES_FIFO = 0x%08h", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            if (errors == 0) begin
+                $display("  PASS: Entries in order, level IRQ, overflow and flush");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 17: UART TX registers and AUTO result records
+        // ==================================================================
+        $display("");
+        $display("[TEST 17] UART TX (UART_DATA / UART_CFG, RESULT frames)");
+        begin : uart_check
+            integer errors, k, n0;
+            errors = 0;
+            uart_level = 5'd3;
+            uart_busy  = 1'b1;
+            wb_read(32'hB8, rd_data);
+            wb_read(32'hB4, rd_data2);
+            if (rd_data !== 32'd216 || uart_div !== 16'd216 || rd_data2 !== 32'h0000_0103) begin
+                $display("    reset: UART_CFG = 0x%08h, UART_DATA = 0x%08h", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            wb_write(32'hB8, 32'h0000_0010);    // 25 MHz / 17
+            n0 = uart_n;
+            wb_write(32'hB4, 32'h0000_A55A);
+            wb_write(32'hB4, 32'h0000_0042);
+            if (uart_div !== 16'd16 || uart_n !== n0 + 2 ||
+                uart_log[n0] !== 8'h5A || uart_log[n0 + 1] !== 8'h42) begin
+                $display("    CPU bytes: div %0d, %0d bytes", uart_div, uart_n - n0);
+                errors = errors + 1;
+            end
+
+            // AUTO: a RESULT frame per result, held back while the FIFO
+            // has no room for a whole frame
+            wb_write(32'hB0, 32'h0000_0100);    // Empty result FIFO
+            uart_level = 5'd9;
+            wb_write(32'hB8, 32'h0001_0010);
+            push_result(5);
+            n0 = uart_n;
+            wb_write(32'hB4, 32'h0000_0077);    // Ignored in AUTO mode
+            wb_read(32'h04, rd_data);
+            if (uart_n !== n0 || rd_data[12:8] !== 5'd1) begin
+                $display("    held back: %0d bytes, STATUS = 0x%08h", uart_n - n0, rd_data);
+                errors = errors + 1;
+            end
+            uart_level = 5'd8;                  // Room for 8 bytes
+            repeat (12) @(posedge clk);
+            wb_write(32'hB8, 32'h0003_0010);    // SCORES: 12-byte frames
+            uart_level = 5'd4;
+            push_result(6);
+            repeat (16) @(posedge clk);
+            wb_read(32'h04, rd_data);
+            if (uart_n !== n0 + 20 || rd_data[12:8] !== 5'd0) begin
+                $display("    sent: %0d bytes, STATUS = 0x%08h", uart_n - n0, rd_data);
+                errors = errors + 1;
+            end
+            for (k = 0; k < 20; k = k + 1) begin
+                if (uart_log[n0 + k] !== ((k < 8) ? frame_byte(5, 0, k) : frame_byte(6, 1, k - 8))) begin
+                    $display("    byte %0d: 0x%02h", k, uart_log[n0 + k]);
+                    errors = errors + 1;
+                end
+            end
+            wb_write(32'hB8, 32'h0000_0010);    // AUTO off
+            uart_level = 5'd0;
+            uart_busy  = 1'b0;
+            if (errors == 0) begin
+                $display("  PASS: CPU bytes, divider and AUTO RESULT frames");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 18: Readback snapshot and packed spectrum window
+        // ==================================================================
+        $display("");
+        $display("[TEST 18] Readback snapshot (SNAP_CTRL / SNAP_FEAT / window)");
+        begin : snap_check
+            integer errors, k;
+            errors = 0;
+            for (k = 0; k < 128; k = k + 1)
+                fft_mem[k] = 16'h1000 + k * 3;
+            wb_write(32'hBC, 32'h0000_0001);
+            if (snap_req !== 1'b1) errors = errors + 1;
+            snap_held  = 1;
+            snap_frame = 16'd1234;
+            snap_size  = 2'd1;
+            wb_read(32'hBC, rd_data);
+            if (rd_data !== {16'd1234, 10'd0, 2'd1, 2'd0, 1'b1, 1'b1}) begin
+                $display("    SNAP_CTRL = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            wb_read(32'hC0, rd_data);
+            wb_read(32'hC4, rd_data2);
+            if ({rd_data2, rd_data} !== snap_feat[63:0]) begin
+                $display("    SNAP_FEAT = 0x%08h_%08h", rd_data2, rd_data);
+                errors = errors + 1;
+            end
+            wb_read(32'hC8, rd_data);
+            if (rd_data !== snap_feat[95:64]) begin
+                $display("    SNAP_FEAT2 = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            // Window: two bins per word, any word order
+            for (k = 0; k < 64; k = k + 7) begin
+                wb_read(32'h100 + 4 * k, rd_data);
+                if (rd_data !== {fft_mem[2 * k + 1], fft_mem[2 * k]}) begin
+                    $display("    window word %0d = 0x%08h", k, rd_data);
+                    errors = errors + 1;
+                end
+            end
+            // The auto-increment port carries on where it was
+            wb_write(32'h10, 32'h0000_0005);
+            wb_read(32'h10, rd_data);
+            wb_read(32'h13C, rd_data2);
+            wb_read(32'h10, rd_data2);
+            if (rd_data !== {16'd0, fft_mem[5]} || rd_data2 !== {16'd0, fft_mem[6]}) begin
+                $display("    FFT_DATA around a window read: 0x%08h, 0x%08h", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            // Window addresses do not alias the registers
+            push_result(3);
+            k = enable;
+            wb_write(32'h100, {31'd0, ~enable}); // Would be CTRL
+            wb_read(32'h1A8, rd_data);          // Would pop RES_FIFO
+            wb_read(32'h04, rd_data2);
+            if (rd_data2[12:8] !== 5'd1 || enable !== k[0]) begin
+                $display("    window access hit the registers: STATUS = 0x%08h", rd_data2);
+                errors = errors + 1;
+            end
+            wb_write(32'hB0, 32'h0000_0100);
+            wb_write(32'hBC, 32'h0000_0000);
+            snap_held = 0;
+            if (snap_req !== 1'b0) errors = errors + 1;
+            if (errors == 0) begin
+                $display("  PASS: Snapshot control, packed features and spectrum window");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 19: PERF page
+        // ==================================================================
+        $display("");
+        $display("[TEST 19] PERF page (0x200) reads");
+        begin : perf_check
+            integer errors, k, n0;
+            errors = 0;
+            n0 = perf_rd_n;
+            for (k = 0; k < 16; k = k + 5) begin
+                wb_read(32'h200 + 4 * k, rd_data);
+                if (rd_data !== {16'hBEEF, 12'd0, k[3:0]}) begin
+                    $display("    PERF word %0d = 0x%08h", k, rd_data);
+                    errors = errors + 1;
+                end
+            end
+            if (perf_rd_n - n0 !== 4) begin
+                $display("    %0d read strobes for 4 reads", perf_rd_n - n0);
+                errors = errors + 1;
+            end
+            // Writes do nothing, and do not reach CTRL
+            n0 = perf_rd_n;
+            k = enable;
+            wb_write(32'h200, {31'd0, ~enable});
+            if (perf_rd_n !== n0 || enable !== k[0]) begin
+                $display("    PERF write strobed or hit CTRL");
+                errors = errors + 1;
+            end
+            if (errors == 0) begin
+                $display("  PASS: PERF words read through, one strobe per read");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 20: Overrun policy and IRQ
+        // ==================================================================
+        $display("");
+        $display("[TEST 20] Overrun: FRAME_CFG.OVR, IRQ flag 3, STATUS[14]");
+        begin : ovr_check
+            integer errors;
+            errors = 0;
+            if (ovr_mode !== 2'd0) begin
+                $display("    ovr_mode reset value %0d", ovr_mode);
+                errors = errors + 1;
+            end
+            // Policy in [13:12], hop size kept
+            wb_write(32'h78, 32'h0000_2010);
+            wb_read(32'h78, rd_data);
+            if (ovr_mode !== 2'd2 || hop_size !== 9'd16 || rd_data !== 32'h0000_2010) begin
+                $display("    FRAME_CFG = 0x%08h, ovr_mode %0d, hop %0d", rd_data,
+                         ovr_mode, hop_size);
+                errors = errors + 1;
+            end
+            // Overrun flag: sticky, cleared by writing 1, raises irq[0]
+            // only with its CTRL enable bit
+            wb_write(32'h18, 32'h0000_000F);
+            wb_write(32'h00, {20'd0, 4'b1000, 8'd0});
+            if (irq[0] !== 1'b0) errors = errors + 1;
+            @(posedge clk); overrun_in <= 1'b1;
+            @(posedge clk); overrun_in <= 1'b0;
+            repeat (2) @(posedge clk);
+            wb_read(32'h18, rd_data);
+            wb_read(32'h04, rd_data2);
+            if (rd_data[3:0] !== 4'b1000 || rd_data2[14] !== 1'b1 || irq[0] !== 1'b1) begin
+                $display("    IRQ_FLAGS = 0x%08h, STATUS = 0x%08h, irq %b", rd_data,
+                         rd_data2, irq[0]);
+                errors = errors + 1;
+            end
+            wb_read(32'h00, rd_data);
+            if (rd_data[11:8] !== 4'b1000) errors = errors + 1;
+            wb_write(32'h18, 32'h0000_0008);
+            wb_read(32'h04, rd_data2);
+            if (rd_data2[14] !== 1'b0 || irq[0] !== 1'b0) errors = errors + 1;
+            wb_write(32'h00, 32'h0000_0000);
+            wb_write(32'h78, 32'h0000_0040);
+            if (errors == 0) begin
+                $display("  PASS: Policy field, overrun flag, status bit and enable");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 21: Spectral averaging configuration
+        // ==================================================================
+        $display("");
+        $display("[TEST 21] AVG_CFG: averaging shift and interval");
+        begin : avg_check
+            integer errors;
+            errors = 0;
+            wb_read(32'hCC, rd_data);
+            if (avg_shift !== 3'd0 || avg_every !== 4'd0 || rd_data !== 32'd0) begin
+                $display("    reset: AVG_CFG = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            // Reserved bits read 0
+            wb_write(32'hCC, 32'hFFFF_F7FB);
+            wb_read(32'hCC, rd_data);
+            if (avg_shift !== 3'd3 || avg_every !== 4'd7 || rd_data !== 32'h0000_0703) begin
+                $display("    AVG_CFG = 0x%08h, shift %0d, every %0d", rd_data,
+                         avg_shift, avg_every);
+                errors = errors + 1;
+            end
+            wb_write(32'hCC, 32'h0000_0000);
+            if (errors == 0) begin
+                $display("  PASS: AVG_CFG fields");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 22: Change gate configuration
+        // ==================================================================
+        $display("");
+        $display("[TEST 22] GATE_CFG and the RES_FIFO reused bit");
+        begin : gate_check
+            integer errors;
+            reg [63:0] e;
+            errors = 0;
+            wb_read(32'hD0, rd_data);
+            if (gate_thr !== 12'd0 || gate_max !== 8'd0 || rd_data !== 32'd0) begin
+                $display("    reset: GATE_CFG = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            // Reserved bits read 0
+            wb_write(32'hD0, 32'hFFA5_F123);
+            wb_read(32'hD0, rd_data);
+            if (gate_thr !== 12'h123 || gate_max !== 8'hA5 || rd_data !== 32'h00A5_0123) begin
+                $display("    GATE_CFG = 0x%08h, threshold %0d, max %0d", rd_data,
+                         gate_thr, gate_max);
+                errors = errors + 1;
+            end
+            wb_write(32'hD0, 32'h0000_0000);
+            // One reused result, then one from an NN run
+            wb_write(32'hB0, 32'h0000_0100);    // Flush
+            result_reused = 1;
+            push_result(2);
+            result_reused = 0;
+            push_result(3);
+            e = res_entry(2);
+            wb_read(32'hA8, rd_data);
+            if (rd_data !== (e[31:0] | 32'h0000_4000)) begin
+                $display("    reused: RES_FIFO = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            e = res_entry(3);
+            wb_read(32'hA8, rd_data);
+            if (rd_data !== e[31:0]) begin
+                $display("    run: RES_FIFO = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            if (errors == 0) begin
+                $display("  PASS: GATE_CFG fields, bit 14 on the reused result only");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 23: ADC channels
+        // ==================================================================
+        $display("");
+        $display("[TEST 23] FRAME_CFG.CH, RES_FIFO_CH, SNAP_CTRL channel, AUTO byte");
+        begin : chan_check
+            integer errors, k, n0;
+            reg [63:0] e;
+            reg [7:0]  b, crc;
+            errors = 0;
+            wb_read(32'h78, rd_data);
+            if (n_ch !== 2'd0 || rd_data[17:16] !== 2'd0) begin
+                $display("    reset: FRAME_CFG = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            wb_write(32'h78, 32'h0002_0040);
+            wb_read(32'h78, rd_data);
+            if (n_ch !== 2'd2 || rd_data !== 32'h0002_0040) begin
+                $display("    FRAME_CFG = 0x%08h, n_ch %0d", rd_data, n_ch);
+                errors = errors + 1;
+            end
+            // The channel travels with the entry and latches on the pop
+            wb_write(32'hB0, 32'h0000_0100);    // Flush
+            result_ch = 2'd2;
+            push_result(1);
+            result_ch = 2'd1;
+            push_result(2);
+            result_ch = 2'd0;
+            wb_read(32'hA8, rd_data);
+            wb_read(32'hD4, rd_data2);
+            e = res_entry(1);
+            if (rd_data !== e[31:0] || rd_data2 !== 32'd2) begin
+                $display("    first: RES_FIFO = 0x%08h, RES_FIFO_CH = 0x%08h", rd_data, rd_data2);
+                errors = errors + 1;
+            end
+            wb_read(32'hA8, rd_data);
+            wb_read(32'hD4, rd_data2);
+            if (rd_data2 !== 32'd1) errors = errors + 1;
+            wb_read(32'hA8, rd_data);
+            wb_read(32'hD4, rd_data2);
+            if (rd_data !== 32'd0 || rd_data2 !== 32'd0) begin
+                $display("    empty: RES_FIFO_CH = 0x%08h", rd_data2);
+                errors = errors + 1;
+            end
+            // SNAP_CTRL[7:6]
+            snap_held  = 1;
+            snap_frame = 16'd77;
+            snap_size  = 2'd0;
+            snap_ch    = 2'd3;
+            wb_read(32'hBC, rd_data);
+            if (rd_data[7:6] !== 2'd3 || rd_data[31:16] !== 16'd77) begin
+                $display("    SNAP_CTRL = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            snap_held = 0;
+            snap_ch   = 2'd0;
+            // AUTO: 5-byte payload, the channel after the RES_FIFO word
+            uart_level = 5'd0;
+            wb_write(32'hB8, 32'h0001_0010);
+            n0 = uart_n;
+            result_ch = 2'd2;
+            push_result(4);
+            result_ch = 2'd0;
+            repeat (12) @(posedge clk);
+            e   = res_entry(4);
+            crc = 8'd0;
+            for (k = 1; k < 8; k = k + 1)
+                crc = crc8(crc, (k == 1) ? 8'h01 : (k == 2) ? 8'd5 :
+                                (k == 7) ? 8'd2 : e[8 * (k - 3) +: 8]);
+            for (k = 0; k < 9; k = k + 1) begin
+                case (k)
+                    0:       b = 8'hA5;
+                    1:       b = 8'h01;
+                    2:       b = 8'd5;
+                    7:       b = 8'd2;
+                    8:       b = crc;
+                    default: b = e[8 * (k - 3) +: 8];
+                endcase
+                if (uart_log[n0 + k] !== b) begin
+                    $display("    byte %0d: 0x%02h (expected 0x%02h)", k, uart_log[n0 + k], b);
+                    errors = errors + 1;
+                end
+            end
+            if (uart_n !== n0 + 9) errors = errors + 1;
+            wb_write(32'hB8, 32'h0000_0010);    // AUTO off
+            wb_write(32'h78, 32'h0000_0040);
+            if (errors == 0) begin
+                $display("  PASS: Channel field, per-entry channel, 9-byte AUTO frame");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 24: Sample period
+        // ==================================================================
+        $display("");
+        $display("[TEST 24] SAMPLE_PERIOD: sample timer, free running at reset");
+        begin : period_check
+            integer errors;
+            errors = 0;
+            wb_read(32'hD8, rd_data);
+            if (sample_period !== 24'd0 || rd_data !== 32'd0) begin
+                $display("    reset: SAMPLE_PERIOD = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            // Bits 31:24 read 0
+            wb_write(32'hD8, 32'hFF12_3456);
+            wb_read(32'hD8, rd_data);
+            if (sample_period !== 24'h12_3456 || rd_data !== 32'h0012_3456) begin
+                $display("    SAMPLE_PERIOD = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            wb_write(32'hD8, 32'h0000_0000);
+            if (errors == 0) begin
+                $display("  PASS: 24-bit period, reserved byte reads 0");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 25: Bus samples
+        // ==================================================================
+        $display("");
+        $display("[TEST 25] CTRL.INJECT / TRIG and SAMPLE_IN");
+        begin : inject_check
+            integer errors;
+            integer k;
+            reg [31:0] ctrl_q;
+            errors = 0;
+            wb_read(32'h00, ctrl_q);
+            // INJECT reads back, TRIG is a pulse that reads 0
+            wb_write(32'h00, 32'h0000_0003);
+            wb_write(32'h00, 32'h0000_0007);
+            wb_read(32'h00, rd_data);
+            if (rd_data[3:0] !== 4'h3 || !inject || trig_n !== 1) begin
+                $display("    CTRL = 0x%08h, inject %b, %0d triggers", rd_data, inject, trig_n);
+                errors = errors + 1;
+            end
+            // A sample taken at once: one pulse with the 12-bit code
+            inj_ready = 1;
+            wb_read(32'hDC, rd_data);
+            if (rd_data !== 32'd1) errors = errors + 1;
+            wb_write(32'hDC, 32'hFFFF_FABC);
+            if (inj_n !== 1 || inj_data_q !== 12'hABC) begin
+                $display("    %0d samples, last 0x%03h", inj_n, inj_data_q);
+                errors = errors + 1;
+            end
+            // Not ready: the ready bit reads 0 and a write is still acked
+            // at once (spi_adc_if drops and counts the sample)
+            inj_ready = 0;
+            wb_read(32'hDC, rd_data);
+            if (rd_data !== 32'd0) errors = errors + 1;
+            fork
+                wb_write(32'hDC, 32'h0000_0123);
+                begin : ack_watch
+                    for (k = 0; k < 20 && wb_ack_o !== 1'b1; k = k + 1)
+                        @(posedge clk);
+                    if (k > 4) begin
+                        $display("    not-ready write acked after %0d clocks", k);
+                        errors = errors + 1;
+                    end
+                end
+            join
+            if (inj_n !== 2 || inj_data_q !== 12'h123) begin
+                $display("    not-ready write: %0d samples, last 0x%03h", inj_n, inj_data_q);
+                errors = errors + 1;
+            end
+            // INJECT off: acked at once, dropped
+            inj_ready = 0;
+            wb_write(32'h00, 32'h0000_0001);
+            wb_write(32'hDC, 32'h0000_0456);
+            if (inj_n !== 2 || inject) errors = errors + 1;
+            wb_write(32'h00, ctrl_q);
+            if (errors == 0) begin
+                $display("  PASS: INJECT bit, TRIG pulse, SAMPLE_IN ready bit and ack");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
+        // ==================================================================
+        // Test 26: Resident models
+        // ==================================================================
+        $display("");
+        $display("[TEST 26] MODEL_CFG, PROFILE, EDIT bank, result bank field");
+        begin : model_check
+            integer errors, n0;
+            errors = 0;
+            wb_read(32'hE0, rd_data);
+            if (rd_data !== 32'd0 || model_per_ch || model_all || nn_bank !== 2'd0) begin
+                $display("    reset: MODEL_CFG = 0x%08h, active bank %0d", rd_data, nn_bank);
+                errors = errors + 1;
+            end
+            wb_write(32'hE0, 32'hFFF8_E431);    // Reserved bits read 0
+            wb_read(32'hE0, rd_data);
+            if (rd_data !== 32'h0000_E431 || !model_per_ch || model_all ||
+                model_map !== 8'hE4 || model_last !== 2'd3) begin
+                $display("    MODEL_CFG = 0x%08h", rd_data);
+                errors = errors + 1;
+            end
+            // The bank travels with the entry and latches on the pop
+            wb_write(32'hB0, 32'h0000_0100);    // Flush
+            result_model = 2'd1;
+            result_ch    = 2'd3;
+            push_result(1);
+            wb_read(32'hA8, rd_data);
+            wb_read(32'hD4, rd_data2);
+            if (rd_data2 !== 32'h0000_0013) begin
+                $display("    RES_FIFO_CH = 0x%08h", rd_data2);
+                errors = errors + 1;
+            end
+            // PER_CH on one channel: the AUTO frame still carries the tag byte
+            result_ch  = 2'd0;
+            uart_level = 5'd0;
+            wb_write(32'hB8, 32'h0001_0010);
+            n0 = uart_n;
+            push_result(4);
+            repeat (12) @(posedge clk);
+            if (uart_n !== n0 + 9 || uart_log[n0 + 7] !== 8'h10) begin
+                $display("    AUTO: %0d bytes, tag 0x%02h", uart_n - n0, uart_log[n0 + 7]);
+                errors = errors + 1;
+            end
+            wb_write(32'hB8, 32'h0000_0010);    // AUTO off
+            // PROFILE(1) replaces ALARM_CFG for bank-1 results only
+            wb_write(32'h0C, 32'h0000_0596);
+            wb_read(32'hE8, rd_data);
+            if (rd_data !== 32'h0000_0380) errors = errors + 1;
+            wb_write(32'hE8, 32'h0001_0740);
+            wb_read(32'hE8, rd_data);
+            wb_read(32'hEC, rd_data2);          // No bank 2 built
+            if (rd_data !== 32'h0001_0740 || rd_data2 !== 32'd0 ||
+                alarm_threshold !== 8'h40 || fault_count_cfg !== 4'd7) begin
+                $display("    PROFILE1 = 0x%08h: threshold %0d, count %0d",
+                         rd_data, alarm_threshold, fault_count_cfg);
+                errors = errors + 1;
+            end
+            result_model = 2'd0;
+            #1;
+            wb_read(32'h0C, rd_data);
+            if (rd_data !== 32'h0000_0596 || alarm_threshold !== 8'h96 ||
+                fault_count_cfg !== 4'd5) begin
+                $display("    bank 0: threshold %0d, count %0d", alarm_threshold, fault_count_cfg);
+                errors = errors + 1;
+            end
+            wb_write(32'hE8, 32'h0000_0740);    // EN off
+            result_model = 2'd1;
+            #1;
+            if (alarm_threshold !== 8'h96) errors = errors + 1;
+            result_model = 2'd0;
+            // EDIT_EN: the model registers edit the active bank 0
+            wb_write(32'hE0, 32'h0004_0000);
+            wb_write(32'hA0, 32'h0000_0010);
+            wb_write(32'hA4, 32'h1234_5678);
+            wb_write(32'h7C, {21'd0, 3'd3, 4'd0, NN_ROM_INT4});
+            wb_write(32'h80, 32'h0000_0408);
+            wb_read(32'h7C, rd_data);
+            if (wt_bank_q !== 2'd0 || nn_layers !== {3'd2, 3'd3} ||
+                nn_desc[31:0] !== 32'h0000_0408 || nn_desc[287:256] !== NN_ROM_DESC[31:0] ||
+                rd_data !== {21'd0, 3'd3, 4'd0, NN_ROM_INT4}) begin
+                $display("    EDIT 0: bank %0d, layers %o, NN_CFG = 0x%08h, SHAPE0 0x%08h",
+                         wt_bank_q, nn_layers, rd_data, nn_desc[31:0]);
+                errors = errors + 1;
+            end
+            wb_write(32'h80, NN_ROM_DESC[31:0]);
+            wb_write(32'h7C, {21'd0, NN_ROM_LAYERS, 4'd0, NN_ROM_INT4});
+            wb_write(32'hE0, 32'h0000_0000);
+            wb_write(32'hA4, 32'h0000_0000);
+            if (wt_bank_q !== 2'd1 || nn_layers !== {2{NN_ROM_LAYERS}}) errors = errors + 1;
+            wb_write(32'h0C, 32'h0000_0380);
+            if (errors == 0) begin
+                $display("  PASS: Model fields, per-bank profile, EDIT bank, bank in RES_FIFO_CH");
+                pass_count = pass_count + 1;
+            end else begin
+                $display("  FAIL: %0d mismatches", errors);
+                fail_count = fail_count + 1;
+            end
+        end
+
         // --- Summary ---
         $display("");
         $display("==========================================");
@@ -2,10 +2,19 @@
 // SenseEdge - Alarm & Interrupt Logic
 // Monitors classification results and generates alarms
 // Configurable confidence threshold and consecutive fault counter
+// With N_CH > 1 the faults of every ADC channel are counted on their own,
+// so one faulty axis between healthy ones still raises the alarm, and only
+// the channel that raised it clears it again. When several NN models
+// classify every vector in turn (MODEL_CFG.ALL) the counters are kept per
+// model instead, channel being the model, so the models never break each
+// other's runs. threshold and fault count are the alarm profile of the
+// model that produced the result (wb_interface PROFILE).
 
 `default_nettype none
 
-module alarm_logic (
+module alarm_logic #(
+    parameter N_CH = 1              // Fault counters: ADC channels / models (1-4)
+)(
     input  wire       clk,
     input  wire       rst,
 
@@ -13,6 +22,7 @@ module alarm_logic (
     input  wire       classification_done,  // Pulse on new result
     input  wire [1:0] class_id,
     input  wire [7:0] confidence,
+    input  wire [1:0] channel,              // ADC channel (or model) of the result
 
     // Configuration
     input  wire [7:0] alarm_threshold,      // Min confidence to count as fault
@@ -25,13 +35,20 @@ module alarm_logic (
 );
 
     // Class 0 = healthy, classes 1-3 = fault conditions
-    reg [3:0] consec_fault_count;
+    reg [3:0] consec_count [0:N_CH-1];
+    reg [1:0] alarm_ch;             // Channel that raised the alarm
 
-    always @(posedge clk) begin
+    wire [1:0] ch = (channel > N_CH - 1) ? N_CH - 1 : channel;
+    wire [3:0] consec_fault_count = consec_count[ch];
+
+    always @(posedge clk) begin : counters
+        integer c;
         if (rst) begin
             alarm_active      <= 1'b0;
             alarm_irq         <= 1'b0;
-            consec_fault_count <= 4'd0;
+            for (c = 0; c < N_CH; c = c + 1)
+                consec_count[c] <= 4'd0;
+            alarm_ch          <= 2'd0;
             last_fault_class  <= 2'd0;
         end else begin
             alarm_irq <= 1'b0;  // Default: single-cycle pulse
@@ -40,7 +57,7 @@ module alarm_logic (
                 if (class_id != 2'd0 && confidence >= alarm_threshold) begin
                     // Fault detected with sufficient confidence
                     if (consec_fault_count < 4'd15) begin
-                        consec_fault_count <= consec_fault_count + 4'd1;
+                        consec_count[ch] <= consec_fault_count + 4'd1;
                     end
                     last_fault_class <= class_id;
 
@@ -48,12 +65,13 @@ module alarm_logic (
                     if (consec_fault_count >= fault_count_cfg && !alarm_active) begin
                         alarm_active <= 1'b1;
                         alarm_irq    <= 1'b1;
+                        alarm_ch     <= ch;
                     end
                 end else begin
                     // Healthy classification or low confidence - reset counter
-                    consec_fault_count <= 4'd0;
+                    consec_count[ch] <= 4'd0;
                     // Clear alarm when machine returns to healthy
-                    if (class_id == 2'd0 && confidence >= alarm_threshold) begin
+                    if (class_id == 2'd0 && confidence >= alarm_threshold && ch == alarm_ch) begin
                         alarm_active <= 1'b0;
                     end
                 end
@@ -1,50 +1,97 @@
 // SPDX-License-Identifier: Apache-2.0
 // SenseEdge - Feature Extraction Engine
-// Computes 8 spectral features from 32 FFT magnitude bins
-// Outputs normalized 8-bit features for neural network input
+// Computes 8 spectral features from the N/2 FFT magnitude bins of an N-point
+// spectrum (N = 64/128/256). Band edges are fixed in frequency: they are
+// defined on 64-point bins and scale with N, and bin-count dependent sums are
+// normalised back to the 64-point scale, so one trained model fits all sizes.
+// The bins are consumed as the FFT magnitude pass produces them (valid /
+// index / data strobe), so the features are written on the clock that
+// takes the last bin: no second pass over the spectrum buffer.
+// Four time-domain features (RMS, peak, crest factor, kurtosis) come from
+// the raw samples of the same window, accumulated as the FFT load pass
+// reads them (smp_valid / smp_data) and normalised by a small sequential
+// unit while the FFT runs, so they are ready with the spectral ones.
+// Outputs normalized 8-bit features for neural network input into a
+// double-buffered feature memory, so the NN can run on frame N while the
+// next frame's features are computed
 
 `default_nettype none
 
-module feature_extract (
+module feature_extract #(
+    parameter LOG2_NMAX = 6         // Largest FFT length: 6/7/8 = 64/128/256
+)(
     input  wire        clk,
     input  wire        rst,
 
-    // Input interface (FFT magnitude bins)
-    input  wire        start,          // Pulse to begin feature extraction
-    output reg  [4:0]  mag_addr,       // Address to read FFT magnitude bin
-    input  wire [15:0] mag_in,         // Magnitude bin data
+    // Input interface (FFT magnitude stream)
+    input  wire        start,          // Pulse with the FFT start: clear, latch size
+    input  wire [1:0]  fft_size,       // Spectrum length: 0 = 64, 1 = 128, 2 = 256
+    input  wire        bin_valid,      // A magnitude bin is on bin_mag this clock
+    input  wire [LOG2_NMAX-2:0] bin_idx,   // Its bin index (0 to N/2-1, in order)
+    input  wire [15:0] bin_mag,        // Its magnitude
+
+    // Raw sample stream of the same window (FFT load pass)
+    input  wire        smp_valid,      // A window sample is on smp_data this clock
+    input  wire [15:0] smp_data,       // Sign-extended 12-bit ADC sample
 
     // Output interface
     output reg         done,           // Pulses when features ready
-    output wire [7:0]  feature_out,    // Feature read port
-    input  wire [2:0]  feature_addr,   // Feature address (0-7)
+    output wire [7:0]  feature_out,    // Feature read port (12-15 read 0)
+    input  wire [4:0]  feature_addr,   // {bank, feature}: bank select + index (0-11)
+    output reg         feat_bank,      // Bank holding the last completed vector
+    input  wire        vec_bank,       // Bank on feature_vec
+    output wire [95:0] feature_vec,    // Whole vector of vec_bank, feature 0 in [7:0]
+    output wire [95:0] last_vec,       // Whole vector of feat_bank (change gating)
     output reg         busy
 );
 
-    // --- Feature storage (8 features, 8-bit each) ---
-    reg [7:0] features [0:7];
+    localparam N_FEAT = 12;
+
+    // --- Feature storage (12 features, 8-bit each), two banks ---
+    // Each frame is written into ~feat_bank; feat_bank flips on done.
+    reg [7:0] features [0:31];
+
+    assign feature_out = (feature_addr[3:0] < N_FEAT) ? features[feature_addr] : 8'd0;
 
-    assign feature_out = features[feature_addr];
+    genvar v;
+    generate
+        for (v = 0; v < N_FEAT; v = v + 1) begin : g_vec
+            assign feature_vec[8*v +: 8] = features[{vec_bank, v[3:0]}];
+            assign last_vec[8*v +: 8]    = features[{feat_bank, v[3:0]}];
+        end
+    endgenerate
 
-    // Feature indices:
+    // Feature indices (bins in 64-point units, i.e. bin >> fft_size):
     // [0] Band energy low     (bins 1-4)
     // [1] Band energy mid-low (bins 5-10)
     // [2] Band energy mid-hi  (bins 11-20)
     // [3] Band energy high    (bins 21-31)
-    // [4] Peak frequency      (bin index of max magnitude)
+    // [4] Peak frequency      (bin index of max magnitude, full resolution)
     // [5] Peak magnitude      (value at peak bin, scaled)
     // [6] Spectral centroid   (weighted average frequency)
     // [7] Total energy        (sum of all bins, scaled)
+    // Sums over 2^fft_size fine bins per 64-point bin are shifted right by
+    // fft_size, which keeps a pure tone's features independent of N.
+    // Time-domain features of the N raw samples x (|x| saturated to 2047):
+    // [8]  RMS                 isqrt(mean(x^2) - mean(x)^2) >> 3
+    // [9]  Peak                max|x| >> 3
+    // [10] Crest factor        16 * max|x| / RMS (saturated)
+    // [11] Kurtosis            16 * mean(q^2) / mean(q)^2, q = x^2 >> 6,
+    //                          about zero (3 for Gaussian noise -> 48)
+    // The means are floor(sum >> log2 N), as in ml/train_senseedge.py.
+
+    localparam BW = LOG2_NMAX - 1;              // Bin index width
+    localparam [1:0] SIZE_MAX = LOG2_NMAX - 6;
 
     // --- FSM ---
-    localparam S_IDLE    = 3'd0;
-    localparam S_SCAN    = 3'd1;
-    localparam S_ACCUM   = 3'd2;
-    localparam S_NORM    = 3'd3;
-    localparam S_DONE    = 3'd4;
+    localparam S_IDLE    = 2'd0;
+    localparam S_STREAM  = 2'd1;    // Accumulating the bins of one spectrum
+    localparam S_TAIL    = 2'd2;    // Spectral features written, time ones pending
+
+    reg [1:0]    state;
+    reg [1:0]    size_q;        // Spectrum length of the frame in progress
 
-    reg [2:0]  state;
-    reg [4:0]  scan_idx;
+    wire [BW-1:0] bin_last = ({{(BW-1){1'b0}}, 1'b1} << (3'd5 + size_q)) - 1'b1;
 
     // Accumulators
     reg [23:0] band_low;        // Sum bins 1-4
@@ -52,122 +99,280 @@ module feature_extract (
     reg [23:0] band_midhi;      // Sum bins 11-20
     reg [23:0] band_high;       // Sum bins 21-31
     reg [15:0] peak_mag;        // Maximum magnitude seen
-    reg [4:0]  peak_bin;        // Bin index of maximum
+    reg [BW-1:0] peak_bin;      // Bin index of maximum
     reg [31:0] weighted_sum;    // For spectral centroid: sum(bin * mag)
     reg [23:0] total_energy;    // Sum of all bins
 
-    // Pipeline delay for memory read
-    reg [4:0]  scan_idx_d;
-    reg        accum_valid;
+    // --- Accumulator update for the bin on the stream ---
+    // Bin being accumulated, in 64-point units
+    wire [4:0] bin64 = bin_idx >> size_q;
+
+    wire [23:0]   low_nx      = (bin64 >= 5'd1  && bin64 <= 5'd4)
+                                ? band_low    + {8'd0, bin_mag} : band_low;
+    wire [23:0]   midlow_nx   = (bin64 >= 5'd5  && bin64 <= 5'd10)
+                                ? band_midlow + {8'd0, bin_mag} : band_midlow;
+    wire [23:0]   midhi_nx    = (bin64 >= 5'd11 && bin64 <= 5'd20)
+                                ? band_midhi  + {8'd0, bin_mag} : band_midhi;
+    wire [23:0]   high_nx     = (bin64 >= 5'd21 && bin64 <= 5'd31)
+                                ? band_high   + {8'd0, bin_mag} : band_high;
+    wire          peak_upd    = (bin_mag > peak_mag);
+    wire [15:0]   peak_mag_nx = peak_upd ? bin_mag : peak_mag;
+    wire [BW-1:0] peak_bin_nx = peak_upd ? bin_idx : peak_bin;
+    wire [31:0]   weighted_nx = weighted_sum + (bin_mag * bin64);
+    wire [23:0]   total_nx    = total_energy + {8'd0, bin_mag};
+
+    wire last_bin = (state == S_STREAM) && bin_valid && (bin_idx == bin_last);
+
+    // --- Time-domain statistics ---
+    reg signed [23:0] t_sum;    // Sum x
+    reg [29:0]   t_sq;          // Sum x^2
+    reg [39:0]   t_q2;          // Sum (x^2 >> 6)^2
+    reg [10:0]   t_peak;        // Max |x|
+    reg [8:0]    t_cnt;         // Samples accumulated
+
+    wire [15:0] smp_abs  = smp_data[15] ? -smp_data : smp_data;
+    wire [10:0] smp_mag  = (smp_abs > 16'd2047) ? 11'd2047 : smp_abs[10:0];
+    wire [21:0] smp_sq   = smp_mag * smp_mag;
+    wire [15:0] smp_q    = smp_sq[21:6];
+    wire [31:0] smp_q2   = smp_q * smp_q;
+    wire        smp_last = smp_valid && (t_cnt == ({8'd0, 1'b1} << (4'd6 + size_q)) - 1'b1);
+
+    // Means over N = 2^(6 + size_q) samples
+    wire [3:0]         t_log2n = 4'd6 + {2'b00, size_q};
+    wire signed [23:0] t_mean  = t_sum >>> t_log2n;
+    wire [21:0]        t_ms    = t_sq >> t_log2n;
+    wire [43:0]        t_mean2 = t_mean * t_mean;
+    wire [21:0]        t_var   = (t_mean2 >= {22'd0, t_ms}) ? 22'd0 : t_ms - t_mean2[21:0];
+    wire [15:0]        t_m2    = t_sq >> (t_log2n + 4'd6);
+    wire [31:0]        t_m2sq  = t_m2 * t_m2;
+    wire [31:0]        t_m4    = t_q2 >> t_log2n;
+
+    // Normalising unit: integer square root (RMS), then two 8-bit
+    // saturating divisions (kurtosis alongside the root, crest after it)
+    localparam T_IDLE = 3'd0;
+    localparam T_GO   = 3'd1;       // Sums final, set up the root and division
+    localparam T_ROOT = 3'd2;       // Root and kurtosis division
+    localparam T_CRST = 3'd3;       // Crest division
+    localparam T_DONE = 3'd4;       // Time features of this frame ready
+
+    reg [2:0]  t_state;
+    reg [21:0] sq_num;          // Root: remainder, result, current bit
+    reg [21:0] sq_res;
+    reg [21:0] sq_bit;
+    reg [43:0] dv_num;          // Division: remainder, shifted divisor, quotient
+    reg [43:0] dv_den;
+    reg [7:0]  dv_q;
+    reg [3:0]  dv_i;            // Quotient bits left
+    reg [7:0]  tf_rms;          // Features 8-11 of the frame in progress
+    reg [7:0]  tf_peak;
+    reg [7:0]  tf_crest;
+    reg [7:0]  tf_kurt;
+
+    wire [21:0] sq_try  = sq_res + sq_bit;
+    wire        dv_fit  = (dv_num >= dv_den);
+    wire [10:0] rms     = sq_res[10:0];
+
+    // Division set-up: quotient saturates at 255, x / 0 reads 255 (0 / 0 = 0)
+    task div_start;
+        input [43:0] num;
+        input [43:0] den;
+        begin
+            dv_num <= num;
+            dv_den <= den << 7;
+            if (den == 44'd0 || num >= (den << 8)) begin
+                dv_q <= (num == 44'd0) ? 8'd0 : 8'hFF;
+                dv_i <= 4'd0;
+            end else begin
+                dv_q <= 8'd0;
+                dv_i <= 4'd8;
+            end
+        end
+    endtask
+
+    always @(posedge clk) begin
+        if (rst) begin
+            t_state <= T_IDLE;
+            t_cnt   <= 9'd0;
+            sq_bit  <= 22'd0;
+            dv_i    <= 4'd0;
+        end else begin
+            // Accumulate every sample of the window as the FFT loads it
+            if (start) begin
+                t_sum   <= 24'sd0;
+                t_sq    <= 30'd0;
+                t_q2    <= 40'd0;
+                t_peak  <= 11'd0;
+                t_cnt   <= 9'd0;
+                t_state <= T_IDLE;
+            end else if (smp_valid && t_state == T_IDLE) begin
+                t_sum  <= t_sum + {{8{smp_data[15]}}, smp_data};
+                t_sq   <= t_sq + smp_sq;
+                t_q2   <= t_q2 + smp_q2;
+                if (smp_mag > t_peak)
+                    t_peak <= smp_mag;
+                t_cnt  <= t_cnt + 9'd1;
+                if (smp_last)
+                    t_state <= T_GO;
+            end
+
+            // One root and one division step per clock
+            if (dv_i != 4'd0) begin
+                dv_i   <= dv_i - 4'd1;
+                dv_den <= dv_den >> 1;
+                dv_q   <= {dv_q[6:0], dv_fit};
+                if (dv_fit)
+                    dv_num <= dv_num - dv_den;
+            end
+            if (sq_bit != 22'd0) begin
+                sq_bit <= sq_bit >> 2;
+                if (sq_num >= sq_try) begin
+                    sq_num <= sq_num - sq_try;
+                    sq_res <= (sq_res >> 1) + sq_bit;
+                end else begin
+                    sq_res <= sq_res >> 1;
+                end
+            end
+
+            case (t_state)
+                T_GO: begin
+                    sq_num  <= t_var;
+                    sq_res  <= 22'd0;
+                    sq_bit  <= 22'h100000;      // Highest power of 4 below 2^22
+                    div_start({8'd0, t_m4, 4'd0}, {12'd0, t_m2sq});
+                    t_state <= T_ROOT;
+                end
+                T_ROOT: begin
+                    if (sq_bit == 22'd0 && dv_i == 4'd0) begin
+                        tf_rms  <= rms[10:3];
+                        tf_peak <= t_peak[10:3];
+                        tf_kurt <= dv_q;
+                        div_start({29'd0, t_peak, 4'd0}, {33'd0, rms});
+                        t_state <= T_CRST;
+                    end
+                end
+                T_CRST: begin
+                    if (dv_i == 4'd0) begin
+                        tf_crest <= dv_q;
+                        t_state <= T_DONE;
+                    end
+                end
+                default: ;
+            endcase
+        end
+    end
+
+    // Time features still being normalised; a frame without samples (bins
+    // streamed on their own) gets 0
+    wire t_busy = (t_state == T_GO || t_state == T_ROOT || t_state == T_CRST);
+    wire t_ok   = (t_state == T_DONE);
 
     always @(posedge clk) begin
         if (rst) begin
             state       <= S_IDLE;
             done        <= 1'b0;
             busy        <= 1'b0;
-            mag_addr    <= 5'd0;
-            scan_idx    <= 5'd0;
-            accum_valid <= 1'b0;
+            size_q      <= 2'd0;
+            feat_bank   <= 1'b1;    // First vector lands in bank 0
         end else begin
-            done        <= 1'b0;
-            accum_valid <= 1'b0;
+            done <= 1'b0;
 
             case (state)
                 S_IDLE: begin
                     if (start) begin
-                        state        <= S_SCAN;
+                        state        <= S_STREAM;
                         busy         <= 1'b1;
-                        scan_idx     <= 5'd0;
-                        mag_addr     <= 5'd0;
+                        size_q       <= (fft_size > SIZE_MAX) ? SIZE_MAX : fft_size;
                         band_low     <= 24'd0;
                         band_midlow  <= 24'd0;
                         band_midhi   <= 24'd0;
                         band_high    <= 24'd0;
                         peak_mag     <= 16'd0;
-                        peak_bin     <= 5'd0;
+                        peak_bin     <= {BW{1'b0}};
                         weighted_sum <= 32'd0;
                         total_energy <= 24'd0;
                     end
                 end
 
-                // Read each bin sequentially, pipeline by 1 cycle
-                S_SCAN: begin
-                    scan_idx_d  <= scan_idx;
-                    accum_valid <= (scan_idx > 5'd0);  // First read has 1-cycle latency
-
-                    if (scan_idx == 5'd31) begin
-                        state    <= S_ACCUM;
-                        mag_addr <= 5'd0;
-                    end else begin
-                        scan_idx <= scan_idx + 5'd1;
-                        mag_addr <= scan_idx + 5'd1;
+                // Accumulate each bin as it arrives
+                S_STREAM: begin
+                    if (bin_valid) begin
+                        band_low     <= low_nx;
+                        band_midlow  <= midlow_nx;
+                        band_midhi   <= midhi_nx;
+                        band_high    <= high_nx;
+                        peak_mag     <= peak_mag_nx;
+                        peak_bin     <= peak_bin_nx;
+                        weighted_sum <= weighted_nx;
+                        total_energy <= total_nx;
                     end
-                end
 
-                // Process last bin
-                S_ACCUM: begin
-                    accum_valid <= 1'b1;
-                    scan_idx_d  <= 5'd31;
-                    state       <= S_NORM;
-                end
+                    // Normalize features to 8-bit from the final sums
+                    if (last_bin) begin : norm_block
+                        reg [23:0] n_low, n_midlow, n_midhi, n_high, n_total;
+                        reg [15:0] n_peak;
+                        reg [31:0] n_weighted;
+                        reg [9:0]  peak_scaled;
+                        // Back to the 64-point bin scale
+                        n_low      = low_nx      >> size_q;
+                        n_midlow   = midlow_nx   >> size_q;
+                        n_midhi    = midhi_nx    >> size_q;
+                        n_high     = high_nx     >> size_q;
+                        n_total    = total_nx    >> size_q;
+                        n_peak     = peak_mag_nx >> size_q;
+                        n_weighted = weighted_nx >> size_q;
+                        // Peak bin / (N/2) scaled to 0-255: peak_bin << (3 - fft_size)
+                        peak_scaled = {{(10-BW){1'b0}}, peak_bin_nx} << (2'd3 - size_q);
 
-                // Normalize features to 8-bit
-                S_NORM: begin
-                    // Band energies: right-shift to fit 8 bits
-                    features[0] <= (band_low[23:16]    != 0) ? 8'hFF : band_low[15:8];
-                    features[1] <= (band_midlow[23:16] != 0) ? 8'hFF : band_midlow[15:8];
-                    features[2] <= (band_midhi[23:16]  != 0) ? 8'hFF : band_midhi[15:8];
-                    features[3] <= (band_high[23:16]   != 0) ? 8'hFF : band_high[15:8];
+                        // Band energies: right-shift to fit 8 bits
+                        features[{~feat_bank, 4'd0}] <= (n_low[23:16]    != 0) ? 8'hFF : n_low[15:8];
+                        features[{~feat_bank, 4'd1}] <= (n_midlow[23:16] != 0) ? 8'hFF : n_midlow[15:8];
+                        features[{~feat_bank, 4'd2}] <= (n_midhi[23:16]  != 0) ? 8'hFF : n_midhi[15:8];
+                        features[{~feat_bank, 4'd3}] <= (n_high[23:16]   != 0) ? 8'hFF : n_high[15:8];
 
-                    // Peak bin index scaled to 0-255 range: (peak_bin * 255) / 31 ≈ peak_bin * 8
-                    features[4] <= {peak_bin, 3'b000};
+                        // Peak bin index scaled to 0-255 range: (peak_bin * 255) / 31 ≈ peak_bin * 8
+                        features[{~feat_bank, 4'd4}] <= peak_scaled[7:0];
 
-                    // Peak magnitude (top 8 bits)
-                    features[5] <= peak_mag[15:8];
+                        // Peak magnitude (top 8 bits)
+                        features[{~feat_bank, 4'd5}] <= n_peak[15:8];
 
-                    // Spectral centroid: weighted_sum / total_energy, scaled
-                    // Approximate: use top bits of weighted_sum
-                    features[6] <= (total_energy == 0) ? 8'd0 : weighted_sum[23:16];
+                        // Spectral centroid: weighted_sum / total_energy, scaled
+                        // Approximate: use top bits of weighted_sum
+                        features[{~feat_bank, 4'd6}] <= (n_total == 0) ? 8'd0 : n_weighted[23:16];
 
-                    // Total energy (top 8 bits)
-                    features[7] <= (total_energy[23:16] != 0) ? 8'hFF : total_energy[15:8];
+                        // Total energy (top 8 bits)
+                        features[{~feat_bank, 4'd7}] <= (n_total[23:16] != 0) ? 8'hFF : n_total[15:8];
 
-                    state <= S_DONE;
+                        if (t_busy) begin
+                            state     <= S_TAIL;
+                        end else begin
+                            features[{~feat_bank, 4'd8}]  <= t_ok ? tf_rms   : 8'd0;
+                            features[{~feat_bank, 4'd9}]  <= t_ok ? tf_peak  : 8'd0;
+                            features[{~feat_bank, 4'd10}] <= t_ok ? tf_crest : 8'd0;
+                            features[{~feat_bank, 4'd11}] <= t_ok ? tf_kurt  : 8'd0;
+                            done      <= 1'b1;
+                            busy      <= 1'b0;
+                            feat_bank <= ~feat_bank;
+                            state     <= S_IDLE;
+                        end
+                    end
                 end
 
-                S_DONE: begin
-                    done <= 1'b1;
-                    busy <= 1'b0;
-                    state <= S_IDLE;
+                // Publish once the time features are in as well
+                S_TAIL: begin
+                    if (!t_busy) begin
+                        features[{~feat_bank, 4'd8}]  <= tf_rms;
+                        features[{~feat_bank, 4'd9}]  <= tf_peak;
+                        features[{~feat_bank, 4'd10}] <= tf_crest;
+                        features[{~feat_bank, 4'd11}] <= tf_kurt;
+                        done      <= 1'b1;
+                        busy      <= 1'b0;
+                        feat_bank <= ~feat_bank;
+                        state     <= S_IDLE;
+                    end
                 end
 
                 default: state <= S_IDLE;
             endcase
-
-            // --- Accumulation logic (runs during S_SCAN and S_ACCUM) ---
-            if (accum_valid) begin
-                // Total energy
-                total_energy <= total_energy + {8'd0, mag_in};
-
-                // Weighted sum for centroid
-                weighted_sum <= weighted_sum + (mag_in * scan_idx_d);
-
-                // Peak detection
-                if (mag_in > peak_mag) begin
-                    peak_mag <= mag_in;
-                    peak_bin <= scan_idx_d;
-                end
-
-                // Band accumulation
-                if (scan_idx_d >= 5'd1 && scan_idx_d <= 5'd4)
-                    band_low <= band_low + {8'd0, mag_in};
-                if (scan_idx_d >= 5'd5 && scan_idx_d <= 5'd10)
-                    band_midlow <= band_midlow + {8'd0, mag_in};
-                if (scan_idx_d >= 5'd11 && scan_idx_d <= 5'd20)
-                    band_midhi <= band_midhi + {8'd0, mag_in};
-                if (scan_idx_d >= 5'd21 && scan_idx_d <= 5'd31)
-                    band_high <= band_high + {8'd0, mag_in};
-            end
         end
     end
 
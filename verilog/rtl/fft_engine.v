@@ -1,126 +1,725 @@
 // SPDX-License-Identifier: Apache-2.0
-// SenseEdge - 64-Point Radix-2 DIT FFT Engine
+// SenseEdge - 64/128/256-Point Radix-2 DIT FFT Engine
 // Fixed-point: 16-bit input, 24-bit internal, 16-bit magnitude output
-// Single butterfly unit, time-multiplexed across all stages
-// Outputs 32 magnitude bins (DC to Nyquist)
+// Transform length selected per frame (fft_size) up to the synthesis-time
+// maximum 2^LOG2_NMAX; twiddles, bit-reversal and stage counters follow it.
+// Butterfly datapath selected at build time by FFT_ARCH (see schedule below):
+// one radix-2 unit at 1 per 2 clk or 1 per clk, two units, or a radix-2^2
+// pass that folds two stages into one. All options are bit-exact.
+// REAL_FFT packs even/odd samples into Re/Im of an N/2-point complex FFT and
+// recovers the N-point real spectrum in a split step fused into the
+// magnitude pass: ~half the butterflies and half the data storage.
+// Outputs N/2 magnitude bins (DC to Nyquist) into a double-buffered spectrum
+// memory, so the next frame can be transformed while the last one is read.
+// The same bins are streamed out (bin_valid / bin_idx / bin_mag) as the
+// magnitude pass produces them, for feature extraction on the fly.
+// The sample ring and the spectrum buffer are synchronous-read memories:
+// sample_in and mag_out are valid the clock after their address.
+// USE_SRAM moves data_re/data_im and the spectrum buffer into SRAM macros.
+// The working data is then split into two banks by index parity, so both
+// points of a butterfly are read in one clock and written back in the next:
+// this is the 2-clk schedule, and USE_SRAM always builds FFT_ARCH 0.
+// WINDOW multiplies each sample by a Hann or Hamming coefficient as it is
+// loaded, so windowing adds no cycles. load_valid marks the raw samples on
+// sample_in during the load, for the time-domain features.
 
 `default_nettype none
 
-module fft_engine (
+module fft_engine #(
+    parameter FFT_ARCH  = 0,        // 0: 2-clk, 1: 1-clk, 2: dual, 3: radix-2^2
+    parameter REAL_FFT  = 0,        // 1: real-input FFT via N/2-point complex FFT
+    parameter LOG2_NMAX = 6,        // Largest supported length: 6/7/8 = 64/128/256
+    parameter USE_SRAM  = 0,        // 1: working data and spectrum in SRAM macros
+    parameter WINDOW    = 0         // 0: rectangular, 1: Hann, 2: Hamming
+)(
     input  wire        clk,
     input  wire        rst,
 
     // Input interface
     input  wire        start,          // Pulse to begin FFT computation
-    input  wire [15:0] sample_in,      // Sample data from buffer
-    output reg  [5:0]  sample_addr,    // Address to read from sample buffer
+    input  wire [1:0]  fft_size,       // Length: 0 = 64, 1 = 128, 2 = 256 (latched on start)
+    input  wire [15:0] sample_in,      // Sample data from buffer (one clock latency)
+    output reg  [LOG2_NMAX-1:0] sample_addr,   // Address to read from sample buffer
 
     // Output interface
     output reg         done,           // Pulses when FFT complete
-    output wire [15:0] mag_out,        // Magnitude bin read port
-    input  wire [4:0]  mag_addr,       // Magnitude bin address (0-31)
-    output reg         busy
+    output wire [15:0] mag_out,        // Magnitude bin read port (one clock latency)
+    output wire        bin_valid,      // Magnitude stream: bin_idx / bin_mag valid
+    output wire [LOG2_NMAX-2:0] bin_idx,   // Bin produced this clock (in order)
+    output wire [15:0] bin_mag,        // Its magnitude (also written to the buffer)
+    input  wire [LOG2_NMAX-1:0] mag_addr,      // {bank, bin}: bank select + bin (0 to N/2-1)
+    output reg         mag_bank,       // Bank holding the last completed spectrum
+    output reg  [1:0]  mag_size,       // fft_size of the spectrum in mag_bank
+    output reg         busy,
+    output wire        loading,        // High while reading the sample buffer
+    output wire        load_valid      // A frame sample is on sample_in (each once)
 );
 
+    // --- Transform size ---
+    // Complex points actually transformed: N, or N/2 in REAL_FFT mode
+    localparam NMAX   = 1 << LOG2_NMAX;
+    localparam AW     = LOG2_NMAX;              // Sample / data index width
+    localparam LOG2_M = LOG2_NMAX - REAL_FFT;
+    localparam DATA_N = 1 << LOG2_M;
+    localparam [1:0] SIZE_MAX = LOG2_NMAX - 6;
+    localparam BKW    = LOG2_M - 1;             // SRAM bank word address width
+
+    // Datapath actually built
+    localparam ARCH   = USE_SRAM ? 0 : FFT_ARCH;
+
     // --- Internal storage ---
     // Real and imaginary parts, 24-bit to preserve precision
-    reg signed [23:0] data_re [0:63];
-    reg signed [23:0] data_im [0:63];
+    // (flops; unused and removed with USE_SRAM, see SRAM working storage)
+    reg signed [23:0] data_re [0:DATA_N-1];
+    reg signed [23:0] data_im [0:DATA_N-1];
 
-    // Magnitude output buffer (16-bit unsigned)
-    reg [15:0] mag_buf [0:31];
+    // --- Twiddle factor ROM ---
+    // W(k,256) = cos(2*pi*k/256) - j*sin(2*pi*k/256), Q1.14 (scaled by 16384)
+    // Indexed in W256 units for every length: W(k,N) = W(k*256/N, 256).
+    // Smaller LOG2_NMAX only ever reach every 2nd / 4th entry, and synthesis
+    // drops the rest. Every 4th entry is the original 64-point table.
+    function [31:0] tw_rom;
+        input [6:0] k;
+        reg signed [15:0] re, im;
+        begin
+            case (k)
+            7'd0:  begin re =  16384; im =      0; end
+            7'd1:  begin re =  16379; im =   -402; end
+            7'd2:  begin re =  16364; im =   -804; end
+            7'd3:  begin re =  16340; im =  -1205; end
+            7'd4:  begin re =  16305; im =  -1608; end
+            7'd5:  begin re =  16261; im =  -2006; end
+            7'd6:  begin re =  16207; im =  -2404; end
+            7'd7:  begin re =  16143; im =  -2801; end
+            7'd8:  begin re =  16069; im =  -3196; end
+            7'd9:  begin re =  15986; im =  -3590; end
+            7'd10: begin re =  15893; im =  -3981; end
+            7'd11: begin re =  15791; im =  -4370; end
+            7'd12: begin re =  15679; im =  -4756; end
+            7'd13: begin re =  15557; im =  -5139; end
+            7'd14: begin re =  15426; im =  -5520; end
+            7'd15: begin re =  15286; im =  -5897; end
+            7'd16: begin re =  15137; im =  -6270; end
+            7'd17: begin re =  14978; im =  -6639; end
+            7'd18: begin re =  14811; im =  -7005; end
+            7'd19: begin re =  14635; im =  -7366; end
+            7'd20: begin re =  14449; im =  -7723; end
+            7'd21: begin re =  14256; im =  -8076; end
+            7'd22: begin re =  14053; im =  -8423; end
+            7'd23: begin re =  13842; im =  -8765; end
+            7'd24: begin re =  13623; im =  -9102; end
+            7'd25: begin re =  13395; im =  -9434; end
+            7'd26: begin re =  13160; im =  -9760; end
+            7'd27: begin re =  12916; im = -10080; end
+            7'd28: begin re =  12665; im = -10394; end
+            7'd29: begin re =  12406; im = -10702; end
+            7'd30: begin re =  12140; im = -11003; end
+            7'd31: begin re =  11866; im = -11297; end
+            7'd32: begin re =  11585; im = -11585; end
+            7'd33: begin re =  11297; im = -11866; end
+            7'd34: begin re =  11003; im = -12140; end
+            7'd35: begin re =  10702; im = -12406; end
+            7'd36: begin re =  10394; im = -12665; end
+            7'd37: begin re =  10080; im = -12916; end
+            7'd38: begin re =   9760; im = -13160; end
+            7'd39: begin re =   9434; im = -13395; end
+            7'd40: begin re =   9102; im = -13623; end
+            7'd41: begin re =   8765; im = -13842; end
+            7'd42: begin re =   8423; im = -14053; end
+            7'd43: begin re =   8076; im = -14256; end
+            7'd44: begin re =   7723; im = -14449; end
+            7'd45: begin re =   7366; im = -14635; end
+            7'd46: begin re =   7005; im = -14811; end
+            7'd47: begin re =   6639; im = -14978; end
+            7'd48: begin re =   6270; im = -15137; end
+            7'd49: begin re =   5897; im = -15286; end
+            7'd50: begin re =   5520; im = -15426; end
+            7'd51: begin re =   5139; im = -15557; end
+            7'd52: begin re =   4756; im = -15679; end
+            7'd53: begin re =   4370; im = -15791; end
+            7'd54: begin re =   3981; im = -15893; end
+            7'd55: begin re =   3590; im = -15986; end
+            7'd56: begin re =   3196; im = -16069; end
+            7'd57: begin re =   2801; im = -16143; end
+            7'd58: begin re =   2404; im = -16207; end
+            7'd59: begin re =   2006; im = -16261; end
+            7'd60: begin re =   1608; im = -16305; end
+            7'd61: begin re =   1205; im = -16340; end
+            7'd62: begin re =    804; im = -16364; end
+            7'd63: begin re =    402; im = -16379; end
+            7'd64: begin re =      0; im = -16384; end
+            7'd65: begin re =   -402; im = -16379; end
+            7'd66: begin re =   -804; im = -16364; end
+            7'd67: begin re =  -1205; im = -16340; end
+            7'd68: begin re =  -1608; im = -16305; end
+            7'd69: begin re =  -2006; im = -16261; end
+            7'd70: begin re =  -2404; im = -16207; end
+            7'd71: begin re =  -2801; im = -16143; end
+            7'd72: begin re =  -3196; im = -16069; end
+            7'd73: begin re =  -3590; im = -15986; end
+            7'd74: begin re =  -3981; im = -15893; end
+            7'd75: begin re =  -4370; im = -15791; end
+            7'd76: begin re =  -4756; im = -15679; end
+            7'd77: begin re =  -5139; im = -15557; end
+            7'd78: begin re =  -5520; im = -15426; end
+            7'd79: begin re =  -5897; im = -15286; end
+            7'd80: begin re =  -6270; im = -15137; end
+            7'd81: begin re =  -6639; im = -14978; end
+            7'd82: begin re =  -7005; im = -14811; end
+            7'd83: begin re =  -7366; im = -14635; end
+            7'd84: begin re =  -7723; im = -14449; end
+            7'd85: begin re =  -8076; im = -14256; end
+            7'd86: begin re =  -8423; im = -14053; end
+            7'd87: begin re =  -8765; im = -13842; end
+            7'd88: begin re =  -9102; im = -13623; end
+            7'd89: begin re =  -9434; im = -13395; end
+            7'd90: begin re =  -9760; im = -13160; end
+            7'd91: begin re = -10080; im = -12916; end
+            7'd92: begin re = -10394; im = -12665; end
+            7'd93: begin re = -10702; im = -12406; end
+            7'd94: begin re = -11003; im = -12140; end
+            7'd95: begin re = -11297; im = -11866; end
+            7'd96: begin re = -11585; im = -11585; end
+            7'd97: begin re = -11866; im = -11297; end
+            7'd98: begin re = -12140; im = -11003; end
+            7'd99: begin re = -12406; im = -10702; end
+            7'd100: begin re = -12665; im = -10394; end
+            7'd101: begin re = -12916; im = -10080; end
+            7'd102: begin re = -13160; im =  -9760; end
+            7'd103: begin re = -13395; im =  -9434; end
+            7'd104: begin re = -13623; im =  -9102; end
+            7'd105: begin re = -13842; im =  -8765; end
+            7'd106: begin re = -14053; im =  -8423; end
+            7'd107: begin re = -14256; im =  -8076; end
+            7'd108: begin re = -14449; im =  -7723; end
+            7'd109: begin re = -14635; im =  -7366; end
+            7'd110: begin re = -14811; im =  -7005; end
+            7'd111: begin re = -14978; im =  -6639; end
+            7'd112: begin re = -15137; im =  -6270; end
+            7'd113: begin re = -15286; im =  -5897; end
+            7'd114: begin re = -15426; im =  -5520; end
+            7'd115: begin re = -15557; im =  -5139; end
+            7'd116: begin re = -15679; im =  -4756; end
+            7'd117: begin re = -15791; im =  -4370; end
+            7'd118: begin re = -15893; im =  -3981; end
+            7'd119: begin re = -15986; im =  -3590; end
+            7'd120: begin re = -16069; im =  -3196; end
+            7'd121: begin re = -16143; im =  -2801; end
+            7'd122: begin re = -16207; im =  -2404; end
+            7'd123: begin re = -16261; im =  -2006; end
+            7'd124: begin re = -16305; im =  -1608; end
+            7'd125: begin re = -16340; im =  -1205; end
+            7'd126: begin re = -16364; im =   -804; end
+            7'd127: begin re = -16379; im =   -402; end
+            default: begin re = 0; im = 0; end
+            endcase
+            tw_rom = {re, im};
+        end
+    endfunction
+
+    // --- Window coefficient ROM (WINDOW != 0) ---
+    // Periodic windows, Q1.14: Hann 0.5 - 0.5*cos(2*pi*k/256), Hamming
+    // 0.54 - 0.46*cos(2*pi*k/256). Indexed in 1/256 units of the frame like
+    // the twiddles, so sample n of an N-point frame uses k = n * 256 / N.
+    // Only k = 0..128 is stored; the second half mirrors the first.
+    function [14:0] win_rom;
+        input [7:0] k;
+        reg   [7:0] m;
+        reg  [14:0] hann, hamm;
+        begin
+            m = (k > 8'd128) ? 8'd0 - k : k;
+            case (m)
+            8'd0:    begin hann =     0; hamm =  1311; end
+            8'd1:    begin hann =     2; hamm =  1313; end
+            8'd2:    begin hann =    10; hamm =  1320; end
+            8'd3:    begin hann =    22; hamm =  1331; end
+            8'd4:    begin hann =    39; hamm =  1347; end
+            8'd5:    begin hann =    62; hamm =  1367; end
+            8'd6:    begin hann =    89; hamm =  1392; end
+            8'd7:    begin hann =   121; hamm =  1422; end
+            8'd8:    begin hann =   157; hamm =  1456; end
+            8'd9:    begin hann =   199; hamm =  1494; end
+            8'd10:   begin hann =   246; hamm =  1537; end
+            8'd11:   begin hann =   297; hamm =  1584; end
+            8'd12:   begin hann =   353; hamm =  1635; end
+            8'd13:   begin hann =   413; hamm =  1691; end
+            8'd14:   begin hann =   479; hamm =  1751; end
+            8'd15:   begin hann =   549; hamm =  1816; end
+            8'd16:   begin hann =   624; hamm =  1884; end
+            8'd17:   begin hann =   703; hamm =  1957; end
+            8'd18:   begin hann =   787; hamm =  2034; end
+            8'd19:   begin hann =   875; hamm =  2115; end
+            8'd20:   begin hann =   967; hamm =  2201; end
+            8'd21:   begin hann =  1064; hamm =  2290; end
+            8'd22:   begin hann =  1165; hamm =  2383; end
+            8'd23:   begin hann =  1271; hamm =  2480; end
+            8'd24:   begin hann =  1381; hamm =  2581; end
+            8'd25:   begin hann =  1494; hamm =  2686; end
+            8'd26:   begin hann =  1612; hamm =  2794; end
+            8'd27:   begin hann =  1734; hamm =  2906; end
+            8'd28:   begin hann =  1859; hamm =  3021; end
+            8'd29:   begin hann =  1989; hamm =  3141; end
+            8'd30:   begin hann =  2122; hamm =  3263; end
+            8'd31:   begin hann =  2259; hamm =  3389; end
+            8'd32:   begin hann =  2399; hamm =  3518; end
+            8'd33:   begin hann =  2543; hamm =  3651; end
+            8'd34:   begin hann =  2691; hamm =  3786; end
+            8'd35:   begin hann =  2841; hamm =  3925; end
+            8'd36:   begin hann =  2995; hamm =  4066; end
+            8'd37:   begin hann =  3152; hamm =  4211; end
+            8'd38:   begin hann =  3312; hamm =  4358; end
+            8'd39:   begin hann =  3475; hamm =  4508; end
+            8'd40:   begin hann =  3641; hamm =  4660; end
+            8'd41:   begin hann =  3809; hamm =  4815; end
+            8'd42:   begin hann =  3980; hamm =  4973; end
+            8'd43:   begin hann =  4154; hamm =  5133; end
+            8'd44:   begin hann =  4330; hamm =  5295; end
+            8'd45:   begin hann =  4509; hamm =  5459; end
+            8'd46:   begin hann =  4689; hamm =  5625; end
+            8'd47:   begin hann =  4872; hamm =  5793; end
+            8'd48:   begin hann =  5057; hamm =  5963; end
+            8'd49:   begin hann =  5244; hamm =  6135; end
+            8'd50:   begin hann =  5432; hamm =  6308; end
+            8'd51:   begin hann =  5622; hamm =  6483; end
+            8'd52:   begin hann =  5814; hamm =  6660; end
+            8'd53:   begin hann =  6007; hamm =  6837; end
+            8'd54:   begin hann =  6202; hamm =  7016; end
+            8'd55:   begin hann =  6397; hamm =  7196; end
+            8'd56:   begin hann =  6594; hamm =  7377; end
+            8'd57:   begin hann =  6791; hamm =  7559; end
+            8'd58:   begin hann =  6990; hamm =  7742; end
+            8'd59:   begin hann =  7189; hamm =  7925; end
+            8'd60:   begin hann =  7389; hamm =  8109; end
+            8'd61:   begin hann =  7589; hamm =  8293; end
+            8'd62:   begin hann =  7790; hamm =  8478; end
+            8'd63:   begin hann =  7991; hamm =  8662; end
+            8'd64:   begin hann =  8192; hamm =  8847; end
+            8'd65:   begin hann =  8393; hamm =  9032; end
+            8'd66:   begin hann =  8594; hamm =  9217; end
+            8'd67:   begin hann =  8795; hamm =  9402; end
+            8'd68:   begin hann =  8995; hamm =  9586; end
+            8'd69:   begin hann =  9195; hamm =  9770; end
+            8'd70:   begin hann =  9394; hamm =  9953; end
+            8'd71:   begin hann =  9593; hamm = 10136; end
+            8'd72:   begin hann =  9790; hamm = 10318; end
+            8'd73:   begin hann =  9987; hamm = 10499; end
+            8'd74:   begin hann = 10182; hamm = 10679; end
+            8'd75:   begin hann = 10377; hamm = 10857; end
+            8'd76:   begin hann = 10570; hamm = 11035; end
+            8'd77:   begin hann = 10762; hamm = 11211; end
+            8'd78:   begin hann = 10952; hamm = 11386; end
+            8'd79:   begin hann = 11140; hamm = 11560; end
+            8'd80:   begin hann = 11327; hamm = 11732; end
+            8'd81:   begin hann = 11512; hamm = 11902; end
+            8'd82:   begin hann = 11695; hamm = 12070; end
+            8'd83:   begin hann = 11875; hamm = 12236; end
+            8'd84:   begin hann = 12054; hamm = 12400; end
+            8'd85:   begin hann = 12230; hamm = 12562; end
+            8'd86:   begin hann = 12404; hamm = 12722; end
+            8'd87:   begin hann = 12575; hamm = 12879; end
+            8'd88:   begin hann = 12743; hamm = 13034; end
+            8'd89:   begin hann = 12909; hamm = 13187; end
+            8'd90:   begin hann = 13072; hamm = 13337; end
+            8'd91:   begin hann = 13232; hamm = 13484; end
+            8'd92:   begin hann = 13389; hamm = 13629; end
+            8'd93:   begin hann = 13543; hamm = 13770; end
+            8'd94:   begin hann = 13693; hamm = 13909; end
+            8'd95:   begin hann = 13841; hamm = 14044; end
+            8'd96:   begin hann = 13985; hamm = 14177; end
+            8'd97:   begin hann = 14125; hamm = 14306; end
+            8'd98:   begin hann = 14262; hamm = 14432; end
+            8'd99:   begin hann = 14395; hamm = 14554; end
+            8'd100:  begin hann = 14525; hamm = 14673; end
+            8'd101:  begin hann = 14650; hamm = 14789; end
+            8'd102:  begin hann = 14772; hamm = 14901; end
+            8'd103:  begin hann = 14890; hamm = 15009; end
+            8'd104:  begin hann = 15003; hamm = 15114; end
+            8'd105:  begin hann = 15113; hamm = 15215; end
+            8'd106:  begin hann = 15219; hamm = 15312; end
+            8'd107:  begin hann = 15320; hamm = 15405; end
+            8'd108:  begin hann = 15417; hamm = 15494; end
+            8'd109:  begin hann = 15509; hamm = 15579; end
+            8'd110:  begin hann = 15597; hamm = 15660; end
+            8'd111:  begin hann = 15681; hamm = 15737; end
+            8'd112:  begin hann = 15760; hamm = 15810; end
+            8'd113:  begin hann = 15835; hamm = 15879; end
+            8'd114:  begin hann = 15905; hamm = 15943; end
+            8'd115:  begin hann = 15971; hamm = 16004; end
+            8'd116:  begin hann = 16031; hamm = 16059; end
+            8'd117:  begin hann = 16087; hamm = 16111; end
+            8'd118:  begin hann = 16138; hamm = 16158; end
+            8'd119:  begin hann = 16185; hamm = 16201; end
+            8'd120:  begin hann = 16227; hamm = 16239; end
+            8'd121:  begin hann = 16263; hamm = 16273; end
+            8'd122:  begin hann = 16295; hamm = 16302; end
+            8'd123:  begin hann = 16322; hamm = 16327; end
+            8'd124:  begin hann = 16345; hamm = 16348; end
+            8'd125:  begin hann = 16362; hamm = 16364; end
+            8'd126:  begin hann = 16374; hamm = 16375; end
+            8'd127:  begin hann = 16382; hamm = 16382; end
+            8'd128:  begin hann = 16384; hamm = 16384; end
+            default: begin hann = 0; hamm = 0; end
+            endcase
+            win_rom = (WINDOW == 2) ? hamm : hann;
+        end
+    endfunction
 
-    assign mag_out = mag_buf[mag_addr];
+    // --- Bit-reversal ---
+    // Reverse the low nbits bits of idx
+    function [AW-1:0] bit_rev;
+        input [AW-1:0] idx;
+        input [3:0]    nbits;
+        reg   [AW-1:0] r;
+        integer b;
+        begin
+            for (b = 0; b < AW; b = b + 1)
+                r[b] = idx[AW-1-b];
+            bit_rev = r >> (AW - nbits);
+        end
+    endfunction
 
-    // --- Twiddle factor ROM ---
-    // W(k,N) = cos(2*pi*k/N) - j*sin(2*pi*k/N)
-    // Stored as Q1.14 fixed-point (scaled by 16384)
-    // Only need 32 twiddle factors for 64-point FFT
-    reg signed [15:0] twiddle_re [0:31];
-    reg signed [15:0] twiddle_im [0:31];
-
-    // Initialize twiddle factors (cos and -sin values, Q1.14)
-    integer tw_i;
-    initial begin
-        // W(k,64) = cos(2*pi*k/64) - j*sin(2*pi*k/64), scaled by 16384
-        twiddle_re[ 0] =  16384; twiddle_im[ 0] =      0;
-        twiddle_re[ 1] =  16305; twiddle_im[ 1] =  -1608;
-        twiddle_re[ 2] =  16069; twiddle_im[ 2] =  -3196;
-        twiddle_re[ 3] =  15679; twiddle_im[ 3] =  -4756;
-        twiddle_re[ 4] =  15137; twiddle_im[ 4] =  -6270;
-        twiddle_re[ 5] =  14449; twiddle_im[ 5] =  -7723;
-        twiddle_re[ 6] =  13623; twiddle_im[ 6] =  -9102;
-        twiddle_re[ 7] =  12665; twiddle_im[ 7] = -10394;
-        twiddle_re[ 8] =  11585; twiddle_im[ 8] = -11585;
-        twiddle_re[ 9] =  10394; twiddle_im[ 9] = -12665;
-        twiddle_re[10] =   9102; twiddle_im[10] = -13623;
-        twiddle_re[11] =   7723; twiddle_im[11] = -14449;
-        twiddle_re[12] =   6270; twiddle_im[12] = -15137;
-        twiddle_re[13] =   4756; twiddle_im[13] = -15679;
-        twiddle_re[14] =   3196; twiddle_im[14] = -16069;
-        twiddle_re[15] =   1608; twiddle_im[15] = -16305;
-        twiddle_re[16] =      0; twiddle_im[16] = -16384;
-        twiddle_re[17] =  -1608; twiddle_im[17] = -16305;
-        twiddle_re[18] =  -3196; twiddle_im[18] = -16069;
-        twiddle_re[19] =  -4756; twiddle_im[19] = -15679;
-        twiddle_re[20] =  -6270; twiddle_im[20] = -15137;
-        twiddle_re[21] =  -7723; twiddle_im[21] = -14449;
-        twiddle_re[22] =  -9102; twiddle_im[22] = -13623;
-        twiddle_re[23] = -10394; twiddle_im[23] = -12665;
-        twiddle_re[24] = -11585; twiddle_im[24] = -11585;
-        twiddle_re[25] = -12665; twiddle_im[25] = -10394;
-        twiddle_re[26] = -13623; twiddle_im[26] =  -9102;
-        twiddle_re[27] = -14449; twiddle_im[27] =  -7723;
-        twiddle_re[28] = -15137; twiddle_im[28] =  -6270;
-        twiddle_re[29] = -15679; twiddle_im[29] =  -4756;
-        twiddle_re[30] = -16069; twiddle_im[30] =  -3196;
-        twiddle_re[31] = -16305; twiddle_im[31] =  -1608;
-    end
+    // Sample read for load step n of an N = 2^nbits frame.
+    // REAL_FFT: sample pair n = {m, odd} goes to Re/Im of point m, so only
+    // the pair index is reversed
+    function [AW-1:0] bit_reverse;
+        input [AW-1:0] idx;
+        input [3:0]    nbits;
+        begin
+            if (REAL_FFT)
+                bit_reverse = {bit_rev(idx >> 1, nbits - 4'd1), idx[0]};
+            else
+                bit_reverse = bit_rev(idx, nbits);
+        end
+    endfunction
 
-    // --- Bit-reversal table for 64-point ---
-    function [5:0] bit_reverse;
-        input [5:0] idx;
+    // --- Butterfly addressing ---
+    // Stage s pairs data[p] with data[p + 2^s]. Butterfly j of a stage maps
+    // to p by inserting a 0 at bit s of j; its twiddle is W(k, 2^(s+1)) with
+    // k the low s bits of j, i.e. k << (7 - s) in W256 units.
+    function [AW-1:0] bf_p;
+        input [3:0]    s;
+        input [AW-1:0] j;
+        reg   [AW-1:0] mask;
         begin
-            bit_reverse = {idx[0], idx[1], idx[2], idx[3], idx[4], idx[5]};
+            mask = ({{(AW-1){1'b0}}, 1'b1} << s) - 1'b1;
+            bf_p = ((j & ~mask) << 1) | (j & mask);
         end
     endfunction
 
+    function [AW-1:0] bf_q;
+        input [3:0]    s;
+        input [AW-1:0] j;
+        begin
+            bf_q = bf_p(s, j) | ({{(AW-1){1'b0}}, 1'b1} << s);
+        end
+    endfunction
+
+    function [6:0] bf_tw;
+        input [3:0]    s;
+        input [AW-1:0] j;
+        reg   [AW+7:0] k;
+        begin
+            k     = {8'd0, j} & (({{(AW+7){1'b0}}, 1'b1} << s) - 1'b1);
+            bf_tw = k << (4'd7 - s);
+        end
+    endfunction
+
+    // --- Radix-2 butterfly (Q14 twiddles) ---
+    // Returns {p_re, p_im, q_re, q_im} with p' = a + w*b, q' = a - w*b
+    function [95:0] butterfly;
+        input signed [23:0] ar, ai, br, bi;
+        input        [6:0]  tw;             // Twiddle index, W256 units
+        reg   signed [15:0] wr, wi;
+        reg   signed [39:0] prod_re, prod_im;   // 24 * 16 = 40 bits
+        reg   signed [23:0] tr, ti;
+        begin
+            {wr, wi} = tw_rom(tw);
+            // Complex multiply: (br + j*bi) * (wr + j*wi)
+            prod_re = (br * wr) - (bi * wi);
+            prod_im = (br * wi) + (bi * wr);
+            // Scale back (divide by 16384 = right shift 14)
+            tr = prod_re[37:14];
+            ti = prod_im[37:14];
+            butterfly = {ar + tr, ai + ti, ar - tr, ai - ti};
+        end
+    endfunction
+
+    // --- Parity banks (USE_SRAM) ---
+    // Point i lives in bank ^i at word i >> 1. The two points of a radix-2
+    // butterfly differ in exactly one index bit, so they never share a bank.
+    function bank_of;
+        input [AW-1:0] idx;
+        begin
+            bank_of = ^idx;
+        end
+    endfunction
+
+    // --- Datapath schedule ---
+    // FFT_ARCH 0: 1 butterfly / 2 clk, log2(M) stages x M/2 steps
+    //          1: 1 butterfly / clk,   log2(M) stages x M/2 steps
+    //          2: 2 butterflies / clk, log2(M) stages x M/4 steps
+    //          3: 1 radix-2^2 (4-point) / clk, ceil(log2(M)/2) passes x M/4
+    // with M = N complex points (N/2 under REAL_FFT). When log2(M) is odd,
+    // FFT_ARCH 3 runs the last stage as two radix-2 butterflies per clock.
+    // Loading takes N + 1 clocks (sample ring read latency); with USE_SRAM
+    // the magnitude pass takes one extra clock for the same reason.
+    localparam STAGE_INC = (ARCH == 3) ? 2 : 1;
+
     // --- FSM States ---
     localparam S_IDLE       = 3'd0;
     localparam S_LOAD       = 3'd1;
-    localparam S_BUTTERFLY  = 3'd2;
+    localparam S_BUTTERFLY  = 3'd2;     // FFT_ARCH 0 only: register indices
     localparam S_BF_COMPUTE = 3'd3;
     localparam S_MAGNITUDE  = 3'd4;
     localparam S_DONE       = 3'd5;
 
-    reg [2:0]  state;
-    reg [5:0]  load_cnt;        // Loading counter
-    reg [2:0]  stage;           // FFT stage (0-5 for 64-point)
-    reg [4:0]  bf_idx;          // Butterfly index within group
-    reg [4:0]  grp_idx;         // Group index within stage
-    reg [5:0]  half_size;       // Half the group size for current stage
-    reg [4:0]  num_groups;      // Number of groups in current stage
-    reg [4:0]  mag_cnt;         // Magnitude computation counter
-
-    // Butterfly computation intermediates
-    reg signed [23:0] ar, ai, br, bi;
-    reg signed [15:0] wr, wi;
-    reg signed [39:0] prod_re, prod_im;    // 24 * 16 = 40 bits
-    reg signed [23:0] tr, ti;
-    reg [5:0] idx_p, idx_q;
-    reg [4:0] tw_idx;
+    // State entered for each butterfly step
+    localparam S_BF_STEP = (ARCH == 0) ? S_BUTTERFLY : S_BF_COMPUTE;
+
+    reg [2:0]    state;
+    reg [1:0]    size_q;        // Length of the frame in progress
+    reg [AW-1:0] load_cnt;      // Sample read issued this clock
+    reg [AW-1:0] ld_idx;        // Sample on sample_in this clock
+    reg          ld_vld;
+    reg [15:0]   ld_even;       // REAL_FFT + USE_SRAM: even sample of the pair
+    reg [3:0]    stage;         // FFT stage, first stage of a pass
+    reg [AW-2:0] bf_idx;        // Step index within stage/pass
+    reg [AW-2:0] mag_cnt;       // Magnitude bin issued this clock
+    reg [AW-2:0] mag_idx;       // USE_SRAM: bin whose data is read back
+    reg          mag_vld;
+
+    assign loading    = (state == S_LOAD);
+    assign load_valid = (state == S_LOAD) && ld_vld;
+
+    // Per-frame sizes
+    wire [3:0]    log2n      = 4'd6 + {2'b00, size_q};
+    wire [3:0]    log2m      = log2n - REAL_FFT;
+    wire [AW-1:0] load_last  = ({{(AW-1){1'b0}}, 1'b1} << log2n) - 1'b1;
+    wire [AW-2:0] bins_last  = ({{(AW-2){1'b0}}, 1'b1} << (log2n - 4'd1)) - 1'b1;
+    wire [AW-2:0] bf_last    = ({{(AW-2){1'b0}}, 1'b1} <<
+                                (log2m - ((ARCH >= 2) ? 4'd2 : 4'd1))) - 1'b1;
+    wire [3:0]    last_stage = (ARCH == 3) ? ((log2m - 4'd1) & 4'hE) : log2m - 4'd1;
+
+    // Windowed sample on sample_in: ld_n is its offset in the frame
+    wire [AW-1:0]      ld_n      = bit_reverse(ld_idx, log2n);
+    wire [AW+7:0]      win_kx    = {8'd0, ld_n} << (4'd8 - log2n);
+    wire signed [15:0] win_coef  = {1'b0, win_rom(win_kx[7:0])};
+    wire signed [31:0] win_prod  = $signed(sample_in) * win_coef;
+    wire [15:0]        ld_sample = (WINDOW == 0) ? sample_in : win_prod[29:14];
+
+    // Registered butterfly indices (FFT_ARCH 0)
+    reg [AW-1:0] idx_p, idx_q;
+    reg [6:0]    tw_idx;
+
+    // Butterfly numbers handled this step (FFT_ARCH 1-3)
+    wire [AW-1:0] bf_j0 = (ARCH >= 2) ? {bf_idx, 1'b0} : {1'b0, bf_idx};
+    wire [AW-1:0] bf_j1 = {bf_idx, 1'b1};
+
+    // Bin written to the spectrum buffer this clock
+    wire          mag_wr  = (state == S_MAGNITUDE) && (mag_vld || !USE_SRAM);
+    wire [AW-2:0] mag_bin = USE_SRAM ? mag_idx : mag_cnt;
+    wire [AW-2:0] mag_mir = (~mag_bin + 1'b1) & bins_last;     // M - k
+
+    // --- SRAM working storage (USE_SRAM) ---
+    // Port A of each bank loads samples and reads / writes butterfly
+    // operands; port B only serves Z[M-k] for the REAL_FFT split, which may
+    // sit in the same bank as Z[k]. Buses are {bank 1, bank 0}.
+    reg  [1:0]       bk_a_en, bk_a_we, bk_b_en;
+    reg  [2*BKW-1:0] bk_a_addr, bk_b_addr;
+    reg  [95:0]      bk_a_din;
+    wire [95:0]      bk_a_dout, bk_b_dout;
+
+    // Butterfly on the operands read in S_BUTTERFLY
+    wire [95:0] bk_bf = butterfly(bk_a_dout[bank_of(idx_p)*48+24 +: 24],
+                                  bk_a_dout[bank_of(idx_p)*48    +: 24],
+                                  bk_a_dout[bank_of(idx_q)*48+24 +: 24],
+                                  bk_a_dout[bank_of(idx_q)*48    +: 24],
+                                  tw_idx);
+
+    always @(*) begin : bank_ports
+        reg [AW-1:0] p, q, pt;
+        reg          bp, bq;
+        p         = {AW{1'b0}};
+        q         = {AW{1'b0}};
+        pt        = {AW{1'b0}};
+        bp        = 1'b0;
+        bq        = 1'b0;
+        bk_a_en   = 2'b00;
+        bk_a_we   = 2'b00;
+        bk_b_en   = 2'b00;
+        bk_a_addr = {(2*BKW){1'b0}};
+        bk_b_addr = {(2*BKW){1'b0}};
+        bk_a_din  = 96'd0;
+        case (state)
+            // Write the point completed by the sample on sample_in
+            S_LOAD: begin
+                pt = REAL_FFT ? (ld_idx >> 1) : ld_idx;
+                bp = bank_of(pt);
+                if (ld_vld && (!REAL_FFT || ld_idx[0])) begin
+                    bk_a_en[bp] = 1'b1;
+                    bk_a_we[bp] = 1'b1;
+                    bk_a_addr[bp*BKW +: BKW] = pt >> 1;
+                    bk_a_din[bp*48 +: 48] = REAL_FFT
+                        ? {{8{ld_even[15]}}, ld_even, {8{ld_sample[15]}}, ld_sample}
+                        : {{8{ld_sample[15]}}, ld_sample, 24'd0};
+                end
+            end
+            // Read both operands of the next butterfly
+            S_BUTTERFLY: begin
+                p  = bf_p(stage, bf_j0);
+                q  = bf_q(stage, bf_j0);
+                bp = bank_of(p);
+                bq = bank_of(q);
+                bk_a_en = 2'b11;
+                bk_a_addr[bp*BKW +: BKW] = p >> 1;
+                bk_a_addr[bq*BKW +: BKW] = q >> 1;
+            end
+            // Write both results back
+            S_BF_COMPUTE: begin
+                bp = bank_of(idx_p);
+                bq = bank_of(idx_q);
+                bk_a_en = 2'b11;
+                bk_a_we = 2'b11;
+                bk_a_addr[bp*BKW +: BKW] = idx_p >> 1;
+                bk_a_addr[bq*BKW +: BKW] = idx_q >> 1;
+                bk_a_din[bp*48 +: 48] = bk_bf[95:48];
+                bk_a_din[bq*48 +: 48] = bk_bf[47:0];
+            end
+            // Read Z[k] (and Z[M-k]) for bin mag_cnt
+            S_MAGNITUDE: begin
+                p  = {1'b0, mag_cnt};
+                q  = {1'b0, (~mag_cnt + 1'b1) & bins_last};
+                bp = bank_of(p);
+                bq = bank_of(q);
+                bk_a_en[bp] = 1'b1;
+                bk_a_addr[bp*BKW +: BKW] = p >> 1;
+                if (REAL_FFT) begin
+                    bk_b_en[bq] = 1'b1;
+                    bk_b_addr[bq*BKW +: BKW] = q >> 1;
+                end
+            end
+            default: ;
+        endcase
+    end
+
+    genvar bk;
+
+    generate
+        if (USE_SRAM) begin : g_bank
+            for (bk = 0; bk < 2; bk = bk + 1) begin : g_b
+                sram_1rw1r #(
+                    .DW         (48),
+                    .AW         (BKW),
+                    .USE_MACRO  (1)
+                ) u_bank (
+                    .clk        (clk),
+                    .a_en       (bk_a_en[bk]),
+                    .a_we       (bk_a_we[bk]),
+                    .a_wmask    (6'h3F),
+                    .a_addr     (bk_a_addr[bk*BKW +: BKW]),
+                    .a_din      (bk_a_din[bk*48 +: 48]),
+                    .a_dout     (bk_a_dout[bk*48 +: 48]),
+                    .b_en       (bk_b_en[bk]),
+                    .b_addr     (bk_b_addr[bk*BKW +: BKW]),
+                    .b_dout     (bk_b_dout[bk*48 +: 48])
+                );
+            end
+        end else begin : g_no_bank
+            assign bk_a_dout = 96'd0;
+            assign bk_b_dout = 96'd0;
+        end
+    endgenerate
+
+    // --- Magnitude approximation ---
+    // |X| ≈ max(|Re|, |Im|) + 0.5 * min(|Re|, |Im|) of bin mag_bin
+    reg [15:0] mag_val;
+
+    always @(*) begin : mag_calc
+        reg signed [23:0] zk_re, zk_im, zm_re, zm_im;
+        reg signed [23:0] xr, xi;
+        reg [23:0] abs_re, abs_im, mag_max, mag_min;
+        if (USE_SRAM) begin
+            {zk_re, zk_im} = bk_a_dout[bank_of({1'b0, mag_bin})*48 +: 48];
+            {zm_re, zm_im} = bk_b_dout[bank_of({1'b0, mag_mir})*48 +: 48];
+        end else begin
+            zk_re = data_re[mag_bin];
+            zk_im = data_im[mag_bin];
+            zm_re = data_re[mag_mir];
+            zm_im = data_im[mag_mir];
+        end
+        if (REAL_FFT) begin : split
+            // X[k] = Fe + W(k,N) * Fo with
+            //   Fe = (Z[k] + conj(Z[M-k])) / 2
+            //   Fo = -j * (Z[k] - conj(Z[M-k])) / 2
+            reg [AW+7:0]      k;
+            reg signed [24:0] e_re, e_im, o_re, o_im;
+            reg [95:0]        r;
+            k    = {9'd0, mag_bin};
+            e_re = zk_re + zm_re;
+            e_im = zk_im - zm_im;
+            o_re = zk_im + zm_im;
+            o_im = zm_re - zk_re;
+            r    = butterfly(e_re[24:1], e_im[24:1], o_re[24:1], o_im[24:1],
+                             k << (4'd8 - log2n));
+            xr   = r[95:72];
+            xi   = r[71:48];
+        end else begin
+            xr   = zk_re;
+            xi   = zk_im;
+        end
+        abs_re  = xr[23] ? -xr : xr;
+        abs_im  = xi[23] ? -xi : xi;
+        mag_max = (abs_re > abs_im) ? abs_re : abs_im;
+        mag_min = (abs_re > abs_im) ? abs_im : abs_re;
+        // Saturate to 16-bit
+        mag_val = (mag_max[23:16] != 0) ? 16'hFFFF
+                                        : mag_max[15:0] + {1'b0, mag_min[15:1]};
+    end
+
+    // --- Magnitude stream ---
+    // Every bin written to the spectrum buffer, once and in bin order
+    assign bin_valid = mag_wr;
+    assign bin_idx   = mag_bin;
+    assign bin_mag   = mag_val;
+
+    // --- Spectrum buffer ---
+    // Two banks of NMAX/2 bins (16-bit unsigned). Each frame is written
+    // into ~mag_bank; mag_bank flips on done. The read port free-runs so
+    // the Wishbone readback always sees its settled address.
+    sram_1rw1r #(
+        .DW         (16),
+        .AW         (AW),
+        .USE_MACRO  (USE_SRAM)
+    ) u_mag_buf (
+        .clk        (clk),
+        .a_en       (mag_wr),
+        .a_we       (mag_wr),
+        .a_wmask    (2'b11),
+        .a_addr     ({~mag_bank, mag_bin}),
+        .a_din      (mag_val),
+        .a_dout     (),
+        .b_en       (1'b1),
+        .b_addr     (mag_addr),
+        .b_dout     (mag_out)
+    );
 
     always @(posedge clk) begin
         if (rst) begin
             state       <= S_IDLE;
             done        <= 1'b0;
             busy        <= 1'b0;
-            sample_addr <= 6'd0;
-            load_cnt    <= 6'd0;
-            stage       <= 3'd0;
-            bf_idx      <= 5'd0;
-            grp_idx     <= 5'd0;
-            mag_cnt     <= 5'd0;
+            sample_addr <= {AW{1'b0}};
+            size_q      <= 2'd0;
+            mag_size    <= 2'd0;
+            load_cnt    <= {AW{1'b0}};
+            ld_idx      <= {AW{1'b0}};
+            ld_vld      <= 1'b0;
+            stage       <= 4'd0;
+            bf_idx      <= {(AW-1){1'b0}};
+            mag_cnt     <= {(AW-1){1'b0}};
+            mag_idx     <= {(AW-1){1'b0}};
+            mag_vld     <= 1'b0;
+            mag_bank    <= 1'b1;    // First frame lands in bank 0
         end else begin
             done <= 1'b0;
 
@@ -130,225 +729,168 @@ module fft_engine (
                     if (start) begin
                         state       <= S_LOAD;
                         busy        <= 1'b1;
-                        load_cnt    <= 6'd0;
-                        sample_addr <= bit_reverse(6'd0);
+                        size_q      <= (fft_size > SIZE_MAX) ? SIZE_MAX : fft_size;
+                        load_cnt    <= {AW{1'b0}};
+                        ld_vld      <= 1'b0;
+                        sample_addr <= {AW{1'b0}};     // bit_reverse(0) = 0
                     end
                 end
 
                 // --- Load samples with bit-reversal ---
+                // sample_in holds the sample addressed on the previous
+                // clock, so the point written (ld_idx) trails load_cnt;
+                // it is stored windowed (ld_sample)
                 S_LOAD: begin
-                    data_re[load_cnt] <= {{8{sample_in[15]}}, sample_in};  // Sign-extend to 24-bit
-                    data_im[load_cnt] <= 24'd0;
-
-                    if (load_cnt == 6'd63) begin
-                        state     <= S_BUTTERFLY;
-                        stage     <= 3'd0;
-                        grp_idx   <= 5'd0;
-                        bf_idx    <= 5'd0;
-                        half_size <= 6'd1;    // Stage 0: groups of 2
-                        num_groups <= 5'd31;  // 32 groups for stage 0
-                    end else begin
-                        load_cnt    <= load_cnt + 6'd1;
-                        sample_addr <= bit_reverse(load_cnt + 6'd1);
+                    if (ld_vld) begin
+                        if (USE_SRAM) begin
+                            // Written through the bank ports (bank_ports)
+                            if (!ld_idx[0])
+                                ld_even <= ld_sample;
+                        end else if (REAL_FFT) begin
+                            // Even samples -> Re, odd samples -> Im
+                            if (ld_idx[0])
+                                data_im[ld_idx >> 1] <= {{8{ld_sample[15]}}, ld_sample};
+                            else
+                                data_re[ld_idx >> 1] <= {{8{ld_sample[15]}}, ld_sample};
+                        end else begin
+                            data_re[ld_idx] <= {{8{ld_sample[15]}}, ld_sample};  // Sign-extend to 24-bit
+                            data_im[ld_idx] <= 24'd0;
+                        end
+                    end
+
+                    ld_idx <= load_cnt;
+                    ld_vld <= 1'b1;
+                    if (ld_vld && ld_idx == load_last) begin
+                        state  <= S_BF_STEP;
+                        stage  <= 4'd0;
+                        bf_idx <= {(AW-1){1'b0}};
+                    end else if (load_cnt != load_last) begin
+                        load_cnt    <= load_cnt + 1'b1;
+                        sample_addr <= bit_reverse(load_cnt + 1'b1, log2n);
                     end
                 end
 
-                // --- Setup butterfly indices ---
+                // --- Setup butterfly indices (FFT_ARCH 0) ---
+                // With USE_SRAM the operands are read from the banks here
                 S_BUTTERFLY: begin
-                    // Compute indices for this butterfly
-                    idx_p  <= {grp_idx, bf_idx[0], bf_idx[4:1]} & 6'h3F;  // Will be overridden below
-                    idx_q  <= ({grp_idx, bf_idx[0], bf_idx[4:1]} & 6'h3F) + half_size;
-
-                    // Proper index computation per stage
-                    case (stage)
-                        3'd0: begin
-                            idx_p <= {bf_idx, 1'b0};
-                            idx_q <= {bf_idx, 1'b1};
-                            tw_idx <= 5'd0;
-                        end
-                        3'd1: begin
-                            idx_p <= {grp_idx[4:0], 2'b00} + {4'd0, bf_idx[0]};
-                            idx_q <= {grp_idx[4:0], 2'b00} + {4'd0, bf_idx[0]} + 6'd2;
-                            tw_idx <= {bf_idx[0], 4'd0};
-                        end
-                        3'd2: begin
-                            idx_p <= {grp_idx[4:0], 3'b000} + {3'd0, bf_idx[1:0]};
-                            idx_q <= {grp_idx[4:0], 3'b000} + {3'd0, bf_idx[1:0]} + 6'd4;
-                            tw_idx <= {bf_idx[1:0], 3'd0};
-                        end
-                        3'd3: begin
-                            idx_p <= {grp_idx[4:0], 4'b0000} + {2'd0, bf_idx[2:0]};
-                            idx_q <= {grp_idx[4:0], 4'b0000} + {2'd0, bf_idx[2:0]} + 6'd8;
-                            tw_idx <= {bf_idx[2:0], 2'd0};
-                        end
-                        3'd4: begin
-                            idx_p <= {grp_idx[4:0], 5'b00000} + {1'd0, bf_idx[3:0]};
-                            idx_q <= {grp_idx[4:0], 5'b00000} + {1'd0, bf_idx[3:0]} + 6'd16;
-                            tw_idx <= {bf_idx[3:0], 1'd0};
-                        end
-                        3'd5: begin
-                            idx_p <= {1'b0, bf_idx[4:0]};
-                            idx_q <= {1'b0, bf_idx[4:0]} + 6'd32;
-                            tw_idx <= bf_idx[4:0];
-                        end
-                        default: begin
-                            idx_p <= 6'd0;
-                            idx_q <= 6'd0;
-                            tw_idx <= 5'd0;
-                        end
-                    endcase
-
-                    state <= S_BF_COMPUTE;
+                    idx_p  <= bf_p(stage, bf_j0);
+                    idx_q  <= bf_q(stage, bf_j0);
+                    tw_idx <= bf_tw(stage, bf_j0);
+                    state  <= S_BF_COMPUTE;
                 end
 
                 // --- Perform butterfly computation ---
                 S_BF_COMPUTE: begin
-                    // Read inputs
-                    ar = data_re[idx_p];
-                    ai = data_im[idx_p];
-                    br = data_re[idx_q];
-                    bi = data_im[idx_q];
-                    wr = twiddle_re[tw_idx];
-                    wi = twiddle_im[tw_idx];
-
-                    // Complex multiply: (br + j*bi) * (wr + j*wi)
-                    // Real part: br*wr - bi*wi
-                    // Imag part: br*wi + bi*wr
-                    prod_re = (br * wr) - (bi * wi);
-                    prod_im = (br * wi) + (bi * wr);
-
-                    // Scale back (divide by 16384 = right shift 14)
-                    tr = prod_re[37:14];
-                    ti = prod_im[37:14];
-
-                    // Butterfly: p' = a + t, q' = a - t
-                    data_re[idx_p] <= ar + tr;
-                    data_im[idx_p] <= ai + ti;
-                    data_re[idx_q] <= ar - tr;
-                    data_im[idx_q] <= ai - ti;
-
-                    // Advance to next butterfly
-                    case (stage)
-                        3'd0: begin
-                            if (bf_idx == 5'd31) begin
-                                stage     <= 3'd1;
-                                bf_idx    <= 5'd0;
-                                grp_idx   <= 5'd0;
-                                half_size <= 6'd2;
-                                num_groups <= 5'd15;
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                            end
-                            state <= S_BUTTERFLY;
-                        end
-                        3'd1: begin
-                            if (bf_idx[0] == 1'b1) begin
-                                if (grp_idx == num_groups) begin
-                                    stage     <= 3'd2;
-                                    bf_idx    <= 5'd0;
-                                    grp_idx   <= 5'd0;
-                                    half_size <= 6'd4;
-                                    num_groups <= 5'd7;
-                                end else begin
-                                    grp_idx <= grp_idx + 5'd1;
-                                    bf_idx  <= 5'd0;
-                                end
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                            end
-                            state <= S_BUTTERFLY;
-                        end
-                        3'd2: begin
-                            if (bf_idx[1:0] == 2'd3) begin
-                                if (grp_idx == num_groups) begin
-                                    stage     <= 3'd3;
-                                    bf_idx    <= 5'd0;
-                                    grp_idx   <= 5'd0;
-                                    half_size <= 6'd8;
-                                    num_groups <= 5'd3;
-                                end else begin
-                                    grp_idx <= grp_idx + 5'd1;
-                                    bf_idx  <= 5'd0;
-                                end
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                            end
-                            state <= S_BUTTERFLY;
-                        end
-                        3'd3: begin
-                            if (bf_idx[2:0] == 3'd7) begin
-                                if (grp_idx == num_groups) begin
-                                    stage     <= 3'd4;
-                                    bf_idx    <= 5'd0;
-                                    grp_idx   <= 5'd0;
-                                    half_size <= 6'd16;
-                                    num_groups <= 5'd1;
-                                end else begin
-                                    grp_idx <= grp_idx + 5'd1;
-                                    bf_idx  <= 5'd0;
-                                end
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                            end
-                            state <= S_BUTTERFLY;
-                        end
-                        3'd4: begin
-                            if (bf_idx[3:0] == 4'd15) begin
-                                if (grp_idx == num_groups) begin
-                                    stage     <= 3'd5;
-                                    bf_idx    <= 5'd0;
-                                    grp_idx   <= 5'd0;
-                                    half_size <= 6'd32;
-                                    num_groups <= 5'd0;
-                                end else begin
-                                    grp_idx <= grp_idx + 5'd1;
-                                    bf_idx  <= 5'd0;
-                                end
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                            end
-                            state <= S_BUTTERFLY;
-                        end
-                        3'd5: begin
-                            if (bf_idx == 5'd31) begin
-                                // All stages complete, compute magnitudes
-                                state   <= S_MAGNITUDE;
-                                mag_cnt <= 5'd0;
-                            end else begin
-                                bf_idx <= bf_idx + 5'd1;
-                                state  <= S_BUTTERFLY;
-                            end
+                    if (USE_SRAM) begin
+                        // Results written back through the bank ports (bk_bf)
+                    end else if (ARCH == 0 || ARCH == 1) begin : bf_single
+                        reg [AW-1:0] p, q;
+                        reg [6:0]    w;
+                        reg [95:0]   r;
+                        p = (ARCH == 0) ? idx_p  : bf_p(stage, bf_j0);
+                        q = (ARCH == 0) ? idx_q  : bf_q(stage, bf_j0);
+                        w = (ARCH == 0) ? tw_idx : bf_tw(stage, bf_j0);
+                        r = butterfly(data_re[p], data_im[p], data_re[q], data_im[q], w);
+                        data_re[p] <= r[95:72];
+                        data_im[p] <= r[71:48];
+                        data_re[q] <= r[47:24];
+                        data_im[q] <= r[23:0];
+                    end else if (ARCH == 2 || stage == log2m - 4'd1) begin : bf_dual
+                        // Butterflies 2m and 2m+1 of a stage touch four
+                        // distinct points, so they run side by side
+                        // (also the odd last stage under FFT_ARCH 3)
+                        reg [AW-1:0] p0, q0, p1, q1;
+                        reg [95:0]   r0, r1;
+                        p0 = bf_p(stage, bf_j0);
+                        q0 = bf_q(stage, bf_j0);
+                        p1 = bf_p(stage, bf_j1);
+                        q1 = bf_q(stage, bf_j1);
+                        r0 = butterfly(data_re[p0], data_im[p0], data_re[q0], data_im[q0],
+                                       bf_tw(stage, bf_j0));
+                        r1 = butterfly(data_re[p1], data_im[p1], data_re[q1], data_im[q1],
+                                       bf_tw(stage, bf_j1));
+                        data_re[p0] <= r0[95:72];
+                        data_im[p0] <= r0[71:48];
+                        data_re[q0] <= r0[47:24];
+                        data_im[q0] <= r0[23:0];
+                        data_re[p1] <= r1[95:72];
+                        data_im[p1] <= r1[71:48];
+                        data_re[q1] <= r1[47:24];
+                        data_im[q1] <= r1[23:0];
+                    end else begin : bf_radix4
+                        // Radix-2^2: stages s and s+1 on one 4-point group
+                        // {i0, i0+h, i0+2h, i0+3h}, h = 2^s. Same twiddles
+                        // and rounding as two radix-2 stages, so the
+                        // result is bit-exact with FFT_ARCH 0-2.
+                        reg [AW-1:0] m, u, h, i0, i1, i2, i3;
+                        reg [AW+7:0] k;
+                        reg [6:0]    wa, wb0, wb1;
+                        reg [95:0]   a, b, c, e;
+                        h   = {{(AW-1){1'b0}}, 1'b1} << stage;
+                        m   = h - 1'b1;
+                        u   = {1'b0, bf_idx};
+                        i0  = ((u & ~m) << 2) | (u & m);
+                        i1  = i0 | h;
+                        i2  = i0 | (h << 1);
+                        i3  = i0 | h | (h << 1);
+                        k   = {8'd0, u & m};
+                        wa  = k << (4'd7 - stage);
+                        wb0 = k << (4'd6 - stage);
+                        wb1 = (k | {8'd0, h}) << (4'd6 - stage);
+                        // Stage s: (i0, i1) and (i2, i3)
+                        a = butterfly(data_re[i0], data_im[i0], data_re[i1], data_im[i1], wa);
+                        b = butterfly(data_re[i2], data_im[i2], data_re[i3], data_im[i3], wa);
+                        // Stage s+1: (i0, i2) and (i1, i3)
+                        c = butterfly(a[95:72], a[71:48], b[95:72], b[71:48], wb0);
+                        e = butterfly(a[47:24], a[23:0], b[47:24], b[23:0], wb1);
+                        data_re[i0] <= c[95:72];
+                        data_im[i0] <= c[71:48];
+                        data_re[i2] <= c[47:24];
+                        data_im[i2] <= c[23:0];
+                        data_re[i1] <= e[95:72];
+                        data_im[i1] <= e[71:48];
+                        data_re[i3] <= e[47:24];
+                        data_im[i3] <= e[23:0];
+                    end
+
+                    // Advance to next step / stage
+                    if (bf_idx == bf_last) begin
+                        bf_idx <= {(AW-1){1'b0}};
+                        if (stage == last_stage) begin
+                            // All stages complete, compute magnitudes
+                            state   <= S_MAGNITUDE;
+                            mag_cnt <= {(AW-1){1'b0}};
+                            mag_vld <= 1'b0;
+                        end else begin
+                            stage <= stage + STAGE_INC;
+                            state <= S_BF_STEP;
                         end
-                        default: state <= S_IDLE;
-                    endcase
+                    end else begin
+                        bf_idx <= bf_idx + 1'b1;
+                        state  <= S_BF_STEP;
+                    end
                 end
 
-                // --- Compute magnitude approximation ---
-                // |X| ≈ max(|Re|, |Im|) + 0.5 * min(|Re|, |Im|)
+                // --- Compute magnitudes into the spectrum buffer ---
+                // mag_calc / u_mag_buf write bin mag_bin; with USE_SRAM it
+                // trails the bin read (mag_cnt) by one clock
                 S_MAGNITUDE: begin
-                    begin : mag_block
-                        reg [23:0] abs_re, abs_im, mag_max, mag_min;
-                        abs_re  = data_re[mag_cnt][23] ? -data_re[mag_cnt] : data_re[mag_cnt];
-                        abs_im  = data_im[mag_cnt][23] ? -data_im[mag_cnt] : data_im[mag_cnt];
-                        mag_max = (abs_re > abs_im) ? abs_re : abs_im;
-                        mag_min = (abs_re > abs_im) ? abs_im : abs_re;
-                        // Saturate to 16-bit
-                        mag_buf[mag_cnt] <= (mag_max[23:16] != 0) ? 16'hFFFF
-                                          : mag_max[15:0] + {1'b0, mag_min[15:1]};
-                    end
-
-                    if (mag_cnt == 5'd31) begin
+                    mag_idx <= mag_cnt;
+                    mag_vld <= 1'b1;
+                    if (mag_wr && mag_bin == bins_last) begin
                         state <= S_DONE;
-                    end else begin
-                        mag_cnt <= mag_cnt + 5'd1;
+                    end else if (mag_cnt != bins_last) begin
+                        mag_cnt <= mag_cnt + 1'b1;
                     end
                 end
 
                 // --- Signal completion ---
                 S_DONE: begin
-                    done <= 1'b1;
-                    busy <= 1'b0;
-                    state <= S_IDLE;
+                    done     <= 1'b1;
+                    busy     <= 1'b0;
+                    mag_bank <= ~mag_bank;
+                    mag_size <= size_q;
+                    state    <= S_IDLE;
                 end
 
                 default: state <= S_IDLE;
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - Boot Default NN Model
+// Auto-generated by ml/export_weights.py -- do not edit by hand
+//
+// Network: 8 -> 16 -> 4, 212 weight memory bytes
+// Included in a module body: nn_engine.v copies the image into weight
+// bank 0 after reset, wb_interface.v resets both banks' descriptors,
+// layer count and INT4 layers to this model.
+
+    // Weight image: byte 4a + k is byte k of nn_rom_word(a)
+    localparam NN_ROM_WORDS = 53;
+
+    // SE_NN_CFG layer count / INT4 layers, descriptor table (SHAPE, BASE)
+    localparam [2:0]   NN_ROM_LAYERS = 3'd2;
+    localparam [3:0]   NN_ROM_INT4   = 4'b0000;
+    localparam [255:0] NN_ROM_DESC   = {
+        32'h00000000, 32'h00000000,   // layer 4: BASE, SHAPE
+        32'h00000000, 32'h00000000,   // layer 3: BASE, SHAPE
+        32'h00D00090, 32'h00000410,   // layer 2: BASE, SHAPE
+        32'h00800000, 32'h00011008};  // layer 1: BASE, SHAPE
+
+    function [31:0] nn_rom_word;
+        input [6:0] a;
+        begin
+            case (a)
+                7'd0  : nn_rom_word = 32'h29F2DE12;
+                7'd1  : nn_rom_word = 32'hF41DC0CA;
+                7'd2  : nn_rom_word = 32'hEBEB18EB;
+                7'd3  : nn_rom_word = 32'hE7B3AA0B;
+                7'd4  : nn_rom_word = 32'hC1D70ED3;
+                7'd5  : nn_rom_word = 32'hC003F642;
+                7'd6  : nn_rom_word = 32'h0FC0CAD9;
+                7'd7  : nn_rom_word = 32'h2CD7BAD6;
+                7'd8  : nn_rom_word = 32'hC925D1FF;
+                7'd9  : nn_rom_word = 32'h09C4A809;
+                7'd10 : nn_rom_word = 32'hF1F5FE33;
+                7'd11 : nn_rom_word = 32'h2BE6D6BA;
+                7'd12 : nn_rom_word = 32'hC50B87A8;
+                7'd13 : nn_rom_word = 32'hE207D6B5;
+                7'd14 : nn_rom_word = 32'h2C0FF2DA;
+                7'd15 : nn_rom_word = 32'hCACEF8EB;
+                7'd16 : nn_rom_word = 32'h0CE615E1;
+                7'd17 : nn_rom_word = 32'h05E9A6E5;
+                7'd18 : nn_rom_word = 32'h258A46FE;
+                7'd19 : nn_rom_word = 32'hA704F304;
+                7'd20 : nn_rom_word = 32'hE3250900;
+                7'd21 : nn_rom_word = 32'hFF17D6CA;
+                7'd22 : nn_rom_word = 32'h2B0417E8;
+                7'd23 : nn_rom_word = 32'hBEEEF1E1;
+                7'd24 : nn_rom_word = 32'hF5000C0D;
+                7'd25 : nn_rom_word = 32'hDCF1EDC1;
+                7'd26 : nn_rom_word = 32'hE0400EF1;
+                7'd27 : nn_rom_word = 32'hDC81D9E3;
+                7'd28 : nn_rom_word = 32'hEC024A85;
+                7'd29 : nn_rom_word = 32'hE61A98DF;
+                7'd30 : nn_rom_word = 32'hBE4EB8E1;
+                7'd31 : nn_rom_word = 32'hCCD34317;
+                7'd32 : nn_rom_word = 32'hD20000CD;
+                7'd33 : nn_rom_word = 32'h00820500;
+                7'd34 : nn_rom_word = 32'h00F2009C;
+                7'd35 : nn_rom_word = 32'hC581D900;
+                7'd36 : nn_rom_word = 32'h04C3ECA1;
+                7'd37 : nn_rom_word = 32'h3DC937D6;
+                7'd38 : nn_rom_word = 32'hD015F381;
+                7'd39 : nn_rom_word = 32'h0089D909;
+                7'd40 : nn_rom_word = 32'hD7D01FFA;
+                7'd41 : nn_rom_word = 32'h0EF20E14;
+                7'd42 : nn_rom_word = 32'hE4EE0925;
+                7'd43 : nn_rom_word = 32'h244C2C49;
+                7'd44 : nn_rom_word = 32'hDF2D1F17;
+                7'd45 : nn_rom_word = 32'h4A0CE926;
+                7'd46 : nn_rom_word = 32'hE00EE30E;
+                7'd47 : nn_rom_word = 32'h3AA747FD;
+                7'd48 : nn_rom_word = 32'h60F63936;
+                7'd49 : nn_rom_word = 32'h1315DE18;
+                7'd50 : nn_rom_word = 32'hFD091C00;
+                7'd51 : nn_rom_word = 32'h0511CBDF;
+                7'd52 : nn_rom_word = 32'h46EE4B81;
+                default: nn_rom_word = 32'h00000000;
+            endcase
+        end
+    endfunction
@@ -1,232 +1,415 @@
 // SPDX-License-Identifier: Apache-2.0
 // SenseEdge - Tiny Neural Network Inference Engine
-// Fully-connected: 8 inputs → 16 hidden (ReLU) → 4 outputs (argmax)
-// INT8 weights and activations, single MAC unit, time-multiplexed
-// Total parameters: (8*16)+16+(16*4)+4 = 212 weights/biases
+// Fully-connected layers walked from a layer descriptor table (desc):
+// up to 4 layers of up to ACT_N neurons, default 8 → 16 (ReLU) → 4 (argmax)
+// INT8 weights and biases, 16-bit activations, time-multiplexed MAC array
+// Weights and biases live in one synchronous-read memory (flops, or an
+// SRAM macro with USE_SRAM) of N_BANKS 2^WT_AW-byte banks: each MAC step
+// uses the weights read on the previous clock, and a neuron's bias is read
+// on the second port with its last weights.
+// Each bank holds one resident model with its own descriptor table, layer
+// count and INT4 layers; an inference runs on the bank selected when it
+// starts (bank), so consecutive inferences may use different models with
+// nothing reloaded, and a bank not in use can be rewritten meanwhile.
+// LANES multipliers work on consecutive inputs of one neuron and an adder
+// tree sums their products, so a neuron takes about inputs/LANES clocks.
+// The weight memory is banked by byte lane: one word holds the weights of
+// LANES (at least 4) consecutive inputs and takes a 32-bit Wishbone write
+// in one clock. Every LANES option gives bit-identical results.
+// Each layer can run on INT4 weights (wt_int4, latched on start), packed
+// two per byte with the even input in the low nibble. Every lane
+// multiplier is split into two 4-bit-weight halves: an INT8 weight uses
+// both on one input, INT4 weights use one each on two inputs, so an INT4
+// layer loads half the bytes and runs twice the inputs per clock.
+// With BOOT_ROM the default model (nn_default_model.vh, generated by
+// ml/export_weights.py) is copied into bank 0 after reset, one word per
+// clock with busy high, so the pipeline classifies without a firmware load.
 
 `default_nettype none
 
-module nn_engine (
+module nn_engine #(
+    parameter USE_SRAM = 0,         // 1: weight memory in an SRAM macro
+    parameter LANES    = 1,         // MAC lanes: 1, 2, 4 or 8
+    parameter ACT_N    = 32,        // Activation buffer depth (max neurons / inputs, <= 32)
+    parameter WT_AW    = 9,         // Weight bank byte address width (<= 10)
+    parameter N_BANKS  = 2,         // Resident models: 2 or 4
+    parameter BOOT_ROM = 1          // 1: copy the default model into bank 0 after reset
+)(
     input  wire        clk,
     input  wire        rst,
 
     // Input interface (features from feature extraction)
     input  wire        start,
     input  wire [7:0]  feature_in,     // Feature data read port
-    output reg  [2:0]  feature_addr,   // Feature address (0-7)
+    output reg  [4:0]  feature_addr,   // Feature address (0 .. layer-0 inputs - 1)
 
     // Output interface
     output reg         done,
     output reg  [1:0]  class_id,       // Classification result (0-3)
     output reg  [7:0]  confidence,     // Confidence score (max activation)
+    output reg  [15:0] top_score,      // Winning class score (signed)
+    output reg  [1:0]  second_id,      // Runner-up class
+    output reg  [15:0] second_score,   // Runner-up class score (signed)
     output reg         busy,
 
+    // Model configuration (via Wishbone), bank b in the b-th slice
+    input  wire [1:0]  bank,           // Bank to run (latched on start)
+    input  wire [3*N_BANKS-1:0]   n_layers,   // Layers in the model, 1-4 (latched on start)
+    input  wire [256*N_BANKS-1:0] desc,       // Layer descriptors, 64 bits per layer
+    input  wire [4*N_BANKS-1:0]   wt_int4,    // INT4 weights, bit l for layer l
+
     // Weight loading interface (via Wishbone)
     input  wire        wt_wr_en,
-    input  wire [7:0]  wt_wr_addr,     // 0-211: weight address
-    input  wire [7:0]  wt_wr_data      // INT8 weight value
+    input  wire [1:0]  wt_wr_bank,     // Bank written
+    input  wire [9:0]  wt_wr_addr,     // Byte address of the word, low WT_AW bits used
+    input  wire [3:0]  wt_wr_sel,      // Bytes written, byte k at wt_wr_addr + k
+    input  wire [31:0] wt_wr_data      // Four INT8 weight / bias values
 );
 
-    // --- Weight storage ---
-    // Layer 1: 8 inputs × 16 neurons = 128 weights + 16 biases = 144
-    // Layer 2: 16 inputs × 4 neurons = 64 weights + 4 biases = 68
-    // Total: 212 parameters
-    reg signed [7:0] weights [0:211];
-
-    // Weight memory layout:
-    // [0..127]   : Layer 1 weights (row-major: w[neuron][input])
-    // [128..143] : Layer 1 biases
-    // [144..207] : Layer 2 weights (row-major: w[neuron][input])
-    // [208..211] : Layer 2 biases
-
-    // --- Weight write port ---
-    always @(posedge clk) begin
-        if (wt_wr_en) begin
-            weights[wt_wr_addr] <= wt_wr_data;
-        end
-    end
-
-    // --- Hidden layer activations ---
-    reg signed [15:0] hidden [0:15];   // After ReLU
-    reg signed [23:0] output_act [0:3]; // Final layer output (full precision)
+    `include "nn_default_model.vh"
+
+    // --- Layer descriptors ---
+    // Layer l of bank b occupies desc[256*b + 64*l +: 64]:
+    //   [5:0]   inputs (1..ACT_N; layer 0 reads that many features)
+    //   [13:8]  outputs (1..ACT_N)
+    //   [16]    ReLU on the outputs
+    //   [23:20] requantise shift: output = sat16((sum + bias) >>> shift)
+    //   [41:32] weight base (byte address)
+    //   [57:48] bias base (byte address)
+    // Neuron n's weights are the row [wbase + n*row ..+row-1], row = inputs
+    // (INT8) or (inputs+1)/2 bytes (INT4), its bias is byte bbase + n.
+    // Rows may start anywhere; one that straddles a LANES-byte block takes
+    // an extra clock. The outputs of the last layer are the class scores:
+    // the first (up to) four are argmaxed into class_id / confidence, with
+    // the winning and runner-up scores in top_score / second_score; a
+    // single-output last layer reports second_id 0, second_score 0.
+    // Out-of-range values still run to done: inputs / outputs of 0 count
+    // as 1 and above ACT_N as ACT_N, a layer count of 0 as 1 and above 4
+    // as 4 (the golden model rejects such tables).
+    // The default table (every bank) is the 8 → 16 → 4 model with its 212 parameters
+    // at [0..127] L1 weights, [128..143] L1 biases, [144..207] L2 weights,
+    // [208..211] L2 biases.
+    localparam LB = (LANES >= 8) ? 3 : (LANES >= 4) ? 2 : (LANES >= 2) ? 1 : 0;
+    localparam MB = (LB > 2) ? LB : 2;  // Weight word: 2^MB bytes
+    localparam MW = 1 << MB;
+    localparam BW = (N_BANKS > 2) ? 2 : 1;  // Bank index width
+    localparam WW = WT_AW + BW - MB;    // Weight word address width (all banks)
+    localparam [5:0] ACT_NW = ACT_N;    // Descriptor input / output clamp
 
     // --- FSM ---
     localparam S_IDLE     = 3'd0;
     localparam S_LOAD_IN  = 3'd1;
-    localparam S_LAYER1   = 3'd2;
-    localparam S_RELU     = 3'd3;
-    localparam S_LAYER2   = 3'd4;
-    localparam S_ARGMAX   = 3'd5;
-    localparam S_DONE     = 3'd6;
+    localparam S_SETUP    = 3'd2;
+    localparam S_LAYER    = 3'd3;
+    localparam S_DONE     = 3'd4;
+    localparam S_BOOT     = 3'd5;
 
     reg [2:0]  state;
 
-    // Input buffer
-    reg signed [7:0] inputs [0:7];
-
-    // MAC computation
-    reg [3:0]  neuron_idx;     // Current neuron (0-15 for L1, 0-3 for L2)
-    reg [3:0]  input_idx;      // Current input index
-    reg signed [23:0] acc;     // Accumulator for MAC
-    reg [7:0]  wt_rd_addr;     // Weight read address
-    reg [3:0]  load_cnt;       // Input loading counter (needs 4 bits for 0-8)
-
-    // Argmax
-    reg signed [23:0] max_val;
+    reg  [1:0]  layer;                  // Layer in progress
+    reg  [BW-1:0] bank_q;               // Bank in use (latched on start)
+    reg  [2:0]  nl_q;                   // Layer count (latched on start)
+    reg  [3:0]  int4_q;                 // INT4 layers (latched on start)
+    reg  [6:0]  boot_addr;              // Boot ROM word being copied
+
+    // The table of the bank being started, then of the bank in use
+    wire [BW-1:0] bank_in  = bank[BW-1:0];
+    wire [BW-1:0] cfg_bank = (state == S_IDLE) ? bank_in : bank_q;
+    wire [255:0] desc_b  = desc[256*cfg_bank +: 256];
+    wire [63:0] d       = desc_b[64*layer +: 64];
+    wire [5:0]  d_nin   = (d[5:0] == 6'd0) ? 6'd1 :
+                          (d[5:0] > ACT_N) ? ACT_NW : d[5:0];
+    wire [5:0]  d_nout  = (d[13:8] == 6'd0) ? 6'd1 :
+                          (d[13:8] > ACT_N) ? ACT_NW : d[13:8];
+    wire [2:0]  nl_in   = n_layers[3*bank_in +: 3];
+    wire        d_relu  = d[16];
+    wire [3:0]  d_shift = d[23:20];
+    wire [9:0]  d_wbase = d[41:32];
+    wire [9:0]  d_bbase = d[57:48];
+    wire        int4    = int4_q[layer];
+    wire [5:0]  row_b   = int4 ? (d_nin + 6'd1) >> 1 : d_nin;
+    wire        last_ly = (layer + 3'd1 >= nl_q);
+
+    // --- Activation buffers ---
+    // Layer l reads act[l % 2] and writes act[(l + 1) % 2]; layer 0's
+    // inputs are the features (unsigned, zero-extended).
+    reg signed [15:0] act0 [0:ACT_N-1];
+    reg signed [15:0] act1 [0:ACT_N-1];
+
+    // MAC fetch: the weights of neuron neuron_idx, inputs input_idx on, are
+    // read at wt_ptr this clock; the row ends at row_end.
+    reg               fetch_on;
+    reg  [4:0]        neuron_idx;
+    reg  [5:0]        input_idx;
+    reg  [WT_AW:0]    wt_ptr;
+    reg  [WT_AW:0]    row_end;
+    reg signed [23:0] acc;              // Accumulator for MAC
+    reg  [4:0]        load_cnt;         // Input loading counter
+
+    // A step reads the rest of the row or of the LANES-byte block, if
+    // shorter
+    wire [2:0]       ptr_off  = wt_ptr & (LANES - 1);
+    wire [3:0]       room     = LANES - ptr_off;
+    wire [WT_AW:0]   rem      = row_end - wt_ptr;
+    wire             row_last = (rem <= room);
+    wire [3:0]       n_b      = row_last ? rem[3:0] : room;
+    wire [WT_AW:0]   bias_adr = d_bbase + neuron_idx;
+
+    // Weight writes win the memory; the fetch and the boot copy wait a
+    // clock for them
+    wire             fetch_go = (state == S_LAYER) && fetch_on && !wt_wr_en;
+    wire             boot_wr  = (state == S_BOOT) && !wt_wr_en;
+
+    // MAC pipeline: the step whose weights are on wt_q
+    reg        mac_vld;
+    reg [4:0]  mac_neuron;
+    reg [5:0]  mac_input;
+    reg [2:0]  mac_off;        // Byte lane of the step's first weight
+    reg [3:0]  mac_nb;         // Weight bytes in the step
+    reg        mac_last;       // Last step of the row (bias on bias_q)
+    reg [2:0]  mac_boff;       // Byte lane of the bias
+
+    // --- Weight memory ---
+    // Word address {bank, byte address / MW}; a 32-bit write fills one word
+    // (LANES <= 4) or half of one (LANES = 8). The boot copy writes whole
+    // 32-bit words to bank 0.
+    wire [8*MW-1:0] wt_q;               // Weights read on the previous clock
+    wire [8*MW-1:0] bias_q;             // Bias word read on the previous clock
+    wire            mem_wr     = wt_wr_en || boot_wr;
+    wire   [BW-1:0] mem_bank   = wt_wr_en ? wt_wr_bank[BW-1:0] : {BW{1'b0}};
+    wire      [9:0] mem_addr   = wt_wr_en ? wt_wr_addr : {1'b0, boot_addr, 2'b00};
+    wire      [3:0] mem_sel    = wt_wr_en ? wt_wr_sel : 4'hF;
+    wire     [31:0] mem_data   = wt_wr_en ? wt_wr_data : nn_rom_word(boot_addr);
+    wire      [2:0] wt_wr_half = (mem_addr & (MW - 1)) >> 2;
+    wire   [MW-1:0] wt_wr_mask = mem_sel << (4 * wt_wr_half);
+    wire            bias_rd    = fetch_go && row_last;
+
+    sram_1rw1r #(
+        .DW         (8 * MW),
+        .AW         (WW),
+        .USE_MACRO  (USE_SRAM)
+    ) u_weights (
+        .clk        (clk),
+        .a_en       (mem_wr || bias_rd),
+        .a_we       (mem_wr),
+        .a_wmask    (wt_wr_mask),
+        .a_addr     (mem_wr ? {mem_bank, mem_addr[WT_AW-1:MB]}
+                            : {bank_q, bias_adr[WT_AW-1:MB]}),
+        .a_din      ({(MW / 4){mem_data}}),
+        .a_dout     (bias_q),
+        .b_en       (fetch_go),
+        .b_addr     ({bank_q, wt_ptr[WT_AW-1:MB]}),
+        .b_dout     (wt_q)
+    );
+
+    // Weight bytes seen from lane 0 of the step
+    wire [8*MW-1:0] wt_row   = wt_q >> (8 * mac_off);
+    wire [8*MW-1:0] bias_row = bias_q >> (8 * mac_boff);
+
+    // --- MAC lanes and adder tree (signed throughout) ---
+    // Lane l takes input mac_input + l (INT8) or inputs mac_input + 2l and
+    // + 2l + 1 (INT4). Its two multipliers see the low nibble (unsigned for
+    // INT8, signed for INT4) and the signed high nibble, so an INT8 weight
+    // is lo + 16 * hi. Inputs past the layer's count read as 0. Tree node k
+    // sums nodes 2k and 2k+1, leaves LANES..2*LANES-1 are the lanes and
+    // node 1 is the step total. Sums wrap at 24 bits like a single
+    // accumulator.
+    wire signed [23:0] mac_tree [1:2*LANES-1];
+
+    genvar l;
+    generate
+        for (l = 0; l < LANES; l = l + 1) begin : g_lane
+            wire        [5:0]  ia   = mac_input + (int4 ? 2 * l : l);
+            wire        [5:0]  ib   = ia + 6'd1;
+            wire signed [15:0] xa   = (ia >= d_nin) ? 16'sd0 :
+                                      layer[0] ? act1[ia[4:0]] : act0[ia[4:0]];
+            wire signed [15:0] xb   = (ib >= d_nin) ? 16'sd0 :
+                                      layer[0] ? act1[ib[4:0]] : act0[ib[4:0]];
+            wire        [7:0]  wb   = wt_row[8*l +: 8];
+            wire signed [4:0]  lo   = {int4 & wb[3], wb[3:0]};
+            wire signed [3:0]  hi   = wb[7:4];
+            wire signed [23:0] p_lo = xa * lo;
+            wire signed [23:0] p_hi = (int4 ? xb : xa) * hi;
+            assign mac_tree[LANES + l] = (l >= mac_nb) ? 24'sd0
+                                       : int4 ? p_lo + p_hi
+                                              : p_lo + (p_hi <<< 4);
+        end
+        for (l = 1; l < LANES; l = l + 1) begin : g_tree
+            assign mac_tree[l] = mac_tree[2*l] + mac_tree[2*l + 1];
+        end
+    endgenerate
+
+    wire signed [23:0] mac_prod = mac_tree[1];
+    wire signed [7:0]  mac_bias = bias_row[7:0];
+    wire signed [23:0] mac_sum  = acc + mac_prod;
+
+    // --- Requantise: bias, shift, saturate to 16 bits, activation ---
+    wire signed [23:0] mac_pre  = mac_sum + mac_bias;
+    wire signed [23:0] mac_shr  = mac_pre >>> d_shift;
+    wire signed [15:0] mac_sat  = (mac_shr >  24'sd32767) ? 16'sd32767 :
+                                  (mac_shr < -24'sd32768) ? -16'sd32768 : mac_shr[15:0];
+    wire signed [15:0] mac_act  = (d_relu && mac_sat[15]) ? 16'sd0 : mac_sat;
+
+    // Argmax and runner-up over the last layer's first four outputs, as
+    // they are written; ties go to the lower class
+    reg signed [15:0] max_val;
     reg [1:0]  max_idx;
-    reg [1:0]  argmax_cnt;
-    reg        argmax_done;
+    reg signed [15:0] max2_val;
+    reg [1:0]  max2_idx;
 
     always @(posedge clk) begin
         if (rst) begin
-            state        <= S_IDLE;
+            state        <= BOOT_ROM ? S_BOOT : S_IDLE;
             done         <= 1'b0;
-            busy         <= 1'b0;
+            busy         <= BOOT_ROM;
             class_id     <= 2'd0;
             confidence   <= 8'd0;
-            feature_addr <= 3'd0;
-            neuron_idx   <= 4'd0;
-            input_idx    <= 4'd0;
-            load_cnt     <= 3'd0;
-            argmax_done  <= 1'b0;
+            top_score    <= 16'd0;
+            second_id    <= 2'd0;
+            second_score <= 16'd0;
+            feature_addr <= 5'd0;
+            layer        <= 2'd0;
+            bank_q       <= {BW{1'b0}};
+            nl_q         <= 3'd2;
+            int4_q       <= 4'd0;
+            boot_addr    <= 7'd0;
+            fetch_on     <= 1'b0;
+            neuron_idx   <= 5'd0;
+            input_idx    <= 6'd0;
+            load_cnt     <= 5'd0;
+            mac_vld      <= 1'b0;
         end else begin
             done <= 1'b0;
 
             case (state)
+                // --- Copy the boot ROM model into bank 0 ---
+                S_BOOT: begin
+                    if (boot_wr) begin
+                        if (boot_addr == NN_ROM_WORDS - 1) begin
+                            state <= S_IDLE;
+                            busy  <= 1'b0;
+                        end else begin
+                            boot_addr <= boot_addr + 7'd1;
+                        end
+                    end
+                end
+
                 S_IDLE: begin
-                    if (start && !wt_wr_en) begin
+                    if (start) begin
                         state        <= S_LOAD_IN;
                         busy         <= 1'b1;
-                        load_cnt     <= 4'd0;
-                        feature_addr <= 3'd0;
+                        layer        <= 2'd0;
+                        bank_q       <= bank_in;
+                        nl_q         <= (nl_in == 3'd0) ? 3'd1 :
+                                        (nl_in > 3'd4) ? 3'd4 : nl_in;
+                        int4_q       <= wt_int4[4*bank_in +: 4];
+                        load_cnt     <= 5'd0;
+                        feature_addr <= 5'd0;
                     end
                 end
 
-                // --- Load 8 input features ---
+                // --- Load the layer-0 input features ---
                 // feature_addr is combinationally read by external memory.
                 // On each cycle, feature_in reflects the address set on the
                 // PREVIOUS clock edge (registered output of feature_addr).
                 // Cycle 0: feature_in = mem[0] (addr set in S_IDLE), set addr=1
-                // Cycle 1: capture inputs[0]=mem[0], feature_in=mem[1], set addr=2
+                // Cycle 1: capture act0[0]=mem[0], feature_in=mem[1], set addr=2
                 // ...
-                // Cycle 8: capture inputs[7]=mem[7], transition to L1
+                // Cycle n-1: capture the last input, set up layer 0
                 S_LOAD_IN: begin
-                    // Capture feature data (available from address set last cycle)
-                    inputs[load_cnt[2:0]] <= feature_in;
-
-                    if (load_cnt == 4'd7) begin
-                        // All 8 inputs captured (0..7)
-                        state      <= S_LAYER1;
-                        neuron_idx <= 4'd0;
-                        input_idx  <= 4'd0;
-                        acc        <= 24'd0;
-                    end else begin
-                        load_cnt     <= load_cnt + 4'd1;
-                        feature_addr <= load_cnt[2:0] + 3'd1;
-                    end
-                end
-
-                // --- Layer 1: 8→16, MAC computation ---
-                S_LAYER1: begin
+                    act0[load_cnt] <= {8'd0, feature_in};
 
-                    // MAC: acc += input[input_idx] * weight[neuron*8 + input]
-                    wt_rd_addr = {neuron_idx[3:0], input_idx[2:0]};  // neuron*8 + input
-                    acc <= acc + (inputs[input_idx[2:0]] * weights[wt_rd_addr]);
-
-                    if (input_idx == 4'd7) begin
-                        // Done with this neuron - add bias and store
-                        // Note: current MAC (input*weight) is added to acc on this cycle via line above
-                        // Bias at offset 128 + neuron_idx
-                        hidden[neuron_idx] <= acc
-                                            + (inputs[input_idx[2:0]] * weights[wt_rd_addr])
-                                            + {{16{weights[128 + neuron_idx][7]}}, weights[128 + neuron_idx]};
-
-                        if (neuron_idx == 4'd15) begin
-                            state      <= S_RELU;
-                            neuron_idx <= 4'd0;
-                        end else begin
-                            neuron_idx <= neuron_idx + 4'd1;
-                            input_idx  <= 4'd0;
-                            acc        <= 24'd0;
-                        end
+                    if (load_cnt == d_nin - 6'd1) begin
+                        state <= S_SETUP;
                     end else begin
-                        input_idx <= input_idx + 4'd1;
+                        load_cnt     <= load_cnt + 5'd1;
+                        feature_addr <= load_cnt + 5'd1;
                     end
                 end
 
-                // --- ReLU activation ---
-                S_RELU: begin
-                    // Apply ReLU to all hidden neurons in one cycle
-                    // (combinational, but registered output)
-                    begin : relu_block
-                        integer i;
-                        for (i = 0; i < 16; i = i + 1) begin
-                            if (hidden[i][15]) // Negative
-                                hidden[i] <= 16'd0;
-                        end
-                    end
-                    state      <= S_LAYER2;
-                    neuron_idx <= 4'd0;
-                    input_idx  <= 4'd0;
+                // --- Start a layer at its first weight row ---
+                S_SETUP: begin
+                    state      <= S_LAYER;
+                    fetch_on   <= 1'b1;
+                    neuron_idx <= 5'd0;
+                    input_idx  <= 6'd0;
+                    wt_ptr     <= d_wbase;
+                    row_end    <= d_wbase + row_b;
+                    mac_vld    <= 1'b0;
                     acc        <= 24'd0;
                 end
 
-                // --- Layer 2: 16→4, MAC computation ---
-                S_LAYER2: begin
-                    // MAC: acc += hidden[input_idx] * weight[144 + neuron*16 + input]
-                    wt_rd_addr = 8'd144 + {neuron_idx[1:0], input_idx[3:0]};
-                    acc <= acc + (hidden[input_idx] * weights[wt_rd_addr]);
-
-                    if (input_idx == 4'd15) begin
-                        // Done with this neuron - add bias (full 24-bit precision)
-                        output_act[neuron_idx[1:0]] <= acc
-                            + (hidden[input_idx] * weights[wt_rd_addr])
-                            + {{16{weights[208 + neuron_idx[1:0]][7]}}, weights[208 + neuron_idx[1:0]]};
-
-                        if (neuron_idx[1:0] == 2'd3) begin
-                            state       <= S_ARGMAX;
-                            argmax_cnt  <= 2'd0;
-                            argmax_done <= 1'b0;
-                            max_val     <= 24'h800000;  // Most negative (24-bit)
-                            max_idx     <= 2'd0;
+                // --- Layer MAC computation ---
+                // Read the next step of the row while the weights read last
+                // clock are accumulated: acc += sum(input * weight). The
+                // last step of a row also reads the bias and writes the
+                // requantised output.
+                S_LAYER: begin
+                    mac_vld <= fetch_go;
+                    if (fetch_go) begin
+                        mac_neuron <= neuron_idx;
+                        mac_input  <= input_idx;
+                        mac_off    <= wt_ptr & (MW - 1);
+                        mac_nb     <= n_b;
+                        mac_last   <= row_last;
+                        mac_boff   <= bias_adr & (MW - 1);
+                        if (row_last) begin
+                            wt_ptr     <= row_end;
+                            row_end    <= row_end + row_b;
+                            input_idx  <= 6'd0;
+                            neuron_idx <= neuron_idx + 5'd1;
+                            if (neuron_idx == d_nout - 6'd1)
+                                fetch_on <= 1'b0;
                         end else begin
-                            neuron_idx <= neuron_idx + 4'd1;
-                            input_idx  <= 4'd0;
-                            acc        <= 24'd0;
+                            wt_ptr    <= wt_ptr + n_b;
+                            input_idx <= input_idx + (n_b << int4);
                         end
-                    end else begin
-                        input_idx <= input_idx + 4'd1;
                     end
-                end
 
-                // --- Argmax to find winning class ---
-                // Cycles 0-3: compare output_act[argmax_cnt] with max_val
-                // Cycle 4 (argmax_done): latch result after last comparison registered
-                S_ARGMAX: begin
-                    if (!argmax_done) begin
-                        if (output_act[argmax_cnt] > max_val) begin
-                            max_val <= output_act[argmax_cnt];
-                            max_idx <= argmax_cnt;
-                        end
-
-                        if (argmax_cnt == 2'd3) begin
-                            argmax_done <= 1'b1;
+                    if (mac_vld) begin
+                        if (mac_last) begin
+                            // Done with this neuron - add bias, requantise, store
+                            if (layer[0]) act0[mac_neuron] <= mac_act;
+                            else          act1[mac_neuron] <= mac_act;
+                            acc <= 24'd0;
+
+                            if (last_ly && mac_neuron < 5'd4) begin
+                                if (mac_neuron == 5'd0 || mac_act > max_val) begin
+                                    max_val  <= mac_act;
+                                    max_idx  <= mac_neuron[1:0];
+                                    max2_val <= (mac_neuron == 5'd0) ? 16'sd0 : max_val;
+                                    max2_idx <= (mac_neuron == 5'd0) ? 2'd0 : max_idx;
+                                end else if (mac_neuron == 5'd1 || mac_act > max2_val) begin
+                                    max2_val <= mac_act;
+                                    max2_idx <= mac_neuron[1:0];
+                                end
+                            end
+
+                            if (mac_neuron == d_nout - 6'd1) begin
+                                if (last_ly) begin
+                                    state <= S_DONE;
+                                end else begin
+                                    state <= S_SETUP;
+                                    layer <= layer + 2'd1;
+                                end
+                            end
                         end else begin
-                            argmax_cnt <= argmax_cnt + 2'd1;
+                            acc <= mac_sum;
                         end
-                    end else begin
-                        // One cycle after last comparison — max_val/max_idx are now stable
-                        class_id   <= max_idx;
-                        // Confidence: saturate to 8 bits from 24-bit signed value
-                        confidence <= (max_val[23]) ? 8'd0 :
-                                      (max_val[23:8] != 0) ? 8'hFF : max_val[7:0];
-                        state      <= S_DONE;
                     end
                 end
 
+                // --- Classification result ---
+                // Confidence: the winning score saturated to 8 bits
                 S_DONE: begin
-                    done <= 1'b1;
-                    busy <= 1'b0;
+                    class_id     <= max_idx;
+                    top_score    <= max_val;
+                    second_id    <= max2_idx;
+                    second_score <= max2_val;
+                    confidence <= max_val[15] ? 8'd0 :
+                                  (max_val[15:8] != 0) ? 8'hFF : max_val[7:0];
+                    done  <= 1'b1;
+                    busy  <= 1'b0;
                     state <= S_IDLE;
                 end
 
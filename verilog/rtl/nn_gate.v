@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - Change-Gated Inference
+// Decides, for each feature vector waiting for the NN, whether it is worth
+// classifying: it is compared with the vector the NN last ran on by the
+// L1 distance over the 12 features, and one closer than threshold reuses
+// the last result instead (skip), leaving the NN idle. The pipeline
+// control turns a skip into a result with the held class, confidence and
+// scores.
+// A run is forced after max_skip skips in a row, when the vector is for
+// another model bank than the last run (a bank swap, or per-channel
+// models) and after the pipeline was disabled, so a slow drift or a new
+// model is always picked up. threshold 0 turns the gate off.
+// The held result is that of the last NN run, so only a vector of the same
+// ADC channel may reuse it: with several channels sampled round robin the
+// gate stays out of the way.
+
+`default_nettype none
+
+module nn_gate (
+    input  wire        clk,
+    input  wire        rst,
+    input  wire        enable,          // Pipeline enabled (forgets the reference when low)
+
+    // Configuration (wb_interface GATE_CFG)
+    input  wire [11:0] threshold,       // Skip below this L1 distance, 0 = off
+    input  wire [7:0]  max_skip,        // Skips in a row before a forced run, 0 = no limit
+    input  wire [1:0]  model_bank,      // NN bank vec would run on
+    input  wire [1:0]  channel,         // ADC channel of vec
+
+    // Feature vector waiting for the NN (feature 0 in [7:0])
+    input  wire [95:0] vec,
+    input  wire        take,            // vec goes on now: run, or skip if skip is high
+    output wire        skip,            // vec may reuse the last result
+    output wire [11:0] distance         // L1 distance of vec to the reference
+);
+
+    localparam N_FEAT = 12;
+
+    reg [95:0] ref_vec;         // Vector of the last NN run
+    reg        ref_ok;
+    reg [1:0]  ref_bank;        // Model bank it was classified with
+    reg [1:0]  ref_ch;          // Its channel
+    reg [7:0]  skip_cnt;        // Skips since that run
+
+    // --- L1 distance ---
+    reg [11:0] dist;
+    always @(*) begin : l1
+        integer f;
+        reg [7:0] a, b;
+        dist = 12'd0;
+        for (f = 0; f < N_FEAT; f = f + 1) begin
+            a = vec[8*f +: 8];
+            b = ref_vec[8*f +: 8];
+            dist = dist + ((a > b) ? a - b : b - a);
+        end
+    end
+
+    assign distance = dist;
+    assign skip     = (threshold != 12'd0) && ref_ok && (ref_bank == model_bank) &&
+                      (ref_ch == channel) && (dist < threshold) && (max_skip == 8'd0 || skip_cnt < max_skip);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            ref_vec  <= 96'd0;
+            ref_ok   <= 1'b0;
+            ref_bank <= 2'd0;
+            ref_ch   <= 2'd0;
+            skip_cnt <= 8'd0;
+        end else begin
+            if (take) begin
+                if (skip) begin
+                    if (skip_cnt != 8'hFF)
+                        skip_cnt <= skip_cnt + 8'd1;
+                end else begin
+                    ref_vec  <= vec;
+                    ref_ok   <= 1'b1;
+                    ref_bank <= model_bank;
+                    ref_ch   <= channel;
+                    skip_cnt <= 8'd0;
+                end
+            end
+            if (!enable)
+                ref_ok <= 1'b0;
+        end
+    end
+
+endmodule
+
+`default_nettype wire
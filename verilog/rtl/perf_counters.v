@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - Performance Counters
+// Cycle counts of every pipeline stage for the last frame plus a running
+// maximum, a free-running count of classified frames, and counts of the
+// windows the sample front end had to drop or could not hand on at once,
+// of the times it stalled sampling to keep a window (spi_adc_if), of the
+// bus samples it could not take and of the frames the change gate
+// answered without the NN (nn_gate).
+// Read from the Wishbone PERF page (wb_interface); reading a MAX or an
+// event count clears it. The key values are mirrored on la_perf.
+//
+// Stages (index s of LAST/MAX):
+//   0 SPI  window hand-over to the next one (SPI fill time of one hop),
+//          restarted when the pipeline is enabled again
+//   1 FFT  FFT start to done
+//   2 FE   feature extraction start (with the FFT) to done
+//   3 NN   NN start to done
+//   4 LAT  window hand-over to its classification, which the alarm logic
+//          takes on the next clock (end-to-end latency), NN runs only
+// Every stage holds one frame at a time, so one counter per stage does.
+// The stage counts saturate at 2^CW - 1, the latency wraps modulo 2^CW.
+
+`default_nettype none
+
+module perf_counters #(
+    parameter CW = 24               // Cycle counter width (16-32)
+)(
+    input  wire        clk,
+    input  wire        rst,
+    input  wire        enable,      // Pipeline enabled (CTRL.ENABLE)
+
+    // Pipeline events (single-cycle pulses)
+    input  wire        win_valid,   // A sample window handed over
+    input  wire        win_drop,    // A window was lost before the FFT took it
+    input  wire        win_overrun, // Window handed over while the FFT is busy
+    input  wire        win_stall,   // Sampling stalled behind a waiting window
+    input  wire        smp_reject,  // A SAMPLE_IN sample came while sampling was held
+    input  wire        fft_start,
+    input  wire        fft_done,
+    input  wire        fe_done,
+    input  wire        nn_start,
+    input  wire        nn_done,
+    input  wire        nn_skip,     // Frame classified by the change gate, NN idle
+
+    // Register read port, rd_addr = word offset in the PERF page
+    input  wire        rd_en,       // Read strobe (clears MAX / counts)
+    input  wire [3:0]  rd_addr,
+    output reg  [31:0] rd_data,
+
+    // Logic analyzer mirror
+    output wire [95:0] la_perf
+);
+
+    // --- Register map (word offsets) ---
+    //   0 FRAMES    classified frames since reset (free running), skips included,
+    //               one per NN run with several models per vector
+    //   1 DROPS     windows dropped (read clears)
+    //   2 OVERRUNS  windows handed over while the FFT was busy (read clears)
+    //   3 STALLS    sampling stalls, overrun policy STALL (read clears)
+    //   4 + 2s      LAST of stage s
+    //   5 + 2s      MAX of stage s (read clears)
+    //  14 SKIPS     frames the change gate reused a result for (read clears)
+    //  15 REJECTS   SAMPLE_IN samples dropped, sampling held (read clears)
+    localparam PERF_FRAMES   = 4'd0;
+    localparam PERF_DROPS    = 4'd1;
+    localparam PERF_OVERRUNS = 4'd2;
+    localparam PERF_STALLS   = 4'd3;
+    localparam PERF_STAGE    = 4'd4;
+    localparam N_STAGES      = 5;
+    localparam PERF_SKIPS    = 4'd14;
+    localparam PERF_REJECTS  = 4'd15;
+
+    localparam [CW-1:0] CNT_MAX = {CW{1'b1}};
+
+    // Start / done of the counted stages (LAT comes from the timestamps)
+    wire [N_STAGES-2:0] st_start = {nn_start, fft_start, fft_start, win_valid};
+    wire [N_STAGES-2:0] st_done  = {nn_done,  fe_done,   fft_done,  win_valid};
+
+    reg [CW-1:0] last [0:N_STAGES-1];
+    reg [CW-1:0] max  [0:N_STAGES-1];
+    reg [CW-1:0] cnt  [0:N_STAGES-2];
+    reg [N_STAGES-2:0] run;
+
+    reg [31:0] frames;
+    reg [15:0] drops;
+    reg [15:0] overruns;
+    reg [15:0] stalls;
+    reg [15:0] skips;
+    reg [15:0] rejects;
+
+    // --- Latency timestamps ---
+    // The hand-over time travels with the window through the stages
+    reg [CW-1:0] now;
+    reg [CW-1:0] t_win;             // Latest window handed over
+    reg [CW-1:0] t_fft;             // Window in the FFT + feature stage
+    reg [CW-1:0] t_feat;            // Published features
+    reg [CW-1:0] t_nn;              // Window being classified
+
+    wire [CW-1:0] lat = now - t_nn;
+
+    // Stage register decode; a MAX read clears it
+    wire       rd_stage = rd_addr >= PERF_STAGE && rd_addr < PERF_STAGE + 2 * N_STAGES;
+    wire [2:0] rd_s     = (rd_addr - PERF_STAGE) >> 1;
+    wire       rd_max   = rd_en && rd_stage && rd_addr[0];
+
+    // --- Stage counters ---
+    always @(posedge clk) begin : stages
+        integer s;
+        if (rst) begin
+            run <= {(N_STAGES - 1){1'b0}};
+            for (s = 0; s < N_STAGES; s = s + 1) begin
+                last[s] <= {CW{1'b0}};
+                max[s]  <= {CW{1'b0}};
+            end
+            for (s = 0; s < N_STAGES - 1; s = s + 1)
+                cnt[s] <= {CW{1'b0}};
+        end else begin
+            for (s = 0; s < N_STAGES; s = s + 1)
+                if (rd_max && rd_s == s)
+                    max[s] <= {CW{1'b0}};
+
+            for (s = 0; s < N_STAGES - 1; s = s + 1) begin
+                if (run[s] && cnt[s] != CNT_MAX)
+                    cnt[s] <= cnt[s] + 1'b1;
+                if (run[s] && st_done[s]) begin
+                    run[s]  <= 1'b0;
+                    last[s] <= cnt[s];
+                    if (cnt[s] > max[s] || (rd_max && rd_s == s))
+                        max[s] <= cnt[s];
+                end
+                // A stage may finish and start again on the same clock
+                if (st_start[s]) begin
+                    run[s] <= 1'b1;
+                    cnt[s] <= {{(CW - 1){1'b0}}, 1'b1};
+                end
+            end
+            // No window interval across a disabled stretch
+            if (!enable)
+                run[0] <= 1'b0;
+
+            if (nn_done) begin
+                last[N_STAGES-1] <= lat;
+                if (lat > max[N_STAGES-1] || (rd_max && rd_s == N_STAGES - 1))
+                    max[N_STAGES-1] <= lat;
+            end
+        end
+    end
+
+    // --- Timestamps and event counts ---
+    always @(posedge clk) begin
+        if (rst) begin
+            now      <= {CW{1'b0}};
+            t_win    <= {CW{1'b0}};
+            t_fft    <= {CW{1'b0}};
+            t_feat   <= {CW{1'b0}};
+            t_nn     <= {CW{1'b0}};
+            frames   <= 32'd0;
+            drops    <= 16'd0;
+            overruns <= 16'd0;
+            stalls   <= 16'd0;
+            skips    <= 16'd0;
+            rejects  <= 16'd0;
+        end else begin
+            now <= now + 1'b1;
+            if (win_valid)
+                t_win <= now;
+            // A window handed over with the start pulse is the one loaded
+            if (fft_start)
+                t_fft <= win_valid ? now : t_win;
+            if (fe_done)
+                t_feat <= t_fft;
+            if (nn_start)
+                t_nn <= t_feat;
+
+            if (nn_done || nn_skip)
+                frames <= frames + 32'd1;
+
+            if (rd_en && rd_addr == PERF_DROPS)
+                drops <= {15'd0, win_drop};
+            else if (win_drop && drops != 16'hFFFF)
+                drops <= drops + 16'd1;
+
+            if (rd_en && rd_addr == PERF_OVERRUNS)
+                overruns <= {15'd0, win_overrun};
+            else if (win_overrun && overruns != 16'hFFFF)
+                overruns <= overruns + 16'd1;
+
+            if (rd_en && rd_addr == PERF_STALLS)
+                stalls <= {15'd0, win_stall};
+            else if (win_stall && stalls != 16'hFFFF)
+                stalls <= stalls + 16'd1;
+
+            if (rd_en && rd_addr == PERF_SKIPS)
+                skips <= {15'd0, nn_skip};
+            else if (nn_skip && skips != 16'hFFFF)
+                skips <= skips + 16'd1;
+
+            if (rd_en && rd_addr == PERF_REJECTS)
+                rejects <= {15'd0, smp_reject};
+            else if (smp_reject && rejects != 16'hFFFF)
+                rejects <= rejects + 16'd1;
+        end
+    end
+
+    // --- Read mux ---
+    always @(*) begin
+        rd_data = 32'd0;
+        case (rd_addr)
+            PERF_FRAMES:   rd_data = frames;
+            PERF_DROPS:    rd_data = {16'd0, drops};
+            PERF_OVERRUNS: rd_data = {16'd0, overruns};
+            PERF_STALLS:   rd_data = {16'd0, stalls};
+            PERF_SKIPS:    rd_data = {16'd0, skips};
+            PERF_REJECTS:  rd_data = {16'd0, rejects};
+            default: begin
+                if (rd_stage)
+                    rd_data = rd_addr[0] ? max[rd_s] : last[rd_s];
+            end
+        endcase
+    end
+
+    // --- Logic analyzer mirror (16-bit views, saturated) ---
+    //   [15:0]  FRAMES         [31:16] FFT LAST   [47:32] NN LAST
+    //   [63:48] LAT LAST       [79:64] SPI LAST   [87:80] DROPS
+    //   [95:88] OVERRUNS
+    function [15:0] sat16;
+        input [CW-1:0] v;
+        begin
+            sat16 = (v > 16'hFFFF) ? 16'hFFFF : v[15:0];
+        end
+    endfunction
+
+    assign la_perf = {(overruns > 16'hFF) ? 8'hFF : overruns[7:0],
+                      (drops > 16'hFF) ? 8'hFF : drops[7:0],
+                      sat16(last[0]), sat16(last[4]), sat16(last[3]),
+                      sat16(last[1]), frames[15:0]};
+
+endmodule
+
+`default_nettype wire
@@ -1,11 +1,23 @@
 // SPDX-License-Identifier: Apache-2.0
 // SenseEdge - Top-Level Module
 // Predictive Maintenance ASIC with Hardware FFT and Neural Network Inference
-// Integrates: SPI ADC → FFT → Feature Extraction → NN Inference → Alarm
+// Integrates: SPI ADC (N_CH channels) → FFT → Spectral Averaging →
+// Feature Extraction → Change Gate → NN Inference (NN_MODELS resident
+// models) → Alarm, with results on the Wishbone bus and the hardware UART
 
 `default_nettype none
 
-module senseedge_top (
+module senseedge_top #(
+    parameter FFT_ARCH  = 0,    // FFT datapath option, see fft_engine.v
+    parameter REAL_FFT  = 0,    // 1: real-input FFT (N/2-point complex + split)
+    parameter LOG2_NMAX = 6,    // Largest runtime FFT length: 6/7/8 = 64/128/256
+    parameter USE_SRAM  = 0,    // 1: sample ring, FFT data, spectrum, weights in SRAM macros
+    parameter WINDOW    = 0,    // FFT input window: 0 rectangular, 1 Hann, 2 Hamming
+    parameter NN_LANES  = 1,    // NN MAC lanes (1/2/4/8), see nn_engine.v
+    parameter NN_BOOT   = 1,    // 1: NN boots with the default model (nn_default_model.vh)
+    parameter N_CH      = 1,    // ADC channels (1-4), chip selects on GPIO 2 and 8-10
+    parameter NN_MODELS = 2     // Resident NN models (weight banks): 2 or 4
+)(
 `ifdef USE_POWER_PINS
     inout vccd1,    // User area 1 1.8V supply
     inout vssd1,    // User area 1 digital ground
@@ -50,37 +62,86 @@ module senseedge_top (
     // Control signals (from WB interface)
     wire        enable;
     wire [15:0] clk_div;
+    wire [23:0] sample_period;
+    wire        inject;         // Samples written over Wishbone instead of the ADC
+    wire        inj_valid;
+    wire [11:0] inj_data;
+    wire        inj_ready;
+    wire        sw_trig;
+    wire [8:0]  hop_size;
+    wire [1:0]  ovr_mode;
+    wire [1:0]  fft_size;
+    wire [1:0]  n_ch;           // ADC channels sampled - 1
+    wire [2:0]  avg_shift;
+    wire [3:0]  avg_every;
+    wire [11:0] gate_thr;
+    wire [7:0]  gate_max;
     wire [7:0]  alarm_threshold;
     wire [3:0]  fault_count_cfg;
+    wire [4*NN_MODELS-1:0]   nn_int4;
+    wire [3*NN_MODELS-1:0]   nn_layers;
+    wire [256*NN_MODELS-1:0] nn_desc;
+    wire [1:0]  nn_bank;        // Active bank
+    wire        model_per_ch;   // Channel c runs bank model_map[2c+1:2c]
+    wire [7:0]  model_map;
+    wire        model_all;      // Banks 0 .. model_last on every vector
+    wire [1:0]  model_last;
 
     // SPI ADC ↔ FFT
     wire        samples_valid;
     wire [15:0] sample_data;
-    wire [5:0]  sample_addr_from_fft;
+    wire [LOG2_NMAX-1:0] sample_addr_from_fft;
     wire [5:0]  sample_count;
+    wire [LOG2_NMAX:0]   sample_frame_base;
+    wire [1:0]  sample_frame_size;
+    wire        sample_bank_lock;
+    wire        adc_drop;       // Window discarded by the SPI side
+    wire        adc_stall;      // Sampling stalled behind a waiting window
+    wire        overrun;        // Window lost or sampling stalled (IRQ, LA)
 
     // SPI pins (directly on io_in/io_out)
     wire        spi_clk_out;
-    wire        spi_cs_n_out;
+    wire [N_CH-1:0] spi_cs_n_out;   // Chip select of channel c in bit c
     wire        spi_miso_in;
 
     // FFT ↔ Feature Extraction
     wire        fft_done;
     wire        fft_busy;
+    wire        fft_loading;
+    wire        fft_load_valid;     // Raw window sample on sample_data
+    wire        fft_mag_bank;
+    wire [1:0]  fft_mag_size;
     wire [15:0] fft_mag_data;
-    wire [4:0]  fft_mag_addr;
+    wire        fft_bin_valid;
+    wire [LOG2_NMAX-2:0] fft_bin_idx;
+    wire [15:0] fft_bin_mag;
+
+    // Spectral averaging ↔ Feature Extraction
+    wire        avg_publish;        // The frame starting now goes on to FE / NN
+    wire        avg_bin_valid;
+    wire [LOG2_NMAX-2:0] avg_bin_idx;
+    wire [15:0] avg_bin_mag;
+    wire        fe_start;           // Feature extraction start (published frames)
 
     // Feature Extraction ↔ NN
     wire        fe_done;
     wire        fe_busy;
+    wire        fe_feat_bank;
     wire [7:0]  feature_data;
-    wire [2:0]  feature_addr_from_nn;
+    wire [4:0]  feature_addr_from_nn;
+    wire [7:0]  nn_feature_in;
+    wire [95:0] fe_last_vec;        // Published feature vector (change gate)
+    wire        gate_skip;          // It may reuse the last result
+
 
     // NN outputs
     wire        nn_done;
     wire        nn_busy;
     wire [1:0]  class_id;
     wire [7:0]  confidence;
+    wire [15:0] nn_top_score;
+    wire [1:0]  nn_second_id;
+    wire [15:0] nn_second_score;
 
     // Alarm
     wire        alarm_active;
@@ -88,17 +149,37 @@ module senseedge_top (
     wire [1:0]  last_fault_class;
 
     // WB ↔ FFT readback
-    wire [4:0]  wb_fft_rd_addr;
+    wire [6:0]  wb_fft_rd_addr;
     wire [15:0] wb_fft_rd_data;
 
     // WB ↔ Feature readback
-    wire [2:0]  wb_feature_rd_addr;
+    wire [3:0]  wb_feature_rd_addr;
     wire [7:0]  wb_feature_rd_data;
 
+    // WB ↔ Readback snapshot
+    wire        snap_req;
+    wire [95:0] snap_feat;
+
     // WB ↔ NN weight loading
     wire        wt_wr_en;
-    wire [7:0]  wt_wr_addr;
-    wire [7:0]  wt_wr_data;
+    wire [1:0]  wt_wr_bank;
+    wire [9:0]  wt_wr_addr;
+    wire [3:0]  wt_wr_sel;
+    wire [31:0] wt_wr_data;
+
+    // WB ↔ Performance counters
+    wire        perf_rd;
+    wire [3:0]  perf_addr;
+    wire [31:0] perf_data;
+    wire [95:0] la_perf;
+
+    // WB ↔ UART TX
+    wire [15:0] uart_div;
+    wire        uart_wr_en;
+    wire [7:0]  uart_wr_data;
+    wire [4:0]  uart_level;
+    wire        uart_busy;
+    wire        uart_txd;
 
     // =========================================================================
     // GPIO Pin Assignments
@@ -108,20 +189,31 @@ module senseedge_top (
     // io_in/io_out[2]  : SPI CS_N (output to ADC)
     // io_in/io_out[3]  : Alarm output (active high)
     // io_in/io_out[4]  : Status LED (healthy=on)
-    // io_in/io_out[5]  : UART TX to ESP32 (directly from LA for firmware)
+    // io_in/io_out[5]  : UART TX to ESP32 (uart_tx, fed from UART_DATA/AUTO)
     // io_in/io_out[6]  : UART RX from ESP32 (directly to LA for firmware)
-    // [7:15]           : Reserved / unused
+    // io_in[7]         : Boot strap, sampled in reset: 1 starts the pipeline
+    //                    (CTRL.ENABLE) on the boot model without firmware
+    // io_out[10:8]     : SPI CS_N of ADC channels 1-3 (outputs up to N_CH)
+    // [11:15]          : Reserved / unused
 
     assign spi_miso_in = io_in[0];
 
+    // Chip selects padded to four channels, unbuilt ones held high
+    wire [N_CH-1:0] cs_act  = ~spi_cs_n_out;
+    wire [3:0]      cs_act4 = cs_act;
+    wire [3:0]      cs_n4   = ~cs_act4;
+    wire [3:0]      cs_n_oe = ~((4'd1 << N_CH) - 4'd1);  // 0: pin driven
+
     assign io_out[0]  = 1'b0;           // MISO is input
     assign io_out[1]  = spi_clk_out;
-    assign io_out[2]  = spi_cs_n_out;
+    assign io_out[2]  = cs_n4[0];
     assign io_out[3]  = alarm_active;
     assign io_out[4]  = enable & ~alarm_active;  // Status LED: on when healthy
-    assign io_out[5]  = 1'b1;           // UART TX idle high (firmware drives via LA)
+    assign io_out[5]  = uart_txd;       // UART TX, idles high
     assign io_out[6]  = 1'b0;           // UART RX is input
-    assign io_out[15:7] = 9'd0;
+    assign io_out[7]  = 1'b0;           // Boot strap is input
+    assign io_out[10:8] = cs_n4[3:1];
+    assign io_out[15:11] = 5'd0;
 
     // Output enable (active low): 0=output, 1=input
     assign io_oeb[0]  = 1'b1;   // MISO = input
@@ -131,7 +223,9 @@ module senseedge_top (
     assign io_oeb[4]  = 1'b0;   // Status LED = output
     assign io_oeb[5]  = 1'b0;   // UART TX = output
     assign io_oeb[6]  = 1'b1;   // UART RX = input
-    assign io_oeb[15:7] = 9'h1FF; // Unused = inputs
+    assign io_oeb[7]  = 1'b1;   // Boot strap = input
+    assign io_oeb[10:8] = cs_n_oe[3:1]; // SPI CS of channels 1-3 = outputs
+    assign io_oeb[15:11] = 5'h1F; // Unused = inputs
 
     // =========================================================================
     // Logic Analyzer connections (debug visibility)
@@ -147,116 +241,463 @@ module senseedge_top (
     assign la_data_out[21:16] = sample_count;
     assign la_data_out[22]    = samples_valid;
     assign la_data_out[23]    = enable;
-    assign la_data_out[127:24] = 104'd0;
+    assign la_data_out[30:24] = sample_frame_base[6:0];
+    assign la_data_out[31]    = overrun;
+    // Performance counters (perf_counters.v): [47:32] frames classified,
+    // last-frame cycles [63:48] FFT, [79:64] NN, [95:80] end-to-end
+    // latency, [111:96] SPI window interval; [119:112] dropped and
+    // [127:120] overrun windows (16-bit views saturate)
+    assign la_data_out[127:32] = la_perf;
 
     // =========================================================================
     // Pipeline Control FSM
     // =========================================================================
     // Autonomous pipeline: SPI collects → FFT runs → features extract → NN infers
-    reg fft_start_reg;
-    reg fe_start_reg;
+    //
+    // Feature extraction consumes the FFT magnitude stream, so FFT and
+    // feature extraction form one stage started together; the spectrum
+    // buffer is only read back over Wishbone. That stage transforms frame
+    // N+1 while the NN classifies frame N. The feature memory is
+    // double-buffered: feature extraction writes the bank it does not
+    // publish and flips it on done.
+    //
+    // Between stages a *_valid flag marks a finished, not yet consumed
+    // result, and a *_ready term says the next stage may take it. A stage
+    // may start a new frame when:
+    //   - it is idle (no start pulse in flight, busy low),
+    //   - its input is valid, and
+    //   - the output bank it is about to write is neither holding an
+    //     unconsumed result nor being read by the downstream stage.
+    // A stage that cannot start keeps its input valid (back-pressure); only
+    // the sample front end loses frames, as FRAME_CFG.OVR selects: the
+    // newest window replaces an unconsumed one (drop oldest), new windows
+    // are discarded while one waits (drop newest), or sampling stalls
+    // until the FFT takes the waiting window (stall). Every lost window
+    // and every stall raises the overrun event. Sustained frame rate is
+    // set by the slowest stage.
+    //
+    // With AVG_CFG set, every FFT frame updates the averaged spectrum but
+    // only every (n + 1)-th one starts feature extraction (fe_start) and
+    // so the NN; frames in between end with the FFT.
+    //
+    // Each window gets a frame number (windows cut since reset, lost ones
+    // included) that travels with it to the result FIFO; a gap means a
+    // window was lost.
+    //
+    // A readback snapshot (SNAP_CTRL) holds the published spectrum and
+    // feature banks of one frame: the FFT + feature stage may finish one
+    // more frame into the other banks, then waits until the release.
+    //
+    // With FRAME_CFG.CH set the SPI side hands over one window per set of
+    // channels; the FFT then takes it once per channel, 0 first, and the
+    // window stays valid until the last one has fired. Each channel runs
+    // through the stages as a frame of its own, tagged with its channel
+    // next to the frame number (shared by the set). Spectral averaging,
+    // the change gate and the alarm fault count keep their state per
+    // channel.
+    //
+    // The NN bank of a vector is picked as it goes to the NN: the active
+    // bank, or with MODEL_CFG.PER_CH the one mapped to its channel. With
+    // MODEL_CFG.ALL the vector stays valid while banks 0 .. LAST classify
+    // it in turn, each run a result of its own tagged with its bank (the
+    // change gate is held off and the alarm counts faults per bank). The
+    // feature stage waits meanwhile, so more models cost frame rate, not
+    // frames.
+    reg fft_start_reg;      // Starts the FFT (and feature extraction, fe_start)
     reg nn_start_reg;
+    reg nn_skip_reg;        // Result reused by the change gate, NN left idle
+    reg res_reused;         // The result being reported was reused
+
+    reg sample_valid_q;     // Sample window handed over, FFT not started yet
+                            // on all its channels
+    reg [1:0] fire_ch;      // Next channel of that window to fire
+    reg [1:0] load_ch;      // Channel being loaded into the FFT
+    reg feat_valid;         // Features in fe_feat_bank not yet taken by NN
+    reg nn_feat_bank;       // Feature bank the NN is reading
+
+    reg [15:0] win_seq;     // Windows cut by the SPI side, lost ones included
+    reg [15:0] pend_frame;  // Frame number of the window in sample_valid_q
+    reg [15:0] fft_frame;   // Frame number in the FFT + feature stage
+    reg [15:0] feat_frame;  // Frame number of the published features
+    reg [15:0] mag_frame;   // Frame number of the published spectrum
+    reg [1:0]  fft_ch;      // Channels of the same
+    reg [1:0]  feat_ch;
+    reg [1:0]  mag_ch;
+
+    reg        snap_held;   // Snapshot banks pinned for Wishbone readback
+    reg        snap_mag_bank;
+    reg        snap_feat_bank;
+    reg [1:0]  snap_size;
+    reg [15:0] snap_frame;
+    reg [1:0]  snap_ch;
+    reg [15:0] nn_frame;    // Frame number being / last classified
+    reg [1:0]  nn_ch;       // and its channel
+    reg [1:0]  nn_model;    // and NN bank
+    reg [1:0]  alarm_src;   // Fault counter of the result (channel, or bank with ALL)
+    reg [1:0]  all_idx;     // MODEL_CFG.ALL: next bank to run on the vector
+
+    wire nn_active = nn_busy | nn_start_reg;
+
+    // FE writes ~fe_feat_bank at the end of the FFT frame; the NN only
+    // ever reads a published bank
+    wire fft_ready = !fft_busy && !fe_busy && !fft_start_reg && !feat_valid &&
+                     !(nn_active && nn_feat_bank == ~fe_feat_bank) &&
+                     !(snap_held && (snap_mag_bank == ~fft_mag_bank ||
+                                     snap_feat_bank == ~fe_feat_bank));
+    // Weight writes go to the shadow bank, so they never hold the NN off.
+    // Not on the done clock either: the result FIFO takes nn_ch / nn_model
+    // the clock after, and with MODEL_CFG.ALL the next bank's run waits
+    wire nn_ready  = !nn_busy && !nn_start_reg && !nn_done;
+
+    // Not on a hand-over clock: frame_base has already moved to the new
+    // window, which replaces the waiting one
+    wire fft_fire = sample_valid_q && fft_ready && !samples_valid;
+    // Bank for the waiting vector (banks past NN_MODELS - 1 fold onto the
+    // built ones)
+    localparam [1:0] BANK_MASK = NN_MODELS - 1;
+    wire [1:0]  all_last  = model_last & BANK_MASK;
+    wire [1:0]  run_model = (model_all    ? all_idx :
+                             model_per_ch ? model_map[2*feat_ch +: 2] : nn_bank) & BANK_MASK;
+    wire        all_more  = model_all && all_idx != all_last;
+
+    wire gate_use = gate_skip && !model_all;
+    wire nn_take  = feat_valid && nn_ready;
+    wire nn_fire  = nn_take && !gate_use;
+    wire nn_skip  = nn_take && gate_use;
+
+    // A classification is finished: the NN is done, or the change gate
+    // answered with the held result (class_id / confidence / scores stay
+    // on the NN outputs until its next run)
+    wire res_done = nn_done | nn_skip_reg;
+
+    // A new window over an unconsumed one replaces it (lost), as does a
+    // window the SPI side discards; one handed over while the FFT runs
+    // has to wait (overrun count of the perf counters)
+    wire win_replaced = samples_valid && sample_valid_q;
+    wire win_lost     = win_replaced | adc_drop;
+    wire win_overrun  = samples_valid && fft_busy;
+    assign overrun    = win_lost | adc_stall;
+
+    wire [15:0] win_num = win_seq + 16'd1;     // Number of a window cut now
+    wire [1:0]  ch_last = (n_ch > N_CH - 1) ? N_CH - 1 : n_ch;
 
     always @(posedge clk) begin
         if (rst) begin
-            fft_start_reg <= 1'b0;
-            fe_start_reg  <= 1'b0;
-            nn_start_reg  <= 1'b0;
+            fft_start_reg  <= 1'b0;
+            nn_start_reg   <= 1'b0;
+            nn_skip_reg    <= 1'b0;
+            res_reused     <= 1'b0;
+            sample_valid_q <= 1'b0;
+            fire_ch        <= 2'd0;
+            load_ch        <= 2'd0;
+            feat_valid     <= 1'b0;
+            nn_feat_bank   <= 1'b0;
+            win_seq        <= 16'd0;
+            pend_frame     <= 16'd0;
+            fft_frame      <= 16'd0;
+            feat_frame     <= 16'd0;
+            mag_frame      <= 16'd0;
+            fft_ch         <= 2'd0;
+            feat_ch        <= 2'd0;
+            mag_ch         <= 2'd0;
+            nn_frame       <= 16'd0;
+            nn_ch          <= 2'd0;
+            nn_model       <= 2'd0;
+            alarm_src      <= 2'd0;
+            all_idx        <= 2'd0;
+            snap_held      <= 1'b0;
         end else begin
             // Default: single-cycle pulses
             fft_start_reg <= 1'b0;
-            fe_start_reg  <= 1'b0;
             nn_start_reg  <= 1'b0;
-
-            // Stage transitions
-            if (samples_valid && enable)
+            nn_skip_reg   <= 1'b0;
+
+            // --- SPI → FFT + Feature Extraction ---
+            // The SPI side holds new windows back from the start decision
+            // until the load pass is done (sample_bank_lock), so the FFT
+            // loads the window it fired on.
+            if (fft_fire) begin
+                load_ch <= fire_ch;
+                if (fire_ch == ch_last) begin
+                    sample_valid_q <= 1'b0;
+                    fire_ch        <= 2'd0;
+                end else begin
+                    fire_ch        <= fire_ch + 2'd1;
+                end
+            end
+            if (samples_valid) begin
+                sample_valid_q <= 1'b1;
+                fire_ch        <= 2'd0;
+            end
+            if (!enable) begin
+                sample_valid_q <= 1'b0;
+                fire_ch        <= 2'd0;
+            end
+            if (fft_fire)
                 fft_start_reg <= 1'b1;
-            if (fft_done)
-                fe_start_reg <= 1'b1;
-            if (fe_done)
+            // A window discarded on a hand-over clock is the newer one
+            if (samples_valid || adc_drop)
+                win_seq <= win_seq + samples_valid + adc_drop;
+            if (samples_valid)
+                pend_frame <= win_num;
+            if (fft_start_reg) begin
+                fft_frame <= pend_frame;
+                fft_ch    <= load_ch;
+            end
+
+            if (fft_done) begin
+                mag_frame <= fft_frame;
+                mag_ch    <= fft_ch;
+            end
+
+            // --- Feature Extraction → NN ---
+            // A vector the change gate skips is taken without an NN run;
+            // with MODEL_CFG.ALL one stays until its last bank has started
+            if (fe_done) begin
+                feat_valid <= 1'b1;
+                feat_frame <= fft_frame;
+                feat_ch    <= fft_ch;
+            end
+            if (nn_fire) begin
+                feat_valid   <= all_more;
+                all_idx      <= all_more ? all_idx + 2'd1 : 2'd0;
+                nn_frame     <= feat_frame;
+                nn_ch        <= feat_ch;
+                nn_model     <= run_model;
+                alarm_src    <= model_all ? run_model : feat_ch;
+                nn_feat_bank <= fe_feat_bank;
                 nn_start_reg <= 1'b1;
+                res_reused   <= 1'b0;
+            end
+            if (nn_skip) begin
+                feat_valid   <= 1'b0;
+                all_idx      <= 2'd0;
+                nn_frame     <= feat_frame;
+                nn_ch        <= feat_ch;
+                nn_model     <= run_model;
+                alarm_src    <= feat_ch;
+                nn_skip_reg  <= 1'b1;
+                res_reused   <= 1'b1;
+            end
+
+            // --- Readback snapshot ---
+            // Taken once spectrum and features are published from the
+            // same frame and channel (they flip a few clocks apart)
+            if (!snap_req) begin
+                snap_held <= 1'b0;
+            end else if (!snap_held && mag_frame == feat_frame && mag_ch == feat_ch &&
+                         !fft_done && !fe_done) begin
+                snap_held      <= 1'b1;
+                snap_mag_bank  <= fft_mag_bank;
+                snap_feat_bank <= fe_feat_bank;
+                snap_size      <= fft_mag_size;
+                snap_frame     <= feat_frame;
+                snap_ch        <= feat_ch;
+            end
         end
     end
 
+    // Sample window handshake: the FFT holds the window from the start
+    // decision until its load pass has copied the frame, then the SPI side
+    // may move on
+    assign sample_bank_lock = fft_fire | fft_start_reg | fft_loading;
+
+    // Feature extraction runs on the frames spec_avg passes on
+    assign fe_start = fft_start_reg && avg_publish;
+
     // =========================================================================
-    // FFT magnitude read mux (WB readback vs Feature Extraction)
+    // FFT magnitude readback (WB) and feature read mux
     // =========================================================================
-    // Feature extraction has priority when busy, otherwise WB can read
-    wire [4:0] fft_mag_addr_mux = fe_busy ? fft_mag_addr : wb_fft_rd_addr;
-    assign wb_fft_rd_data = fft_mag_data;  // Both read same data
+    // WB reads the snapshot, or else the latest published spectrum
+    wire wb_mag_bank  = snap_held ? snap_mag_bank  : fft_mag_bank;
+    wire wb_feat_bank = snap_held ? snap_feat_bank : fe_feat_bank;
+
+    wire [LOG2_NMAX-1:0] fft_mag_addr_wb = {wb_mag_bank, wb_fft_rd_addr[LOG2_NMAX-2:0]};
+    assign wb_fft_rd_data = fft_mag_data;
 
-    // Feature read mux (NN vs WB)
-    wire [2:0] feature_addr_mux = nn_busy ? feature_addr_from_nn : wb_feature_rd_addr;
+    // Feature read mux (NN vs WB); the packed snapshot words have their
+    // own port
+    wire [4:0] feature_addr_mux = nn_busy ? {nn_feat_bank, feature_addr_from_nn[3:0]}
+                                          : {wb_feat_bank, wb_feature_rd_addr};
     assign wb_feature_rd_data = feature_data;
 
+    // NN inputs past the 12 extracted features (8 spectral, 4 time-domain)
+    // read as 0
+    assign nn_feature_in = !feature_addr_from_nn[4] ? feature_data : 8'd0;
+
     // =========================================================================
     // Module Instantiations
     // =========================================================================
 
     // --- SPI ADC Interface ---
-    spi_adc_if u_spi_adc (
+    spi_adc_if #(
+        .LOG2_NMAX    (LOG2_NMAX),
+        .USE_SRAM     (USE_SRAM),
+        .N_CH         (N_CH)
+    ) u_spi_adc (
         .clk          (clk),
         .rst          (rst),
         .enable       (enable),
         .clk_div      (clk_div),
+        .sample_period(sample_period),
+        .hop_size     (hop_size),
+        .fft_size     (fft_size),
+        .ovr_mode     (ovr_mode),
+        .n_ch         (n_ch),
+        .inject       (inject),
+        .inj_valid    (inj_valid),
+        .inj_data     (inj_data),
+        .inj_ready    (inj_ready),
+        .sw_trig      (sw_trig),
         .spi_clk      (spi_clk_out),
         .spi_cs_n     (spi_cs_n_out),
         .spi_miso     (spi_miso_in),
         .samples_valid(samples_valid),
         .sample_out   (sample_data),
         .sample_addr  (sample_addr_from_fft),
+        .sample_ch    (load_ch),
+        .frame_base   (sample_frame_base),
+        .frame_size   (sample_frame_size),
+        .bank_lock    (sample_bank_lock),
+        .win_busy     (sample_valid_q),
+        .win_drop     (adc_drop),
+        .win_stall    (adc_stall),
         .sample_count (sample_count)
     );
 
-    // --- 64-Point FFT Engine ---
-    fft_engine u_fft (
+    // --- 64/128/256-Point FFT Engine ---
+    // Each frame is transformed at the length its window was cut with
+    fft_engine #(
+        .FFT_ARCH   (FFT_ARCH),
+        .REAL_FFT   (REAL_FFT),
+        .LOG2_NMAX  (LOG2_NMAX),
+        .USE_SRAM   (USE_SRAM),
+        .WINDOW     (WINDOW)
+    ) u_fft (
         .clk        (clk),
         .rst        (rst),
         .start      (fft_start_reg),
+        .fft_size   (sample_frame_size),
         .sample_in  (sample_data),
         .sample_addr(sample_addr_from_fft),
         .done       (fft_done),
         .mag_out    (fft_mag_data),
-        .mag_addr   (fft_mag_addr_mux),
-        .busy       (fft_busy)
+        .bin_valid  (fft_bin_valid),
+        .bin_idx    (fft_bin_idx),
+        .bin_mag    (fft_bin_mag),
+        .mag_addr   (fft_mag_addr_wb),
+        .mag_bank   (fft_mag_bank),
+        .mag_size   (fft_mag_size),
+        .busy       (fft_busy),
+        .loading    (fft_loading),
+        .load_valid (fft_load_valid)
+    );
+
+    // --- Spectral Averaging ---
+    spec_avg #(
+        .LOG2_NMAX   (LOG2_NMAX),
+        .USE_SRAM    (USE_SRAM),
+        .N_CH        (N_CH)
+    ) u_avg (
+        .clk         (clk),
+        .rst         (rst),
+        .enable      (enable),
+        .avg_shift   (avg_shift),
+        .avg_every   (avg_every),
+        .start       (fft_start_reg),
+        .fft_size    (sample_frame_size),
+        .ch          (load_ch),
+        .publish     (avg_publish),
+        .in_valid    (fft_bin_valid),
+        .in_idx      (fft_bin_idx),
+        .in_mag      (fft_bin_mag),
+        .out_valid   (avg_bin_valid),
+        .out_idx     (avg_bin_idx),
+        .out_mag     (avg_bin_mag)
     );
 
     // --- Feature Extraction ---
-    feature_extract u_feature (
+    // Started with the FFT on published frames and fed by its load pass
+    // (time-domain features) and the averaged magnitude stream
+    feature_extract #(
+        .LOG2_NMAX   (LOG2_NMAX)
+    ) u_feature (
         .clk         (clk),
         .rst         (rst),
-        .start       (fe_start_reg),
-        .mag_addr    (fft_mag_addr),
-        .mag_in      (fft_mag_data),
+        .start       (fe_start),
+        .fft_size    (sample_frame_size),
+        .bin_valid   (avg_bin_valid),
+        .bin_idx     (avg_bin_idx),
+        .bin_mag     (avg_bin_mag),
+        .smp_valid   (fft_load_valid),
+        .smp_data    (sample_data),
         .done        (fe_done),
         .feature_out (feature_data),
         .feature_addr(feature_addr_mux),
+        .feat_bank   (fe_feat_bank),
+        .vec_bank    (wb_feat_bank),
+        .feature_vec (snap_feat),
+        .last_vec    (fe_last_vec),
         .busy        (fe_busy)
     );
 
+    // --- Change-Gated Inference ---
+    // Decides for the published vector whether the NN has to run on it;
+    // held in reset with MODEL_CFG.ALL, whose runs leave another bank's
+    // result on the NN outputs
+    nn_gate u_gate (
+        .clk         (clk),
+        .rst         (rst),
+        .enable      (enable && !model_all),
+        .threshold   (gate_thr),
+        .max_skip    (gate_max),
+        .model_bank  (run_model),
+        .channel     (feat_ch),
+        .vec         (fe_last_vec),
+        .take        (nn_take),
+        .skip        (gate_skip),
+        .distance    ()
+    );
+
     // --- Neural Network Inference Engine ---
-    nn_engine u_nn (
+    nn_engine #(
+        .USE_SRAM    (USE_SRAM),
+        .LANES       (NN_LANES),
+        .BOOT_ROM    (NN_BOOT),
+        .N_BANKS     (NN_MODELS)
+    ) u_nn (
         .clk         (clk),
         .rst         (rst),
         .start       (nn_start_reg),
-        .feature_in  (feature_data),
+        .feature_in  (nn_feature_in),
         .feature_addr(feature_addr_from_nn),
         .done        (nn_done),
         .class_id    (class_id),
         .confidence  (confidence),
+        .top_score   (nn_top_score),
+        .second_id   (nn_second_id),
+        .second_score(nn_second_score),
         .busy        (nn_busy),
+        .bank        (nn_model),
+        .n_layers    (nn_layers),
+        .desc        (nn_desc),
+        .wt_int4     (nn_int4),
         .wt_wr_en    (wt_wr_en),
+        .wt_wr_bank  (wt_wr_bank),
         .wt_wr_addr  (wt_wr_addr),
+        .wt_wr_sel   (wt_wr_sel),
         .wt_wr_data  (wt_wr_data)
     );
 
     // --- Alarm Logic ---
-    alarm_logic u_alarm (
+    // Fault counters per channel, or per bank with MODEL_CFG.ALL
+    alarm_logic #(.N_CH((N_CH > NN_MODELS) ? N_CH : NN_MODELS)) u_alarm (
         .clk                (clk),
         .rst                (rst),
-        .classification_done(nn_done),
+        .classification_done(res_done),
         .class_id           (class_id),
         .confidence         (confidence),
+        .channel            (alarm_src),
         .alarm_threshold    (alarm_threshold),
         .fault_count_cfg    (fault_count_cfg),
         .alarm_active       (alarm_active),
@@ -265,7 +706,7 @@ module senseedge_top (
     );
 
     // --- Wishbone Interface ---
-    wb_interface u_wb (
+    wb_interface #(.NN_MODELS(NN_MODELS)) u_wb (
         .clk              (clk),
         .rst              (rst),
         .wb_cyc_i         (wbs_cyc_i),
@@ -276,12 +717,42 @@ module senseedge_top (
         .wb_dat_i         (wbs_dat_i),
         .wb_ack_o         (wbs_ack_o),
         .wb_dat_o         (wbs_dat_o),
+        .boot_run         (io_in[7]),
         .enable           (enable),
         .clk_div          (clk_div),
+        .sample_period    (sample_period),
+        .inject           (inject),
+        .hop_size         (hop_size),
+        .ovr_mode         (ovr_mode),
+        .fft_size         (fft_size),
+        .n_ch             (n_ch),
+        .avg_shift        (avg_shift),
+        .avg_every        (avg_every),
+        .gate_thr         (gate_thr),
+        .gate_max         (gate_max),
         .alarm_threshold  (alarm_threshold),
         .fault_count_cfg  (fault_count_cfg),
+        .nn_int4          (nn_int4),
+        .nn_layers        (nn_layers),
+        .nn_desc          (nn_desc),
+        .nn_bank          (nn_bank),
+        .model_per_ch     (model_per_ch),
+        .model_map        (model_map),
+        .model_all        (model_all),
+        .model_last       (model_last),
+        .inj_valid        (inj_valid),
+        .inj_data         (inj_data),
+        .inj_ready        (inj_ready),
+        .sw_trig          (sw_trig),
         .class_id         (class_id),
         .confidence       (confidence),
+        .frame_id         (nn_frame),
+        .top_score        (nn_top_score),
+        .second_id        (nn_second_id),
+        .second_score     (nn_second_score),
+        .result_reused    (res_reused),
+        .result_ch        (nn_ch),
+        .result_model     (nn_model),
         .fft_busy         (fft_busy),
         .nn_busy          (nn_busy),
         .fe_busy          (fe_busy),
@@ -290,14 +761,65 @@ module senseedge_top (
         .fft_rd_data      (wb_fft_rd_data),
         .feature_rd_addr  (wb_feature_rd_addr),
         .feature_rd_data  (wb_feature_rd_data),
+        .snap_req         (snap_req),
+        .snap_held        (snap_held),
+        .snap_frame       (snap_frame),
+        .snap_size        (snap_size),
+        .snap_ch          (snap_ch),
+        .snap_feat        (snap_feat),
         .wt_wr_en         (wt_wr_en),
+        .wt_wr_bank       (wt_wr_bank),
         .wt_wr_addr       (wt_wr_addr),
+        .wt_wr_sel        (wt_wr_sel),
         .wt_wr_data       (wt_wr_data),
-        .classification_done(nn_done),
+        .perf_rd          (perf_rd),
+        .perf_addr        (perf_addr),
+        .perf_data        (perf_data),
+        .uart_div         (uart_div),
+        .uart_wr_en       (uart_wr_en),
+        .uart_wr_data     (uart_wr_data),
+        .uart_level       (uart_level),
+        .uart_busy        (uart_busy),
+        .classification_done(res_done),
         .alarm_irq_in     (alarm_irq),
+        .overrun_in       (overrun),
         .irq              (irq)
     );
 
+    // --- Performance Counters ---
+    perf_counters #(.CW(24)) u_perf (
+        .clk        (clk),
+        .rst        (rst),
+        .enable     (enable),
+        .win_valid  (samples_valid),
+        .win_drop   (win_lost),
+        .win_overrun(win_overrun),
+        .win_stall  (adc_stall),
+        .smp_reject (inj_valid && !inj_ready),
+        .fft_start  (fft_start_reg),
+        .fft_done   (fft_done),
+        .fe_done    (fe_done),
+        .nn_start   (nn_start_reg),
+        .nn_done    (nn_done),
+        .nn_skip    (nn_skip_reg),
+        .rd_en      (perf_rd),
+        .rd_addr    (perf_addr),
+        .rd_data    (perf_data),
+        .la_perf    (la_perf)
+    );
+
+    // --- UART Transmitter ---
+    uart_tx #(.AW(4)) u_uart (
+        .clk     (clk),
+        .rst     (rst),
+        .clk_div (uart_div),
+        .wr_en   (uart_wr_en),
+        .wr_data (uart_wr_data),
+        .level   (uart_level),
+        .busy    (uart_busy),
+        .tx      (uart_txd)
+    );
+
 endmodule
 
 `default_nettype wire
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - Spectral Averaging
+// Sits on the FFT magnitude stream in front of feature extraction and
+// replaces every bin by an exponential average over frames:
+//   avg[k] += (mag[k] - avg[k]) / 2^avg_shift
+// kept with 8 fraction bits in a one-spectrum memory (read one clock ahead
+// of the write, so the stream passes with one clock of delay). avg_shift
+// 0 passes the spectrum through unchanged. The first frame after enable,
+// after averaging is switched on or after an FFT length change starts the
+// average from its own spectrum.
+// Only every (avg_every + 1)-th frame is streamed on (publish, sampled with
+// the FFT start): feature extraction and the NN then run once per that
+// many windows, on the averaged spectrum. The average itself is updated on
+// every frame.
+// With N_CH > 1 every channel has its own average and its own interval
+// count; ch tags the frame started with start.
+
+`default_nettype none
+
+module spec_avg #(
+    parameter LOG2_NMAX = 6,        // Largest FFT length: 6/7/8 = 64/128/256
+    parameter USE_SRAM  = 0,        // 1: average memory in an SRAM macro
+    parameter N_CH      = 1         // ADC channels (1-4), one average each
+)(
+    input  wire        clk,
+    input  wire        rst,
+    input  wire        enable,          // Pipeline enabled (clears the average when low)
+
+    // Configuration (wb_interface AVG_CFG)
+    input  wire [2:0]  avg_shift,       // 0: off, s: weight 1/2^s for the new frame
+    input  wire [3:0]  avg_every,       // Publish every avg_every + 1 frames
+
+    // Frame control
+    input  wire        start,           // FFT start: latch the length
+    input  wire [1:0]  fft_size,        // Length: 0 = 64, 1 = 128, 2 = 256
+    input  wire [1:0]  ch,              // Channel of the frame (N_CH > 1)
+    output wire        publish,         // A frame started now is streamed on
+
+    // Magnitude stream in (FFT)
+    input  wire        in_valid,
+    input  wire [LOG2_NMAX-2:0] in_idx,
+    input  wire [15:0] in_mag,
+
+    // Averaged stream out (feature extraction), one clock behind
+    output wire        out_valid,
+    output reg  [LOG2_NMAX-2:0] out_idx,
+    output wire [15:0] out_mag
+);
+
+    localparam BW = LOG2_NMAX - 1;      // Bin index width
+    localparam FB = 8;                  // Fraction bits of the average
+    localparam [1:0] SIZE_MAX = LOG2_NMAX - 6;
+    localparam CHW = (N_CH > 2) ? 2 : (N_CH > 1) ? 1 : 0;
+    localparam AW  = BW + CHW;          // Average memory address width
+
+    // Per channel
+    reg [3:0]  frame_cnt [0:N_CH-1];    // Frames since the last published one
+    reg        primed    [0:N_CH-1];    // The memory holds an average of length size_q
+    reg [1:0]  size_q    [0:N_CH-1];
+
+    // Frame in progress
+    reg        pub_q;           // Published
+    reg        fill;            // Restarts the average
+    reg [1:0]  size_cur;
+    reg [1:0]  ch_q;
+
+    reg        v_q;             // Bin out_idx is in mag_q
+    reg [15:0] mag_q;
+
+    wire [1:0] ch_in = (ch > N_CH - 1) ? N_CH - 1 : ch;
+
+    assign publish = (frame_cnt[ch_in] >= avg_every);
+
+    wire [1:0]    size_in   = (fft_size > SIZE_MAX) ? SIZE_MAX : fft_size;
+    wire [BW-1:0] bins_last = {BW{1'b1}} >> (SIZE_MAX - size_cur);
+
+    // --- Average update ---
+    // acc_rd was read on the clock bin out_idx came in
+    wire [15+FB:0] acc_rd;
+    wire signed [16+FB:0] acc_diff = {1'b0, mag_q, {FB{1'b0}}} - {1'b0, acc_rd};
+    wire signed [16+FB:0] acc_step = acc_diff >>> avg_shift;
+    wire [15+FB:0] acc_nx = fill ? {mag_q, {FB{1'b0}}} : acc_rd + acc_step[15+FB:0];
+
+    assign out_valid = v_q && pub_q;
+    assign out_mag   = acc_nx[15+FB:FB];
+
+    // --- Average memory ---
+    // Port B reads bin in_idx while port A writes bin out_idx back; channel
+    // c has entries c * 2^BW on
+    wire [AW-1:0] avg_wr = (ch_q << BW) | out_idx;
+    wire [AW-1:0] avg_rd = (ch_q << BW) | in_idx;
+
+    sram_1rw1r #(
+        .DW         (16 + FB),
+        .AW         (AW),
+        .USE_MACRO  (USE_SRAM)
+    ) u_avg_buf (
+        .clk        (clk),
+        .a_en       (v_q),
+        .a_we       (v_q),
+        .a_wmask    (3'b111),
+        .a_addr     (avg_wr),
+        .a_din      (acc_nx),
+        .a_dout     (),
+        .b_en       (in_valid),
+        .b_addr     (avg_rd),
+        .b_dout     (acc_rd)
+    );
+
+    always @(posedge clk) begin : ctl
+        integer c;
+        if (rst) begin
+            for (c = 0; c < N_CH; c = c + 1) begin
+                frame_cnt[c] <= 4'd0;
+                primed[c]    <= 1'b0;
+                size_q[c]    <= 2'd0;
+            end
+            pub_q     <= 1'b0;
+            fill      <= 1'b1;
+            size_cur  <= 2'd0;
+            ch_q      <= 2'd0;
+            v_q       <= 1'b0;
+            mag_q     <= 16'd0;
+            out_idx   <= {BW{1'b0}};
+        end else begin
+            v_q     <= in_valid;
+            mag_q   <= in_mag;
+            out_idx <= in_idx;
+
+            if (start) begin
+                pub_q         <= publish;
+                ch_q          <= ch_in;
+                size_cur      <= size_in;
+                size_q[ch_in] <= size_in;
+                fill          <= !primed[ch_in] || size_in != size_q[ch_in] ||
+                                 avg_shift == 3'd0;
+            end
+
+            // End of a frame's spectrum
+            if (v_q && out_idx == bins_last) begin
+                primed[ch_q]    <= 1'b1;
+                frame_cnt[ch_q] <= pub_q ? 4'd0 :
+                                   (frame_cnt[ch_q] == 4'hF) ? 4'hF : frame_cnt[ch_q] + 4'd1;
+            end
+
+            for (c = 0; c < N_CH; c = c + 1) begin
+                if (!enable) begin
+                    primed[c]    <= 1'b0;
+                    frame_cnt[c] <= 4'd0;
+                end
+                if (avg_shift == 3'd0)
+                    primed[c] <= 1'b0;
+            end
+        end
+    end
+
+endmodule
+
+`default_nettype wire
@@ -1,35 +1,113 @@
 // SPDX-License-Identifier: Apache-2.0
 // SenseEdge - SPI ADC Interface
 // Configurable SPI master for external ADC (e.g., MCP3201, ADS7042)
-// Collects 64 samples into a circular buffer, triggers FFT on completion
+// Collects samples into a 2*NMAX-entry ring (two NMAX-sample banks): the SPI
+// side keeps writing while the FFT reads the latest N-sample window, so
+// acquisition never stalls. A new window is handed over every hop_size
+// samples, giving overlapped frames when hop_size < N. The window length N
+// (64/128/256) is selected at run time by fft_size.
+// The ring is a synchronous-read memory (flops, or an SRAM macro with
+// USE_SRAM): sample_out is valid the clock after sample_addr, and is only
+// read while the consumer holds bank_lock.
+// A window that comes due while the consumer is loading the previous one
+// waits for bank_lock to drop. ovr_mode sets what happens when windows
+// come faster than the consumer takes them (win_busy: one handed over and
+// not yet taken):
+//   0 drop oldest: hand the newest over, it replaces the waiting one
+//   1 drop newest: keep the waiting window, discard new ones until it is
+//     taken or the writer would overwrite it
+//   2 stall: stop sampling until the consumer takes the waiting window
+//     (win_stall); nothing is lost, but the sample clock has a gap
+//   3 as 0
+// win_drop flags a window lost before it was handed over (a replaced due
+// window, or a discarded new one).
+// With N_CH > 1 up to N_CH ADCs share SPI clock and MISO, each on its own
+// chip select. The n_ch + 1 active channels are converted round robin, one
+// set of one sample per channel per sample period, into one ring per
+// channel; a window is handed over for the whole set and the consumer reads
+// channel sample_ch of it. Each channel is sampled at 1 / (n_ch + 1) of the
+// conversion rate.
+// clk_div sets the SPI bit clock. With sample_period 0 conversions follow
+// each other as fast as that bit clock allows (free running, a sample
+// every 35 bit-clock ticks or so). A non-zero sample_period starts a set
+// every sample_period clocks instead: the timer restarts the bit clock
+// divider, so chip select falls a fixed two clocks after the tick, and the
+// channels of the set are converted back to back. The period has to cover
+// the set (n_ch + 1 transfers of 34 * (clk_div + 1) clocks); a tick that
+// finds the previous one still waiting counts as a stall (win_stall).
+// With inject set the SPI master stays idle and the samples come from the
+// bus instead (inj_valid / inj_data, a 12-bit ADC code each, channels in
+// round robin order like the conversions): they go through the same ring,
+// hop and overrun logic, so a recorded signal can be replayed through the
+// pipeline. inj_ready says a sample would be taken now (low while a stall
+// holds sampling). sw_trig hands the newest N samples over at once,
+// whatever the hop count, if a full window has been stored and a sample
+// came in since the last handover. Switching inject restarts the window
+// fill, so a window never mixes ADC and bus samples.
 
 `default_nettype none
 
-module spi_adc_if (
+module spi_adc_if #(
+    parameter LOG2_NMAX = 6,        // Largest window: 6/7/8 = 64/128/256 samples
+    parameter USE_SRAM  = 0,        // 1: sample ring in an SRAM macro
+    parameter N_CH      = 1         // ADC channels (1-4), one chip select each
+)(
     input  wire        clk,
     input  wire        rst,
 
     // Control
     input  wire        enable,
-    input  wire [15:0] clk_div,       // SPI clock divider (sample rate control)
+    input  wire [15:0] clk_div,       // SPI bit clock divider: SCLK = clk / (2 * (clk_div + 1))
+    input  wire [23:0] sample_period, // Clocks per sample set, 0 = free running
+    input  wire [8:0]  hop_size,      // New samples per frame (1-N, 0 = N)
+    input  wire [1:0]  fft_size,      // Window length: 0 = 64, 1 = 128, 2 = 256
+    input  wire [1:0]  ovr_mode,      // Overrun policy: 0 drop oldest, 1 drop newest, 2 stall
+    input  wire [1:0]  n_ch,          // Active channels - 1 (up to N_CH - 1)
+
+    // Bus sample source (wb_interface SAMPLE_IN / CTRL.TRIG)
+    input  wire        inject,        // Samples from inj_data, SPI idle
+    input  wire        inj_valid,     // inj_data is the next sample (pulse)
+    input  wire [11:0] inj_data,      // ADC code
+    output wire        inj_ready,     // A sample is taken at once
+    input  wire        sw_trig,       // Hand the newest window over now (pulse)
 
     // SPI pins
     output reg         spi_clk,
-    output reg         spi_cs_n,
+    output reg  [N_CH-1:0] spi_cs_n,  // Chip select of channel c in bit c
     input  wire        spi_miso,
 
     // Sample buffer output (to FFT)
-    output reg         samples_valid,  // Pulses when 64 samples collected
-    output wire [15:0] sample_out,     // Sample data read port
-    input  wire [5:0]  sample_addr,    // Sample address (0-63)
+    output reg         samples_valid,  // Pulses when a new N-sample window is ready
+    output wire [15:0] sample_out,     // Sample data read port (one clock latency)
+    input  wire [LOG2_NMAX-1:0] sample_addr,   // Sample address within the window (0 to N-1)
+    input  wire [1:0]  sample_ch,      // Channel read on sample_out
+
+    // Frame handshake
+    output reg  [LOG2_NMAX:0] frame_base,      // Ring index of the window's oldest sample
+    output reg  [1:0]  frame_size,     // fft_size the window was cut with
+    input  wire        bank_lock,      // Consumer is reading the window; hold it
+    input  wire        win_busy,       // A handed-over window is still waiting
+
+    // Overrun events (single-cycle pulses)
+    output reg         win_drop,       // A window was lost before handover
+    output reg         win_stall,      // A conversion was postponed (stall)
 
     // Status
     output wire [5:0]  sample_count
 );
 
     // --- Parameters ---
-    localparam SAMPLE_DEPTH = 64;
+    localparam SAMPLE_DEPTH = 1 << LOG2_NMAX;
     localparam ADC_BITS     = 12;
+    localparam RW           = LOG2_NMAX + 1;    // Ring index width
+    localparam CHW          = (N_CH > 2) ? 2 : (N_CH > 1) ? 1 : 0;
+    localparam AW           = RW + CHW;         // Ring memory address width
+    localparam [N_CH-1:0] CS_FIRST = 1;         // Chip select of channel 0
+    localparam [1:0] SIZE_MAX = LOG2_NMAX - 6;
+
+    localparam [1:0] OVR_DROP_OLDEST = 2'd0;
+    localparam [1:0] OVR_DROP_NEWEST = 2'd1;
+    localparam [1:0] OVR_STALL       = 2'd2;
 
     // --- State Machine ---
     localparam S_IDLE    = 3'd0;
@@ -43,15 +121,113 @@ module spi_adc_if (
     reg        spi_clk_en;      // SPI clock edge trigger
     reg [4:0]  bit_cnt;         // Bits shifted in (0-15)
     reg [15:0] shift_reg;       // SPI shift register
-    reg [5:0]  wr_ptr;          // Write pointer into sample buffer
-    reg [15:0] sample_buf [0:SAMPLE_DEPTH-1];
+    reg [RW-1:0] wr_ptr;        // Write pointer into the sample ring
+    reg [RW-1:0] fill_cnt;      // Samples stored since reset (saturates at NMAX)
+    reg [8:0]    hop_cnt;       // Samples stored since the last handover
+    reg [1:0]    cur_ch;        // Channel of the conversion in progress
+
+    // Window due for handover, waiting for the consumer
+    reg          due;
+    reg [RW-1:0] due_base;
+    reg [1:0]    due_size;
+    reg          stalled;       // Conversion postponed for the due window
+    reg          trig_pend;     // sw_trig waiting for a clock without a store
+    reg          inject_q;      // inject on the last clock
+
+    // Current window length
+    wire [1:0]    size_eff  = (fft_size > SIZE_MAX) ? SIZE_MAX : fft_size;
+    wire [8:0]    frame_len = 9'd64 << size_eff;
+
+    // Sliding-window read: window address is relative to frame_base and
+    // wraps around the ring. With hop_size = N = NMAX frame_base alternates
+    // between 0 and NMAX, i.e. plain ping-pong banking.
+    wire [RW-1:0] rd_ptr  = frame_base + {1'b0, sample_addr};
+    wire [8:0]    hop_eff = (hop_size == 9'd0 || hop_size > frame_len) ? frame_len : hop_size;
+
+    assign sample_count = wr_ptr[5:0];
+
+    wire [1:0] ch_last = (n_ch > N_CH - 1) ? N_CH - 1 : n_ch;
+    wire       set_end = (cur_ch >= ch_last);  // Last conversion of the set
+
+    wire keep_old = (ovr_mode == OVR_DROP_NEWEST);
+    wire stall    = (ovr_mode == OVR_STALL);
 
-    assign sample_out   = sample_buf[sample_addr];
-    assign sample_count = wr_ptr;
+    // The due window goes out once the consumer is not loading; with
+    // stall also only after the waiting one has been taken
+    wire due_go   = due && !bank_lock && !(stall && win_busy);
+    wire hold     = stall && due && !due_go;    // Stall: no new conversion
+    // Drop newest: the next write would land on the waiting window
+    wire old_lost = keep_old && win_busy && (wr_ptr + 1'b1 == frame_base);
+
+    // --- Sample source ---
+    // A sample is stored once per conversion in S_CS_HIGH, or per bus
+    // sample while the SPI master is idle (a conversion that was still
+    // running when inject was set is dropped)
+    assign inj_ready = inject && enable && (state == S_IDLE) && !hold;
+
+    wire        inj_take  = inj_valid && inj_ready;
+    wire        sample_we = (state == S_CS_HIGH && !inject) || inj_take;
+    wire [11:0] sample_in = inj_take ? inj_data : shift_reg[ADC_BITS-1:0];
+
+    // Windows handed over: the hop is reached with this sample, or sw_trig
+    // cuts the newest N samples stored so far
+    wire hop_cut  = sample_we && set_end && fill_cnt >= frame_len - 9'd1 &&
+                    (hop_cnt + 9'd1 >= hop_eff || old_lost);
+    wire trig_cut = trig_pend && enable && !sample_we && fill_cnt >= frame_len &&
+                    hop_cnt != 9'd0;
+
+    // --- Sample ring ---
+    // Written with every stored sample (sign-extend 12-bit to 16-bit
+    // signed), read by the consumer while it holds bank_lock.
+    // Channel c has ring entries c * 2^RW on.
+    wire [AW-1:0] ring_wr = (cur_ch << RW) | wr_ptr;
+    wire [AW-1:0] ring_rd = (sample_ch << RW) | rd_ptr;
+
+    sram_1rw1r #(
+        .DW         (16),
+        .AW         (AW),
+        .USE_MACRO  (USE_SRAM)
+    ) u_sample_buf (
+        .clk        (clk),
+        .a_en       (sample_we),
+        .a_we       (sample_we),
+        .a_wmask    (2'b11),
+        .a_addr     (ring_wr),
+        .a_din      ({{(16-ADC_BITS){sample_in[ADC_BITS-1]}}, sample_in}),
+        .a_dout     (),
+        .b_en       (bank_lock),
+        .b_addr     (ring_rd),
+        .b_dout     (sample_out)
+    );
+
+    // --- Sample timer ---
+    // smp_tick every sample_period clocks from enable; smp_pend holds a
+    // tick until its set starts
+    reg [23:0] smp_cnt;
+    reg        smp_pend;
+
+    wire timed    = (sample_period != 24'd0) && !inject;
+    wire smp_tick = timed && (smp_cnt == 24'd0);
+
+    // A conversion may start: the next bit clock tick, for channel 0 of a
+    // timed set the sample timer
+    wire set_start  = timed && (cur_ch == 2'd0);
+    wire start_ok   = set_start ? (smp_pend || smp_tick) : spi_clk_en;
+    wire conv_start = (state == S_IDLE) && enable && !inject && start_ok && !hold;
+
+    always @(posedge clk) begin
+        if (rst || !enable || !timed) begin
+            smp_cnt <= 24'd0;
+        end else begin
+            smp_cnt <= smp_tick ? sample_period - 24'd1 : smp_cnt - 24'd1;
+        end
+    end
 
     // --- SPI Clock Divider ---
+    // Restarted with a timed set, so its first edge is a fixed time after
+    // the tick
     always @(posedge clk) begin
-        if (rst || !enable) begin
+        if (rst || !enable || (conv_start && set_start)) begin
             clk_cnt    <= 16'd0;
             spi_clk_en <= 1'b0;
         end else begin
@@ -70,25 +246,117 @@ module spi_adc_if (
         if (rst) begin
             state         <= S_IDLE;
             spi_clk       <= 1'b0;
-            spi_cs_n      <= 1'b1;
+            spi_cs_n      <= {N_CH{1'b1}};
             bit_cnt       <= 5'd0;
             shift_reg     <= 16'd0;
-            wr_ptr        <= 6'd0;
+            wr_ptr        <= {RW{1'b0}};
+            fill_cnt      <= {RW{1'b0}};
+            hop_cnt       <= 9'd0;
+            cur_ch        <= 2'd0;
+            frame_base    <= {RW{1'b0}};
+            frame_size    <= 2'd0;
             samples_valid <= 1'b0;
+            win_drop      <= 1'b0;
+            win_stall     <= 1'b0;
+            due           <= 1'b0;
+            due_base      <= {RW{1'b0}};
+            due_size      <= 2'd0;
+            stalled       <= 1'b0;
+            trig_pend     <= 1'b0;
+            inject_q      <= 1'b0;
+            smp_pend      <= 1'b0;
         end else begin
-            samples_valid <= 1'b0;  // Default: single-cycle pulse
+            samples_valid <= 1'b0;  // Default: single-cycle pulses
+            win_drop      <= 1'b0;
+            win_stall     <= 1'b0;
+
+            // --- Window handover ---
+            // (a window due from this clock's S_CS_HIGH waits for the next)
+            if (due_go) begin
+                due           <= 1'b0;
+                frame_base    <= due_base;
+                frame_size    <= due_size;
+                samples_valid <= 1'b1;
+            end
+            if (!enable)
+                due <= 1'b0;
+
+            // One stall event per postponed conversion (free running), or
+            // per sample period lost (timed)
+            if (!due) begin
+                stalled <= 1'b0;
+            end else if (!timed && !inject && state == S_IDLE && enable && spi_clk_en && hold) begin
+                stalled   <= 1'b1;
+                win_stall <= !stalled;
+            end
+
+            if (!enable || !timed) begin
+                smp_pend <= 1'b0;
+            end else if (conv_start && set_start) begin
+                smp_pend <= smp_pend && smp_tick;
+            end else if (smp_tick) begin
+                smp_pend  <= 1'b1;
+                win_stall <= smp_pend;
+            end
+
+            // --- Sample store ---
+            // Into the ring of cur_ch at wr_ptr (u_sample_buf); the set's
+            // last one moves wr_ptr on
+            if (sample_we) begin
+                cur_ch <= set_end ? 2'd0 : cur_ch + 2'd1;
+                if (set_end) begin
+                    wr_ptr  <= wr_ptr + 1'b1;
+                    hop_cnt <= hop_cnt + 9'd1;
+                    if (fill_cnt != SAMPLE_DEPTH)
+                        fill_cnt <= fill_cnt + 1'b1;
+                end
+            end
+
+            // Window full and hop reached (or sw_trig): the newest N
+            // samples are due for the consumer, replacing a due window
+            // that has not gone out yet. Drop newest discards them instead
+            // while another window is due or waiting, unless the writer is
+            // about to overwrite that one.
+            if (hop_cut || trig_cut) begin
+                hop_cnt <= 9'd0;
+                if (keep_old && ((due && !due_go) || (win_busy && !old_lost))) begin
+                    win_drop <= 1'b1;
+                end else begin
+                    if (due && !due_go)
+                        win_drop <= 1'b1;
+                    due      <= 1'b1;
+                    // A trigger comes after the set's wr_ptr step
+                    due_base <= wr_ptr - (frame_len - (trig_cut ? 9'd0 : 9'd1));
+                    due_size <= size_eff;
+                end
+            end
+
+            if (sw_trig)
+                trig_pend <= 1'b1;
+            else if (!sample_we)
+                trig_pend <= 1'b0;
+
+            // New sample source: start filling from scratch
+            inject_q <= inject;
+            if (inject != inject_q) begin
+                fill_cnt <= {RW{1'b0}};
+                hop_cnt  <= 9'd0;
+                cur_ch   <= 2'd0;
+            end
 
             case (state)
                 S_IDLE: begin
-                    spi_cs_n <= 1'b1;
+                    spi_cs_n <= {N_CH{1'b1}};
                     spi_clk  <= 1'b0;
-                    if (enable && spi_clk_en) begin
+                    if (!enable)
+                        cur_ch <= 2'd0;     // Sets restart with channel 0
+                    if (conv_start) begin
                         state <= S_CS_LOW;
                     end
                 end
 
                 S_CS_LOW: begin
-                    spi_cs_n  <= 1'b0;
+                    spi_cs_n  <= ~(CS_FIRST << cur_ch);
                     bit_cnt   <= 5'd0;
                     shift_reg <= 16'd0;
                     if (spi_clk_en) begin
@@ -111,15 +379,11 @@ module spi_adc_if (
                 end
 
                 S_CS_HIGH: begin
-                    spi_cs_n <= 1'b1;
+                    spi_cs_n <= {N_CH{1'b1}};
                     spi_clk  <= 1'b0;
-                    // Store sample (sign-extend 12-bit to 16-bit signed)
-                    sample_buf[wr_ptr] <= {{(16-ADC_BITS){shift_reg[ADC_BITS-1]}}, shift_reg[ADC_BITS-1:0]};
-                    wr_ptr <= wr_ptr + 6'd1;
-                    if (wr_ptr == 6'd63) begin
-                        samples_valid <= 1'b1;
-                    end
-                    state <= S_WAIT;
+                    // (the sample is stored above)
+                    // Timed sets need no gap, the next start waits anyway
+                    state <= timed ? S_IDLE : S_WAIT;
                 end
 
                 S_WAIT: begin
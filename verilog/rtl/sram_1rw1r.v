@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - Synchronous-Read Memory (1 read/write + 1 read port)
+// Storage primitive for the sample ring, FFT working data, spectrum buffer
+// and NN weights. Both ports register their address: read data is valid the
+// clock after it was requested, the timing of an OpenRAM SRAM macro, so the
+// same FSMs run on flops or macros.
+// USE_MACRO = 0 builds the array from flops. USE_MACRO = 1 maps it onto
+// sky130 OpenRAM 1rw1r macros in synthesis (32 x 256 for AW <= 8, 32 x 512
+// for AW = 9); words wider than 32 bits use several macros side by side.
+// RTL simulation always uses the behavioural model.
+// Port A writes are byte-masked (a_wmask, one bit per 8 data bits; DW is a
+// multiple of 8), like the macro's wmask0.
+// A read on port A while it writes, or a port B read of the word port A is
+// writing, returns undefined data on a macro; callers never do either.
+
+`default_nettype none
+
+module sram_1rw1r #(
+    parameter DW        = 16,       // Word width
+    parameter AW        = 8,        // Address width, depth 2^AW (macro: AW <= 9)
+    parameter USE_MACRO = 0         // 1: sky130 OpenRAM macro in synthesis
+)(
+    input  wire          clk,
+
+    // Port A: read / write
+    input  wire          a_en,      // Access enable
+    input  wire          a_we,      // 1: write a_din, 0: read
+    input  wire [DW/8-1:0] a_wmask, // Byte lanes written
+    input  wire [AW-1:0] a_addr,
+    input  wire [DW-1:0] a_din,
+    output wire [DW-1:0] a_dout,    // Valid the clock after a read
+
+    // Port B: read only
+    input  wire          b_en,
+    input  wire [AW-1:0] b_addr,
+    output wire [DW-1:0] b_dout     // Valid the clock after a read
+);
+
+`ifdef SYNTHESIS
+    localparam MACRO = USE_MACRO;
+`else
+    localparam MACRO = 0;           // Behavioural model in RTL simulation
+`endif
+
+    genvar c;
+
+    generate
+        if (MACRO) begin : g_macro
+            // --- sky130 OpenRAM macros ---
+            localparam COLS = (DW + 31) / 32;
+            localparam MAW  = (AW <= 8) ? 8 : 9;
+
+            wire [MAW-1:0]       addr0 = a_addr;
+            wire [MAW-1:0]       addr1 = b_addr;
+            wire [32*COLS-1:0]   din0  = a_din;
+            wire [4*COLS-1:0]    wmask = a_wmask;
+            wire [32*COLS-1:0]   dout0;
+            wire [32*COLS-1:0]   dout1;
+
+            assign a_dout = dout0[DW-1:0];
+            assign b_dout = dout1[DW-1:0];
+
+            for (c = 0; c < COLS; c = c + 1) begin : g_col
+                if (MAW == 8) begin : g_1kb
+                    sky130_sram_1kbyte_1rw1r_32x256_8 u_sram (
+                        .clk0   (clk),
+                        .csb0   (~a_en),
+                        .web0   (~a_we),
+                        .wmask0 (wmask[4*c +: 4]),
+                        .addr0  (addr0),
+                        .din0   (din0[32*c +: 32]),
+                        .dout0  (dout0[32*c +: 32]),
+                        .clk1   (clk),
+                        .csb1   (~b_en),
+                        .addr1  (addr1),
+                        .dout1  (dout1[32*c +: 32])
+                    );
+                end else begin : g_2kb
+                    sky130_sram_2kbyte_1rw1r_32x512_8 u_sram (
+                        .clk0   (clk),
+                        .csb0   (~a_en),
+                        .web0   (~a_we),
+                        .wmask0 (wmask[4*c +: 4]),
+                        .addr0  (addr0),
+                        .din0   (din0[32*c +: 32]),
+                        .dout0  (dout0[32*c +: 32]),
+                        .clk1   (clk),
+                        .csb1   (~b_en),
+                        .addr1  (addr1),
+                        .dout1  (dout1[32*c +: 32])
+                    );
+                end
+            end
+        end else begin : g_flop
+            // --- Flop array with registered read ---
+            reg [DW-1:0] mem [0:(1<<AW)-1];
+            reg [DW-1:0] a_q;
+            reg [DW-1:0] b_q;
+
+            assign a_dout = a_q;
+            assign b_dout = b_q;
+
+            always @(posedge clk) begin : ports
+                integer i;
+                if (a_en) begin
+                    if (a_we) begin
+                        for (i = 0; i < DW / 8; i = i + 1)
+                            if (a_wmask[i])
+                                mem[a_addr][8*i +: 8] <= a_din[8*i +: 8];
+                    end else begin
+                        a_q <= mem[a_addr];
+                    end
+                end
+                if (b_en)
+                    b_q <= mem[b_addr];
+            end
+        end
+    endgenerate
+
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+// SenseEdge - UART Transmitter with Byte FIFO
+// 8N1, LSB first, one bit every clk_div + 1 clocks (25 MHz / 217 = 115200
+// baud). Bytes are queued in a 2^AW-entry FIFO and sent back to back, so
+// a writer only has to keep the FIFO from running full.
+// A write while the FIFO is full is dropped.
+
+`default_nettype none
+
+module uart_tx #(
+    parameter AW = 4                // FIFO depth 2^AW bytes
+)(
+    input  wire          clk,
+    input  wire          rst,
+
+    input  wire [15:0]   clk_div,   // Bit period - 1, in clocks
+
+    // Byte FIFO write port
+    input  wire          wr_en,
+    input  wire [7:0]    wr_data,
+    output wire [AW:0]   level,     // Bytes queued, not counting the one on the line
+    output wire          busy,      // Sending, or bytes queued
+
+    output reg           tx         // Serial output, idles high
+);
+
+    localparam DEPTH = 1 << AW;
+
+    // --- Byte FIFO ---
+    reg [7:0]  fifo [0:DEPTH-1];
+    reg [AW:0] wp;
+    reg [AW:0] rp;
+
+    assign level = wp - rp;
+
+    wire empty = (wp == rp);
+    wire full  = (level == DEPTH);
+
+    // --- Shifter ---
+    // sreg holds {stop, data, start} and shifts out LSB first
+    reg [9:0]  sreg;
+    reg [3:0]  bits_left;           // Bits still to send, 0 = idle
+    reg [15:0] baud_cnt;
+
+    wire bit_end = (baud_cnt >= clk_div);
+    wire load    = !empty && (bits_left == 4'd0 || (bits_left == 4'd1 && bit_end));
+
+    assign busy = !empty || (bits_left != 4'd0);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            wp        <= {(AW + 1){1'b0}};
+            rp        <= {(AW + 1){1'b0}};
+            sreg      <= 10'h3FF;
+            bits_left <= 4'd0;
+            baud_cnt  <= 16'd0;
+            tx        <= 1'b1;
+        end else begin
+            if (wr_en && !full) begin
+                fifo[wp[AW-1:0]] <= wr_data;
+                wp <= wp + 1'b1;
+            end
+
+            if (load) begin
+                // Next byte: start bit on the line from this clock
+                sreg      <= {1'b1, fifo[rp[AW-1:0]], 1'b0};
+                tx        <= 1'b0;
+                bits_left <= 4'd10;
+                baud_cnt  <= 16'd0;
+                rp        <= rp + 1'b1;
+            end else if (bits_left != 4'd0) begin
+                if (bit_end) begin
+                    baud_cnt  <= 16'd0;
+                    bits_left <= bits_left - 4'd1;
+                    sreg      <= {1'b1, sreg[9:1]};
+                    tx        <= (bits_left == 4'd1) ? 1'b1 : sreg[1];
+                end else begin
+                    baud_cnt <= baud_cnt + 16'd1;
+                end
+            end
+        end
+    end
+
+endmodule
+
+`default_nettype wire
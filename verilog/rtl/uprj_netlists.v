@@ -25,10 +25,15 @@
 `else
     `include "user_project_wrapper.v"
     `include "senseedge_top.v"
+    `include "sram_1rw1r.v"
     `include "spi_adc_if.v"
     `include "fft_engine.v"
+    `include "spec_avg.v"
     `include "feature_extract.v"
+    `include "nn_gate.v"
     `include "nn_engine.v"
     `include "wb_interface.v"
     `include "alarm_logic.v"
+    `include "uart_tx.v"
+    `include "perf_counters.v"
 `endif
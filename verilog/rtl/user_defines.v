@@ -56,7 +56,11 @@
 // GPIO 0-4: Fixed management (SPI flash, JTAG) - not configurable here
 // GPIO 5:   UART TX (output) - firmware reconfigures at runtime for SPI MISO etc.
 // GPIO 6:   UART RX (input)
-// GPIO 7-37: Unused by SenseEdge (default to input nopull)
+// GPIO 7:   Boot strap (input, sampled in reset; pull up on the board to
+//           start classifying on the boot model without firmware)
+// GPIO 30-32: SPI CS_N of ADC channels 1-3 when built with N_CH > 1
+//           (input until the firmware makes them outputs, ADC_CHANNELS)
+// GPIO 8-37: Otherwise unused by SenseEdge (default to input nopull)
 `define USER_CONFIG_GPIO_5_INIT  `GPIO_MODE_USER_STD_OUTPUT
 `define USER_CONFIG_GPIO_6_INIT  `GPIO_MODE_USER_STD_INPUT_NOPULL
 `define USER_CONFIG_GPIO_7_INIT  `GPIO_MODE_USER_STD_INPUT_NOPULL
@@ -1,11 +1,40 @@
 // SPDX-License-Identifier: Apache-2.0
 // SenseEdge - Wishbone Slave Interface & Control Registers
 // 32-bit Wishbone B4 compliant slave
-// Provides register access for control, status, FFT data, features, and NN weights
+// Provides register access for control, status, FFT data, features, NN weights
+// and the NN layer descriptor table
+// The NN model (weights, descriptors, layer count, INT4 layers) is banked,
+// one resident model per bank (NN_MODELS): the registers edit the shadow
+// bank while the engine runs the active one, and NN_CFG.SWAP exchanges
+// them in one write. MODEL_CFG can instead point the registers at any
+// bank, give every ADC channel its own model, or run several models back
+// to back on each feature vector; every bank has an alarm profile
+// (PROFILE) that replaces ALARM_CFG for its results once enabled.
+// All banks reset to the boot model (nn_default_model.vh), and the
+// boot_run strap sets CTRL.ENABLE in reset so it classifies straight away.
+// Every classification is also queued in a 2^RES_AW-entry result FIFO with
+// its frame number, alarm flag and top-2 scores, so results survive a busy
+// CPU; a level IRQ lets it drain a batch per wake-up.
+// A snapshot (SNAP_CTRL) pins the latest spectrum and feature vector for
+// readback, two bins per word in the 0x100 window and four features per
+// word, while the pipeline carries on in its other banks.
+// The 0x200 page reads the perf_counters block (stage cycle counts, frame,
+// drop and overrun counts).
+// UART_DATA feeds the uart_tx byte FIFO; with UART_CFG.AUTO the hardware
+// instead pops the result FIFO itself and sends each entry as a RESULT
+// frame (sync, type, length, payload, CRC8), keeping the management core
+// off the link.
+// With several ADC channels (FRAME_CFG.CH) every result carries the channel
+// it was classified on: RES_FIFO_CH after a pop, and one more payload byte
+// in the AUTO frames; with per-channel or back-to-back models
+// (MODEL_CFG) the same byte carries the model too.
 
 `default_nettype none
 
-module wb_interface (
+module wb_interface #(
+    parameter RES_AW    = 3,            // Result FIFO depth 2^RES_AW (1-4)
+    parameter NN_MODELS = 2             // NN model banks: 2 or 4
+)(
     input  wire        clk,
     input  wire        rst,
 
@@ -19,78 +48,390 @@ module wb_interface (
     output reg         wb_ack_o,
     output reg  [31:0] wb_dat_o,
 
+    // Boot strap: 1 in reset enables the pipeline
+    input  wire        boot_run,
+
     // Control outputs
     output reg         enable,
-    output reg  [15:0] clk_div,
-    output reg  [7:0]  alarm_threshold,
-    output reg  [3:0]  fault_count_cfg, // Consecutive faults before alarm
+    output reg  [15:0] clk_div,         // SPI bit clock divider
+    output reg  [23:0] sample_period,   // Clocks per ADC sample set, 0 = free running
+    output reg         inject,          // Samples from SAMPLE_IN instead of the ADC
+    output reg  [8:0]  hop_size,        // New samples per FFT frame (1-N)
+    output reg  [1:0]  ovr_mode,        // Overrun policy: 0 drop oldest, 1 drop newest, 2 stall
+    output reg  [1:0]  fft_size,        // FFT length: 0 = 64, 1 = 128, 2 = 256
+    output reg  [1:0]  n_ch,            // ADC channels sampled - 1 (spi_adc_if)
+    output reg  [2:0]  avg_shift,       // Spectral averaging weight 1/2^n, 0 = off
+    output reg  [3:0]  avg_every,       // Classify every avg_every + 1 frames
+    output reg  [11:0] gate_thr,        // Change gate L1 threshold, 0 = off
+    output reg  [7:0]  gate_max,        // Skips in a row before a forced NN run, 0 = no limit
+    output wire [7:0]  alarm_threshold, // Alarm profile of result_model:
+    output wire [3:0]  fault_count_cfg, // consecutive faults before alarm
+    output reg  [4*NN_MODELS-1:0]   nn_int4,    // INT4 weights, bit l for layer l, 4 per bank
+    output reg  [3*NN_MODELS-1:0]   nn_layers,  // NN layer count (1-4), 3 bits per bank
+    output wire [256*NN_MODELS-1:0] nn_desc,    // NN layer descriptors, 64 bits per layer, 256 per bank
+    output reg  [1:0]  nn_bank,         // Active NN bank
+    output reg         model_per_ch,    // MODEL_CFG.PER_CH: channel c runs bank model_map[2c+1:2c]
+    output reg  [7:0]  model_map,
+    output reg         model_all,       // MODEL_CFG.ALL: banks 0..model_last on every vector
+    output reg  [1:0]  model_last,
+
+    // Bus sample source (spi_adc_if)
+    output reg         inj_valid,       // SAMPLE_IN written (pulse)
+    output reg  [11:0] inj_data,        // ADC code
+    input  wire        inj_ready,       // spi_adc_if takes a sample at once
+    output reg         sw_trig,         // CTRL.TRIG written 1 (pulse)
 
     // Status inputs
     input  wire [1:0]  class_id,
     input  wire [7:0]  confidence,
+    input  wire [15:0] frame_id,        // Window classified (windows since reset)
+    input  wire [15:0] top_score,       // Winning class score
+    input  wire [1:0]  second_id,       // Runner-up class
+    input  wire [15:0] second_score,    // Runner-up class score
+    input  wire        result_reused,   // Result held over by the change gate (nn_gate)
+    input  wire [1:0]  result_ch,       // ADC channel classified
+    input  wire [1:0]  result_model,    // and the NN bank it ran on
     input  wire        fft_busy,
     input  wire        nn_busy,
     input  wire        fe_busy,
     input  wire        alarm_active,
 
     // FFT magnitude readback
-    output reg  [4:0]  fft_rd_addr,
+    output reg  [6:0]  fft_rd_addr,
     input  wire [15:0] fft_rd_data,
 
     // Feature readback
-    output reg  [2:0]  feature_rd_addr,
+    output reg  [3:0]  feature_rd_addr,
     input  wire [7:0]  feature_rd_data,
 
-    // NN weight loading
+    // Readback snapshot: FFT_DATA, FEATURE_DATA and the packed window read
+    // the held frame while snap_held
+    output reg         snap_req,
+    input  wire        snap_held,
+    input  wire [15:0] snap_frame,      // Frame number of the held spectrum / features
+    input  wire [1:0]  snap_size,       // Its FFT length
+    input  wire [1:0]  snap_ch,         // Its ADC channel
+    input  wire [95:0] snap_feat,       // Its features, feature 0 in [7:0]
+
+    // Performance counters (perf_counters read port)
+    output wire        perf_rd,         // PERF page read, clears MAX / counts
+    output wire [3:0]  perf_addr,       // Word in the PERF page
+    input  wire [31:0] perf_data,
+
+    // UART TX (uart_tx byte FIFO)
+    output reg  [15:0] uart_div,        // Bit period - 1, in clocks
+    output wire        uart_wr_en,
+    output wire [7:0]  uart_wr_data,
+    input  wire [4:0]  uart_level,      // Bytes queued (16-byte FIFO)
+    input  wire        uart_busy,
+
+    // NN weight loading (always into the shadow bank)
     output reg         wt_wr_en,
-    output reg  [7:0]  wt_wr_addr,
-    output reg  [7:0]  wt_wr_data,
+    output reg  [1:0]  wt_wr_bank,
+    output reg  [9:0]  wt_wr_addr,      // Byte address of the word
+    output reg  [3:0]  wt_wr_sel,
+    output reg  [31:0] wt_wr_data,      // Byte k is weight wt_wr_addr + k
 
     // Interrupt
     input  wire        classification_done,
     input  wire        alarm_irq_in,
+    input  wire        overrun_in,      // A sample window was lost, or sampling stalled
     output reg  [2:0]  irq
 );
 
     // --- Address map (relative to base) ---
-    // We use bits [7:0] of the address for register selection
+    // We use bits [7:0] of the address for register selection; with
+    // bit 8 set they index the packed spectrum window instead:
+    //   0x100 + 4k: bin 2k in [15:0], bin 2k + 1 in [31:16] (read only,
+    //   three wait states)
+    // and with bit 9 set the PERF page (read only, see perf_counters.v):
+    //   0x200 FRAMES, 0x204 DROPS, 0x208 OVERRUNS,
+    //   0x210 + 8s LAST / 0x214 + 8s MAX of stage s (SPI, FFT, FE, NN, LAT)
+    // CTRL: [0] enable, [1] INJECT (samples from SAMPLE_IN, SPI idle), [2]
+    // TRIG (write 1: hand the newest window over now, reads 0), [5:4] FFT
+    // length, [11:8] IRQ enable
     localparam ADDR_CTRL         = 8'h00;
-    localparam ADDR_STATUS       = 8'h04;
+    localparam ADDR_STATUS       = 8'h04;   // [12:8] result FIFO level, [13] overflow, [14] overrun
     localparam ADDR_CLASS_RESULT = 8'h08;
     localparam ADDR_ALARM_CFG   = 8'h0C;
     localparam ADDR_FFT_DATA    = 8'h10;
     localparam ADDR_FEATURE_DATA = 8'h14;
     localparam ADDR_IRQ_FLAGS   = 8'h18;
     localparam ADDR_CLK_DIV     = 8'h1C;
-    // 8'h20 - 8'h7F: NN weights (212 bytes, 53 x 32-bit words)
+    // 8'h20 - 8'h74: NN weights 0-211 (53 x 32-bit words), byte k of the
+    // word at 0x20 + a is weight a + k
     localparam ADDR_NN_WEIGHTS_BASE = 8'h20;
     localparam ADDR_NN_WEIGHTS_END  = 8'h74; // 0x20 + 53*4 - 4
+    // FRAME_CFG: [8:0] hop size, [13:12] overrun policy, [17:16] ADC
+    // channels sampled - 1 (spi_adc_if)
+    localparam ADDR_FRAME_CFG       = 8'h78;
+    // NN_CFG: [3:0] INT4 layers, [10:8] layer count (shadow bank),
+    // [16] SWAP (write 1: the shadow bank becomes active), [18:17] active
+    // bank
+    localparam ADDR_NN_CFG          = 8'h7C;
+    // 8'h80 - 8'h9F: NN layer descriptors (shadow bank), layer l at 0x80 + 8*l:
+    //   +0 SHAPE [5:0] inputs, [13:8] outputs, [16] ReLU, [23:20] shift
+    //   +4 BASE  [9:0] weight base, [25:16] bias base (byte addresses)
+    localparam ADDR_NN_LAYER_BASE   = 8'h80;
+    // Weight streaming port: NN_WT_ADDR sets the byte address (word
+    // aligned), every NN_WT_DATA write stores 4 weights there and steps it
+    localparam ADDR_NN_WT_ADDR      = 8'hA0;
+    localparam ADDR_NN_WT_DATA      = 8'hA4;
+    // Result FIFO: reading RES_FIFO pops the oldest entry, returning word 0
+    // and latching word 1 into RES_FIFO_HI (an empty FIFO reads 0):
+    //   word 0 [1:0] class, [9:2] confidence, [10] alarm, [11] valid,
+    //          [13:12] runner-up class, [14] reused (change gate skip),
+    //          [31:16] frame
+    //   word 1 [15:0] winning score, [31:16] runner-up score (signed)
+    localparam ADDR_RES_FIFO        = 8'hA8;
+    localparam ADDR_RES_FIFO_HI     = 8'hAC;
+    // RES_CFG: [4:0] IRQ level (IRQ flag 2 when a result brings the FIFO to
+    // that many entries, 0 = off), [8] FLUSH (write 1: empty the FIFO and
+    // clear the overflow flag), [9] CLR_OVF (write 1: clear the overflow flag)
+    localparam ADDR_RES_CFG         = 8'hB0;
+    // UART_DATA: W [7:0] byte into the TX FIFO (dropped when full or in
+    // AUTO mode); R [4:0] bytes queued, [8] busy
+    localparam ADDR_UART_DATA       = 8'hB4;
+    // UART_CFG: [15:0] bit period - 1 in clocks, [16] AUTO: send every
+    // result as a RESULT frame, [17] SCORES: with RES_FIFO_HI as well
+    localparam ADDR_UART_CFG        = 8'hB8;
+    // SNAP_CTRL: [0] TAKE (1: hold the latest spectrum and features, 0:
+    // release); R [1] held, [5:4] FFT length, [7:6] channel, [31:16] frame
+    // number
+    localparam ADDR_SNAP_CTRL       = 8'hBC;
+    // SNAP_FEAT0/1/2: features 0-3 / 4-7 / 8-11, lowest index in [7:0]
+    localparam ADDR_SNAP_FEAT0      = 8'hC0;
+    localparam ADDR_SNAP_FEAT1      = 8'hC4;
+    localparam ADDR_SNAP_FEAT2      = 8'hC8;
+    // AVG_CFG: [2:0] spectral averaging shift (0 = off), [11:8] classify
+    // every n + 1 frames (spec_avg)
+    localparam ADDR_AVG_CFG         = 8'hCC;
+    // GATE_CFG: [11:0] change gate L1 threshold (0 = off), [23:16] NN run
+    // forced after that many skips in a row (0 = no limit, nn_gate)
+    localparam ADDR_GATE_CFG        = 8'hD0;
+    // RES_FIFO_CH: R [1:0] ADC channel and [5:4] NN bank of the entry last
+    // popped (latched with RES_FIFO_HI)
+    localparam ADDR_RES_FIFO_CH     = 8'hD4;
+    // SAMPLE_PERIOD: [23:0] clocks from one ADC sample set to the next;
+    // 0 = free running, as fast as the CLK_DIV bit clock allows (spi_adc_if)
+    localparam ADDR_SAMPLE_PERIOD   = 8'hD8;
+    // SAMPLE_IN: W [11:0] next sample as an ADC code, taken with INJECT and
+    // the pipeline enabled (dropped otherwise). The write is acknowledged
+    // at once; a sample spi_adc_if cannot take (a stall holding sampling)
+    // is dropped and counted in PERF_REJECTS. R [0] a sample would be
+    // taken at once: poll it to throttle the writes to the pipeline rate
+    localparam ADDR_SAMPLE_IN       = 8'hDC;
+    // MODEL_CFG: [0] PER_CH (channel c runs bank [9+2c:8+2c] instead of the
+    // active one), [1] ALL (every feature vector runs banks 0 to [5:4] in
+    // turn, one result each, change gate off), [15:8] channel map, [17:16]
+    // EDIT bank and [18] EDIT_EN (NN_CFG, descriptors and weights edit the
+    // EDIT bank instead of the shadow one). Takes effect from the next
+    // inference, nothing is reloaded
+    localparam ADDR_MODEL_CFG       = 8'hE0;
+    // 8'hE4 - 8'hF0: PROFILE of bank m at 0xE4 + 4*m: [7:0] threshold,
+    // [11:8] fault count (as ALARM_CFG), [16] EN (0: ALARM_CFG applies)
+    localparam ADDR_PROFILE_BASE    = 8'hE4;
+
+    // Link frames: FRAME_SYNC, type, payload length, payload, CRC-8
+    // (polynomial 0x07, init 0) over type, length and payload
+    localparam FRAME_SYNC           = 8'hA5;
+    localparam FRAME_RESULT         = 8'h01;    // RES_FIFO word (+ RES_FIFO_HI) (+ channel), LE
+
+    `include "nn_default_model.vh"
+
+    localparam [31:0] SHAPE_MASK = 32'h00F1_3F3F;
+    localparam [31:0] BASE_MASK  = 32'h03FF_03FF;
 
     // --- Internal registers ---
-    reg [2:0]  irq_flags;       // [0] classification done, [1] alarm, [2] reserved
-    reg [2:0]  irq_enable;
-    reg [4:0]  fft_auto_addr;   // Auto-incrementing FFT read address
-    reg [2:0]  feat_auto_addr;  // Auto-incrementing feature read address
+    reg [3:0]  irq_flags;       // [0] classification done, [1] alarm, [2] result FIFO level,
+                                // [3] overrun
+    reg [3:0]  irq_enable;
+    reg [6:0]  fft_auto_addr;   // Auto-incrementing FFT read address
+    reg [3:0]  feat_auto_addr;  // Auto-incrementing feature read address
+    reg [9:0]  wt_load_addr;    // Weight streaming port address
+    reg [31:0] nn_desc_r [0:8*NN_MODELS-1]; // Layer descriptor words (SHAPE, BASE) x 4, bank b at 8b
+    reg [7:0]  alarm_thr_r;     // ALARM_CFG
+    reg [3:0]  fault_cnt_r;
+    reg [7:0]  prof_thr [0:NN_MODELS-1];    // PROFILE of each bank
+    reg [3:0]  prof_cnt [0:NN_MODELS-1];
+    reg [NN_MODELS-1:0] prof_en;
+    reg [1:0]  model_edit;      // MODEL_CFG.EDIT
+    reg        model_edit_en;
+    reg [4:0]  res_thr;         // Result FIFO IRQ level
+    reg [31:0] res_hi;          // Word 1 of the entry last popped
+    reg [1:0]  res_ch;          // and its channel
+    reg [1:0]  res_model;       // and bank
+    reg        uart_auto;       // Results go out on the UART by themselves
+    reg        uart_scores;     // AUTO frames carry the scores word too
+    reg        uart_cpu_en;     // UART_DATA byte written
+    reg [7:0]  uart_cpu_data;
+    reg [1:0]  win_ph;          // Spectrum window read wait state
+    reg [15:0] win_lo;          // Even bin of the window word
+
+    genvar gd;
+    generate
+        for (gd = 0; gd < 8 * NN_MODELS; gd = gd + 1) begin : g_desc
+            assign nn_desc[32*gd +: 32] = nn_desc_r[gd];
+        end
+    endgenerate
+
+    // Banks past NN_MODELS - 1 fold onto the built ones
+    localparam [1:0] BANK_MASK = NN_MODELS - 1;
+
+    // Alarm profile of the bank that produced the result
+    wire [1:0] prof_m = result_model & BANK_MASK;
+    assign alarm_threshold = prof_en[prof_m] ? prof_thr[prof_m] : alarm_thr_r;
+    assign fault_count_cfg = prof_en[prof_m] ? prof_cnt[prof_m] : fault_cnt_r;
 
     wire       wb_valid = wb_cyc_i && wb_stb_i;
+    wire       wb_reg   = wb_valid && wb_adr_i[9:8] == 2'b00;   // Register page
+    wire       wb_win   = wb_valid && wb_adr_i[9:8] == 2'b01;   // Spectrum window
+    wire       wb_perf  = wb_valid && wb_adr_i[9];              // PERF page
     wire [7:0] reg_addr = wb_adr_i[7:0];
 
-    // --- IRQ flag capture ---
+    assign perf_rd   = wb_perf && !wb_ack_o && !wb_we_i;
+    assign perf_addr = wb_adr_i[5:2];
+    // Bank the model registers edit: the other bank of the active one's
+    // pair, or MODEL_CFG.EDIT
+    wire [1:0] shadow   = (model_edit_en ? model_edit : {nn_bank[1], ~nn_bank[0]}) & BANK_MASK;
+    wire [1:0] prof_idx = (reg_addr - ADDR_PROFILE_BASE) >> 2;
+    wire       prof_reg = reg_addr >= ADDR_PROFILE_BASE &&
+                          reg_addr < ADDR_PROFILE_BASE + 4 * NN_MODELS;
+
+    wire [4:0] desc_idx = {shadow, reg_addr[4:2]};
+
+    // --- Result FIFO ---
+    // Written the clock after classification_done, once alarm_logic has
+    // taken the result into alarm_active. When full, new results are
+    // dropped and the overflow flag set; the frame numbers show the gap.
+    // An entry is word 0, word 1, the channel in [65:64] and the bank in
+    // [67:66].
+    localparam RES_DEPTH = 1 << RES_AW;
+
+    reg [67:0]       res_mem [0:RES_DEPTH-1];
+    reg [RES_AW:0]   res_wp;
+    reg [RES_AW:0]   res_rp;
+    reg              res_push;
+    reg              res_ovf;
+
+    wire [RES_AW:0]  res_level = res_wp - res_rp;
+    wire [4:0]       res_lvl5  = res_level;
+    wire             res_empty = (res_wp == res_rp);
+    wire             res_full  = (res_level == RES_DEPTH);
+    wire [67:0]      res_head  = res_mem[res_rp[RES_AW-1:0]];
+    wire             res_rd    = wb_reg && !wb_ack_o && !wb_we_i &&
+                                 reg_addr == ADDR_RES_FIFO;
+    wire             rep_pop;   // Result reporter takes the head entry
+    wire             res_pop   = (res_rd && !res_empty) || rep_pop;
+    wire             res_flush = wb_reg && !wb_ack_o && wb_we_i &&
+                                 reg_addr == ADDR_RES_CFG && wb_sel_i[1] && wb_dat_i[8];
+    wire             res_clr   = wb_reg && !wb_ack_o && wb_we_i &&
+                                 reg_addr == ADDR_RES_CFG && wb_sel_i[1] && wb_dat_i[9];
+
     always @(posedge clk) begin
         if (rst) begin
-            irq_flags <= 3'd0;
+            res_wp   <= {(RES_AW + 1){1'b0}};
+            res_rp   <= {(RES_AW + 1){1'b0}};
+            res_push <= 1'b0;
+            res_ovf  <= 1'b0;
         end else begin
-            // Set on event
-            if (classification_done) irq_flags[0] <= 1'b1;
-            if (alarm_irq_in)       irq_flags[1] <= 1'b1;
-
-            // Clear on write to IRQ_FLAGS register
-            if (wb_valid && wb_we_i && reg_addr == ADDR_IRQ_FLAGS) begin
-                irq_flags <= irq_flags & ~wb_dat_i[2:0];
+            res_push <= classification_done;
+            if (res_flush) begin
+                res_wp  <= {(RES_AW + 1){1'b0}};
+                res_rp  <= {(RES_AW + 1){1'b0}};
+                res_ovf <= 1'b0;
+            end else begin
+                if (res_clr)
+                    res_ovf <= 1'b0;
+                if (res_pop)
+                    res_rp <= res_rp + 1'b1;
+                if (res_push) begin
+                    if (res_full && !res_pop) begin
+                        res_ovf <= 1'b1;
+                    end else begin
+                        res_mem[res_wp[RES_AW-1:0]] <=
+                            {result_model, result_ch, second_score, top_score,
+                             frame_id, 1'b0, result_reused, second_id, 1'b1, alarm_active,
+                             confidence, class_id};
+                        res_wp <= res_wp + 1'b1;
+                    end
+                end
             end
         end
     end
 
+    // --- Result reporter (UART_CFG.AUTO) ---
+    // Pops an entry once the UART FIFO has room for a whole frame and
+    // pushes its 8 (or 12 with SCORES) bytes on consecutive clocks, the
+    // CRC running over the bytes as they go; with more than one channel or
+    // with MODEL_CFG.PER_CH / ALL the payload ends in a byte with the
+    // channel in [1:0] and the bank in [5:4]. Wishbone RES_FIFO reads keep
+    // priority; a frame, once started, is always finished.
+    reg [95:0] rep_sr;          // Frame bytes still to push, next in [7:0]
+    reg [3:0]  rep_cnt;         // Bytes left, the last one is the CRC
+    reg        rep_sync;        // Next byte is the sync byte (not in the CRC)
+    reg [7:0]  rep_crc;
+
+    wire        rep_tag = (n_ch != 2'd0) || model_per_ch || model_all;
+    wire [3:0]  rep_len = (uart_scores ? 4'd12 : 4'd8) + rep_tag;
+    wire [7:0]  rep_chb = {2'd0, res_head[67:66], 2'd0, res_head[65:64]};
+    wire [71:0] rep_pay = uart_scores ? {rep_chb, res_head[63:0]}
+                                      : {32'd0, rep_chb, res_head[31:0]};
+
+    // CRC-8, polynomial x^8 + x^2 + x + 1, MSB first
+    function [7:0] crc8;
+        input [7:0] crc;
+        input [7:0] data;
+        reg   [7:0] c;
+        integer b;
+        begin
+            c = crc ^ data;
+            for (b = 0; b < 8; b = b + 1)
+                c = c[7] ? ((c << 1) ^ 8'h07) : (c << 1);
+            crc8 = c;
+        end
+    endfunction
+
+    assign rep_pop = uart_auto && rep_cnt == 4'd0 && !res_empty && !res_rd &&
+                     !res_flush && uart_level <= 5'd16 - rep_len;
+
+    assign uart_wr_en   = (rep_cnt != 4'd0) || uart_cpu_en;
+    assign uart_wr_data = (rep_cnt == 4'd1) ? rep_crc :
+                          (rep_cnt != 4'd0) ? rep_sr[7:0] : uart_cpu_data;
+
+    always @(posedge clk) begin
+        if (rst) begin
+            rep_cnt <= 4'd0;
+        end else if (rep_pop) begin
+            rep_sr   <= {rep_pay, 4'd0, rep_len - 4'd4, FRAME_RESULT, FRAME_SYNC};
+            rep_cnt  <= rep_len;
+            rep_sync <= 1'b1;
+            rep_crc  <= 8'd0;
+        end else if (rep_cnt != 4'd0) begin
+            rep_sr   <= rep_sr >> 8;
+            rep_cnt  <= rep_cnt - 4'd1;
+            rep_sync <= 1'b0;
+            if (!rep_sync) rep_crc <= crc8(rep_crc, rep_sr[7:0]);
+        end
+    end
+
+    // --- IRQ flag capture ---
+    // Set on event, cleared by writing 1s to IRQ_FLAGS (once, on the
+    // clock the write is acked); an event on that clock wins over the clear
+    wire [3:0] irq_set = {overrun_in,
+                          res_push && res_thr != 5'd0 && res_level + 1 >= res_thr,
+                          alarm_irq_in,
+                          classification_done};
+    wire [3:0] irq_clr = (wb_reg && !wb_ack_o && wb_we_i && reg_addr == ADDR_IRQ_FLAGS) ?
+                         wb_dat_i[3:0] : 4'd0;
+
+    always @(posedge clk) begin
+        if (rst)
+            irq_flags <= 4'd0;
+        else
+            irq_flags <= (irq_flags & ~irq_clr) | irq_set;
+    end
+
     // IRQ output
     always @(*) begin
         irq[0] = |(irq_flags & irq_enable);
@@ -99,25 +440,100 @@ module wb_interface (
     end
 
     // --- Wishbone transaction handling ---
-    always @(posedge clk) begin
+    always @(posedge clk) begin : wb_regs
+        integer i;
         if (rst) begin
             wb_ack_o       <= 1'b0;
             wb_dat_o       <= 32'd0;
             enable         <= 1'b0;
+            if (boot_run)               // (a floating strap simulates as 0)
+                enable     <= 1'b1;
             clk_div        <= 16'd249;  // Default: divide by 250
-            alarm_threshold <= 8'd128;
-            fault_count_cfg <= 4'd3;
-            irq_enable     <= 3'd0;
-            fft_auto_addr  <= 5'd0;
-            feat_auto_addr <= 3'd0;
+            sample_period  <= 24'd0;    // Default: free running
+            inject         <= 1'b0;     // Default: samples from the ADC
+            inj_valid      <= 1'b0;
+            inj_data       <= 12'd0;
+            sw_trig        <= 1'b0;
+            hop_size       <= 9'd64;    // Default: no frame overlap at N = 64
+            ovr_mode       <= 2'd0;     // Default: the newest window wins
+            fft_size       <= 2'd0;     // Default: 64-point
+            n_ch           <= 2'd0;     // Default: channel 0 only
+            avg_shift      <= 3'd0;     // Default: no averaging,
+            avg_every      <= 4'd0;     // every frame classified
+            gate_thr       <= 12'd0;    // Default: NN runs on every frame
+            gate_max       <= 8'd0;
+            alarm_thr_r    <= 8'd128;
+            fault_cnt_r    <= 4'd3;
+            // Boot model in every bank (default: 8 -> 16 (ReLU) -> 4, 212
+            // parameters from 0, INT8)
+            nn_int4        <= {NN_MODELS{NN_ROM_INT4}};
+            nn_layers      <= {NN_MODELS{NN_ROM_LAYERS}};
+            nn_bank        <= 2'd0;
+            for (i = 0; i < 8 * NN_MODELS; i = i + 1)
+                nn_desc_r[i] <= NN_ROM_DESC[32 * (i % 8) +: 32];
+            // Default: one model for every frame, profiles off (ALARM_CFG)
+            model_per_ch   <= 1'b0;
+            model_all      <= 1'b0;
+            model_last     <= 2'd0;
+            model_map      <= 8'd0;
+            model_edit     <= 2'd0;
+            model_edit_en  <= 1'b0;
+            prof_en        <= {NN_MODELS{1'b0}};
+            for (i = 0; i < NN_MODELS; i = i + 1) begin
+                prof_thr[i] <= 8'd128;
+                prof_cnt[i] <= 4'd3;
+            end
+            irq_enable     <= 4'd0;
+            fft_auto_addr  <= 7'd0;
+            feat_auto_addr <= 4'd0;
+            wt_load_addr   <= 10'd0;
+            res_thr        <= RES_DEPTH / 2;
+            res_hi         <= 32'd0;
+            res_ch         <= 2'd0;
+            res_model      <= 2'd0;
+            uart_div       <= 16'd216;  // Default: 115200 baud at 25 MHz
+            uart_auto      <= 1'b0;
+            uart_scores    <= 1'b0;
+            uart_cpu_en    <= 1'b0;
+            snap_req       <= 1'b0;
+            win_ph         <= 2'd0;
             wt_wr_en       <= 1'b0;
-            fft_rd_addr    <= 5'd0;
-            feature_rd_addr <= 3'd0;
+            fft_rd_addr    <= 7'd0;
+            feature_rd_addr <= 4'd0;
         end else begin
             wb_ack_o <= 1'b0;
             wt_wr_en <= 1'b0;
+            uart_cpu_en <= 1'b0;
+            inj_valid <= 1'b0;
+            sw_trig  <= 1'b0;
 
-            if (wb_valid && !wb_ack_o) begin
+            // --- Spectrum window ---
+            // Bins 2k and 2k + 1 go through the fft_rd_addr port one after
+            // the other (one clock read latency), then the auto-increment
+            // address is put back. Writes are ignored
+            if (wb_win && !wb_ack_o) begin
+                if (wb_we_i || win_ph == 2'd3) begin
+                    wb_ack_o    <= 1'b1;
+                    wb_dat_o    <= wb_we_i ? 32'd0 : {fft_rd_data, win_lo};
+                    win_ph      <= 2'd0;
+                    fft_rd_addr <= fft_auto_addr;
+                end else begin
+                    win_ph <= win_ph + 2'd1;
+                    case (win_ph)
+                        2'd0:    fft_rd_addr <= {wb_adr_i[7:2], 1'b0};
+                        2'd1:    fft_rd_addr <= {wb_adr_i[7:2], 1'b1};
+                        default: win_lo      <= fft_rd_data;
+                    endcase
+                end
+            end
+
+            // --- PERF page --- (writes are ignored)
+            if (wb_perf && !wb_ack_o) begin
+                wb_ack_o <= 1'b1;
+                wb_dat_o <= wb_we_i ? 32'd0 : perf_data;
+            end
+
+            if (wb_reg && !wb_ack_o) begin
                 wb_ack_o <= 1'b1;
 
                 if (wb_we_i) begin
@@ -125,42 +541,119 @@ module wb_interface (
                     case (reg_addr)
                         ADDR_CTRL: begin
                             if (wb_sel_i[0]) enable    <= wb_dat_i[0];
-                            if (wb_sel_i[1]) irq_enable <= wb_dat_i[10:8];
+                            if (wb_sel_i[0]) inject    <= wb_dat_i[1];
+                            if (wb_sel_i[0]) sw_trig   <= wb_dat_i[2];
+                            if (wb_sel_i[0]) fft_size  <= wb_dat_i[5:4];
+                            if (wb_sel_i[1]) irq_enable <= wb_dat_i[11:8];
                         end
                         ADDR_ALARM_CFG: begin
-                            if (wb_sel_i[0]) alarm_threshold <= wb_dat_i[7:0];
-                            if (wb_sel_i[1]) fault_count_cfg <= wb_dat_i[11:8];
+                            if (wb_sel_i[0]) alarm_thr_r <= wb_dat_i[7:0];
+                            if (wb_sel_i[1]) fault_cnt_r <= wb_dat_i[11:8];
+                        end
+                        ADDR_MODEL_CFG: begin
+                            if (wb_sel_i[0]) model_per_ch  <= wb_dat_i[0];
+                            if (wb_sel_i[0]) model_all     <= wb_dat_i[1];
+                            if (wb_sel_i[0]) model_last    <= wb_dat_i[5:4];
+                            if (wb_sel_i[1]) model_map     <= wb_dat_i[15:8];
+                            if (wb_sel_i[2]) model_edit    <= wb_dat_i[17:16];
+                            if (wb_sel_i[2]) model_edit_en <= wb_dat_i[18];
                         end
                         ADDR_CLK_DIV: begin
                             if (wb_sel_i[0]) clk_div[7:0]  <= wb_dat_i[7:0];
                             if (wb_sel_i[1]) clk_div[15:8] <= wb_dat_i[15:8];
                         end
+                        ADDR_SAMPLE_PERIOD: begin
+                            if (wb_sel_i[0]) sample_period[7:0]   <= wb_dat_i[7:0];
+                            if (wb_sel_i[1]) sample_period[15:8]  <= wb_dat_i[15:8];
+                            if (wb_sel_i[2]) sample_period[23:16] <= wb_dat_i[23:16];
+                        end
+                        ADDR_SAMPLE_IN: begin
+                            inj_valid <= wb_sel_i[0] && inject && enable;
+                            inj_data  <= wb_dat_i[11:0];
+                        end
+                        ADDR_FRAME_CFG: begin
+                            if (wb_sel_i[0]) hop_size[7:0] <= wb_dat_i[7:0];
+                            if (wb_sel_i[1]) hop_size[8]   <= wb_dat_i[8];
+                            if (wb_sel_i[1]) ovr_mode      <= wb_dat_i[13:12];
+                            if (wb_sel_i[2]) n_ch          <= wb_dat_i[17:16];
+                        end
+                        ADDR_AVG_CFG: begin
+                            if (wb_sel_i[0]) avg_shift <= wb_dat_i[2:0];
+                            if (wb_sel_i[1]) avg_every <= wb_dat_i[11:8];
+                        end
+                        ADDR_GATE_CFG: begin
+                            if (wb_sel_i[0]) gate_thr[7:0]  <= wb_dat_i[7:0];
+                            if (wb_sel_i[1]) gate_thr[11:8] <= wb_dat_i[11:8];
+                            if (wb_sel_i[2]) gate_max       <= wb_dat_i[23:16];
+                        end
+                        ADDR_NN_CFG: begin
+                            // A write may set the shadow config and swap it
+                            // in at once
+                            if (wb_sel_i[0]) nn_int4[4*shadow +: 4]   <= wb_dat_i[3:0];
+                            if (wb_sel_i[1]) nn_layers[3*shadow +: 3] <= wb_dat_i[10:8];
+                            if (wb_sel_i[2] && wb_dat_i[16]) nn_bank <= shadow;
+                        end
+                        ADDR_NN_WT_ADDR: begin
+                            wt_load_addr <= wb_dat_i[9:0] & 10'h3FC;
+                        end
+                        ADDR_NN_WT_DATA: begin
+                            wt_wr_en     <= |wb_sel_i;
+                            wt_wr_bank   <= shadow;
+                            wt_wr_addr   <= wt_load_addr;
+                            wt_wr_sel    <= wb_sel_i;
+                            wt_wr_data   <= wb_dat_i;
+                            wt_load_addr <= wt_load_addr + 10'd4;
+                        end
+                        ADDR_RES_CFG: begin
+                            if (wb_sel_i[0]) res_thr <= wb_dat_i[4:0];
+                        end
+                        ADDR_UART_DATA: begin
+                            // The reporter owns the UART while AUTO is on
+                            // or a record is going out
+                            uart_cpu_en   <= wb_sel_i[0] && !uart_auto && rep_cnt == 4'd0;
+                            uart_cpu_data <= wb_dat_i[7:0];
+                        end
+                        ADDR_SNAP_CTRL: begin
+                            if (wb_sel_i[0]) snap_req <= wb_dat_i[0];
+                        end
+                        ADDR_UART_CFG: begin
+                            if (wb_sel_i[0]) uart_div[7:0]  <= wb_dat_i[7:0];
+                            if (wb_sel_i[1]) uart_div[15:8] <= wb_dat_i[15:8];
+                            if (wb_sel_i[2]) uart_auto      <= wb_dat_i[16];
+                            if (wb_sel_i[2]) uart_scores    <= wb_dat_i[17];
+                        end
                         ADDR_FFT_DATA: begin
                             // Write sets the auto-increment address
-                            fft_auto_addr <= wb_dat_i[4:0];
-                            fft_rd_addr   <= wb_dat_i[4:0];
+                            fft_auto_addr <= wb_dat_i[6:0];
+                            fft_rd_addr   <= wb_dat_i[6:0];
                         end
                         ADDR_FEATURE_DATA: begin
-                            feat_auto_addr  <= wb_dat_i[2:0];
-                            feature_rd_addr <= wb_dat_i[2:0];
+                            feat_auto_addr  <= wb_dat_i[3:0];
+                            feature_rd_addr <= wb_dat_i[3:0];
                         end
                         default: begin
-                            // NN weight writes
+                            if (prof_reg) begin
+                                if (wb_sel_i[0]) prof_thr[prof_idx] <= wb_dat_i[7:0];
+                                if (wb_sel_i[1]) prof_cnt[prof_idx] <= wb_dat_i[11:8];
+                                if (wb_sel_i[2]) prof_en[prof_idx]  <= wb_dat_i[16];
+                            end
+                            // NN layer descriptor writes
+                            if ((reg_addr & 8'hE0) == ADDR_NN_LAYER_BASE) begin : desc_write_block
+                                reg [31:0] mask;
+                                mask = reg_addr[2] ? BASE_MASK : SHAPE_MASK;
+                                if (wb_sel_i[0]) nn_desc_r[desc_idx][7:0]   <= wb_dat_i[7:0]   & mask[7:0];
+                                if (wb_sel_i[1]) nn_desc_r[desc_idx][15:8]  <= wb_dat_i[15:8]  & mask[15:8];
+                                if (wb_sel_i[2]) nn_desc_r[desc_idx][23:16] <= wb_dat_i[23:16] & mask[23:16];
+                                if (wb_sel_i[3]) nn_desc_r[desc_idx][31:24] <= wb_dat_i[31:24] & mask[31:24];
+                            end
+                            // NN weight writes: one word carries 4 weight
+                            // bytes, byte lane k at (reg_addr - 0x20) + k
                             if (reg_addr >= ADDR_NN_WEIGHTS_BASE && reg_addr <= ADDR_NN_WEIGHTS_END) begin
-                                // Each 32-bit word writes up to 4 weight bytes
-                                // Address mapping: (reg_addr - 0x20) gives word offset
-                                // Byte address = word_offset * 4 + byte_lane
-                                begin : wt_write_block
-                                    reg [7:0] base_addr;
-                                    base_addr = (reg_addr - ADDR_NN_WEIGHTS_BASE);  // Word offset * 4 (already aligned)
-
-                                    // Write byte 0
-                                    if (wb_sel_i[0] && base_addr < 8'd212) begin
-                                        wt_wr_en   <= 1'b1;
-                                        wt_wr_addr <= base_addr;
-                                        wt_wr_data <= wb_dat_i[7:0];
-                                    end
-                                end
+                                wt_wr_en   <= |wb_sel_i;
+                                wt_wr_bank <= shadow;
+                                wt_wr_addr <= {2'b00, reg_addr - ADDR_NN_WEIGHTS_BASE} & 10'h3FC;
+                                wt_wr_sel  <= wb_sel_i;
+                                wt_wr_data <= wb_dat_i;
                             end
                         end
                     endcase
@@ -168,35 +661,101 @@ module wb_interface (
                     // --- Read operations ---
                     case (reg_addr)
                         ADDR_CTRL: begin
-                            wb_dat_o <= {21'd0, irq_enable, 7'd0, enable};
+                            wb_dat_o <= {20'd0, irq_enable, 2'd0, fft_size, 2'd0, inject, enable};
                         end
                         ADDR_STATUS: begin
-                            wb_dat_o <= {27'd0, alarm_active, fe_busy, nn_busy, fft_busy, enable};
+                            wb_dat_o <= {17'd0, irq_flags[3], res_ovf, res_lvl5, 3'd0,
+                                         alarm_active, fe_busy, nn_busy, fft_busy, enable};
                         end
                         ADDR_CLASS_RESULT: begin
                             wb_dat_o <= {22'd0, confidence, class_id};
                         end
                         ADDR_ALARM_CFG: begin
-                            wb_dat_o <= {20'd0, fault_count_cfg, alarm_threshold};
+                            wb_dat_o <= {20'd0, fault_cnt_r, alarm_thr_r};
+                        end
+                        ADDR_MODEL_CFG: begin
+                            wb_dat_o <= {13'd0, model_edit_en, model_edit, model_map,
+                                         2'd0, model_last, 2'd0, model_all, model_per_ch};
                         end
                         ADDR_FFT_DATA: begin
                             wb_dat_o      <= {16'd0, fft_rd_data};
-                            fft_auto_addr <= fft_auto_addr + 5'd1;
-                            fft_rd_addr   <= fft_auto_addr + 5'd1;
+                            fft_auto_addr <= fft_auto_addr + 7'd1;
+                            fft_rd_addr   <= fft_auto_addr + 7'd1;
                         end
                         ADDR_FEATURE_DATA: begin
                             wb_dat_o       <= {24'd0, feature_rd_data};
-                            feat_auto_addr <= feat_auto_addr + 3'd1;
-                            feature_rd_addr <= feat_auto_addr + 3'd1;
+                            feat_auto_addr <= feat_auto_addr + 4'd1;
+                            feature_rd_addr <= feat_auto_addr + 4'd1;
                         end
                         ADDR_IRQ_FLAGS: begin
-                            wb_dat_o <= {29'd0, irq_flags};
+                            wb_dat_o <= {28'd0, irq_flags};
                         end
                         ADDR_CLK_DIV: begin
                             wb_dat_o <= {16'd0, clk_div};
                         end
+                        ADDR_SAMPLE_PERIOD: begin
+                            wb_dat_o <= {8'd0, sample_period};
+                        end
+                        ADDR_SAMPLE_IN: begin
+                            wb_dat_o <= {31'd0, inj_ready};
+                        end
+                        ADDR_FRAME_CFG: begin
+                            wb_dat_o <= {14'd0, n_ch, 2'd0, ovr_mode, 3'd0, hop_size};
+                        end
+                        ADDR_AVG_CFG: begin
+                            wb_dat_o <= {20'd0, avg_every, 5'd0, avg_shift};
+                        end
+                        ADDR_GATE_CFG: begin
+                            wb_dat_o <= {8'd0, gate_max, 4'd0, gate_thr};
+                        end
+                        ADDR_NN_CFG: begin
+                            wb_dat_o <= {13'd0, nn_bank, 6'd0, nn_layers[3*shadow +: 3],
+                                         4'd0, nn_int4[4*shadow +: 4]};
+                        end
+                        ADDR_NN_WT_ADDR: begin
+                            wb_dat_o <= {22'd0, wt_load_addr};
+                        end
+                        ADDR_RES_FIFO: begin
+                            wb_dat_o <= res_empty ? 32'd0 : res_head[31:0];
+                            res_hi   <= res_empty ? 32'd0 : res_head[63:32];
+                            res_ch   <= res_empty ? 2'd0  : res_head[65:64];
+                            res_model <= res_empty ? 2'd0 : res_head[67:66];
+                        end
+                        ADDR_RES_FIFO_HI: begin
+                            wb_dat_o <= res_hi;
+                        end
+                        ADDR_RES_FIFO_CH: begin
+                            wb_dat_o <= {26'd0, res_model, 2'd0, res_ch};
+                        end
+                        ADDR_RES_CFG: begin
+                            wb_dat_o <= {27'd0, res_thr};
+                        end
+                        ADDR_UART_DATA: begin
+                            wb_dat_o <= {23'd0, uart_busy, 3'd0, uart_level};
+                        end
+                        ADDR_UART_CFG: begin
+                            wb_dat_o <= {14'd0, uart_scores, uart_auto, uart_div};
+                        end
+                        ADDR_SNAP_CTRL: begin
+                            wb_dat_o <= {snap_frame, 8'd0, snap_ch, snap_size, 2'd0, snap_held, snap_req};
+                        end
+                        ADDR_SNAP_FEAT0: begin
+                            wb_dat_o <= snap_feat[31:0];
+                        end
+                        ADDR_SNAP_FEAT1: begin
+                            wb_dat_o <= snap_feat[63:32];
+                        end
+                        ADDR_SNAP_FEAT2: begin
+                            wb_dat_o <= snap_feat[95:64];
+                        end
                         default: begin
-                            wb_dat_o <= 32'd0;
+                            if (prof_reg)
+                                wb_dat_o <= {15'd0, prof_en[prof_idx], 4'd0,
+                                             prof_cnt[prof_idx], prof_thr[prof_idx]};
+                            else if ((reg_addr & 8'hE0) == ADDR_NN_LAYER_BASE)
+                                wb_dat_o <= nn_desc_r[desc_idx];
+                            else
+                                wb_dat_o <= 32'd0;
                         end
                     endcase
                 end